@@ -0,0 +1,69 @@
+#ifndef BENCH_SOURCE_H
+#define BENCH_SOURCE_H
+
+// Timing and synthetic FCx source shared by the benchmark programs
+// (src/*/*_bench.c). Each bench is a single translation unit, so everything
+// here is static.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// One generated function; %zu is replaced by the function number
+#define BENCH_FUNCTION_TEMPLATE                                               \
+  "fn bench_func_%zu(a, b) -> i64 {\n"                                        \
+  "    let x := a + b * %zu\n"                                                \
+  "    let y := (x << 2) ^ (b >> 1)\n"                                        \
+  "    let total := 0\n"                                                      \
+  "    if x > y {\n"                                                          \
+  "        total := total + x - y\n"                                          \
+  "    } else {\n"                                                            \
+  "        total := total + y - x\n"                                          \
+  "    }\n"                                                                   \
+  "    if a == 0 { ret total }\n"                                             \
+  "    if b >= 48 {\n"                                                        \
+  "        if b <= 57 {\n"                                                    \
+  "            total := total * 10 + b - 48\n"                                \
+  "        }\n"                                                               \
+  "    }\n"                                                                   \
+  "    ret total + bench_helper(x, y, a & 255)\n"                             \
+  "}\n"                                                                       \
+  "\n"
+#define BENCH_FUNCTION_TEMPLATE_LINES 18
+
+// The function every template calls
+#define BENCH_HELPER                                                          \
+  "fn bench_helper(p, q, r) -> i64 {\n    ret p + q + r\n}\n\n"
+
+static inline double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// prelude followed by function_count copies of function_template, which
+// takes the function number twice. Caller frees; NULL on OOM. out_size may
+// be NULL.
+static inline char *generate_bench_source(const char *prelude,
+                                          const char *function_template,
+                                          size_t function_count,
+                                          size_t *out_size) {
+  size_t capacity = strlen(prelude) + 1 +
+                    function_count * (strlen(function_template) + 48);
+  char *source = malloc(capacity);
+  if (!source) {
+    return NULL;
+  }
+  size_t size = (size_t)snprintf(source, capacity, "%s", prelude);
+  for (size_t i = 0; i < function_count; i++) {
+    size += (size_t)snprintf(source + size, capacity - size,
+                             function_template, i, i);
+  }
+  if (out_size) {
+    *out_size = size;
+  }
+  return source;
+}
+
+#endif // BENCH_SOURCE_H
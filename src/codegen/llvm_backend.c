@@ -1,10 +1,19 @@
 #include "llvm_backend.h"
+#include "../lexer/intern.h"
+#include <llvm-c/BitReader.h>
 #include <llvm-c/IRReader.h>
 #include <llvm-c/Linker.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <spawn.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
 static void set_error(LLVMBackend* backend, const char* fmt, ...) {
@@ -38,7 +47,7 @@ static const char* build_target_features(const CpuFeatures* features) {
 LLVMBackendConfig llvm_default_config(void) {
     return (LLVMBackendConfig){
         .opt_level = LLVM_OPT_DEFAULT, .size_level = LLVM_SIZE_DEFAULT,
-        .debug_info = false, .verify_module = true,
+        .debug_info = false, .verify_module = true, .direct_ssa = true,
         .target_triple = "x86_64-pc-linux-gnu", .cpu = "x86-64", .features = ""
     };
 }
@@ -107,6 +116,16 @@ LLVMBackend* llvm_backend_create(const CpuFeatures* features, const LLVMBackendC
     return b;
 }
 
+// Each split-codegen thread needs its own machine; they are not shared
+static LLVMTargetMachineRef create_target_machine(const LLVMBackend* b) {
+    LLVMCodeGenOptLevel opt = LLVMCodeGenLevelDefault;
+    if (b->config.opt_level == LLVM_OPT_NONE) opt = LLVMCodeGenLevelNone;
+    else if (b->config.opt_level == LLVM_OPT_AGGRESSIVE) opt = LLVMCodeGenLevelAggressive;
+    
+    return LLVMCreateTargetMachine(b->target, b->config.target_triple,
+        b->config.cpu, b->config.features, opt, LLVMRelocPIC, LLVMCodeModelDefault);
+}
+
 bool llvm_backend_init_target(LLVMBackend* b) {
     LLVMInitializeX86TargetInfo();
     LLVMInitializeX86Target();
@@ -121,12 +140,7 @@ bool llvm_backend_init_target(LLVMBackend* b) {
         return false;
     }
     
-    LLVMCodeGenOptLevel opt = LLVMCodeGenLevelDefault;
-    if (b->config.opt_level == LLVM_OPT_NONE) opt = LLVMCodeGenLevelNone;
-    else if (b->config.opt_level == LLVM_OPT_AGGRESSIVE) opt = LLVMCodeGenLevelAggressive;
-    
-    b->target_machine = LLVMCreateTargetMachine(b->target, b->config.target_triple,
-        b->config.cpu, b->config.features, opt, LLVMRelocPIC, LLVMCodeModelDefault);
+    b->target_machine = create_target_machine(b);
     if (!b->target_machine) { set_error(b, "Failed to create target machine"); return false; }
     
     b->target_data = LLVMCreateTargetDataLayout(b->target_machine);
@@ -143,8 +157,12 @@ void llvm_backend_destroy(LLVMBackend* b) {
         free(b->current_func_ctx->vreg_values);
         free(b->current_func_ctx->vreg_allocas);
         free(b->current_func_ctx->vreg_is_mutable);
+        free(b->current_func_ctx->vreg_slot_types);
         free(b->current_func_ctx->vreg_types);
         free(b->current_func_ctx->label_blocks);
+        free(b->current_func_ctx->pending_phis);
+        free(b->current_func_ctx->pending_phi_instrs);
+        free(b->current_func_ctx->label_end_blocks);
         free(b->current_func_ctx);
         b->current_func_ctx = NULL;
     }
@@ -162,6 +180,10 @@ void llvm_backend_destroy(LLVMBackend* b) {
     b->external_funcs = NULL;
     b->external_func_count = 0;
     
+    free(b->internal_funcs);
+    b->internal_funcs = NULL;
+    b->internal_func_count = 0;
+    
     // LLVM objects must be disposed in reverse creation order
     // Modules depend on builders and contexts
     if (b->module) {
@@ -211,8 +233,12 @@ void llvm_backend_reset(LLVMBackend* b) {
         free(b->current_func_ctx->vreg_values);
         free(b->current_func_ctx->vreg_allocas);
         free(b->current_func_ctx->vreg_is_mutable);
+        free(b->current_func_ctx->vreg_slot_types);
         free(b->current_func_ctx->vreg_types);
         free(b->current_func_ctx->label_blocks);
+        free(b->current_func_ctx->pending_phis);
+        free(b->current_func_ctx->pending_phi_instrs);
+        free(b->current_func_ctx->label_end_blocks);
         // Note: current_func_ctx->blocks is never allocated per the cleanup comment in emit_function
         free(b->current_func_ctx);
         b->current_func_ctx = NULL;
@@ -233,6 +259,10 @@ void llvm_backend_reset(LLVMBackend* b) {
     b->external_funcs = NULL;
     b->external_func_count = 0;
     
+    free(b->internal_funcs);
+    b->internal_funcs = NULL;
+    b->internal_func_count = 0;
+    
     // Dispose module if it exists
     if (b->module) {
         LLVMDisposeModule(b->module);
@@ -250,6 +280,7 @@ void llvm_backend_reset(LLVMBackend* b) {
     // Reset error state
     b->has_error = false;
     b->error_message[0] = '\0';
+    b->optimized = false;
     
     // Note: Do NOT dispose/reset LLVM infrastructure that should persist:
     // - b->context (LLVM context)
@@ -313,7 +344,9 @@ static LLVMTypeRef llvm_type_for_vreg(LLVMBackend* b, VRegType type) {
         case VREG_TYPE_PTR:
         case VREG_TYPE_RAWPTR:
         case VREG_TYPE_BYTEPTR:
-            return LLVMPointerTypeInContext(b->context, 0);
+            // Function bodies do address arithmetic on pointers as i64;
+            // only signatures use pointer types (signature_llvm_type)
+            return LLVMInt64TypeInContext(b->context);
         case VREG_TYPE_BOOL:
             return LLVMInt1TypeInContext(b->context);
         case VREG_TYPE_VOID:
@@ -382,27 +415,453 @@ static LLVMTypeRef llvm_type_for_vreg_or_size(LLVMBackend* b, VirtualReg vreg, u
     return llvm_int_type(b, sz);
 }
 
-static LLVMValueRef get_vreg(LLVMBackend* b, VirtualReg vreg) {
+// ============================================================================
+// Direct SSA Construction
+// ============================================================================
+
+// With config.direct_ssa, mutable vregs (written in several blocks, and the
+// ABI registers) are built straight into SSA form after Braun et al.,
+// "Simple and Efficient Construction of Static Single Assignment Form":
+// every FC IR block records each vreg's value at its end, a read with no
+// definition in its block asks the predecessors, and a phi is placed where
+// they can disagree. A block is sealed once all its predecessors have been
+// emitted; a read in an unsealed block gets a phi whose operands are added
+// on sealing. Trivial phis are removed once the function is complete. The
+// values are those the allocas would hold: of the vreg's slot type, and
+// zero on paths that never write it.
+
+typedef struct {
+    uint32_t vreg;
+    LLVMValueRef phi;
+    uint32_t next;                  // Next incomplete phi of the block + 1, 0 ends
+} IncompletePhi;
+
+struct LLVMSSABuilder {
+    uint32_t block_count;           // FC IR blocks; index block_count is the entry block
+    uint32_t current;               // Block whose instructions are being emitted
+    uint32_t* block_of_label;       // By label id; UINT32_MAX for labels of no block
+    uint32_t* pred_start;           // Preds of block k: preds[pred_start[k] .. pred_start[k + 1])
+    uint32_t* preds;
+    uint32_t succs[2];              // Scratch for block_successors
+    uint32_t* unfilled_preds;       // Predecessors not yet emitted
+    bool* sealed;
+    uint32_t* incomplete_head;      // Per block, first incomplete phi + 1
+    IncompletePhi* incomplete;
+    uint32_t incomplete_count;
+    uint32_t incomplete_capacity;
+    // Definition of each (block, vreg): open addressing on (block + 1) << 32 | vreg
+    uint64_t* def_keys;
+    LLVMValueRef* def_values;
+    uint32_t def_capacity;
+    uint32_t def_count;
+    LLVMValueRef* phis;             // Every phi built, for trivial phi removal
+    uint32_t phi_count;
+    uint32_t phi_capacity;
+    LLVMBasicBlockRef entry;
+    LLVMBuilderRef builder;         // Places phis without moving the main builder
+    bool failed;
+};
+
+static bool is_fc_jump(FcIROpcode opcode) {
+    return opcode == FCIR_JMP || (opcode >= FCIR_JE && opcode <= FCIR_JBE);
+}
+
+
+// Direct SSA needs every edge to leave from the end of an FC IR block, where
+// the block's definitions are final: jumps and returns must close their
+// block (jcc only as jcc; jmp) and target labels of the function's blocks
+static bool has_plain_block_ends(const FcIRFunction* fn, const uint32_t* block_of_label,
+                                 uint32_t label_count) {
+    for (uint32_t k = 0; k < fn->block_count; k++) {
+        const FcIRBasicBlock* blk = &fn->blocks[k];
+        for (uint32_t j = 0; j < blk->instruction_count; j++) {
+            const FcIRInstruction* instr = &blk->instructions[j];
+            if (instr->opcode == FCIR_LABEL) return false;
+            if (instr->opcode == FCIR_RET && j + 1 != blk->instruction_count) return false;
+            if (!is_fc_jump(instr->opcode)) continue;
+            bool last = j + 1 == blk->instruction_count;
+            if (instr->opcode == FCIR_JMP ? !last :
+                !(j + 2 == blk->instruction_count && blk->instructions[j + 1].opcode == FCIR_JMP)) {
+                return false;
+            }
+            if (instr->operand_count == 0 || instr->operands[0].type != FC_OPERAND_LABEL ||
+                instr->operands[0].u.label_id >= label_count ||
+                block_of_label[instr->operands[0].u.label_id] == UINT32_MAX) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Distinct successors of block k in s->succs; returns how many
+static uint32_t block_successors(LLVMSSABuilder* s, const FcIRFunction* fn, uint32_t k) {
+    const FcIRBasicBlock* blk = &fn->blocks[k];
+    uint32_t count = 0;
+    const FcIRInstruction* last = blk->instruction_count ? &blk->instructions[blk->instruction_count - 1] : NULL;
+    if (last && last->opcode == FCIR_JMP) {
+        if (blk->instruction_count >= 2 && is_fc_jump(blk->instructions[blk->instruction_count - 2].opcode)) {
+            s->succs[count++] = s->block_of_label[blk->instructions[blk->instruction_count - 2].operands[0].u.label_id];
+        }
+        uint32_t target = s->block_of_label[last->operands[0].u.label_id];
+        if (count == 0 || s->succs[0] != target) {
+            s->succs[count++] = target;
+        }
+    } else if (!last || last->opcode != FCIR_RET) {
+        // Falls through, as llvm_emit_function branches to the next block
+        if (k + 1 < fn->block_count) {
+            s->succs[count++] = k + 1;
+        }
+    }
+    return count;
+}
+
+static void ssa_builder_destroy(LLVMSSABuilder* s) {
+    if (!s) return;
+    free(s->block_of_label);
+    free(s->pred_start);
+    free(s->preds);
+    free(s->unfilled_preds);
+    free(s->sealed);
+    free(s->incomplete_head);
+    free(s->incomplete);
+    free(s->def_keys);
+    free(s->def_values);
+    free(s->phis);
+    if (s->builder) LLVMDisposeBuilder(s->builder);
+    free(s);
+}
+
+// Builds the predecessor lists of `fn`, or returns NULL when the function
+// cannot be emitted in direct SSA form (or on allocation failure)
+static LLVMSSABuilder* ssa_builder_create(LLVMBackend* b, const FcIRFunction* fn,
+                                          uint32_t label_count, LLVMBasicBlockRef entry) {
+    LLVMSSABuilder* s = calloc(1, sizeof(LLVMSSABuilder));
+    if (!s) return NULL;
+    uint32_t n = fn->block_count;
+    s->block_count = n;
+    s->current = n;
+    s->entry = entry;
+    s->block_of_label = malloc((label_count ? label_count : 1) * sizeof(uint32_t));
+    s->pred_start = calloc(n + 2, sizeof(uint32_t));
+    s->unfilled_preds = calloc(n + 1, sizeof(uint32_t));
+    s->sealed = calloc(n + 1, sizeof(bool));
+    s->incomplete_head = calloc(n + 1, sizeof(uint32_t));
+    s->def_capacity = 64;
+    s->def_keys = calloc(s->def_capacity, sizeof(uint64_t));
+    s->def_values = calloc(s->def_capacity, sizeof(LLVMValueRef));
+    s->builder = LLVMCreateBuilderInContext(b->context);
+    if (!s->block_of_label || !s->pred_start || !s->unfilled_preds || !s->sealed ||
+        !s->incomplete_head || !s->def_keys || !s->def_values || !s->builder) {
+        ssa_builder_destroy(s);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < label_count; i++) {
+        s->block_of_label[i] = UINT32_MAX;
+    }
+    for (uint32_t k = 0; k < n; k++) {
+        if (fn->blocks[k].id < label_count) {
+            s->block_of_label[fn->blocks[k].id] = k;
+        }
+    }
+    if (!has_plain_block_ends(fn, s->block_of_label, label_count)) {
+        ssa_builder_destroy(s);
+        return NULL;
+    }
+    
+    // Count, then place, the predecessors of every block; the entry block
+    // precedes the first
+    uint32_t edge_count = 1;
+    s->pred_start[1]++;
+    for (uint32_t k = 0; k < n; k++) {
+        uint32_t count = block_successors(s, fn, k);
+        for (uint32_t e = 0; e < count; e++) {
+            s->pred_start[s->succs[e] + 1]++;
+            s->unfilled_preds[s->succs[e]]++;
+        }
+        edge_count += count;
+    }
+    for (uint32_t k = 0; k <= n; k++) {
+        s->pred_start[k + 1] += s->pred_start[k];
+    }
+    s->preds = malloc(edge_count * sizeof(uint32_t));
+    uint32_t* fill = calloc(n + 1, sizeof(uint32_t));
+    if (!s->preds || !fill) {
+        free(fill);
+        ssa_builder_destroy(s);
+        return NULL;
+    }
+    s->preds[s->pred_start[0] + fill[0]++] = n;
+    for (uint32_t k = 0; k < n; k++) {
+        uint32_t count = block_successors(s, fn, k);
+        for (uint32_t e = 0; e < count; e++) {
+            uint32_t succ = s->succs[e];
+            s->preds[s->pred_start[succ] + fill[succ]++] = k;
+        }
+    }
+    free(fill);
+    for (uint32_t k = 0; k <= n; k++) {
+        s->sealed[k] = s->unfilled_preds[k] == 0;
+    }
+    return s;
+}
+
+static uint32_t ssa_def_index(const LLVMSSABuilder* s, uint64_t key) {
+    uint32_t mask = s->def_capacity - 1;
+    uint32_t i = (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+    while (s->def_keys[i] != 0 && s->def_keys[i] != key) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+static LLVMValueRef ssa_lookup(const LLVMSSABuilder* s, uint32_t block, uint32_t vreg) {
+    uint64_t key = ((uint64_t)(block + 1) << 32) | vreg;
+    uint32_t i = ssa_def_index(s, key);
+    return s->def_keys[i] == key ? s->def_values[i] : NULL;
+}
+
+static void ssa_write(LLVMSSABuilder* s, uint32_t block, uint32_t vreg, LLVMValueRef val) {
+    if (s->def_count * 2 >= s->def_capacity) {
+        uint32_t old_capacity = s->def_capacity;
+        uint64_t* old_keys = s->def_keys;
+        LLVMValueRef* old_values = s->def_values;
+        s->def_capacity = old_capacity * 2;
+        s->def_keys = calloc(s->def_capacity, sizeof(uint64_t));
+        s->def_values = calloc(s->def_capacity, sizeof(LLVMValueRef));
+        if (!s->def_keys || !s->def_values) {
+            free(s->def_keys);
+            free(s->def_values);
+            s->def_keys = old_keys;
+            s->def_values = old_values;
+            s->def_capacity = old_capacity;
+            s->failed = true;
+            return;
+        }
+        for (uint32_t i = 0; i < old_capacity; i++) {
+            if (old_keys[i] != 0) {
+                uint32_t j = ssa_def_index(s, old_keys[i]);
+                s->def_keys[j] = old_keys[i];
+                s->def_values[j] = old_values[i];
+            }
+        }
+        free(old_keys);
+        free(old_values);
+    }
+    uint64_t key = ((uint64_t)(block + 1) << 32) | vreg;
+    uint32_t i = ssa_def_index(s, key);
+    if (s->def_keys[i] == 0) {
+        s->def_keys[i] = key;
+        s->def_count++;
+    }
+    s->def_values[i] = val;
+}
+
+// The LLVM block the edge from FC block `label` to `to` leaves from.
+// emit_jcc continues an FC block in a new LLVM block, so the edge to the
+// jcc's target leaves from an earlier block than the FC block's last one.
+static LLVMBasicBlockRef edge_block(LLVMBackend* b, uint32_t label, LLVMBasicBlockRef to) {
+    LLVMFunctionContext* ctx = b->current_func_ctx;
+    LLVMBasicBlockRef end = ctx->label_end_blocks[label];
+    LLVMBasicBlockRef block = end;
+    while (block) {
+        LLVMValueRef term = LLVMGetBasicBlockTerminator(block);
+        unsigned count = term ? LLVMGetNumSuccessors(term) : 0;
+        for (unsigned k = 0; k < count; k++) {
+            if (LLVMGetSuccessor(term, k) == to) return block;
+        }
+        if (block == ctx->label_blocks[label]) break;
+        
+        // A block emit_jcc started is used only by the jcc's branch
+        LLVMUseRef use = LLVMGetFirstUse(LLVMBasicBlockAsValue(block));
+        block = use ? LLVMGetInstructionParent(LLVMGetUser(use)) : NULL;
+    }
+    return end;
+}
+
+// LLVM block the edge from block k to `to` leaves from
+static LLVMBasicBlockRef ssa_edge_block(LLVMBackend* b, uint32_t k, LLVMBasicBlockRef to) {
+    LLVMSSABuilder* s = b->current_func_ctx->ssa;
+    if (k == s->block_count) return s->entry;
+    return edge_block(b, b->current_func_ctx->fc_function->blocks[k].id, to);
+}
+
+// An operand-less phi for `vreg` at the top of block k
+static LLVMValueRef ssa_new_phi(LLVMBackend* b, uint32_t k, uint32_t vreg) {
+    LLVMFunctionContext* ctx = b->current_func_ctx;
+    LLVMSSABuilder* s = ctx->ssa;
+    if (s->phi_count >= s->phi_capacity) {
+        uint32_t new_capacity = s->phi_capacity == 0 ? 64 : s->phi_capacity * 2;
+        LLVMValueRef* phis = realloc(s->phis, new_capacity * sizeof(LLVMValueRef));
+        if (!phis) {
+            s->failed = true;
+            return NULL;
+        }
+        s->phis = phis;
+        s->phi_capacity = new_capacity;
+    }
+    LLVMBasicBlockRef top = ctx->label_blocks[ctx->fc_function->blocks[k].id];
+    LLVMValueRef first = LLVMGetFirstInstruction(top);
+    if (first) {
+        LLVMPositionBuilderBefore(s->builder, first);
+    } else {
+        LLVMPositionBuilderAtEnd(s->builder, top);
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "v%u", vreg);
+    LLVMValueRef phi = LLVMBuildPhi(s->builder, ctx->vreg_slot_types[vreg], name);
+    s->phis[s->phi_count++] = phi;
+    return phi;
+}
+
+static LLVMValueRef ssa_read(LLVMBackend* b, uint32_t k, uint32_t vreg);
+
+static void ssa_add_phi_operands(LLVMBackend* b, uint32_t k, uint32_t vreg, LLVMValueRef phi) {
+    LLVMSSABuilder* s = b->current_func_ctx->ssa;
+    for (uint32_t p = s->pred_start[k]; p < s->pred_start[k + 1]; p++) {
+        LLVMValueRef val = ssa_read(b, s->preds[p], vreg);
+        if (!val) return;
+        LLVMBasicBlockRef from = ssa_edge_block(b, s->preds[p], LLVMGetInstructionParent(phi));
+        LLVMAddIncoming(phi, &val, &from, 1);
+    }
+}
+
+// Value of `vreg` at the current point of block k, or at its end once the
+// block has been emitted
+static LLVMValueRef ssa_read(LLVMBackend* b, uint32_t k, uint32_t vreg) {
+    LLVMSSABuilder* s = b->current_func_ctx->ssa;
+    LLVMValueRef val = ssa_lookup(s, k, vreg);
+    if (val) return val;
+    
+    // Runs of single-predecessor blocks are walked without recursing; the
+    // value found is then recorded in each block of the run
+    uint32_t start = k;
+    uint32_t steps = 0;
+    while (s->sealed[k] && s->pred_start[k + 1] - s->pred_start[k] == 1 && steps++ <= s->block_count) {
+        k = s->preds[s->pred_start[k]];
+        val = ssa_lookup(s, k, vreg);
+        if (val) break;
+    }
+    if (!val) {
+        if (steps > s->block_count) {
+            // A cycle no path from the entry reaches
+            val = LLVMConstNull(b->current_func_ctx->vreg_slot_types[vreg]);
+            ssa_write(s, k, vreg, val);
+        } else if (!s->sealed[k]) {
+            val = ssa_new_phi(b, k, vreg);
+            if (!val) return NULL;
+            if (s->incomplete_count >= s->incomplete_capacity) {
+                uint32_t new_capacity = s->incomplete_capacity == 0 ? 32 : s->incomplete_capacity * 2;
+                IncompletePhi* incomplete = realloc(s->incomplete, new_capacity * sizeof(IncompletePhi));
+                if (!incomplete) {
+                    s->failed = true;
+                    return NULL;
+                }
+                s->incomplete = incomplete;
+                s->incomplete_capacity = new_capacity;
+            }
+            s->incomplete[s->incomplete_count] = (IncompletePhi){
+                .vreg = vreg, .phi = val, .next = s->incomplete_head[k]
+            };
+            s->incomplete_head[k] = ++s->incomplete_count;
+            ssa_write(s, k, vreg, val);
+        } else if (s->pred_start[k + 1] == s->pred_start[k]) {
+            // The entry block, or an unreachable one: the vreg was never written
+            val = LLVMConstNull(b->current_func_ctx->vreg_slot_types[vreg]);
+            ssa_write(s, k, vreg, val);
+        } else {
+            // Written first so that reads around a loop find the phi
+            val = ssa_new_phi(b, k, vreg);
+            if (!val) return NULL;
+            ssa_write(s, k, vreg, val);
+            ssa_add_phi_operands(b, k, vreg, val);
+        }
+    }
+    for (uint32_t j = start; j != k; j = s->preds[s->pred_start[j]]) {
+        ssa_write(s, j, vreg, val);
+    }
+    return val;
+}
+
+// Completes the phis of block k once all its predecessors are emitted
+static void ssa_seal(LLVMBackend* b, uint32_t k) {
+    LLVMSSABuilder* s = b->current_func_ctx->ssa;
+    for (uint32_t i = s->incomplete_head[k]; i != 0; i = s->incomplete[i - 1].next) {
+        ssa_add_phi_operands(b, k, s->incomplete[i - 1].vreg, s->incomplete[i - 1].phi);
+    }
+    s->incomplete_head[k] = 0;
+    s->sealed[k] = true;
+}
+
+// Block k has been emitted: seal each successor it was the last
+// predecessor of
+static void ssa_fill(LLVMBackend* b, uint32_t k) {
+    LLVMSSABuilder* s = b->current_func_ctx->ssa;
+    uint32_t count = block_successors(s, b->current_func_ctx->fc_function, k);
+    uint32_t succs[2] = { s->succs[0], s->succs[1] };
+    for (uint32_t e = 0; e < count; e++) {
+        if (--s->unfilled_preds[succs[e]] == 0) {
+            ssa_seal(b, succs[e]);
+        }
+    }
+}
+
+// Replaces phis whose operands are all one value (or the phi itself) by that
+// value, until none are left
+static void ssa_remove_trivial_phis(LLVMSSABuilder* s) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (uint32_t k = 0; k < s->phi_count; k++) {
+            LLVMValueRef phi = s->phis[k];
+            if (!phi) continue;
+            LLVMValueRef same = NULL;
+            bool trivial = true;
+            unsigned count = LLVMCountIncoming(phi);
+            for (unsigned j = 0; j < count; j++) {
+                LLVMValueRef val = LLVMGetIncomingValue(phi, j);
+                if (val == same || val == phi) continue;
+                if (same) {
+                    trivial = false;
+                    break;
+                }
+                same = val;
+            }
+            if (!trivial) continue;
+            LLVMReplaceAllUsesWith(phi, same ? same : LLVMConstNull(LLVMTypeOf(phi)));
+            LLVMInstructionEraseFromParent(phi);
+            s->phis[k] = NULL;
+            changed = true;
+        }
+    }
+}
+
+static LLVMValueRef get_vreg_id(LLVMBackend* b, uint32_t id) {
     LLVMFunctionContext* ctx = b->current_func_ctx;
-    if (!ctx || vreg.id >= ctx->vreg_capacity) return NULL;
+    if (!ctx || id >= ctx->vreg_capacity) return NULL;
+    
+    if (ctx->ssa && ctx->vreg_is_mutable[id]) {
+        return ssa_read(b, ctx->ssa->current, id);
+    }
     
     // If this vreg uses alloca (mutable), load from memory
-    if (ctx->vreg_is_mutable && ctx->vreg_is_mutable[vreg.id] && ctx->vreg_allocas[vreg.id]) {
+    if (ctx->vreg_is_mutable && ctx->vreg_is_mutable[id] && ctx->vreg_allocas[id]) {
         char name[32];
-        snprintf(name, sizeof(name), "v%u.load", vreg.id);
-        // Use the stored vreg type, or fall back to i64
-        LLVMTypeRef load_type;
-        if (ctx->vreg_types && vreg.id < ctx->vreg_capacity) {
-            load_type = llvm_type_for_vreg(b, ctx->vreg_types[vreg.id]);
-        } else {
-            load_type = LLVMInt64TypeInContext(b->context);
-        }
-        return LLVMBuildLoad2(b->builder, load_type, ctx->vreg_allocas[vreg.id], name);
+        snprintf(name, sizeof(name), "v%u.load", id);
+        // Load the slot's own type; writes of other types convert on store
+        LLVMTypeRef load_type = LLVMGetAllocatedType(ctx->vreg_allocas[id]);
+        return LLVMBuildLoad2(b->builder, load_type, ctx->vreg_allocas[id], name);
     }
     
-    return ctx->vreg_values[vreg.id];
+    return ctx->vreg_values[id];
+}
+
+static LLVMValueRef get_vreg(LLVMBackend* b, VirtualReg vreg) {
+    return get_vreg_id(b, vreg.id);
 }
 
+static LLVMValueRef cast_to(LLVMBackend* b, LLVMValueRef val, LLVMTypeRef target);
+
 static void set_vreg(LLVMBackend* b, VirtualReg vreg, LLVMValueRef val) {
     LLVMFunctionContext* ctx = b->current_func_ctx;
     if (!ctx) return;
@@ -419,6 +878,10 @@ static void set_vreg(LLVMBackend* b, VirtualReg vreg, LLVMValueRef val) {
             ctx->vreg_is_mutable = realloc(ctx->vreg_is_mutable, new_cap * sizeof(bool));
             memset(ctx->vreg_is_mutable + ctx->vreg_capacity, 0, (new_cap - ctx->vreg_capacity) * sizeof(bool));
         }
+        if (ctx->vreg_slot_types) {
+            ctx->vreg_slot_types = realloc(ctx->vreg_slot_types, new_cap * sizeof(LLVMTypeRef));
+            memset(ctx->vreg_slot_types + ctx->vreg_capacity, 0, (new_cap - ctx->vreg_capacity) * sizeof(LLVMTypeRef));
+        }
         if (ctx->vreg_types) {
             ctx->vreg_types = realloc(ctx->vreg_types, new_cap * sizeof(VRegType));
             memset(ctx->vreg_types + ctx->vreg_capacity, 0, (new_cap - ctx->vreg_capacity) * sizeof(VRegType));
@@ -431,19 +894,19 @@ static void set_vreg(LLVMBackend* b, VirtualReg vreg, LLVMValueRef val) {
         ctx->vreg_types[vreg.id] = vreg.type;
     }
     
-    // If this vreg uses alloca (mutable), store to memory
-    if (ctx->vreg_is_mutable && ctx->vreg_is_mutable[vreg.id] && ctx->vreg_allocas[vreg.id]) {
+    // If this vreg is mutable, store to its alloca or record the definition
+    if (ctx->vreg_is_mutable && ctx->vreg_is_mutable[vreg.id] && (ctx->ssa || ctx->vreg_allocas[vreg.id])) {
         LLVMTypeRef val_type = LLVMTypeOf(val);
         LLVMTypeKind kind = LLVMGetTypeKind(val_type);
         
         // Skip storing void values
         if (kind != LLVMVoidTypeKind) {
-            // Get the target type for this vreg
-            LLVMTypeRef target_ty = llvm_type_for_vreg(b, vreg.type);
-            unsigned target_bits = llvm_bitwidth_for_vreg(vreg.type);
+            // Convert to the type of the vreg's stack slot
+            LLVMTypeRef target_ty = ctx->vreg_slot_types[vreg.id];
             
             if (val_type != target_ty) {
-                if (kind == LLVMIntegerTypeKind) {
+                if (kind == LLVMIntegerTypeKind && LLVMGetTypeKind(target_ty) == LLVMIntegerTypeKind) {
+                    unsigned target_bits = LLVMGetIntTypeWidth(target_ty);
                     unsigned bits = LLVMGetIntTypeWidth(val_type);
                     if (bits < target_bits) {
                         if (vreg_type_is_signed(vreg.type)) {
@@ -454,9 +917,15 @@ static void set_vreg(LLVMBackend* b, VirtualReg vreg, LLVMValueRef val) {
                     } else if (bits > target_bits) {
                         val = LLVMBuildTrunc(b->builder, val, target_ty, "");
                     }
+                } else {
+                    val = cast_to(b, val, target_ty);
                 }
             }
-            LLVMBuildStore(b->builder, val, ctx->vreg_allocas[vreg.id]);
+            if (ctx->ssa) {
+                ssa_write(ctx->ssa, ctx->ssa->current, vreg.id, val);
+            } else {
+                LLVMBuildStore(b->builder, val, ctx->vreg_allocas[vreg.id]);
+            }
         }
     }
     
@@ -507,10 +976,13 @@ static LLVMValueRef get_operand(LLVMBackend* b, const FcOperand* op) {
         }
         case FC_OPERAND_BIGINT: {
             // Bigint constant - use LLVMConstIntOfArbitraryPrecision
-            uint8_t num_limbs = op->u.bigint.num_limbs;
+            const uint64_t* limbs = b->current_func_ctx ?
+                fc_ir_operand_bigint_limbs(b->current_func_ctx->fc_function, op) : NULL;
+            if (!limbs) return NULL;
+            uint8_t num_limbs = op->num_limbs;
             unsigned num_bits = num_limbs * 64;
             LLVMTypeRef bigint_type = LLVMIntTypeInContext(b->context, num_bits);
-            return LLVMConstIntOfArbitraryPrecision(bigint_type, num_limbs, op->u.bigint.limbs);
+            return LLVMConstIntOfArbitraryPrecision(bigint_type, num_limbs, limbs);
         }
         case FC_OPERAND_EXTERNAL_FUNC:
             if (op->u.external_func_id < b->external_func_count)
@@ -575,6 +1047,265 @@ static LLVMValueRef cast_to(LLVMBackend* b, LLVMValueRef val, LLVMTypeRef target
     return val;
 }
 
+// ============================================================================
+// Function Signatures
+// ============================================================================
+
+// Module functions are declared with their FCx parameter and result types.
+// Inside a body, floats are carried as the bits of a double in an i64 (as
+// float literals are) and pointers as i64 addresses; the helpers below
+// convert between that and the signature types at entry, return and calls.
+
+// Result type of a module function: main keeps the i64 status _start hands
+// to exit, and unannotated functions return i64
+static VRegType signature_return_type(const FcIRFunction* fn) {
+    if (fn->return_type == VREG_TYPE_VOID || strcmp(fn->name, "main") == 0) {
+        return VREG_TYPE_I64;
+    }
+    return (VRegType)fn->return_type;
+}
+
+static bool is_pointer_vreg_type(uint8_t type) {
+    return type == VREG_TYPE_PTR || type == VREG_TYPE_RAWPTR || type == VREG_TYPE_BYTEPTR;
+}
+
+static LLVMTypeRef signature_llvm_type(LLVMBackend* b, VRegType type) {
+    if (is_pointer_vreg_type(type)) return LLVMPointerTypeInContext(b->context, 0);
+    return llvm_type_for_vreg(b, type);
+}
+
+static VRegType signature_param_type(const FcIRFunction* fn, uint32_t index) {
+    if (!fn->parameters || fn->parameters[index].type == VREG_TYPE_VOID) {
+        return VREG_TYPE_I64;
+    }
+    return (VRegType)fn->parameters[index].type;
+}
+
+// Integer resize that extends by the signedness of `type`
+static LLVMValueRef resize_int(LLVMBackend* b, LLVMValueRef val, LLVMTypeRef target, VRegType type) {
+    unsigned from = LLVMGetIntTypeWidth(LLVMTypeOf(val));
+    unsigned to = LLVMGetIntTypeWidth(target);
+    if (from < to) {
+        return vreg_type_is_signed(type) ? LLVMBuildSExt(b->builder, val, target, "")
+                                         : LLVMBuildZExt(b->builder, val, target, "");
+    }
+    if (from > to) return LLVMBuildTrunc(b->builder, val, target, "");
+    return val;
+}
+
+// Body value -> argument or result of signature type `type`
+static LLVMValueRef to_signature_value(LLVMBackend* b, LLVMValueRef val, VRegType type) {
+    LLVMTypeRef i64 = LLVMInt64TypeInContext(b->context);
+    LLVMTypeRef f64 = LLVMDoubleTypeInContext(b->context);
+    LLVMTypeRef target = signature_llvm_type(b, type);
+    LLVMTypeKind target_kind = LLVMGetTypeKind(target);
+    if (LLVMTypeOf(val) == target) return val;
+    
+    switch (LLVMGetTypeKind(LLVMTypeOf(val))) {
+        case LLVMPointerTypeKind:
+            if (target_kind == LLVMPointerTypeKind) return LLVMBuildPointerCast(b->builder, val, target, "");
+            val = LLVMBuildPtrToInt(b->builder, val, i64, "");
+            break;
+        case LLVMFloatTypeKind:
+        case LLVMDoubleTypeKind:
+            if (target_kind == LLVMFloatTypeKind || target_kind == LLVMDoubleTypeKind) {
+                return LLVMBuildFPCast(b->builder, val, target, "");
+            }
+            val = LLVMBuildBitCast(b->builder, LLVMBuildFPExt(b->builder, val, f64, ""), i64, "");
+            break;
+        case LLVMIntegerTypeKind:
+            break;
+        default:
+            return LLVMConstNull(target);
+    }
+    
+    switch (target_kind) {
+        case LLVMPointerTypeKind:
+            return LLVMBuildIntToPtr(b->builder, resize_int(b, val, i64, VREG_TYPE_U64), target, "");
+        case LLVMDoubleTypeKind:
+        case LLVMFloatTypeKind: {
+            LLVMValueRef bits = resize_int(b, val, i64, VREG_TYPE_U64);
+            return LLVMBuildFPCast(b->builder, LLVMBuildBitCast(b->builder, bits, f64, ""), target, "");
+        }
+        default:
+            return resize_int(b, val, target, type);
+    }
+}
+
+// Parameter or call result -> the representation the body works with
+static LLVMValueRef from_signature_value(LLVMBackend* b, LLVMValueRef val) {
+    LLVMTypeRef i64 = LLVMInt64TypeInContext(b->context);
+    switch (LLVMGetTypeKind(LLVMTypeOf(val))) {
+        case LLVMPointerTypeKind:
+            return LLVMBuildPtrToInt(b->builder, val, i64, "");
+        case LLVMFloatTypeKind:
+            val = LLVMBuildFPExt(b->builder, val, LLVMDoubleTypeInContext(b->context), "");
+            return LLVMBuildBitCast(b->builder, val, i64, "");
+        case LLVMDoubleTypeKind:
+            return LLVMBuildBitCast(b->builder, val, i64, "");
+        default:
+            return val;
+    }
+}
+
+static void add_attribute(LLVMBackend* b, LLVMValueRef func, LLVMAttributeIndex index, const char* name) {
+    unsigned kind = LLVMGetEnumAttributeKindForName(name, strlen(name));
+    LLVMAddAttributeAtIndex(func, index, LLVMCreateEnumAttribute(b->context, kind, 0));
+}
+
+// signext/zeroext for integers narrower than 32 bits, which the System V
+// ABI leaves for the callee (or caller, for results) to extend
+static const char* extension_attribute(LLVMBackend* b, VRegType type) {
+    LLVMTypeRef ty = llvm_type_for_vreg(b, type);
+    if (LLVMGetTypeKind(ty) != LLVMIntegerTypeKind || LLVMGetIntTypeWidth(ty) >= 32) return NULL;
+    return vreg_type_is_signed(type) ? "signext" : "zeroext";
+}
+
+// Facts about the pointer parameters of `fn`, one bit per parameter (the
+// first 64). A parameter is readonly when nothing derived from it by moves
+// and arithmetic is written through, stored, passed on or returned. It is
+// nonnull when the entry block dereferences it, within the never-mapped
+// first page, before anything that could leave the function.
+static void pointer_param_facts(const FcIRFunction* fn, uint64_t* readonly, uint64_t* nonnull) {
+    *readonly = 0;
+    *nonnull = 0;
+    if (!fn->parameters || fn->block_count == 0) return;
+    
+    uint32_t vreg_limit = fn->next_vreg_id > FCX_IR_RESERVED_VREG_LAST ? fn->next_vreg_id
+                                                                       : FCX_IR_RESERVED_VREG_LAST + 1;
+    uint64_t pointers = 0;
+    for (uint8_t i = 0; i < fn->parameter_count && i < 64; i++) {
+        if (is_pointer_vreg_type(fn->parameters[i].type) && fn->parameters[i].id < vreg_limit) {
+            pointers |= 1ULL << i;
+        }
+    }
+    if (!pointers) return;
+    
+    // derived[v]: parameters v may hold a value computed from
+    uint64_t* derived = calloc(vreg_limit, sizeof(uint64_t));
+    if (!derived) return;
+    for (uint8_t i = 0; i < fn->parameter_count && i < 64; i++) {
+        if (pointers & (1ULL << i)) derived[fn->parameters[i].id] |= 1ULL << i;
+    }
+    
+    // Masks only grow, so this settles after a few rounds even through loops
+    uint64_t escaped = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (uint32_t bi = 0; bi < fn->block_count; bi++) {
+            const FcIRBasicBlock* blk = &fn->blocks[bi];
+            for (uint32_t ii = 0; ii < blk->instruction_count; ii++) {
+                const FcIRInstruction* instr = &blk->instructions[ii];
+                uint64_t values = 0;    // Registers read as values
+                uint64_t addresses = 0; // Registers used to address memory
+                bool writes_memory = false;
+                for (uint8_t k = 0; k < instr->operand_count; k++) {
+                    const FcOperand* op = &instr->operands[k];
+                    if (op->type == FC_OPERAND_VREG && op->u.vreg.id < vreg_limit) {
+                        values |= derived[op->u.vreg.id];
+                    } else if (op->type == FC_OPERAND_MEMORY && !(op->flags & FC_OPERAND_FLAG_GLOBAL)) {
+                        if (op->u.memory.base < vreg_limit) addresses |= derived[op->u.memory.base];
+                        if (op->u.memory.index < vreg_limit) addresses |= derived[op->u.memory.index];
+                        if (k == 0) writes_memory = true;
+                    } else if (op->type == FC_OPERAND_MEMORY && k == 0) {
+                        writes_memory = true;
+                    }
+                }
+                
+                const FcOperand* dst = instr->operand_count > 0 ? &instr->operands[0] : NULL;
+                uint64_t result = 0;
+                switch (instr->opcode) {
+                    case FCIR_MOV:
+                    case FCIR_MOVZX:
+                    case FCIR_MOVSX:
+                    case FCIR_LEA:
+                        // A load yields data, not an address derived from a parameter
+                        if (instr->operand_count > 1 && instr->operands[1].type == FC_OPERAND_VREG &&
+                            instr->operands[1].u.vreg.id < vreg_limit) {
+                            result = derived[instr->operands[1].u.vreg.id];
+                        } else if (instr->opcode == FCIR_LEA) {
+                            result = addresses;
+                        }
+                        break;
+                    case FCIR_ADD: case FCIR_SUB: case FCIR_IMUL: case FCIR_IDIV: case FCIR_IMOD:
+                    case FCIR_NEG: case FCIR_INC: case FCIR_DEC:
+                    case FCIR_AND: case FCIR_OR: case FCIR_XOR: case FCIR_NOT:
+                    case FCIR_SHL: case FCIR_SHR: case FCIR_SAR: case FCIR_ROL: case FCIR_ROR:
+                    case FCIR_BSF: case FCIR_BSR: case FCIR_PHI:
+                        result = values;
+                        break;
+                    case FCIR_CMP: case FCIR_TEST:
+                    case FCIR_PREFETCHT0: case FCIR_PREFETCHT1: case FCIR_PREFETCHT2:
+                    case FCIR_PREFETCHNTA: case FCIR_PREFETCHW:
+                    case FCIR_MFENCE: case FCIR_LFENCE: case FCIR_SFENCE:
+                    case FCIR_RET: case FCIR_LABEL: case FCIR_ALIGN:
+                        // Read-only uses, even of a memory first operand
+                        writes_memory = false;
+                        dst = NULL;
+                        break;
+                    default:
+                        if (!is_fc_jump(instr->opcode)) {
+                            // Calls, atomics, asm: anything they touch escapes
+                            escaped |= values | addresses;
+                        }
+                        dst = NULL;
+                        break;
+                }
+                
+                if (writes_memory) {
+                    // Written through, and whatever is stored escapes
+                    escaped |= values | addresses;
+                } else if (dst && dst->type == FC_OPERAND_VREG && dst->u.vreg.id < vreg_limit) {
+                    uint32_t id = dst->u.vreg.id;
+                    if (id >= FCX_IR_RESERVED_VREG_FIRST && id <= FCX_IR_RESERVED_VREG_LAST) {
+                        escaped |= result;  // Argument or return value
+                    }
+                    if ((derived[id] | result) != derived[id]) {
+                        derived[id] |= result;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+    *readonly = pointers & ~escaped;
+    
+    // Exact copies of parameters through the entry block
+    memset(derived, 0, vreg_limit * sizeof(uint64_t));
+    for (uint8_t i = 0; i < fn->parameter_count && i < 64; i++) {
+        if (pointers & (1ULL << i)) derived[fn->parameters[i].id] = 1ULL << i;
+    }
+    const FcIRBasicBlock* entry = &fn->blocks[0];
+    for (uint32_t ii = 0; ii < entry->instruction_count; ii++) {
+        const FcIRInstruction* instr = &entry->instructions[ii];
+        if (instr->opcode == FCIR_CALL || instr->opcode == FCIR_SYSCALL || instr->opcode == FCIR_INLINE_ASM ||
+            instr->opcode == FCIR_RET || is_fc_jump(instr->opcode)) {
+            break;
+        }
+        bool touches_memory = instr->opcode != FCIR_LEA && instr->opcode != FCIR_PREFETCHT0 &&
+                              instr->opcode != FCIR_PREFETCHT1 && instr->opcode != FCIR_PREFETCHT2 &&
+                              instr->opcode != FCIR_PREFETCHNTA && instr->opcode != FCIR_PREFETCHW;
+        for (uint8_t k = 0; touches_memory && k < instr->operand_count; k++) {
+            const FcOperand* op = &instr->operands[k];
+            if (op->type == FC_OPERAND_MEMORY && !(op->flags & FC_OPERAND_FLAG_GLOBAL) &&
+                op->u.memory.index == 0 && op->displacement >= 0 && op->displacement < 4096 &&
+                op->u.memory.base < vreg_limit) {
+                *nonnull |= derived[op->u.memory.base];
+            }
+        }
+        const FcOperand* dst = instr->operand_count > 0 ? &instr->operands[0] : NULL;
+        if (dst && dst->type == FC_OPERAND_VREG && dst->u.vreg.id < vreg_limit &&
+            instr->opcode != FCIR_CMP && instr->opcode != FCIR_TEST) {
+            const FcOperand* src = instr->operand_count > 1 ? &instr->operands[1] : NULL;
+            bool copy = instr->opcode == FCIR_MOV && src && src->type == FC_OPERAND_VREG &&
+                        src->u.vreg.id < vreg_limit;
+            derived[dst->u.vreg.id] = copy ? derived[src->u.vreg.id] : 0;
+        }
+    }
+    free(derived);
+}
+
 static bool emit_mov(LLVMBackend* b, const FcIRInstruction* i) {
     const FcOperand* dst = &i->operands[0];
     const FcOperand* src = &i->operands[1];
@@ -583,7 +1314,7 @@ static bool emit_mov(LLVMBackend* b, const FcIRInstruction* i) {
     if (i->opcode == FCIR_LEA && src->type == FC_OPERAND_MEMORY && dst->type == FC_OPERAND_VREG) {
         LLVMTypeRef i64 = LLVMInt64TypeInContext(b->context);
         
-        LLVMValueRef base = get_vreg(b, src->u.memory.base);
+        LLVMValueRef base = get_vreg_id(b, src->u.memory.base);
         if (!base) {
             base = LLVMConstInt(i64, 0, 0);
         } else if (LLVMGetTypeKind(LLVMTypeOf(base)) == LLVMPointerTypeKind) {
@@ -592,17 +1323,17 @@ static bool emit_mov(LLVMBackend* b, const FcIRInstruction* i) {
             base = cast_to(b, base, i64);
         }
         
-        LLVMValueRef offset_val = LLVMConstInt(i64, src->u.memory.displacement, true);
+        LLVMValueRef offset_val = LLVMConstInt(i64, src->displacement, true);
         
-        if (src->u.memory.index.id != 0) {
-            LLVMValueRef index = get_vreg(b, src->u.memory.index);
+        if (src->u.memory.index != 0) {
+            LLVMValueRef index = get_vreg_id(b, src->u.memory.index);
             if (index) {
                 if (LLVMGetTypeKind(LLVMTypeOf(index)) == LLVMPointerTypeKind) {
                     index = LLVMBuildPtrToInt(b->builder, index, i64, "");
                 } else {
                     index = cast_to(b, index, i64);
                 }
-                LLVMValueRef scale = LLVMConstInt(i64, src->u.memory.scale, 0);
+                LLVMValueRef scale = LLVMConstInt(i64, src->scale, 0);
                 LLVMValueRef scaled = LLVMBuildMul(b->builder, index, scale, "");
                 offset_val = LLVMBuildAdd(b->builder, offset_val, scaled, "");
             }
@@ -641,9 +1372,9 @@ static bool emit_mov(LLVMBackend* b, const FcIRInstruction* i) {
     }
     
     // Check for global variable store pattern: memory operand with special flag
-    if (dst->type == FC_OPERAND_MEMORY && dst->u.memory.base.flags == 0x8000) {
+    if (dst->type == FC_OPERAND_MEMORY && (dst->flags & FC_OPERAND_FLAG_GLOBAL)) {
         // This is a global variable store
-        uint32_t global_index = UINT32_MAX - dst->u.memory.base.id;
+        uint32_t global_index = UINT32_MAX - dst->u.memory.base;
         
         if (global_index < b->global_var_count && b->global_vars[global_index]) {
             LLVMValueRef src_val = get_operand(b, src);
@@ -720,21 +1451,21 @@ static bool emit_mov(LLVMBackend* b, const FcIRInstruction* i) {
         }
         
         // Get base address as pointer
-        LLVMValueRef base = get_vreg(b, src->u.memory.base);
+        LLVMValueRef base = get_vreg_id(b, src->u.memory.base);
         if (!base) {
             base = LLVMConstInt(i64, 0, 0);
         }
         LLVMValueRef base_ptr = LLVMBuildIntToPtr(b->builder, base, ptr_ty, "");
         
         // Calculate total byte offset
-        int64_t total_offset = src->u.memory.displacement;
+        int64_t total_offset = src->displacement;
         LLVMValueRef offset_val = LLVMConstInt(i64, total_offset, true);
         
         // Add scaled index if present
-        if (src->u.memory.index.id != 0) {
-            LLVMValueRef index = get_vreg(b, src->u.memory.index);
+        if (src->u.memory.index != 0) {
+            LLVMValueRef index = get_vreg_id(b, src->u.memory.index);
             if (index) {
-                LLVMValueRef scale = LLVMConstInt(i64, src->u.memory.scale, 0);
+                LLVMValueRef scale = LLVMConstInt(i64, src->scale, 0);
                 LLVMValueRef scaled = LLVMBuildMul(b->builder, index, scale, "");
                 offset_val = LLVMBuildAdd(b->builder, offset_val, scaled, "");
             }
@@ -778,21 +1509,21 @@ static bool emit_mov(LLVMBackend* b, const FcIRInstruction* i) {
         if (!src_val) { set_error(b, "MOV store: null source"); return false; }
         
         // Get base address as pointer
-        LLVMValueRef base = get_vreg(b, dst->u.memory.base);
+        LLVMValueRef base = get_vreg_id(b, dst->u.memory.base);
         if (!base) {
             base = LLVMConstInt(i64, 0, 0);
         }
         LLVMValueRef base_ptr = LLVMBuildIntToPtr(b->builder, base, ptr_ty, "");
         
         // Calculate total byte offset
-        int64_t total_offset = dst->u.memory.displacement;
+        int64_t total_offset = dst->displacement;
         LLVMValueRef offset_val = LLVMConstInt(i64, total_offset, true);
         
         // Add scaled index if present
-        if (dst->u.memory.index.id != 0) {
-            LLVMValueRef index = get_vreg(b, dst->u.memory.index);
+        if (dst->u.memory.index != 0) {
+            LLVMValueRef index = get_vreg_id(b, dst->u.memory.index);
             if (index) {
-                LLVMValueRef scale = LLVMConstInt(i64, dst->u.memory.scale, 0);
+                LLVMValueRef scale = LLVMConstInt(i64, dst->scale, 0);
                 LLVMValueRef scaled = LLVMBuildMul(b->builder, index, scale, "");
                 offset_val = LLVMBuildAdd(b->builder, offset_val, scaled, "");
             }
@@ -984,25 +1715,23 @@ static bool emit_jmp(LLVMBackend* b, const FcIRInstruction* i) {
     return true;
 }
 
-static bool emit_jcc(LLVMBackend* b, const FcIRInstruction* i) {
-    uint32_t label = i->operands[0].u.label_id;
-    ensure_label(b, label);
-    
+// The i1 a conditional jump tests, from the flags of the last cmp
+static LLVMValueRef jcc_condition(LLVMBackend* b, FcIROpcode opcode) {
     LLVMValueRef cond;
     
     // Check if the last comparison was a boolean comparison (cmp bool, 0)
     if (b->current_func_ctx->last_cmp_is_bool) {
         // For boolean comparisons, use the boolean value directly
         // JNE means "jump if not zero" which is "jump if true"
-        if (i->opcode == FCIR_JNE) {
+        if (opcode == FCIR_JNE) {
             cond = b->current_func_ctx->last_cmp_lhs;
-        } else if (i->opcode == FCIR_JE) {
+        } else if (opcode == FCIR_JE) {
             // JE means "jump if zero" which is "jump if false"
             cond = LLVMBuildNot(b->builder, b->current_func_ctx->last_cmp_lhs, "");
         } else {
             // For other conditions, fall back to regular comparison
             LLVMIntPredicate pred;
-            switch (i->opcode) {
+            switch (opcode) {
                 case FCIR_JL: pred = LLVMIntSLT; break;
                 case FCIR_JLE: pred = LLVMIntSLE; break;
                 case FCIR_JG: pred = LLVMIntSGT; break;
@@ -1015,7 +1744,7 @@ static bool emit_jcc(LLVMBackend* b, const FcIRInstruction* i) {
     } else {
         // Regular comparison
         LLVMIntPredicate pred;
-        switch (i->opcode) {
+        switch (opcode) {
             case FCIR_JE: pred = LLVMIntEQ; break;
             case FCIR_JNE: pred = LLVMIntNE; break;
             case FCIR_JL: pred = LLVMIntSLT; break;
@@ -1026,13 +1755,23 @@ static bool emit_jcc(LLVMBackend* b, const FcIRInstruction* i) {
             case FCIR_JB: pred = LLVMIntULT; break;
             case FCIR_JAE: pred = LLVMIntUGE; break;
             case FCIR_JBE: pred = LLVMIntULE; break;
-            default: return false;
+            default: return NULL;
         }
         
         cond = LLVMBuildICmp(b->builder, pred,
             b->current_func_ctx->last_cmp_lhs, b->current_func_ctx->last_cmp_rhs, "");
     }
     
+    return cond;
+}
+
+static bool emit_jcc(LLVMBackend* b, const FcIRInstruction* i) {
+    uint32_t label = i->operands[0].u.label_id;
+    ensure_label(b, label);
+    
+    LLVMValueRef cond = jcc_condition(b, i->opcode);
+    if (!cond) return false;
+    
     LLVMBasicBlockRef fall = LLVMAppendBasicBlockInContext(b->context, b->current_func_ctx->function, "");
     LLVMBuildCondBr(b->builder, cond, get_label(b, label), fall);
     LLVMPositionBuilderAtEnd(b->builder, fall);
@@ -1041,6 +1780,71 @@ static bool emit_jcc(LLVMBackend* b, const FcIRInstruction* i) {
     return true;
 }
 
+// jcc T; jmp F as one conditional branch, without a fall-through block
+static bool emit_jcc_jmp(LLVMBackend* b, const FcIRInstruction* jcc, const FcIRInstruction* jmp) {
+    uint32_t true_label = jcc->operands[0].u.label_id;
+    uint32_t false_label = jmp->operands[0].u.label_id;
+    ensure_label(b, true_label);
+    ensure_label(b, false_label);
+    
+    if (true_label == false_label) {
+        LLVMBuildBr(b->builder, get_label(b, true_label));
+    } else {
+        LLVMValueRef cond = jcc_condition(b, jcc->opcode);
+        if (!cond) return false;
+        LLVMBuildCondBr(b->builder, cond, get_label(b, true_label), get_label(b, false_label));
+    }
+    b->instruction_count += 2;
+    return true;
+}
+
+// Calls module function `function_id`: arguments are read from the argument
+// registers and converted to the callee's parameter types, and the result is
+// widened back into rax
+static bool emit_internal_call(LLVMBackend* b, uint32_t function_id) {
+    static const uint32_t arg_vreg_ids[] = {1001, 1002, 1003, 1007, 1005, 1006};
+    const FcIRFunction* callee = &b->fc_module->functions[function_id];
+    LLVMValueRef fn = b->internal_funcs[function_id];
+    LLVMTypeRef fn_ty = LLVMGlobalGetValueType(fn);
+    
+    // Only six arguments travel in registers; stack arguments are not lowered
+    if (callee->parameter_count > 6) {
+        set_error(b, "Call to '%s' needs %u arguments; at most 6 are supported",
+                  callee->name, callee->parameter_count);
+        return false;
+    }
+    LLVMValueRef args[6];
+    for (uint8_t j = 0; j < callee->parameter_count; j++) {
+        VRegType type = signature_param_type(callee, j);
+        LLVMValueRef arg = get_vreg_id(b, arg_vreg_ids[j]);
+        args[j] = arg ? to_signature_value(b, arg, type) : LLVMConstNull(signature_llvm_type(b, type));
+    }
+    
+    LLVMValueRef ret = LLVMBuildCall2(b->builder, fn_ty, fn, args, callee->parameter_count, "");
+    for (uint8_t j = 0; j < callee->parameter_count; j++) {
+        const char* ext = extension_attribute(b, signature_param_type(callee, j));
+        if (ext) {
+            LLVMAddCallSiteAttribute(ret, (LLVMAttributeIndex)j + 1,
+                LLVMCreateEnumAttribute(b->context, LLVMGetEnumAttributeKindForName(ext, strlen(ext)), 0));
+        }
+    }
+    
+    // Integers narrower than rax are extended by their own signedness
+    VRegType return_type = signature_return_type(callee);
+    LLVMValueRef result = from_signature_value(b, ret);
+    VirtualReg rax = {.id = 1000, .type = VREG_TYPE_I64, .size = 8};
+    unsigned bits = LLVMGetIntTypeWidth(LLVMTypeOf(result));
+    if (bits < 64) {
+        result = resize_int(b, result, LLVMInt64TypeInContext(b->context), return_type);
+    } else if (bits > 64) {
+        rax.type = return_type;
+        rax.size = (uint8_t)(bits / 8);
+    }
+    set_vreg(b, rax, result);
+    b->instruction_count++;
+    return true;
+}
+
 static bool emit_call(LLVMBackend* b, const FcIRInstruction* i) {
     const FcOperand* op = &i->operands[0];
     LLVMValueRef fn = NULL;
@@ -1056,37 +1860,10 @@ static bool emit_call(LLVMBackend* b, const FcIRInstruction* i) {
                 fn_name = b->fc_module->external_functions[op->u.external_func_id];
             }
         }
-    } else if (op->type == FC_OPERAND_LABEL) {
-        // Internal function call - the label ID maps to a function
-        // Search through all functions in the FC module to find matching label
-        uint32_t target_label = op->u.label_id;
-        
-        // First, try to find function by iterating through module functions
-        // The label ID should correspond to a function's entry block label
-        for (uint32_t fi = 0; fi < b->fc_module->function_count; fi++) {
-            const FcIRFunction* fc_fn = &b->fc_module->functions[fi];
-            // Check if this function's first block has the target label
-            if (fc_fn->block_count > 0 && fc_fn->blocks[0].id == target_label) {
-                fn = LLVMGetNamedFunction(b->module, fc_fn->name);
-                break;
-            }
-            // Also check if the function name hash matches the label
-            // (some call instructions use function name hash as label)
-            uint32_t name_hash = 0;
-            for (const char* p = fc_fn->name; *p; p++) {
-                name_hash = name_hash * 31 + (uint8_t)*p;
-            }
-            if (name_hash == target_label) {
-                fn = LLVMGetNamedFunction(b->module, fc_fn->name);
-                break;
-            }
-        }
-        
-        // If not found by label, try direct function name lookup
-        if (!fn) {
-            char name[64];
-            snprintf(name, sizeof(name), ".L%u", target_label);
-            fn = LLVMGetNamedFunction(b->module, name);
+    } else if (op->type == FC_OPERAND_FUNCTION) {
+        // Internal function call - resolved to a module function during lowering
+        if (op->u.function_id < b->internal_func_count) {
+            return emit_internal_call(b, op->u.function_id);
         }
     } else if (op->type == FC_OPERAND_VREG) {
         // Indirect call through register
@@ -1204,11 +1981,21 @@ static bool emit_call(LLVMBackend* b, const FcIRInstruction* i) {
                 args[0] = LLVMConstInt(i128_type, 0, 0);
             }
         } else {
-            // Normal argument handling
-            for (unsigned j = 0; j < param_count && j < 6; j++) {
+            // Normal argument handling; only six arguments travel in registers
+            if (param_count > 6) {
+                set_error(b, "Call to '%s' needs %u arguments; at most 6 are supported",
+                          fn_name ? fn_name : "<indirect>", param_count);
+                free(args);
+                return false;
+            }
+            LLVMTypeRef* param_types = malloc(param_count * sizeof(LLVMTypeRef));
+            if (param_types) LLVMGetParamTypes(fn_ty, param_types);
+            for (unsigned j = 0; j < param_count; j++) {
                 LLVMValueRef arg = get_vreg(b, (VirtualReg){.id = arg_vreg_ids[j], .size = 8});
                 args[j] = arg ? arg : LLVMConstInt(i64, 0, 0);
+                if (param_types) args[j] = cast_to(b, args[j], param_types[j]);
             }
+            free(param_types);
         }
     }
     
@@ -1231,16 +2018,13 @@ static bool emit_call(LLVMBackend* b, const FcIRInstruction* i) {
 static bool emit_ret(LLVMBackend* b, const FcIRInstruction* i) {
     (void)i;
     LLVMTypeRef ret_ty = LLVMGetReturnType(LLVMGlobalGetValueType(b->current_func_ctx->function));
-    if (LLVMGetTypeKind(ret_ty) == LLVMVoidTypeKind) {
-        LLVMBuildRetVoid(b->builder);
+    // FC IR convention: return value is in v1000
+    LLVMValueRef ret_val = get_vreg(b, (VirtualReg){.id = 1000, .size = 8});
+    if (ret_val) {
+        VRegType type = signature_return_type(b->current_func_ctx->fc_function);
+        LLVMBuildRet(b->builder, to_signature_value(b, ret_val, type));
     } else {
-        // FC IR convention: return value is in v1000
-        LLVMValueRef ret_val = get_vreg(b, (VirtualReg){.id = 1000, .size = 8});
-        if (ret_val) {
-            LLVMBuildRet(b->builder, cast_to(b, ret_val, ret_ty));
-        } else {
-            LLVMBuildRet(b->builder, LLVMConstInt(ret_ty, 0, 0));
-        }
+        LLVMBuildRet(b->builder, LLVMConstNull(ret_ty));
     }
     b->instruction_count++;
     return true;
@@ -1624,20 +2408,7 @@ static bool emit_inline_asm(LLVMBackend* b, const FcIRInstruction* i) {
     }
     
     // Cast the immediate value back to the inline_asm struct pointer
-    struct {
-        const char* asm_template;
-        const char** output_constraints;
-        const char** input_constraints;
-        VirtualReg* outputs;
-        VirtualReg* inputs;
-        const char** clobbers;
-        uint8_t output_count;
-        uint8_t input_count;
-        uint8_t clobber_count;
-        bool is_volatile;
-        bool has_side_effects;
-        bool align_stack;
-    } *asm_data = (void*)(uintptr_t)i->operands[0].u.immediate;
+    const FcxIRInlineAsm* asm_data = (const FcxIRInlineAsm*)(uintptr_t)i->operands[0].u.immediate;
     
     if (!asm_data || !asm_data->asm_template) {
         b->instruction_count++;
@@ -1769,8 +2540,8 @@ static bool emit_inline_asm(LLVMBackend* b, const FcIRInstruction* i) {
     LLVMValueRef ia = LLVMGetInlineAsm(fn_ty, 
         (char*)final_template, strlen(final_template),
         constraint_str, strlen(constraint_str),
-        asm_data->has_side_effects,
-        asm_data->align_stack,
+        false,  // HasSideEffects, IsAlignStack: not tracked by the FCx IR
+        false,
         LLVMInlineAsmDialectATT,
         asm_data->is_volatile
     );
@@ -1835,16 +2606,16 @@ static bool emit_prefetch(LLVMBackend* b, const FcIRInstruction* i) {
     
     if (i->operands[0].type == FC_OPERAND_MEMORY) {
         // Memory operand: get the base register
-        LLVMValueRef base = get_vreg(b, i->operands[0].u.memory.base);
+        LLVMValueRef base = get_vreg_id(b, i->operands[0].u.memory.base);
         if (!base) {
             // If base not set, use a zero value
             base = LLVMConstInt(LLVMInt64TypeInContext(b->context), 0, false);
         }
         
         // Add displacement if present
-        if (i->operands[0].u.memory.displacement != 0) {
+        if (i->operands[0].displacement != 0) {
             LLVMValueRef offset = LLVMConstInt(LLVMInt64TypeInContext(b->context), 
-                                               i->operands[0].u.memory.displacement, true);
+                                               i->operands[0].displacement, true);
             base = LLVMBuildAdd(b->builder, base, offset, "prefetch_addr");
         }
         
@@ -2022,15 +2793,126 @@ static bool emit_bitscan(LLVMBackend* b, const FcIRInstruction* i) {
     return true;
 }
 
-static bool emit_label(LLVMBackend* b, const FcIRInstruction* i) {
-    uint32_t id = i->operands[0].u.label_id;
-    ensure_label(b, id);
-    LLVMBasicBlockRef blk = get_label(b, id);
-    LLVMBasicBlockRef cur = LLVMGetInsertBlock(b->builder);
-    
-    // If current block doesn't have a terminator, add a branch to the label
-    if (cur && !LLVMGetBasicBlockTerminator(cur)) {
-        LLVMBuildBr(b->builder, blk);
+// The FC IR phis of one FCx IR phi are consecutive, one per incoming edge,
+// and share a single LLVM phi node; its incoming values are added once all
+// blocks are emitted (see llvm_emit_function)
+static bool emit_phi(LLVMBackend* b, const FcIRInstruction* i) {
+    LLVMFunctionContext* ctx = b->current_func_ctx;
+    VirtualReg dest = i->operands[0].u.vreg;
+    if (i->operands[0].type != FC_OPERAND_VREG || dest.id >= ctx->vreg_capacity) {
+        set_error(b, "Invalid phi destination");
+        return false;
+    }
+    
+    LLVMBasicBlockRef cur = LLVMGetInsertBlock(b->builder);
+    LLVMValueRef phi = ctx->vreg_values[dest.id];
+    if (!phi || !LLVMIsAPHINode(phi) || LLVMGetInstructionParent(phi) != cur) {
+        LLVMTypeRef phi_type;
+        if (dest.id >= 1000 && dest.id <= 1006) {
+            phi_type = LLVMInt64TypeInContext(b->context);
+        } else if (ctx->vreg_types[dest.id] != VREG_TYPE_VOID) {
+            phi_type = llvm_type_for_vreg(b, ctx->vreg_types[dest.id]);
+        } else {
+            phi_type = LLVMInt64TypeInContext(b->context);
+        }
+        
+        // Phis must lead the block, ahead of any store set_vreg adds
+        LLVMValueRef first = LLVMGetFirstInstruction(cur);
+        while (first && LLVMIsAPHINode(first)) {
+            first = LLVMGetNextInstruction(first);
+        }
+        if (first) {
+            LLVMPositionBuilderBefore(b->builder, first);
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "v%u", dest.id);
+        phi = LLVMBuildPhi(b->builder, phi_type, name);
+        LLVMPositionBuilderAtEnd(b->builder, cur);
+        set_vreg(b, dest, phi);
+    }
+    
+    if (ctx->pending_phi_count >= ctx->pending_phi_capacity) {
+        uint32_t new_capacity = ctx->pending_phi_capacity == 0 ? 16 : ctx->pending_phi_capacity * 2;
+        LLVMValueRef* phis = realloc(ctx->pending_phis, new_capacity * sizeof(LLVMValueRef));
+        if (phis) ctx->pending_phis = phis;
+        const FcIRInstruction** instrs = realloc(ctx->pending_phi_instrs,
+            new_capacity * sizeof(const FcIRInstruction*));
+        if (instrs) ctx->pending_phi_instrs = instrs;
+        if (!phis || !instrs) {
+            set_error(b, "Failed to allocate pending phis");
+            return false;
+        }
+        ctx->pending_phi_capacity = new_capacity;
+    }
+    ctx->pending_phis[ctx->pending_phi_count] = phi;
+    ctx->pending_phi_instrs[ctx->pending_phi_count] = i;
+    ctx->pending_phi_count++;
+    b->instruction_count++;
+    return true;
+}
+
+// Adds the incoming values of the function's phis, each computed at the end
+// of its predecessor and converted to the phi's type
+static bool resolve_phis(LLVMBackend* b) {
+    LLVMFunctionContext* ctx = b->current_func_ctx;
+    
+    for (uint32_t k = 0; k < ctx->pending_phi_count; k++) {
+        LLVMValueRef phi = ctx->pending_phis[k];
+        const FcIRInstruction* i = ctx->pending_phi_instrs[k];
+        uint32_t pred = i->operands[2].u.label_id;
+        
+        LLVMBasicBlockRef pred_end = pred < ctx->label_count && ctx->label_end_blocks[pred] ?
+            edge_block(b, pred, LLVMGetInstructionParent(phi)) : NULL;
+        if (!pred_end) {
+            set_error(b, "Phi for v%u names unknown predecessor L%u", i->operands[0].u.vreg.id, pred);
+            return false;
+        }
+        LLVMValueRef term = LLVMGetBasicBlockTerminator(pred_end);
+        if (term) {
+            LLVMPositionBuilderBefore(b->builder, term);
+        } else {
+            LLVMPositionBuilderAtEnd(b->builder, pred_end);
+        }
+        
+        if (ctx->ssa) {
+            ctx->ssa->current = ctx->ssa->block_of_label[pred];
+        }
+        LLVMValueRef val = get_operand(b, &i->operands[1]);
+        LLVMTypeRef phi_type = LLVMTypeOf(phi);
+        LLVMTypeRef val_type = val ? LLVMTypeOf(val) : NULL;
+        if (val && val_type != phi_type) {
+            if (LLVMGetTypeKind(val_type) == LLVMIntegerTypeKind &&
+                LLVMGetTypeKind(phi_type) == LLVMIntegerTypeKind &&
+                LLVMGetIntTypeWidth(val_type) < LLVMGetIntTypeWidth(phi_type)) {
+                // Widen by the phi's signedness, as set_vreg does for stack slots
+                if (vreg_type_is_signed(ctx->vreg_types[i->operands[0].u.vreg.id])) {
+                    val = LLVMBuildSExt(b->builder, val, phi_type, "");
+                } else {
+                    val = LLVMBuildZExt(b->builder, val, phi_type, "");
+                }
+            } else {
+                val = cast_to(b, val, phi_type);
+            }
+        }
+        if (!val || LLVMTypeOf(val) != phi_type) {
+            set_error(b, "Phi for v%u has an incoming value of a different type", i->operands[0].u.vreg.id);
+            return false;
+        }
+        LLVMAddIncoming(phi, &val, &pred_end, 1);
+    }
+    
+    return true;
+}
+
+static bool emit_label(LLVMBackend* b, const FcIRInstruction* i) {
+    uint32_t id = i->operands[0].u.label_id;
+    ensure_label(b, id);
+    LLVMBasicBlockRef blk = get_label(b, id);
+    LLVMBasicBlockRef cur = LLVMGetInsertBlock(b->builder);
+    
+    // If current block doesn't have a terminator, add a branch to the label
+    if (cur && !LLVMGetBasicBlockTerminator(cur)) {
+        LLVMBuildBr(b->builder, blk);
     }
     
     // Check if the label block already has instructions (was already visited)
@@ -2101,6 +2983,8 @@ bool llvm_emit_instruction(LLVMBackend* b, const FcIRInstruction* i) {
             return true;
         case FCIR_INLINE_ASM:
             return emit_inline_asm(b, i);
+        case FCIR_PHI:
+            return emit_phi(b, i);
         default:
             return true;
     }
@@ -2110,18 +2994,82 @@ bool llvm_emit_block(LLVMBackend* b, const FcIRBasicBlock* blk) {
     if (!b || !blk) return false;
     
     for (uint32_t i = 0; i < blk->instruction_count; i++) {
-        if (!llvm_emit_instruction(b, &blk->instructions[i])) return false;
+        const FcIRInstruction* instr = &blk->instructions[i];
+        
+        // Two-way branches are lowered as jcc T; jmp F
+        if (instr->opcode >= FCIR_JE && instr->opcode <= FCIR_JBE &&
+            i + 1 < blk->instruction_count && blk->instructions[i + 1].opcode == FCIR_JMP) {
+            if (!emit_jcc_jmp(b, instr, &blk->instructions[i + 1])) return false;
+            i++;
+            continue;
+        }
+        if (!llvm_emit_instruction(b, instr)) return false;
     }
     b->block_count++;
     return true;
 }
 
+// Adds the LLVM function for `fn` with its FCx parameter and result types.
+// Every parameter and the result are noundef: FCx values are never undefined
+static LLVMValueRef declare_function(LLVMBackend* b, const FcIRFunction* fn) {
+    LLVMTypeRef param_types[256];
+    for (uint8_t i = 0; i < fn->parameter_count; i++) {
+        param_types[i] = signature_llvm_type(b, signature_param_type(fn, i));
+    }
+    
+    VRegType return_type = signature_return_type(fn);
+    LLVMTypeRef fn_ty = LLVMFunctionType(signature_llvm_type(b, return_type), param_types,
+                                         fn->parameter_count, false);
+    LLVMValueRef func = LLVMAddFunction(b->module, fn->name, fn_ty);
+    if (!func) return NULL;
+    if (strcmp(fn->name, "main") != 0 && strcmp(fn->name, "_start") != 0) {
+        add_attribute(b, func, LLVMAttributeFunctionIndex, "inlinehint");
+    }
+    
+    const char* ext = extension_attribute(b, return_type);
+    add_attribute(b, func, LLVMAttributeReturnIndex, "noundef");
+    if (ext) add_attribute(b, func, LLVMAttributeReturnIndex, ext);
+    
+    uint64_t readonly = 0;
+    uint64_t nonnull = 0;
+    pointer_param_facts(fn, &readonly, &nonnull);
+    for (uint8_t i = 0; i < fn->parameter_count; i++) {
+        LLVMAttributeIndex index = (LLVMAttributeIndex)i + 1;
+        add_attribute(b, func, index, "noundef");
+        ext = extension_attribute(b, signature_param_type(fn, i));
+        if (ext) add_attribute(b, func, index, ext);
+        if (i < 64 && (nonnull & (1ULL << i))) add_attribute(b, func, index, "nonnull");
+        if (i < 64 && (readonly & (1ULL << i))) add_attribute(b, func, index, "readonly");
+    }
+    return func;
+}
+
+// Declares every module function before any body is emitted, so a call
+// resolves by index whether its callee comes before or after it
+static bool declare_functions(LLVMBackend* b, const FcIRModule* m) {
+    if (!m->function_count) return true;
+    b->internal_funcs = calloc(m->function_count, sizeof(LLVMValueRef));
+    if (!b->internal_funcs) {
+        set_error(b, "Failed to allocate function table");
+        return false;
+    }
+    b->internal_func_count = m->function_count;
+    for (uint32_t i = 0; i < m->function_count; i++) {
+        b->internal_funcs[i] = declare_function(b, &m->functions[i]);
+        if (!b->internal_funcs[i]) {
+            set_error(b, "Failed to add function '%s'", m->functions[i].name);
+            return false;
+        }
+    }
+    return true;
+}
 
 bool llvm_emit_function(LLVMBackend* b, const FcIRFunction* fn) {
     if (!b || !fn) return false;
     
     LLVMFunctionContext* ctx = NULL;
     uint32_t* vreg_write_count = NULL;
+    uint32_t* write_block = NULL;
     uint32_t* label_to_block_index = NULL;
     uint32_t* used_vregs = NULL;
     uint32_t used_vreg_count = 0;
@@ -2134,32 +3082,19 @@ bool llvm_emit_function(LLVMBackend* b, const FcIRFunction* fn) {
         return false;
     }
 
-    LLVMTypeRef* param_types = NULL;
-    if (fn->parameter_count > 0) {
-        param_types = malloc(fn->parameter_count * sizeof(LLVMTypeRef));
-        if (!param_types) {
-            set_error(b, "Failed to allocate parameter types");
-            return false;
-        }
-        for (uint8_t i = 0; i < fn->parameter_count; i++) {
-            param_types[i] = i64_ty;
-        }
+    // Module functions were declared up front by declare_functions
+    LLVMValueRef func = NULL;
+    if (b->fc_module && fn >= b->fc_module->functions &&
+        fn < b->fc_module->functions + b->internal_func_count) {
+        func = b->internal_funcs[fn - b->fc_module->functions];
+    } else {
+        func = declare_function(b, fn);
     }
     
-    LLVMTypeRef fn_ty = LLVMFunctionType(i64_ty, param_types, fn->parameter_count, false);
-    LLVMValueRef func = LLVMAddFunction(b->module, fn->name, fn_ty);
-    free(param_types);
-    param_types = NULL;
-    
     if (!func) {
         set_error(b, "Failed to add function '%s'", fn->name);
         return false;
     }
-    if (strcmp(fn->name, "main") != 0 && strcmp(fn->name, "_start") != 0) {
-        LLVMAddAttributeAtIndex(func, LLVMAttributeFunctionIndex,
-            LLVMCreateEnumAttribute(b->context, 
-                LLVMGetEnumAttributeKindForName("inlinehint", 10), 0));
-    }
     
     uint32_t max_vreg_id = 0;
     uint32_t max_label_id = 0;
@@ -2203,9 +3138,11 @@ bool llvm_emit_function(LLVMBackend* b, const FcIRFunction* fn) {
         ctx->vreg_values = calloc(ctx->vreg_capacity, sizeof(LLVMValueRef));
         ctx->vreg_allocas = calloc(ctx->vreg_capacity, sizeof(LLVMValueRef));
         ctx->vreg_is_mutable = calloc(ctx->vreg_capacity, sizeof(bool));
+        ctx->vreg_slot_types = calloc(ctx->vreg_capacity, sizeof(LLVMTypeRef));
         ctx->vreg_types = calloc(ctx->vreg_capacity, sizeof(VRegType));
         
-        if (!ctx->vreg_values || !ctx->vreg_allocas || !ctx->vreg_is_mutable || !ctx->vreg_types) {
+        if (!ctx->vreg_values || !ctx->vreg_allocas || !ctx->vreg_is_mutable ||
+            !ctx->vreg_slot_types || !ctx->vreg_types) {
             set_error(b, "Failed to allocate vreg arrays");
             goto cleanup;
         }
@@ -2214,12 +3151,14 @@ bool llvm_emit_function(LLVMBackend* b, const FcIRFunction* fn) {
     // Allocate label blocks array
     if (ctx->label_count > 0) {
         ctx->label_blocks = calloc(ctx->label_count, sizeof(LLVMBasicBlockRef));
-        if (!ctx->label_blocks) {
+        ctx->label_end_blocks = calloc(ctx->label_count, sizeof(LLVMBasicBlockRef));
+        if (!ctx->label_blocks || !ctx->label_end_blocks) {
             set_error(b, "Failed to allocate label blocks");
             goto cleanup;
         }
     }
     
+    ctx->fc_function = fn;
     b->current_func_ctx = ctx;
     
     // ========================================================================
@@ -2269,15 +3208,48 @@ bool llvm_emit_function(LLVMBackend* b, const FcIRFunction* fn) {
         }
     }
     
-    // Mark multi-assigned vregs as mutable
-    for (uint32_t i = 0; i < ctx->vreg_capacity; i++) {
-        if (vreg_write_count[i] > 1) {
-            ctx->vreg_is_mutable[i] = true;
+    if (fn->is_ssa) {
+        // SSA input: a vreg written in a single block (including the mov +
+        // op pairs of two-address lowering) is carried in vreg_values and
+        // merged by phis; only the ABI registers and vregs written in
+        // several blocks need a stack slot
+        write_block = calloc(ctx->vreg_capacity, sizeof(uint32_t));
+        if (!write_block) {
+            set_error(b, "Failed to allocate vreg write blocks");
+            goto cleanup;
+        }
+        for (uint32_t i = 0; i < fn->block_count; i++) {
+            const FcIRBasicBlock* blk = &fn->blocks[i];
+            for (uint32_t j = 0; j < blk->instruction_count; j++) {
+                const FcIRInstruction* instr = &blk->instructions[j];
+                if (instr->operand_count == 0 || instr->operands[0].type != FC_OPERAND_VREG ||
+                    instr->opcode == FCIR_CMP || instr->opcode == FCIR_TEST || instr->opcode == FCIR_PUSH) {
+                    continue;
+                }
+                uint32_t vreg_id = instr->operands[0].u.vreg.id;
+                if (vreg_id >= ctx->vreg_capacity) continue;
+                if (write_block[vreg_id] != 0 && write_block[vreg_id] != i + 1) {
+                    ctx->vreg_is_mutable[vreg_id] = true;
+                }
+                write_block[vreg_id] = i + 1;
+            }
+        }
+        for (uint32_t i = FCX_IR_RESERVED_VREG_FIRST; i <= FCX_IR_RESERVED_VREG_LAST && i < ctx->vreg_capacity; i++) {
+            if (vreg_write_count[i] > 1) {
+                ctx->vreg_is_mutable[i] = true;
+            }
+        }
+    } else {
+        // Mark multi-assigned vregs as mutable
+        for (uint32_t i = 0; i < ctx->vreg_capacity; i++) {
+            if (vreg_write_count[i] > 1) {
+                ctx->vreg_is_mutable[i] = true;
+            }
         }
     }
     
     // O(n) loop detection: mark vregs in loops as mutable
-    for (uint32_t i = 0; i < fn->block_count; i++) {
+    for (uint32_t i = 0; !fn->is_ssa && i < fn->block_count; i++) {
         const FcIRBasicBlock* blk = &fn->blocks[i];
         
         for (uint32_t j = 0; j < blk->instruction_count; j++) {
@@ -2409,6 +3381,11 @@ bool llvm_emit_function(LLVMBackend* b, const FcIRFunction* fn) {
     ctx->current_block = entry;
     LLVMPositionBuilderAtEnd(b->builder, entry);
     
+    // Direct SSA replaces the allocas below when the function's blocks allow
+    if (b->config.direct_ssa && fn->block_count > 0) {
+        ctx->ssa = ssa_builder_create(b, fn, ctx->label_count, entry);
+    }
+    
     // Create allocas only for mutable vregs (optimization)
     // Build list of used vregs to avoid scanning all 2048+ slots
     used_vregs = malloc(ctx->vreg_capacity * sizeof(uint32_t));
@@ -2430,17 +3407,24 @@ bool llvm_emit_function(LLVMBackend* b, const FcIRFunction* fn) {
         snprintf(name, sizeof(name), "v%u.addr", vreg_id);
         
         // Use the vreg's type for the alloca, default to i64 if unknown
-        // IMPORTANT: ABI registers (v1000-v1006) must always be i64 to match
-        // the System V AMD64 calling convention
+        // IMPORTANT: ABI registers (v1000-v1006) are i64 to match the System V
+        // AMD64 calling convention, unless a wider integer is passed in them
         LLVMTypeRef alloca_type;
         if (vreg_id >= 1000 && vreg_id <= 1006) {
             // ABI registers: rax(1000), rdi(1001), rsi(1002), rdx(1003), r8(1005), r9(1006), rcx(1007)
             alloca_type = i64_ty;
+            if (ctx->vreg_types && llvm_bitwidth_for_vreg(ctx->vreg_types[vreg_id]) > 64) {
+                alloca_type = llvm_type_for_vreg(b, ctx->vreg_types[vreg_id]);
+            }
         } else if (ctx->vreg_types && ctx->vreg_types[vreg_id] != VREG_TYPE_VOID) {
             alloca_type = llvm_type_for_vreg(b, ctx->vreg_types[vreg_id]);
         } else {
             alloca_type = i64_ty;
         }
+        ctx->vreg_slot_types[vreg_id] = alloca_type;
+        if (ctx->ssa) {
+            continue;
+        }
         
         ctx->vreg_allocas[vreg_id] = LLVMBuildAlloca(b->builder, alloca_type, name);
         if (!ctx->vreg_allocas[vreg_id]) {
@@ -2482,7 +3466,7 @@ bool llvm_emit_function(LLVMBackend* b, const FcIRFunction* fn) {
             goto cleanup;
         }
         
-        set_vreg(b, vreg, param);
+        set_vreg(b, vreg, from_signature_value(b, param));
     }
     
     // Create all basic blocks upfront
@@ -2516,7 +3500,7 @@ bool llvm_emit_function(LLVMBackend* b, const FcIRFunction* fn) {
         }
         LLVMBuildBr(b->builder, ctx->label_blocks[first_label]);
     } else {
-        LLVMBuildRet(b->builder, LLVMConstInt(i64_ty, 0, false));
+        LLVMBuildRet(b->builder, LLVMConstNull(LLVMGetReturnType(LLVMGlobalGetValueType(func))));
         success = true;
         goto cleanup;
     }
@@ -2542,6 +3526,9 @@ bool llvm_emit_function(LLVMBackend* b, const FcIRFunction* fn) {
         
         LLVMPositionBuilderAtEnd(b->builder, llvm_blk);
         ctx->current_block = llvm_blk;
+        if (ctx->ssa) {
+            ctx->ssa->current = i;
+        }
         
         // Emit all instructions in the block
         if (!llvm_emit_block(b, blk)) {
@@ -2562,9 +3549,24 @@ bool llvm_emit_function(LLVMBackend* b, const FcIRFunction* fn) {
                 LLVMBuildBr(b->builder, ctx->label_blocks[next_label]);
             } else {
                 // Last block - return 0
-                LLVMBuildRet(b->builder, LLVMConstInt(i64_ty, 0, false));
+                LLVMBuildRet(b->builder, LLVMConstNull(LLVMGetReturnType(LLVMGlobalGetValueType(func))));
             }
         }
+        ctx->label_end_blocks[blk->id] = LLVMGetInsertBlock(b->builder);
+        if (ctx->ssa) {
+            ssa_fill(b, i);
+        }
+    }
+    
+    if (!resolve_phis(b)) {
+        goto cleanup;
+    }
+    if (ctx->ssa) {
+        if (ctx->ssa->failed) {
+            set_error(b, "Failed to allocate SSA state for '%s'", fn->name);
+            goto cleanup;
+        }
+        ssa_remove_trivial_phis(ctx->ssa);
     }
     
     // Success!
@@ -2573,6 +3575,7 @@ bool llvm_emit_function(LLVMBackend* b, const FcIRFunction* fn) {
 cleanup:
     // Clean up temporary allocations
     free(vreg_write_count);
+    free(write_block);
     free(label_to_block_index);
     free(used_vregs);
     
@@ -2581,8 +3584,13 @@ cleanup:
         free(ctx->vreg_values);
         free(ctx->vreg_allocas);
         free(ctx->vreg_is_mutable);
+        free(ctx->vreg_slot_types);
+        ssa_builder_destroy(ctx->ssa);
         free(ctx->label_blocks);
         free(ctx->vreg_types);
+        free(ctx->pending_phis);
+        free(ctx->pending_phi_instrs);
+        free(ctx->label_end_blocks);
         free(ctx);
     }
     
@@ -2623,166 +3631,141 @@ static void emit_strings(LLVMBackend* b, const FcIRModule* m) {
     }
 }
 
+// Runtime function signatures from fcx_runtime.h. One letter per type:
+// v void, b i1, i i32, l i64, q i128, f float, d double, p ptr
+typedef struct {
+    const char* name;
+    char ret;
+    const char* params;
+} RuntimeSignature;
+
+static const RuntimeSignature RUNTIME_SIGNATURES[] = {
+    {"_fcx_print_int", 'v', "l"},
+    {"_fcx_println_int", 'v', "l"},
+    {"_fcx_println_hex", 'v', "l"},
+    {"_fcx_println_bin", 'v', "l"},
+    {"_fcx_println_bool", 'v', "l"},
+    {"_fcx_println_char", 'v', "l"},
+    {"_fcx_println_u8", 'v', "l"},
+    {"_fcx_println_f32", 'v', "f"},
+    {"_fcx_println_f64", 'v', "d"},
+    {"_fcx_println_ptr", 'v', "p"},
+    {"_fcx_println_i128", 'v', "q"},  // void _fcx_println_i128(__int128 value)
+    {"_fcx_println_u128", 'v', "q"},  // void _fcx_println_u128(unsigned __int128 value)
+    // Wider integers are passed as pointers due to size
+    {"_fcx_println_i256", 'v', "p"},
+    {"_fcx_println_u256", 'v', "p"},
+    {"_fcx_println_i512", 'v', "p"},
+    {"_fcx_println_u512", 'v', "p"},
+    {"_fcx_println_i1024", 'v', "p"},
+    {"_fcx_println_u1024", 'v', "p"},
+    {"_fcx_print_func", 'v', "p"},
+    {"_fcx_print_str", 'v', "p"},
+    {"_fcx_println", 'v', "p"},
+    {"_fcx_alloc", 'p', "ll"},        // void* _fcx_alloc(size_t size, size_t alignment)
+    {"_fcx_free", 'v', "p"},          // void _fcx_free(void* ptr)
+    {"_fcx_arena_alloc", 'p', "lli"}, // void* _fcx_arena_alloc(size_t size, size_t alignment, uint32_t scope_id)
+    {"_fcx_slab_alloc", 'p', "li"},   // void* _fcx_slab_alloc(size_t object_size, uint32_t type_hash)
+    // long _fcx_syscall(long num, long a1, long a2, long a3, long a4, long a5, long a6)
+    {"_fcx_syscall", 'l', "lllllll"},
+    {"_fcx_write", 'l', "ipl"},       // long _fcx_write(int fd, const void* buf, size_t count)
+    {"_fcx_read", 'l', "ipl"},
+    {"_fcx_atomic_cas", 'b', "pll"},  // bool _fcx_atomic_cas(volatile uint64_t* ptr, uint64_t expected, uint64_t new_val)
+    {"_fcx_atomic_swap", 'l', "pl"},  // uint64_t _fcx_atomic_swap(volatile uint64_t* ptr, uint64_t val)
+    {"_fcx_memory_barrier", 'v', ""},
+    {"_fcx_atomic_fence", 'v', ""},
+    {"_fcx_panic", 'v', "p"},         // void _fcx_panic(const char* message)
+    // String functions
+    {"_fcx_strlen", 'l', "p"},
+    {"_fcx_strcmp", 'l', "pp"},
+    {"_fcx_strcpy", 'p', "pp"},
+    {"_fcx_strcat", 'p', "pp"},
+    {"_fcx_strchr", 'p', "pl"},
+    {"_fcx_strstr", 'p', "pp"},
+    // Memory functions
+    {"_fcx_memcpy", 'p', "ppl"},
+    {"_fcx_memmove", 'p', "ppl"},
+    {"_fcx_memset", 'p', "pll"},
+    {"_fcx_memcmp", 'l', "ppl"},
+    // Conversion functions
+    {"_fcx_atoi", 'l', "p"},
+    {"_fcx_itoa", 'l', "lpl"},
+    // Timing functions
+    {"_fcx_time_ns", 'l', ""},
+    {"_fcx_time_us", 'l', ""},
+    {"_fcx_time_ms", 'l', ""},
+    {"_fcx_cycles", 'l', ""},
+    {"_fcx_tock_ns", 'l', ""},
+    {"_fcx_tock_us", 'l', ""},
+    {"_fcx_tock_ms", 'l', ""},
+    {"_fcx_tock_cycles", 'l', ""},
+    {"_fcx_timer_start", 'l', ""},
+    {"_fcx_timer_stop_ns", 'l', "l"}, // int64_t _fcx_timer_stop_*(int64_t id)
+    {"_fcx_timer_stop_us", 'l', "l"},
+    {"_fcx_timer_stop_ms", 'l', "l"},
+    {"_fcx_timer_stop_cycles", 'l', "l"},
+    {"_fcx_timer_elapsed_ns", 'l', "l"},
+    {"_fcx_tick", 'v', ""},
+    {"_fcx_timer_reset", 'v', "l"},   // void _fcx_timer_reset(int64_t id)
+    {"_fcx_print_timing", 'v', "pl"}, // void _fcx_print_timing(const char* label, int64_t ns)
+};
+
+#define RUNTIME_SIGNATURE_COUNT (sizeof(RUNTIME_SIGNATURES) / sizeof(RUNTIME_SIGNATURES[0]))
+#define RUNTIME_SIGNATURE_MAX_PARAMS 7
+
+// Interned RUNTIME_SIGNATURES names, so lookups compare pointers
+static const char* runtime_signature_names[RUNTIME_SIGNATURE_COUNT];
+static pthread_once_t runtime_signature_once = PTHREAD_ONCE_INIT;
+
+static void intern_runtime_signature_names(void) {
+    for (size_t i = 0; i < RUNTIME_SIGNATURE_COUNT; i++) {
+        runtime_signature_names[i] = fcx_intern_cstr(RUNTIME_SIGNATURES[i].name);
+    }
+}
+
+// Signature of an interned runtime function name, or NULL
+static const RuntimeSignature* find_runtime_signature(const char* name) {
+    pthread_once(&runtime_signature_once, intern_runtime_signature_names);
+    for (size_t i = 0; i < RUNTIME_SIGNATURE_COUNT; i++) {
+        if (runtime_signature_names[i] == name) {
+            return &RUNTIME_SIGNATURES[i];
+        }
+    }
+    return NULL;
+}
+
+static LLVMTypeRef runtime_signature_type(LLVMBackend* b, char code) {
+    switch (code) {
+        case 'b': return LLVMInt1TypeInContext(b->context);
+        case 'i': return LLVMInt32TypeInContext(b->context);
+        case 'l': return LLVMInt64TypeInContext(b->context);
+        case 'q': return LLVMInt128TypeInContext(b->context);
+        case 'f': return LLVMFloatTypeInContext(b->context);
+        case 'd': return LLVMDoubleTypeInContext(b->context);
+        case 'p': return llvm_ptr_type(b);
+        default: return LLVMVoidTypeInContext(b->context);
+    }
+}
+
 static void emit_externals(LLVMBackend* b, const FcIRModule* m) {
     if (!m->external_func_count) return;
     b->external_funcs = calloc(m->external_func_count, sizeof(LLVMValueRef));
     b->external_func_count = m->external_func_count;
     LLVMTypeRef i64 = LLVMInt64TypeInContext(b->context);
-    LLVMTypeRef ptr = llvm_ptr_type(b);
-    LLVMTypeRef void_ty = LLVMVoidTypeInContext(b->context);
-    LLVMTypeRef f32 = LLVMFloatTypeInContext(b->context);
-    LLVMTypeRef f64 = LLVMDoubleTypeInContext(b->context);
     
     for (uint32_t i = 0; i < m->external_func_count; i++) {
+        // External function names are interned by fc_ir_module_add_external_func
         const char* name = m->external_functions[i];
         LLVMTypeRef ft;
         
-        // Match runtime function signatures from fcx_runtime.h
-        if (strcmp(name, "_fcx_print_int") == 0 || strcmp(name, "_fcx_println_int") == 0 ||
-            strcmp(name, "_fcx_println_hex") == 0 || strcmp(name, "_fcx_println_bin") == 0 ||
-            strcmp(name, "_fcx_println_bool") == 0 || strcmp(name, "_fcx_println_char") == 0 ||
-            strcmp(name, "_fcx_println_u8") == 0) {
-            LLVMTypeRef p[] = {i64};
-            ft = LLVMFunctionType(void_ty, p, 1, false);
-        } else if (strcmp(name, "_fcx_println_f32") == 0) {
-            LLVMTypeRef p[] = {f32};
-            ft = LLVMFunctionType(void_ty, p, 1, false);
-        } else if (strcmp(name, "_fcx_println_f64") == 0) {
-            LLVMTypeRef p[] = {f64};
-            ft = LLVMFunctionType(void_ty, p, 1, false);
-        } else if (strcmp(name, "_fcx_println_ptr") == 0) {
-            LLVMTypeRef p[] = {ptr};
-            ft = LLVMFunctionType(void_ty, p, 1, false);
-        } else if (strcmp(name, "_fcx_println_i128") == 0) {
-            // void _fcx_println_i128(__int128 value)
-            LLVMTypeRef i128 = LLVMInt128TypeInContext(b->context);
-            LLVMTypeRef p[] = {i128};
-            ft = LLVMFunctionType(void_ty, p, 1, false);
-        } else if (strcmp(name, "_fcx_println_u128") == 0) {
-            // void _fcx_println_u128(unsigned __int128 value)
-            LLVMTypeRef i128 = LLVMInt128TypeInContext(b->context);
-            LLVMTypeRef p[] = {i128};
-            ft = LLVMFunctionType(void_ty, p, 1, false);
-        } else if (strcmp(name, "_fcx_println_i256") == 0 || strcmp(name, "_fcx_println_u256") == 0) {
-            // void _fcx_println_i256(i256 value) - passed as pointer due to size
-            LLVMTypeRef p[] = {ptr};
-            ft = LLVMFunctionType(void_ty, p, 1, false);
-        } else if (strcmp(name, "_fcx_println_i512") == 0 || strcmp(name, "_fcx_println_u512") == 0) {
-            // void _fcx_println_i512(i512 value) - passed as pointer due to size
-            LLVMTypeRef p[] = {ptr};
-            ft = LLVMFunctionType(void_ty, p, 1, false);
-        } else if (strcmp(name, "_fcx_println_i1024") == 0 || strcmp(name, "_fcx_println_u1024") == 0) {
-            // void _fcx_println_i1024(i1024 value) - passed as pointer due to size
-            LLVMTypeRef p[] = {ptr};
-            ft = LLVMFunctionType(void_ty, p, 1, false);
-        } else if (strcmp(name, "_fcx_print_func") == 0 || strcmp(name, "_fcx_print_str") == 0 ||
-                   strcmp(name, "_fcx_println") == 0) {
-            LLVMTypeRef p[] = {ptr};
-            ft = LLVMFunctionType(void_ty, p, 1, false);
-        } else if (strcmp(name, "_fcx_alloc") == 0) {
-            // void* _fcx_alloc(size_t size, size_t alignment)
-            LLVMTypeRef p[] = {i64, i64};
-            ft = LLVMFunctionType(ptr, p, 2, false);
-        } else if (strcmp(name, "_fcx_free") == 0) {
-            // void _fcx_free(void* ptr)
-            LLVMTypeRef p[] = {ptr};
-            ft = LLVMFunctionType(void_ty, p, 1, false);
-        } else if (strcmp(name, "_fcx_arena_alloc") == 0) {
-            // void* _fcx_arena_alloc(size_t size, size_t alignment, uint32_t scope_id)
-            LLVMTypeRef p[] = {i64, i64, LLVMInt32TypeInContext(b->context)};
-            ft = LLVMFunctionType(ptr, p, 3, false);
-        } else if (strcmp(name, "_fcx_slab_alloc") == 0) {
-            // void* _fcx_slab_alloc(size_t object_size, uint32_t type_hash)
-            LLVMTypeRef p[] = {i64, LLVMInt32TypeInContext(b->context)};
-            ft = LLVMFunctionType(ptr, p, 2, false);
-        } else if (strcmp(name, "_fcx_syscall") == 0) {
-            // long _fcx_syscall(long num, long a1, long a2, long a3, long a4, long a5, long a6)
-            LLVMTypeRef p[] = {i64, i64, i64, i64, i64, i64, i64};
-            ft = LLVMFunctionType(i64, p, 7, false);
-        } else if (strcmp(name, "_fcx_write") == 0 || strcmp(name, "_fcx_read") == 0) {
-            // long _fcx_write/read(int fd, const void* buf, size_t count)
-            LLVMTypeRef p[] = {LLVMInt32TypeInContext(b->context), ptr, i64};
-            ft = LLVMFunctionType(i64, p, 3, false);
-        } else if (strcmp(name, "_fcx_atomic_cas") == 0) {
-            // bool _fcx_atomic_cas(volatile uint64_t* ptr, uint64_t expected, uint64_t new_val)
-            LLVMTypeRef p[] = {ptr, i64, i64};
-            ft = LLVMFunctionType(LLVMInt1TypeInContext(b->context), p, 3, false);
-        } else if (strcmp(name, "_fcx_atomic_swap") == 0) {
-            // uint64_t _fcx_atomic_swap(volatile uint64_t* ptr, uint64_t val)
-            LLVMTypeRef p[] = {ptr, i64};
-            ft = LLVMFunctionType(i64, p, 2, false);
-        } else if (strcmp(name, "_fcx_memory_barrier") == 0 || 
-                   strcmp(name, "_fcx_atomic_fence") == 0) {
-            // void _fcx_memory_barrier(void)
-            ft = LLVMFunctionType(void_ty, NULL, 0, false);
-        } else if (strcmp(name, "_fcx_panic") == 0) {
-            // void _fcx_panic(const char* message)
-            LLVMTypeRef p[] = {ptr};
-            ft = LLVMFunctionType(void_ty, p, 1, false);
-        // String functions
-        } else if (strcmp(name, "_fcx_strlen") == 0) {
-            LLVMTypeRef p[] = {ptr};
-            ft = LLVMFunctionType(i64, p, 1, false);
-        } else if (strcmp(name, "_fcx_strcmp") == 0) {
-            LLVMTypeRef p[] = {ptr, ptr};
-            ft = LLVMFunctionType(i64, p, 2, false);
-        } else if (strcmp(name, "_fcx_strcpy") == 0 || strcmp(name, "_fcx_strcat") == 0) {
-            LLVMTypeRef p[] = {ptr, ptr};
-            ft = LLVMFunctionType(ptr, p, 2, false);
-        } else if (strcmp(name, "_fcx_strchr") == 0) {
-            LLVMTypeRef p[] = {ptr, i64};
-            ft = LLVMFunctionType(ptr, p, 2, false);
-        } else if (strcmp(name, "_fcx_strstr") == 0) {
-            LLVMTypeRef p[] = {ptr, ptr};
-            ft = LLVMFunctionType(ptr, p, 2, false);
-        // Memory functions
-        } else if (strcmp(name, "_fcx_memcpy") == 0 || strcmp(name, "_fcx_memmove") == 0) {
-            LLVMTypeRef p[] = {ptr, ptr, i64};
-            ft = LLVMFunctionType(ptr, p, 3, false);
-        } else if (strcmp(name, "_fcx_memset") == 0) {
-            LLVMTypeRef p[] = {ptr, i64, i64};
-            ft = LLVMFunctionType(ptr, p, 3, false);
-        } else if (strcmp(name, "_fcx_memcmp") == 0) {
-            LLVMTypeRef p[] = {ptr, ptr, i64};
-            ft = LLVMFunctionType(i64, p, 3, false);
-        // Conversion functions
-        } else if (strcmp(name, "_fcx_atoi") == 0) {
-            LLVMTypeRef p[] = {ptr};
-            ft = LLVMFunctionType(i64, p, 1, false);
-        } else if (strcmp(name, "_fcx_itoa") == 0) {
-            LLVMTypeRef p[] = {i64, ptr, i64};
-            ft = LLVMFunctionType(i64, p, 3, false);
-        // Timing functions
-        } else if (strcmp(name, "_fcx_time_ns") == 0 ||
-                   strcmp(name, "_fcx_time_us") == 0 ||
-                   strcmp(name, "_fcx_time_ms") == 0 ||
-                   strcmp(name, "_fcx_cycles") == 0 ||
-                   strcmp(name, "_fcx_tock_ns") == 0 ||
-                   strcmp(name, "_fcx_tock_us") == 0 ||
-                   strcmp(name, "_fcx_tock_ms") == 0 ||
-                   strcmp(name, "_fcx_tock_cycles") == 0 ||
-                   strcmp(name, "_fcx_timer_start") == 0) {
-            // int64_t _fcx_time_*() - no args, returns i64
-            ft = LLVMFunctionType(i64, NULL, 0, false);
-        } else if (strcmp(name, "_fcx_timer_stop_ns") == 0 ||
-                   strcmp(name, "_fcx_timer_stop_us") == 0 ||
-                   strcmp(name, "_fcx_timer_stop_ms") == 0 ||
-                   strcmp(name, "_fcx_timer_stop_cycles") == 0 ||
-                   strcmp(name, "_fcx_timer_elapsed_ns") == 0) {
-            // int64_t _fcx_timer_stop_*(int64_t id)
-            LLVMTypeRef p[] = {i64};
-            ft = LLVMFunctionType(i64, p, 1, false);
-        } else if (strcmp(name, "_fcx_tick") == 0) {
-            // void _fcx_tick()
-            ft = LLVMFunctionType(void_ty, NULL, 0, false);
-        } else if (strcmp(name, "_fcx_timer_reset") == 0) {
-            // void _fcx_timer_reset(int64_t id)
-            LLVMTypeRef p[] = {i64};
-            ft = LLVMFunctionType(void_ty, p, 1, false);
-        } else if (strcmp(name, "_fcx_print_timing") == 0) {
-            // void _fcx_print_timing(const char* label, int64_t ns)
-            LLVMTypeRef p[] = {ptr, i64};
-            ft = LLVMFunctionType(void_ty, p, 2, false);
+        const RuntimeSignature* sig = find_runtime_signature(name);
+        if (sig) {
+            LLVMTypeRef p[RUNTIME_SIGNATURE_MAX_PARAMS];
+            unsigned param_count = 0;
+            for (const char* c = sig->params; *c; c++) {
+                p[param_count++] = runtime_signature_type(b, *c);
+            }
+            ft = LLVMFunctionType(runtime_signature_type(b, sig->ret), p, param_count, false);
         } else {
             // Default: Check if function already exists (from C imports)
             // If it does, use that declaration instead of creating a generic one
@@ -2906,6 +3889,7 @@ bool llvm_emit_module_with_imports(LLVMBackend* b, const FcIRModule* m,
     emit_global_vars(b, m);
     emit_strings(b, m);
     emit_externals(b, m);
+    if (!declare_functions(b, m)) return false;
     
     for (uint32_t i = 0; i < m->function_count; i++) {
         if (!llvm_emit_function(b, &m->functions[i])) return false;
@@ -2929,15 +3913,15 @@ bool llvm_verify_module(LLVMBackend* b) {
     return true;
 }
 
-bool llvm_optimize_module(LLVMBackend* b) {
-    if (!b || !b->module) return false;
-    if (b->config.opt_level == LLVM_OPT_NONE) return true;
-    
+// Runs the pipeline for `level` over one module. Returns NULL on success or
+// a message for LLVMDisposeErrorMessage
+static char* run_pass_pipeline(LLVMModuleRef module, LLVMTargetMachineRef machine,
+                               LLVMOptLevel level) {
     // Build optimized pass pipeline based on optimization level
     // LLVM 21+ new pass manager with explicit passes for better control
     const char* passes;
     
-    switch (b->config.opt_level) {
+    switch (level) {
         case LLVM_OPT_LESS:
             // O1: Basic optimizations with mem2reg for SSA promotion
             passes = "function(mem2reg,sroa,early-cse,simplifycfg,instcombine)";
@@ -2964,7 +3948,7 @@ bool llvm_optimize_module(LLVMBackend* b) {
     LLVMPassBuilderOptionsRef opts = LLVMCreatePassBuilderOptions();
     
     // Configure optimization options for LLVM 21+
-    if (b->config.opt_level == LLVM_OPT_AGGRESSIVE) {
+    if (level == LLVM_OPT_AGGRESSIVE) {
         LLVMPassBuilderOptionsSetLoopVectorization(opts, true);
         LLVMPassBuilderOptionsSetSLPVectorization(opts, true);
         LLVMPassBuilderOptionsSetLoopInterleaving(opts, true);
@@ -2976,26 +3960,34 @@ bool llvm_optimize_module(LLVMBackend* b) {
         LLVMPassBuilderOptionsSetInlinerThreshold(opts, 250);
         // Enable call graph profiling for better inlining decisions
         LLVMPassBuilderOptionsSetCallGraphProfile(opts, true);
-    } else if (b->config.opt_level == LLVM_OPT_DEFAULT) {
+    } else if (level == LLVM_OPT_DEFAULT) {
         LLVMPassBuilderOptionsSetLoopVectorization(opts, true);
         LLVMPassBuilderOptionsSetSLPVectorization(opts, true);
         LLVMPassBuilderOptionsSetLoopUnrolling(opts, false);
     }
     
-    LLVMErrorRef e = LLVMRunPasses(b->module, passes, b->target_machine, opts);
+    LLVMErrorRef e = LLVMRunPasses(module, passes, machine, opts);
     LLVMDisposePassBuilderOptions(opts);
+    return e ? LLVMGetErrorMessage(e) : NULL;
+}
+
+// Runs the pipeline once per module; every output generated afterwards,
+// in whatever order, starts from the same optimized IR
+bool llvm_optimize_module(LLVMBackend* b) {
+    if (!b || !b->module) return false;
+    if (b->optimized || b->config.opt_level == LLVM_OPT_NONE) return true;
     
-    if (e) {
-        char* msg = LLVMGetErrorMessage(e);
-        set_error(b, "Opt failed: %s", msg ? msg : "unknown");
+    char* msg = run_pass_pipeline(b->module, b->target_machine, b->config.opt_level);
+    if (msg) {
+        set_error(b, "Opt failed: %s", msg);
         LLVMDisposeErrorMessage(msg);
         return false;
     }
+    b->optimized = true;
     return true;
 }
 
-bool llvm_generate_object_file(LLVMBackend* b, const char* path) {
-    if (!b || !b->module || !path) return false;
+static bool emit_object_file(LLVMBackend* b, const char* path) {
     if (!llvm_optimize_module(b)) return false;
     char* err = NULL;
     if (LLVMTargetMachineEmitToFile(b->target_machine, b->module, (char*)path, LLVMObjectFile, &err)) {
@@ -3006,21 +3998,830 @@ bool llvm_generate_object_file(LLVMBackend* b, const char* path) {
     return true;
 }
 
-bool llvm_generate_assembly(LLVMBackend* b, const char* path) {
-    if (!b || !b->module || !path) return false;
+static bool emit_object_buffer(LLVMBackend* b, LLVMMemoryBufferRef* object) {
     if (!llvm_optimize_module(b)) return false;
     char* err = NULL;
-    if (LLVMTargetMachineEmitToFile(b->target_machine, b->module, (char*)path, LLVMAssemblyFile, &err)) {
-        set_error(b, "Emit asm failed: %s", err ? err : "unknown");
+    if (LLVMTargetMachineEmitToMemoryBuffer(b->target_machine, b->module, LLVMObjectFile, &err, object)) {
+        set_error(b, "Emit obj failed: %s", err ? err : "unknown");
         LLVMDisposeMessage(err);
         return false;
     }
     return true;
 }
 
+// ============================================================================
+// Split-Module Code Generation
+// ============================================================================
+
+// Upper bound on partitions, which also keeps linker command lines short
+#define CODEGEN_MAX_PARTITIONS 32
+
+typedef struct {
+    LLVMValueRef function;
+    uint32_t index;  // Position in the module's function list
+} FunctionIndex;
+
+typedef struct {
+    LLVMValueRef value;
+    LLVMLinkage linkage;
+    LLVMVisibility visibility;
+} SavedLinkage;
+
+typedef struct {
+    LLVMValueRef* functions;    // Module order
+    uint32_t* partition_of;     // By module order; UINT32_MAX for declarations
+    FunctionIndex* by_value;    // Sorted by function for lookups
+    uint32_t function_count;
+    uint32_t partition_count;
+    SavedLinkage* externalized; // Symbols made external for the split
+    uint32_t externalized_count;
+    uint32_t externalized_capacity;
+} ModuleSplit;
+
+typedef struct {
+    const LLVMBackend* backend;
+    LLVMMemoryBufferRef bitcode;  // This partition's slice of the module
+    uint32_t index;
+    LLVMMemoryBufferRef object;   // The partition's object code
+    char error[256];
+    bool ok;
+    bool unreadable;  // The bitcode reader rejected the partition
+} CodegenPartition;
+
+static int compare_function_index(const void* a, const void* b) {
+    uintptr_t x = (uintptr_t)((const FunctionIndex*)a)->function;
+    uintptr_t y = (uintptr_t)((const FunctionIndex*)b)->function;
+    return (x > y) - (x < y);
+}
+
+// Module position of a function, or UINT32_MAX if it is not one of ours
+static uint32_t split_function_index(const ModuleSplit* split, LLVMValueRef function) {
+    FunctionIndex key = {function, 0};
+    const FunctionIndex* found = bsearch(&key, split->by_value, split->function_count,
+                                         sizeof(FunctionIndex), compare_function_index);
+    return found ? found->index : UINT32_MAX;
+}
+
+static void module_split_destroy(ModuleSplit* split) {
+    free(split->functions);
+    free(split->partition_of);
+    free(split->by_value);
+    free(split->externalized);
+}
+
+// Orders defined functions depth-first along direct calls, so a caller and
+// its callees land in the same partition where possible, then cuts that
+// order into `wanted` slices of similar instruction count
+static bool module_split_create(ModuleSplit* split, LLVMModuleRef module, uint32_t wanted) {
+    memset(split, 0, sizeof(*split));
+    for (LLVMValueRef fn = LLVMGetFirstFunction(module); fn; fn = LLVMGetNextFunction(fn)) {
+        split->function_count++;
+    }
+    uint32_t n = split->function_count;
+    split->functions = malloc((n + 1) * sizeof(LLVMValueRef));
+    split->partition_of = malloc((n + 1) * sizeof(uint32_t));
+    split->by_value = malloc((n + 1) * sizeof(FunctionIndex));
+    uint32_t* order = malloc((n + 1) * sizeof(uint32_t));
+    uint64_t* weight = calloc(n + 1, sizeof(uint64_t));
+    bool* visited = calloc(n + 1, sizeof(bool));
+    uint32_t stack_capacity = n + 16;
+    uint32_t* stack = malloc(stack_capacity * sizeof(uint32_t));
+    bool ok = split->functions && split->partition_of && split->by_value &&
+              order && weight && visited && stack;
+    
+    uint32_t defined = 0;
+    if (ok) {
+        uint32_t i = 0;
+        for (LLVMValueRef fn = LLVMGetFirstFunction(module); fn; fn = LLVMGetNextFunction(fn), i++) {
+            split->functions[i] = fn;
+            split->partition_of[i] = UINT32_MAX;
+            split->by_value[i] = (FunctionIndex){fn, i};
+            if (LLVMIsDeclaration(fn)) visited[i] = true;
+            else defined++;
+        }
+        qsort(split->by_value, n, sizeof(FunctionIndex), compare_function_index);
+    }
+    
+    uint32_t ordered = 0;
+    uint64_t total_weight = 0;
+    bool addressed_block = false;
+    for (uint32_t root = 0; ok && root < n; root++) {
+        if (visited[root]) continue;
+        uint32_t depth = 0;
+        stack[depth++] = root;
+        while (ok && depth > 0) {
+            uint32_t f = stack[--depth];
+            if (visited[f]) continue;
+            visited[f] = true;
+            order[ordered++] = f;
+            
+            for (LLVMBasicBlockRef bb = LLVMGetFirstBasicBlock(split->functions[f]); bb;
+                 bb = LLVMGetNextBasicBlock(bb)) {
+                // blockaddress constants need their block attached while
+                // the module is written, so such modules are not split
+                for (LLVMUseRef use = LLVMGetFirstUse(LLVMBasicBlockAsValue(bb)); use;
+                     use = LLVMGetNextUse(use)) {
+                    if (!LLVMIsAInstruction(LLVMGetUser(use))) addressed_block = true;
+                }
+                for (LLVMValueRef inst = LLVMGetFirstInstruction(bb); inst;
+                     inst = LLVMGetNextInstruction(inst)) {
+                    weight[f]++;
+                    if (!LLVMIsACallInst(inst)) continue;
+                    LLVMValueRef callee = LLVMGetCalledValue(inst);
+                    if (!callee || !LLVMIsAFunction(callee)) continue;
+                    uint32_t c = split_function_index(split, callee);
+                    if (c == UINT32_MAX || visited[c]) continue;
+                    if (depth == stack_capacity) {
+                        uint32_t* grown = realloc(stack, 2 * stack_capacity * sizeof(uint32_t));
+                        if (!grown) { ok = false; break; }
+                        stack = grown;
+                        stack_capacity *= 2;
+                    }
+                    stack[depth++] = c;
+                }
+            }
+            total_weight += weight[f];
+        }
+    }
+    
+    if (ok) {
+        uint32_t parts = wanted < defined ? wanted : defined;
+        if (parts == 0 || addressed_block) parts = 1;
+        // Slice boundaries fall where the running weight crosses k/parts of
+        // the total; slices a single huge function skips over stay unused
+        uint64_t running = 0;
+        uint32_t previous = UINT32_MAX;
+        for (uint32_t k = 0; k < ordered; k++) {
+            uint32_t f = order[k];
+            uint32_t slice = total_weight ? (uint32_t)(running * parts / total_weight) : 0;
+            if (slice != previous) {
+                previous = slice;
+                split->partition_count++;
+            }
+            split->partition_of[f] = split->partition_count - 1;
+            running += weight[f];
+        }
+        if (split->partition_count == 0) split->partition_count = 1;
+    }
+    
+    free(order);
+    free(weight);
+    free(visited);
+    free(stack);
+    if (!ok) module_split_destroy(split);
+    return ok;
+}
+
+// Functions with one of these linkages may be defined in every object
+static bool is_duplicable_linkage(LLVMLinkage linkage) {
+    return linkage == LLVMLinkOnceAnyLinkage || linkage == LLVMLinkOnceODRLinkage ||
+           linkage == LLVMWeakAnyLinkage || linkage == LLVMWeakODRLinkage ||
+           linkage == LLVMAvailableExternallyLinkage;
+}
+
+// Whether anything outside partition `owner` refers to `value`, looking
+// through constant expressions. Global initializers and functions copied
+// into every partition count as outside
+static bool used_outside_partition(const ModuleSplit* split, LLVMValueRef value, uint32_t owner) {
+    for (LLVMUseRef use = LLVMGetFirstUse(value); use; use = LLVMGetNextUse(use)) {
+        LLVMValueRef user = LLVMGetUser(use);
+        if (LLVMIsAInstruction(user)) {
+            LLVMValueRef fn = LLVMGetBasicBlockParent(LLVMGetInstructionParent(user));
+            uint32_t f = split_function_index(split, fn);
+            if (f == UINT32_MAX || split->partition_of[f] != owner ||
+                is_duplicable_linkage(LLVMGetLinkage(fn))) {
+                return true;
+            }
+        } else if (LLVMIsAGlobalValue(user)) {
+            return true;
+        } else if (LLVMIsAConstant(user) && used_outside_partition(split, user, owner)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_local_linkage(LLVMLinkage linkage) {
+    return linkage == LLVMInternalLinkage || linkage == LLVMPrivateLinkage;
+}
+
+// Private constants (string literals) are copied into every partition that
+// uses them; every other global is defined once, in partition 0
+static bool is_copied_global(LLVMValueRef global) {
+    return LLVMGetLinkage(global) == LLVMPrivateLinkage && LLVMIsGlobalConstant(global);
+}
+
+static bool externalize_symbol(ModuleSplit* split, LLVMValueRef value) {
+    if (split->externalized_count == split->externalized_capacity) {
+        uint32_t capacity = split->externalized_capacity ? split->externalized_capacity * 2 : 16;
+        SavedLinkage* grown = realloc(split->externalized, capacity * sizeof(SavedLinkage));
+        if (!grown) return false;
+        split->externalized = grown;
+        split->externalized_capacity = capacity;
+    }
+    split->externalized[split->externalized_count++] =
+        (SavedLinkage){value, LLVMGetLinkage(value), LLVMGetVisibility(value)};
+    LLVMSetLinkage(value, LLVMExternalLinkage);
+    LLVMSetVisibility(value, LLVMHiddenVisibility);
+    return true;
+}
+
+// Gives local symbols that another partition refers to hidden external
+// linkage, so that partition can declare them instead. Only the partitions'
+// bitcode needs this; restore_shared_symbols undoes it on the module
+static bool externalize_shared_symbols(LLVMModuleRef module, ModuleSplit* split) {
+    for (uint32_t f = 0; f < split->function_count; f++) {
+        LLVMValueRef fn = split->functions[f];
+        if (split->partition_of[f] == UINT32_MAX || !is_local_linkage(LLVMGetLinkage(fn))) continue;
+        if (used_outside_partition(split, fn, split->partition_of[f]) && !externalize_symbol(split, fn)) {
+            return false;
+        }
+    }
+    for (LLVMValueRef g = LLVMGetFirstGlobal(module); g; g = LLVMGetNextGlobal(g)) {
+        if (LLVMIsDeclaration(g) || !is_local_linkage(LLVMGetLinkage(g)) || is_copied_global(g)) continue;
+        if (used_outside_partition(split, g, 0) && !externalize_symbol(split, g)) return false;
+    }
+    return true;
+}
+
+static void restore_shared_symbols(ModuleSplit* split) {
+    for (uint32_t k = 0; k < split->externalized_count; k++) {
+        LLVMSetLinkage(split->externalized[k].value, split->externalized[k].linkage);
+        LLVMSetVisibility(split->externalized[k].value, split->externalized[k].visibility);
+    }
+    split->externalized_count = 0;
+}
+
+static void take_value_name(LLVMValueRef to, LLVMValueRef from) {
+    size_t length = 0;
+    const char* name = LLVMGetValueName2(from, &length);
+    char* copy = strndup(name, length);
+    LLVMSetValueName2(from, "", 0);
+    if (copy) {
+        LLVMSetValueName2(to, copy, length);
+        free(copy);
+    }
+}
+
+// Replaces a global defined in partition 0 with a declaration
+static void drop_global_definition(LLVMModuleRef module, LLVMValueRef g) {
+    LLVMValueRef decl = LLVMAddGlobal(module, LLVMGlobalGetValueType(g), "");
+    LLVMSetGlobalConstant(decl, LLVMIsGlobalConstant(g));
+    LLVMSetThreadLocalMode(decl, LLVMGetThreadLocalMode(g));
+    LLVMSetVisibility(decl, LLVMGetVisibility(g));
+    LLVMReplaceAllUsesWith(g, decl);
+    take_value_name(decl, g);
+    LLVMDeleteGlobal(g);
+}
+
+// Serializes each partition of the module into bitcode[p]. While partition
+// p is written, functions it does not own have their blocks detached, which
+// leaves declarations behind; the blocks are put back afterwards
+static bool write_partitions(LLVMModuleRef module, const ModuleSplit* split,
+                             LLVMMemoryBufferRef* bitcode) {
+    uint32_t block_count = 0;
+    for (uint32_t f = 0; f < split->function_count; f++) {
+        if (split->partition_of[f] != UINT32_MAX) {
+            block_count += LLVMCountBasicBlocks(split->functions[f]);
+        }
+    }
+    LLVMBasicBlockRef* blocks = malloc((block_count + 1) * sizeof(LLVMBasicBlockRef));
+    uint32_t* first_block = malloc((split->function_count + 1) * sizeof(uint32_t));
+    LLVMLinkage* linkage = malloc((split->function_count + 1) * sizeof(LLVMLinkage));
+    if (!blocks || !first_block || !linkage) {
+        free(blocks);
+        free(first_block);
+        free(linkage);
+        return false;
+    }
+    uint32_t next = 0;
+    for (uint32_t f = 0; f < split->function_count; f++) {
+        first_block[f] = next;
+        linkage[f] = LLVMGetLinkage(split->functions[f]);
+        if (split->partition_of[f] == UINT32_MAX) continue;
+        LLVMGetBasicBlocks(split->functions[f], blocks + next);
+        next += LLVMCountBasicBlocks(split->functions[f]);
+    }
+    first_block[split->function_count] = next;
+    
+    bool ok = true;
+    for (uint32_t p = 0; ok && p < split->partition_count; p++) {
+        for (uint32_t f = 0; f < split->function_count; f++) {
+            uint32_t owner = split->partition_of[f];
+            if (owner == UINT32_MAX || owner == p || is_duplicable_linkage(linkage[f])) continue;
+            for (uint32_t k = first_block[f]; k < first_block[f + 1]; k++) {
+                LLVMRemoveBasicBlockFromParent(blocks[k]);
+            }
+            // A declaration cannot be local; it is unused in p anyway
+            if (is_local_linkage(linkage[f])) LLVMSetLinkage(split->functions[f], LLVMExternalLinkage);
+        }
+        bitcode[p] = LLVMWriteBitcodeToMemoryBuffer(module);
+        ok = bitcode[p] != NULL;
+        for (uint32_t f = 0; f < split->function_count; f++) {
+            uint32_t owner = split->partition_of[f];
+            if (owner == UINT32_MAX || owner == p || is_duplicable_linkage(linkage[f])) continue;
+            for (uint32_t k = first_block[f]; k < first_block[f + 1]; k++) {
+                LLVMAppendExistingBasicBlock(split->functions[f], blocks[k]);
+            }
+            LLVMSetLinkage(split->functions[f], linkage[f]);
+        }
+    }
+    
+    free(blocks);
+    free(first_block);
+    free(linkage);
+    return ok;
+}
+
+// Globals other than copied constants are defined only in partition 0
+static void drop_foreign_globals(LLVMModuleRef module, uint32_t index) {
+    if (index == 0) return;
+    LLVMValueRef g = LLVMGetFirstGlobal(module);
+    while (g) {
+        LLVMValueRef next = LLVMGetNextGlobal(g);
+        LLVMLinkage linkage = LLVMGetLinkage(g);
+        if (linkage == LLVMAppendingLinkage) {
+            // llvm.global_ctors and friends must appear exactly once
+            LLVMDeleteGlobal(g);
+        } else if (!LLVMIsDeclaration(g) && !is_copied_global(g) && !is_duplicable_linkage(linkage)) {
+            drop_global_definition(module, g);
+        }
+        g = next;
+    }
+}
+
+// Keeps the bitcode reader's complaints out of stderr; the first error
+// becomes the partition's
+static void partition_diagnostic(LLVMDiagnosticInfoRef info, void* arg) {
+    CodegenPartition* part = (CodegenPartition*)arg;
+    if (LLVMGetDiagInfoSeverity(info) != LLVMDSError || part->error[0]) return;
+    char* text = LLVMGetDiagInfoDescription(info);
+    snprintf(part->error, sizeof(part->error), "%s", text ? text : "unknown");
+    LLVMDisposeMessage(text);
+}
+
+static void* codegen_partition(void* arg) {
+    CodegenPartition* part = (CodegenPartition*)arg;
+    const LLVMBackend* b = part->backend;
+    LLVMContextRef context = LLVMContextCreate();
+    LLVMModuleRef module = NULL;
+    LLVMTargetMachineRef machine = NULL;
+    char* msg = NULL;
+    
+    LLVMContextSetDiagnosticHandler(context, partition_diagnostic, part);
+    part->unreadable = LLVMParseBitcodeInContext2(context, part->bitcode, &module);
+    LLVMContextSetDiagnosticHandler(context, NULL, NULL);
+    
+    if (part->unreadable) {
+        module = NULL;
+    } else if (!(machine = create_target_machine(b))) {
+        snprintf(part->error, sizeof(part->error), "Failed to create target machine");
+    } else {
+        drop_foreign_globals(module, part->index);
+        // Drop what only the other partitions' bodies referred to
+        LLVMPassBuilderOptionsRef opts = LLVMCreatePassBuilderOptions();
+        LLVMErrorRef e = LLVMRunPasses(module, "globaldce", machine, opts);
+        LLVMDisposePassBuilderOptions(opts);
+        msg = e ? LLVMGetErrorMessage(e) : NULL;
+        // An already optimized module is only code generated here
+        if (!msg && !b->optimized && b->config.opt_level != LLVM_OPT_NONE) {
+            msg = run_pass_pipeline(module, machine, b->config.opt_level);
+        }
+        if (msg) {
+            snprintf(part->error, sizeof(part->error), "Opt failed: %s", msg);
+            LLVMDisposeErrorMessage(msg);
+        } else if (LLVMTargetMachineEmitToMemoryBuffer(machine, module, LLVMObjectFile, &msg, &part->object)) {
+            snprintf(part->error, sizeof(part->error), "Emit obj failed: %s", msg ? msg : "unknown");
+            LLVMDisposeMessage(msg);
+        } else {
+            part->ok = true;
+        }
+    }
+    
+    if (machine) LLVMDisposeTargetMachine(machine);
+    if (module) LLVMDisposeModule(module);
+    LLVMContextDispose(context);
+    return NULL;
+}
+
+// Splits the module into up to config.codegen_threads partitions and emits
+// each from its own LLVM context and thread, into objects[n] in memory; on
+// failure none are kept. Returns the partition count, or 0 if the module
+// was not split: it is too small, has aliases or block addresses we cannot
+// divide, or a partition did not survive the round trip through bitcode
+static uint32_t generate_split_objects(LLVMBackend* b, LLVMMemoryBufferRef* objects, bool* ok) {
+    *ok = true;
+    uint32_t wanted = b->config.codegen_threads;
+    if (wanted > CODEGEN_MAX_PARTITIONS) wanted = CODEGEN_MAX_PARTITIONS;
+    if (wanted < 2 || LLVMGetFirstGlobalAlias(b->module) || LLVMGetFirstGlobalIFunc(b->module)) {
+        return 0;
+    }
+    
+    ModuleSplit split;
+    if (!module_split_create(&split, b->module, wanted)) return 0;
+    if (split.partition_count < 2) {
+        module_split_destroy(&split);
+        return 0;
+    }
+    
+    // The module keeps its own linkage whatever happens: it is emitted
+    // whole when the split fails, and other outputs may still be written
+    uint32_t count = split.partition_count;
+    LLVMMemoryBufferRef* bitcode = calloc(count, sizeof(LLVMMemoryBufferRef));
+    CodegenPartition* parts = calloc(count, sizeof(CodegenPartition));
+    pthread_t* threads = calloc(count, sizeof(pthread_t));
+    bool* started = calloc(count, sizeof(bool));
+    bool written = bitcode && parts && threads && started &&
+                   externalize_shared_symbols(b->module, &split) &&
+                   write_partitions(b->module, &split, bitcode);
+    restore_shared_symbols(&split);
+    if (!written) {
+        set_error(b, "Failed to split module");
+        *ok = false;
+    } else {
+        for (uint32_t p = 0; p < count; p++) {
+            parts[p].backend = b;
+            parts[p].bitcode = bitcode[p];
+            parts[p].index = p;
+        }
+        // The calling thread takes partition 0
+        for (uint32_t p = 1; p < count; p++) {
+            started[p] = pthread_create(&threads[p], NULL, codegen_partition, &parts[p]) == 0;
+        }
+        codegen_partition(&parts[0]);
+        bool unreadable = parts[0].unreadable;
+        for (uint32_t p = 1; p < count; p++) {
+            if (started[p]) pthread_join(threads[p], NULL);
+            else codegen_partition(&parts[p]);
+            unreadable |= parts[p].unreadable;
+        }
+        // Unreadable: the module holds IR the verifier was not asked to
+        // reject and bitcode cannot carry; emit it whole instead
+        for (uint32_t p = 0; !unreadable && p < count; p++) {
+            if (!parts[p].ok && *ok) {
+                set_error(b, "Partition %u: %s", p, parts[p].error);
+                *ok = false;
+            }
+            objects[p] = parts[p].object;
+        }
+        if (unreadable || !*ok) {
+            for (uint32_t p = 0; p < count; p++) {
+                if (parts[p].object) LLVMDisposeMemoryBuffer(parts[p].object);
+                objects[p] = NULL;
+            }
+            if (unreadable) count = 0;
+        }
+    }
+    
+    for (uint32_t p = 0; bitcode && p < split.partition_count; p++) {
+        if (bitcode[p]) LLVMDisposeMemoryBuffer(bitcode[p]);
+    }
+    free(bitcode);
+    free(parts);
+    free(threads);
+    free(started);
+    module_split_destroy(&split);
+    return count;
+}
+
+// ============================================================================
+// Linking
+// ============================================================================
+
+// Objects are linked without touching the filesystem: each is written to a
+// memfd and handed to the linker as /proc/self/fd/<n>. The linkers usable
+// for each kind of output are probed on PATH once per process; a link is
+// retried with the next one when a linker fails. Executables prefer GNU ld,
+// which finds libc on its own: lld has no default library search path, so
+// it comes second and is given the usual library directories.
+
+typedef enum {
+    LINK_EXECUTABLE,
+    LINK_SHARED,
+    LINK_RELOCATABLE,
+    LINK_KIND_COUNT
+} LinkKind;
+
+#define LINKER_CANDIDATE_MAX 3
+
+typedef struct {
+    const char* program;
+    const char* args[4];   // Leading arguments, NULL-terminated
+    bool library_paths;    // Needs LINKER_LIBRARY_PATHS to find -lc and -lm
+} LinkerCandidate;
+
+// Where libc lives on multiarch and lib64 systems
+static const char* const LINKER_LIBRARY_PATHS[] = {
+    "-L/usr/lib/x86_64-linux-gnu", "-L/lib/x86_64-linux-gnu", "-L/usr/lib64", "-L/lib64", NULL
+};
+#define LINKER_LIBRARY_PATH_COUNT (sizeof(LINKER_LIBRARY_PATHS) / sizeof(LINKER_LIBRARY_PATHS[0]) - 1)
+
+// In order of preference
+static const LinkerCandidate LINKER_CANDIDATES[LINK_KIND_COUNT][LINKER_CANDIDATE_MAX] = {
+    [LINK_EXECUTABLE] = {
+        {"ld", {NULL}, false},
+        {"ld.lld", {NULL}, true},
+        {"lld", {"-flavor", "gnu", NULL}, true},
+    },
+    // Shared libraries go through a compiler driver for its crt objects
+    [LINK_SHARED] = {
+        {"gcc", {"-shared", "-fPIC", NULL}},
+        {"clang", {"-shared", "-fPIC", NULL}},
+        {"ld", {"-shared", NULL}},
+    },
+    [LINK_RELOCATABLE] = {
+        {"ld.lld", {"-r", NULL}},
+        {"ld", {"-r", NULL}},
+    },
+};
+
+// The candidates that passed the probe, in the same order
+static const LinkerCandidate* linkers[LINK_KIND_COUNT][LINKER_CANDIDATE_MAX];
+static char linker_paths[LINK_KIND_COUNT][LINKER_CANDIDATE_MAX][PATH_MAX];
+static uint32_t linker_count[LINK_KIND_COUNT];
+static pthread_once_t linker_probe_once = PTHREAD_ONCE_INIT;
+
+static bool find_program(const char* name, char* path, size_t size) {
+    const char* dirs = getenv("PATH");
+    if (!dirs || !*dirs) dirs = "/usr/local/bin:/usr/bin:/bin";
+    while (*dirs) {
+        size_t length = strcspn(dirs, ":");
+        int n = snprintf(path, size, "%.*s/%s", (int)length, length ? dirs : ".", name);
+        if (n > 0 && (size_t)n < size && access(path, X_OK) == 0) return true;
+        dirs += length;
+        if (*dirs == ':') dirs++;
+    }
+    return false;
+}
+
+// Runs `path` and waits for it; fds are kept open across the exec, and
+// with `quiet` its stdout and stderr go to /dev/null. Returns 0 when it
+// exited successfully, -1 when it exited otherwise, or the posix_spawn
+// error when it could not be started
+static int run_program(const char* path, const char* const* argv,
+                       const int* fds, uint32_t fd_count, bool quiet) {
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    // dup2 onto itself clears close-on-exec in the child only
+    for (uint32_t k = 0; k < fd_count; k++) {
+        posix_spawn_file_actions_adddup2(&actions, fds[k], fds[k]);
+    }
+    if (quiet) {
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+        posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+    }
+    pid_t pid;
+    int err = posix_spawn(&pid, path, &actions, NULL, (char* const*)argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (err != 0) return err;
+    
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return -1;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+// A candidate is usable when it is on PATH and answers --version
+static void probe_linkers(void) {
+    for (int kind = 0; kind < LINK_KIND_COUNT; kind++) {
+        for (int c = 0; c < LINKER_CANDIDATE_MAX && LINKER_CANDIDATES[kind][c].program; c++) {
+            const LinkerCandidate* candidate = &LINKER_CANDIDATES[kind][c];
+            char* path = linker_paths[kind][linker_count[kind]];
+            if (!find_program(candidate->program, path, PATH_MAX)) continue;
+            const char* argv[8];
+            size_t argc = 0;
+            argv[argc++] = candidate->program;
+            // Keep lld's -flavor, drop output-kind flags like -shared
+            if (strcmp(candidate->program, "lld") == 0) {
+                for (int k = 0; candidate->args[k]; k++) argv[argc++] = candidate->args[k];
+            }
+            argv[argc++] = "--version";
+            argv[argc] = NULL;
+            if (run_program(path, argv, NULL, 0, true) == 0) {
+                linkers[kind][linker_count[kind]++] = candidate;
+            }
+        }
+    }
+}
+
+// Runs the linkers for `kind` in order of preference with their leading
+// arguments, `-o out`, the inputs, then `tail`, until one succeeds. Only
+// the last one tried reports its errors. fds are kept open across the
+// exec for inputs that name them. Returns whether a linker succeeded;
+// `b` (if any) gets the reason none could run
+static bool spawn_linker(LLVMBackend* b, LinkKind kind, const char* out,
+                         const char* const* inputs, uint32_t input_count,
+                         const char* const* tail, const int* fds, uint32_t fd_count) {
+    pthread_once(&linker_probe_once, probe_linkers);
+    if (linker_count[kind] == 0) {
+        if (b) set_error(b, "No linker found on PATH (tried %s)", LINKER_CANDIDATES[kind][0].program);
+        return false;
+    }
+    
+    size_t tail_count = 0;
+    while (tail && tail[tail_count]) tail_count++;
+    const char** argv = malloc((8 + LINKER_LIBRARY_PATH_COUNT + input_count + tail_count) * sizeof(char*));
+    if (!argv) {
+        if (b) set_error(b, "Failed to allocate linker arguments");
+        return false;
+    }
+    
+    bool ok = false;
+    for (uint32_t c = 0; !ok && c < linker_count[kind]; c++) {
+        const LinkerCandidate* linker = linkers[kind][c];
+        size_t argc = 0;
+        argv[argc++] = linker->program;
+        for (int k = 0; linker->args[k]; k++) argv[argc++] = linker->args[k];
+        argv[argc++] = "-o";
+        argv[argc++] = out;
+        for (size_t k = 0; linker->library_paths && k < LINKER_LIBRARY_PATH_COUNT; k++) {
+            argv[argc++] = LINKER_LIBRARY_PATHS[k];
+        }
+        for (uint32_t k = 0; k < input_count; k++) argv[argc++] = inputs[k];
+        for (size_t k = 0; k < tail_count; k++) argv[argc++] = tail[k];
+        argv[argc] = NULL;
+        
+        bool last = c + 1 == linker_count[kind];
+        int err = run_program(linker_paths[kind][c], argv, fds, fd_count, !last);
+        ok = err == 0;
+        if (err > 0 && last && b) {
+            set_error(b, "Failed to run %s: %s", linker_paths[kind][c], strerror(err));
+        }
+    }
+    free(argv);
+    return ok;
+}
+
+// The FCx runtime objects, when built, relative to the working directory
+static const char* const* runtime_objects(void) {
+    static const char* const in_tree[] = {
+        "obj/runtime/bootstrap.o", "obj/runtime/fcx_memory.o", "obj/runtime/fcx_syscall.o",
+        "obj/runtime/fcx_atomic.o", "obj/runtime/fcx_hardware.o", "obj/runtime/fcx_runtime.o", NULL
+    };
+    static const char* const from_subdir[] = {
+        "../obj/runtime/bootstrap.o", "../obj/runtime/fcx_memory.o", "../obj/runtime/fcx_syscall.o",
+        "../obj/runtime/fcx_atomic.o", "../obj/runtime/fcx_hardware.o", "../obj/runtime/fcx_runtime.o", NULL
+    };
+    if (access(in_tree[0], F_OK) == 0) return in_tree;
+    if (access(from_subdir[0], F_OK) == 0) return from_subdir;
+    return NULL;
+}
+
+// Links `inputs` as `kind` into `out`. Executables get the runtime (when
+// built) and libc, for C imports and the runtime's own memcpy, strlen, ...
+static bool link_inputs(LLVMBackend* b, LinkKind kind, const char* out,
+                        const char* const* inputs, uint32_t input_count,
+                        const int* fds, uint32_t fd_count) {
+    const char* tail[32];
+    size_t n = 0;
+    if (kind == LINK_EXECUTABLE) {
+        tail[n++] = "-e";
+        tail[n++] = "_start";
+        tail[n++] = "--dynamic-linker";
+        tail[n++] = "/lib64/ld-linux-x86-64.so.2";
+        const char* const* runtime = runtime_objects();
+        for (size_t k = 0; runtime && runtime[k]; k++) tail[n++] = runtime[k];
+        tail[n++] = "-lc";
+        tail[n++] = "-lm";
+    }
+    tail[n] = NULL;
+    return spawn_linker(b, kind, out, inputs, input_count, tail, fds, fd_count);
+}
+
+// Links in-memory objects through memfds
+static bool link_objects(LLVMBackend* b, LinkKind kind, const char* out,
+                         LLVMMemoryBufferRef* objects, uint32_t count) {
+    int fds[CODEGEN_MAX_PARTITIONS] = {0};
+    char paths[CODEGEN_MAX_PARTITIONS][32];
+    const char* inputs[CODEGEN_MAX_PARTITIONS] = {0};
+    uint32_t opened = 0;
+    bool ok = true;
+    for (; opened < count; opened++) {
+        int fd = memfd_create("fcx-object", MFD_CLOEXEC);
+        if (fd < 0) {
+            set_error(b, "memfd_create failed: %s", strerror(errno));
+            ok = false;
+            break;
+        }
+        fds[opened] = fd;
+        const char* data = LLVMGetBufferStart(objects[opened]);
+        size_t size = LLVMGetBufferSize(objects[opened]);
+        while (size > 0) {
+            ssize_t written = write(fd, data, size);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) break;
+            data += written;
+            size -= (size_t)written;
+        }
+        if (size > 0) {
+            set_error(b, "Failed to write object to memfd");
+            ok = false;
+            opened++;
+            break;
+        }
+        snprintf(paths[opened], sizeof(paths[opened]), "/proc/self/fd/%d", fd);
+        inputs[opened] = paths[opened];
+    }
+    
+    if (ok) {
+        ok = link_inputs(b, kind, out, inputs, count, fds, count);
+        if (!ok && !b->has_error) {
+            set_error(b, kind == LINK_EXECUTABLE ? "Linking failed" :
+                         kind == LINK_SHARED ? "Shared library linking failed" :
+                         "Combining partition objects failed");
+        }
+    }
+    for (uint32_t k = 0; k < opened; k++) close(fds[k]);
+    return ok;
+}
+
+// Splits a space-separated list of object paths
+static uint32_t split_paths(char* list, const char** paths, uint32_t max) {
+    uint32_t count = 0;
+    for (char* p = strtok(list, " "); p && count < max; p = strtok(NULL, " ")) {
+        paths[count++] = p;
+    }
+    return count;
+}
+
+static void dispose_objects(LLVMMemoryBufferRef* objects, uint32_t count) {
+    for (uint32_t p = 0; p < count; p++) {
+        if (objects[p]) LLVMDisposeMemoryBuffer(objects[p]);
+    }
+}
+
+// Generates the module's code in memory, split when the config asks for
+// several codegen threads; returns the object count, 0 on failure
+static uint32_t generate_objects(LLVMBackend* b, LLVMMemoryBufferRef* objects) {
+    bool ok;
+    uint32_t count = generate_split_objects(b, objects, &ok);
+    if (count) return ok ? count : 0;
+    return emit_object_buffer(b, &objects[0]) ? 1 : 0;
+}
+
+bool llvm_generate_object_file(LLVMBackend* b, const char* path) {
+    if (!b || !b->module || !path) return false;
+    LLVMMemoryBufferRef objects[CODEGEN_MAX_PARTITIONS];
+    bool ok;
+    uint32_t count = generate_split_objects(b, objects, &ok);
+    if (count) {
+        // One object per partition; combine them into the requested one
+        if (!ok) return false;
+        ok = link_objects(b, LINK_RELOCATABLE, path, objects, count);
+        dispose_objects(objects, count);
+        return ok;
+    }
+    return emit_object_file(b, path);
+}
+
+bool llvm_generate_assembly(LLVMBackend* b, const char* path) {
+    if (!b || !b->module || !path) return false;
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        set_error(b, "Cannot open %s: %s", path, strerror(errno));
+        return false;
+    }
+    bool ok = llvm_print_assembly(b, out);
+    if (fclose(out) != 0 && ok) {
+        set_error(b, "Failed to write %s", path);
+        ok = false;
+    }
+    return ok;
+}
+
 bool llvm_generate_bitcode(LLVMBackend* b, const char* path) {
     if (!b || !b->module || !path) return false;
-    return LLVMWriteBitcodeToFile(b->module, path) == 0;
+    if (LLVMWriteBitcodeToFile(b->module, path) != 0) {
+        set_error(b, "Failed to write bitcode to %s", path);
+        return false;
+    }
+    return true;
+}
+
+bool llvm_generate_ir(LLVMBackend* b, const char* path) {
+    if (!b || !b->module || !path) return false;
+    char* err = NULL;
+    if (LLVMPrintModuleToFile(b->module, path, &err)) {
+        set_error(b, "Failed to write IR to %s: %s", path, err ? err : "unknown");
+        LLVMDisposeMessage(err);
+        return false;
+    }
+    return true;
+}
+
+// Optimizes once and writes every requested output from the result. An
+// object on its own is left to llvm_generate_object_file, which optimizes
+// split partitions in parallel
+bool llvm_emit_outputs(LLVMBackend* b, const LLVMOutputPaths* outputs) {
+    if (!b || !b->module || !outputs) return false;
+    bool whole_module = outputs->ir_path || outputs->bitcode_path || outputs->assembly_path;
+    if (whole_module && !llvm_optimize_module(b)) return false;
+    if (outputs->ir_path && !llvm_generate_ir(b, outputs->ir_path)) return false;
+    if (outputs->bitcode_path && !llvm_generate_bitcode(b, outputs->bitcode_path)) return false;
+    if (outputs->assembly_path && !llvm_generate_assembly(b, outputs->assembly_path)) return false;
+    if (outputs->object_path && !llvm_generate_object_file(b, outputs->object_path)) return false;
+    return true;
 }
 
 void llvm_print_module(LLVMBackend* b, FILE* out) {
@@ -3029,6 +4830,26 @@ void llvm_print_module(LLVMBackend* b, FILE* out) {
     if (ir) { fprintf(out, "%s", ir); LLVMDisposeMessage(ir); }
 }
 
+// Code generation rewrites the IR it runs on, so assembly is generated from
+// a copy and the module stays as the optimizer left it for the object
+bool llvm_print_assembly(LLVMBackend* b, FILE* out) {
+    if (!b || !b->module || !out) return false;
+    if (!llvm_optimize_module(b)) return false;
+    LLVMModuleRef copy = LLVMCloneModule(b->module);
+    char* err = NULL;
+    LLVMMemoryBufferRef assembly = NULL;
+    bool failed = LLVMTargetMachineEmitToMemoryBuffer(b->target_machine, copy, LLVMAssemblyFile, &err, &assembly);
+    LLVMDisposeModule(copy);
+    if (failed) {
+        set_error(b, "Emit asm failed: %s", err ? err : "unknown");
+        LLVMDisposeMessage(err);
+        return false;
+    }
+    fwrite(LLVMGetBufferStart(assembly), 1, LLVMGetBufferSize(assembly), out);
+    LLVMDisposeMemoryBuffer(assembly);
+    return true;
+}
+
 void llvm_print_statistics(const LLVMBackend* b) {
     if (!b) return;
     printf("\n=== LLVM Backend Statistics ===\n");
@@ -3039,90 +4860,46 @@ void llvm_print_statistics(const LLVMBackend* b) {
 
 bool llvm_link_executable(const char* obj, const char* out) {
     if (!obj || !out) return false;
-    
-    char cmd[4096];
-    
-    // Check if runtime objects exist
-    const char* runtime_paths[] = {
-        "obj/runtime/bootstrap.o obj/runtime/fcx_memory.o obj/runtime/fcx_syscall.o "
-        "obj/runtime/fcx_atomic.o obj/runtime/fcx_hardware.o obj/runtime/fcx_runtime.o",
-        "../obj/runtime/bootstrap.o ../obj/runtime/fcx_memory.o ../obj/runtime/fcx_syscall.o "
-        "../obj/runtime/fcx_atomic.o ../obj/runtime/fcx_hardware.o ../obj/runtime/fcx_runtime.o",
-        NULL
-    };
-    
-    bool has_runtime = false;
-    const char* runtime_objs = NULL;
-    
-    for (int i = 0; runtime_paths[i] != NULL; i++) {
-        char first_obj[256];
-        sscanf(runtime_paths[i], "%255s", first_obj);
-        if (access(first_obj, F_OK) == 0) {
-            has_runtime = true;
-            runtime_objs = runtime_paths[i];
-            break;
-        }
-    }
-    
-    // Always link with libc for C import support and standard library functions
-    // This enables using printf, malloc, math functions, etc. from C imports
-    if (has_runtime && runtime_objs) {
-        // Link with runtime and libc (for memcpy, strlen, C imports, etc.)
-        snprintf(cmd, sizeof(cmd), 
-            "ld.lld -o %s -e _start --dynamic-linker /lib64/ld-linux-x86-64.so.2 %s %s -lc -lm 2>/dev/null || "
-            "lld -flavor gnu -o %s -e _start --dynamic-linker /lib64/ld-linux-x86-64.so.2 %s %s -lc -lm 2>/dev/null || "
-            "ld -o %s -e _start --dynamic-linker /lib64/ld-linux-x86-64.so.2 %s %s -lc -lm",
-            out, obj, runtime_objs,
-            out, obj, runtime_objs,
-            out, obj, runtime_objs);
-    } else {
-        // Link without runtime but with libc for C import support
-        snprintf(cmd, sizeof(cmd), 
-            "ld.lld -o %s -e _start --dynamic-linker /lib64/ld-linux-x86-64.so.2 %s -lc -lm 2>/dev/null || "
-            "lld -flavor gnu -o %s -e _start --dynamic-linker /lib64/ld-linux-x86-64.so.2 %s -lc -lm 2>/dev/null || "
-            "ld -o %s -e _start --dynamic-linker /lib64/ld-linux-x86-64.so.2 %s -lc -lm",
-            out, obj, out, obj, out, obj);
-    }
-    
-    return system(cmd) == 0;
+    char* list = strdup(obj);
+    if (!list) return false;
+    const char* inputs[CODEGEN_MAX_PARTITIONS] = {0};
+    uint32_t count = split_paths(list, inputs, CODEGEN_MAX_PARTITIONS);
+    bool ok = link_inputs(NULL, LINK_EXECUTABLE, out, inputs, count, NULL, 0);
+    free(list);
+    return ok;
 }
 
 bool llvm_link_shared_library(const char* obj, const char* out) {
     if (!obj || !out) return false;
-    
-    char cmd[2048];
-    
+    char* list = strdup(obj);
+    if (!list) return false;
+    const char* inputs[CODEGEN_MAX_PARTITIONS] = {0};
+    uint32_t count = split_paths(list, inputs, CODEGEN_MAX_PARTITIONS);
     // For shared libraries, we don't link the FCx runtime by default
     // The runtime contains global state that doesn't work well in shared libs
     // Users can link it separately if needed
-    snprintf(cmd, sizeof(cmd), 
-        "gcc -shared -fPIC -o %s %s 2>/dev/null || "
-        "clang -shared -fPIC -o %s %s 2>/dev/null || "
-        "ld -shared -o %s %s",
-        out, obj, out, obj, out, obj);
-    
-    return system(cmd) == 0;
+    bool ok = link_inputs(NULL, LINK_SHARED, out, inputs, count, NULL, 0);
+    free(list);
+    return ok;
 }
 
 bool llvm_compile_and_link(LLVMBackend* b, const char* out) {
     if (!b || !b->module || !out) return false;
-    char obj[256];
-    snprintf(obj, sizeof(obj), "/tmp/fcx_%d.o", getpid());
-    if (!llvm_generate_object_file(b, obj)) return false;
-    bool ok = llvm_link_executable(obj, out);
-    unlink(obj);
-    if (!ok) set_error(b, "Linking failed");
+    LLVMMemoryBufferRef objects[CODEGEN_MAX_PARTITIONS];
+    uint32_t count = generate_objects(b, objects);
+    if (!count) return false;
+    bool ok = link_objects(b, LINK_EXECUTABLE, out, objects, count);
+    dispose_objects(objects, count);
     return ok;
 }
 
 bool llvm_compile_shared_library(LLVMBackend* b, const char* out) {
     if (!b || !b->module || !out) return false;
-    char obj[256];
-    snprintf(obj, sizeof(obj), "/tmp/fcx_%d.o", getpid());
-    if (!llvm_generate_object_file(b, obj)) return false;
-    bool ok = llvm_link_shared_library(obj, out);
-    unlink(obj);
-    if (!ok) set_error(b, "Shared library linking failed");
+    LLVMMemoryBufferRef objects[CODEGEN_MAX_PARTITIONS];
+    uint32_t count = generate_objects(b, objects);
+    if (!count) return false;
+    bool ok = link_objects(b, LINK_SHARED, out, objects, count);
+    dispose_objects(objects, count);
     return ok;
 }
 
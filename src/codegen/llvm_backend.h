@@ -17,6 +17,7 @@
 
 typedef struct LLVMBackend LLVMBackend;
 typedef struct LLVMFunctionContext LLVMFunctionContext;
+typedef struct LLVMSSABuilder LLVMSSABuilder;
 
 typedef enum {
     LLVM_OPT_NONE = 0,
@@ -39,9 +40,12 @@ typedef struct {
     const char* target_triple;
     const char* cpu;
     const char* features;
+    uint32_t codegen_threads;  // >1: split the module and emit objects in parallel
+    bool direct_ssa;           // Build phis for mutable vregs instead of stack slots
 } LLVMBackendConfig;
 
 struct LLVMFunctionContext {
+    const FcIRFunction* fc_function;  // Function being emitted
     LLVMValueRef function;
     LLVMBasicBlockRef* blocks;
     uint32_t block_count;
@@ -60,6 +64,18 @@ struct LLVMFunctionContext {
     // For loop variable support - use alloca for vregs that need to be mutable
     LLVMValueRef* vreg_allocas;     // alloca pointers for mutable vregs
     bool* vreg_is_mutable;          // track which vregs need alloca
+    LLVMTypeRef* vreg_slot_types;   // type a mutable vreg is kept in
+    // Direct SSA emission: mutable vregs have no alloca; their definitions
+    // are tracked per FC IR block and merged by phis (owned by
+    // llvm_emit_function, NULL when the function uses allocas)
+    LLVMSSABuilder* ssa;
+    // SSA functions: phi nodes get their incoming values once every block
+    // has been emitted, from the LLVM block each FC IR block ended in
+    LLVMValueRef* pending_phis;     // phi node of each pending FCIR_PHI
+    const FcIRInstruction** pending_phi_instrs;
+    uint32_t pending_phi_count;
+    uint32_t pending_phi_capacity;
+    LLVMBasicBlockRef* label_end_blocks;  // by label id
 };
 
 struct LLVMBackend {
@@ -80,13 +96,24 @@ struct LLVMBackend {
     uint32_t global_var_count;
     LLVMValueRef* external_funcs;
     uint32_t external_func_count;
+    LLVMValueRef* internal_funcs;    // By FC IR function index
+    uint32_t internal_func_count;
     uint32_t instruction_count;
     uint32_t function_count;
     uint32_t block_count;
     char error_message[512];
     bool has_error;
+    bool optimized;                  // Module has been through the pass pipeline
 };
 
+// Files written from one optimized module by llvm_emit_outputs; NULL skips
+typedef struct {
+    const char* object_path;         // .o
+    const char* assembly_path;       // .s
+    const char* bitcode_path;        // .bc
+    const char* ir_path;             // .ll
+} LLVMOutputPaths;
+
 LLVMBackend* llvm_backend_create(const CpuFeatures* features, const LLVMBackendConfig* config);
 void llvm_backend_destroy(LLVMBackend* backend);
 void llvm_backend_reset(LLVMBackend* backend);
@@ -101,9 +128,12 @@ bool llvm_emit_instruction(LLVMBackend* backend, const FcIRInstruction* instr);
 bool llvm_generate_object_file(LLVMBackend* backend, const char* output_path);
 bool llvm_generate_assembly(LLVMBackend* backend, const char* output_path);
 bool llvm_generate_bitcode(LLVMBackend* backend, const char* output_path);
+bool llvm_generate_ir(LLVMBackend* backend, const char* output_path);
+bool llvm_emit_outputs(LLVMBackend* backend, const LLVMOutputPaths* outputs);
 bool llvm_verify_module(LLVMBackend* backend);
 bool llvm_optimize_module(LLVMBackend* backend);
 void llvm_print_module(LLVMBackend* backend, FILE* output);
+bool llvm_print_assembly(LLVMBackend* backend, FILE* output);
 void llvm_print_statistics(const LLVMBackend* backend);
 LLVMBackendConfig llvm_default_config(void);
 LLVMBackendConfig llvm_debug_config(void);
@@ -0,0 +1,189 @@
+// LLVM emission benchmark for call-heavy modules
+// Generates functions that each call several others, lowers the module to
+// FC IR and times fc_ir_lower_module and llvm_emit_module separately, so the
+// cost of resolving call targets shows up next to the rest of emission.
+// Emission runs with stack slots for mutable vregs and with direct SSA
+// construction; for each the emitted instruction count, -O0 object
+// generation time and object size are reported too.
+// Usage: llvm_emit_bench [functions] [calls_per_function]
+
+#include "llvm_backend.h"
+#include "../ir/fc_ir_lower.h"
+#include "../ir/ir_gen.h"
+#include "../ir/ir_ssa.h"
+#include "../bench_source.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Function i calls calls_per_function others spread over the whole module,
+// before and after it, so callees are both already emitted and still ahead
+static char *generate_source(size_t function_count, size_t calls_per_function) {
+  size_t capacity = function_count * (96 + calls_per_function * 48) + 64;
+  char *source = malloc(capacity);
+  if (!source) {
+    return NULL;
+  }
+  size_t size = 0;
+  for (size_t i = 0; i < function_count; i++) {
+    size += (size_t)snprintf(source + size, capacity - size,
+                             "fn bench_func_%zu(a, b) -> i64 {\n"
+                             "    let x := a + b\n",
+                             i);
+    for (size_t c = 0; c < calls_per_function; c++) {
+      size_t callee = (i * 7919 + c * 104729 + 1) % function_count;
+      size += (size_t)snprintf(source + size, capacity - size,
+                               "    x := x + bench_func_%zu(x, b)\n", callee);
+    }
+    size += (size_t)snprintf(source + size, capacity - size,
+                             "    ret x\n}\n\n");
+  }
+  size += (size_t)snprintf(source + size, capacity - size,
+                           "fn main() -> i64 {\n    ret 0\n}\n");
+  return source;
+}
+
+static unsigned count_instructions(LLVMModuleRef module) {
+  unsigned count = 0;
+  for (LLVMValueRef fn = LLVMGetFirstFunction(module); fn;
+       fn = LLVMGetNextFunction(fn)) {
+    for (LLVMBasicBlockRef bb = LLVMGetFirstBasicBlock(fn); bb;
+         bb = LLVMGetNextBasicBlock(bb)) {
+      for (LLVMValueRef i = LLVMGetFirstInstruction(bb); i;
+           i = LLVMGetNextInstruction(i)) {
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
+int main(int argc, char **argv) {
+  size_t function_count = 5000;
+  size_t calls_per_function = 10;
+  if (argc > 1) {
+    function_count = (size_t)strtoul(argv[1], NULL, 10);
+    if (function_count == 0) {
+      function_count = 1;
+    }
+  }
+  if (argc > 2) {
+    calls_per_function = (size_t)strtoul(argv[2], NULL, 10);
+  }
+
+  char *source = generate_source(function_count, calls_per_function);
+  if (!source) {
+    fprintf(stderr, "Error: Failed to allocate benchmark source\n");
+    return 1;
+  }
+
+  init_operator_registry();
+  TokenBuffer tokens;
+  if (!token_buffer_fill(&tokens, source)) {
+    fprintf(stderr, "Error: Failed to lex benchmark source\n");
+    free(source);
+    return 1;
+  }
+  Parser parser;
+  parser_init_tokens(&parser, &tokens);
+  Stmt **statements = NULL;
+  size_t stmt_count = 0;
+  IRGenerator *gen = NULL;
+  if (!parse_program(&parser, 1, &statements, &stmt_count) ||
+      !(gen = ir_gen_create("bench_module")) ||
+      !ir_gen_generate_module(gen, statements, stmt_count)) {
+    fprintf(stderr, "Error: Failed to generate benchmark IR\n");
+    return 1;
+  }
+  ir_ssa_construct_module(gen->module);
+
+  LLVMBackendConfig config = llvm_debug_config();
+  config.verify_module = false;
+  LLVMBackend *backend = llvm_backend_create(NULL, &config);
+  if (!backend) {
+    fprintf(stderr, "Error: Failed to create LLVM backend\n");
+    return 1;
+  }
+
+  printf("=== FCx LLVM Emission Benchmark ===\n");
+  printf("%zu functions, %zu calls\n\n", function_count + 1,
+         function_count * calls_per_function);
+
+  // Best of three per mode; each run lowers and emits the whole module
+  // afresh, then generates its -O0 object in memory
+  double best_lower = 0.0;
+  double best_emit[2] = {0.0, 0.0};
+  double best_codegen[2] = {0.0, 0.0};
+  unsigned instructions[2] = {0, 0};
+  size_t object_size[2] = {0, 0};
+  bool ok = true;
+  for (int direct_ssa = 0; direct_ssa < 2 && ok; direct_ssa++) {
+    backend->config.direct_ssa = direct_ssa;
+    for (int run = 0; run < 3 && ok; run++) {
+      FcIRLowerContext *lower = fc_ir_lower_create();
+      double start = now_seconds();
+      ok = lower && fc_ir_lower_module(lower, gen->module);
+      double lowered = now_seconds();
+      ok = ok && llvm_emit_module(backend, lower->fc_module);
+      double emitted = now_seconds();
+      if (!ok) {
+        fprintf(stderr, "Error: %s\n",
+                llvm_backend_get_error(backend) ? llvm_backend_get_error(backend)
+                                                : "lowering failed");
+        fc_ir_lower_destroy(lower);
+        break;
+      }
+      instructions[direct_ssa] = count_instructions(backend->module);
+
+      char *message = NULL;
+      LLVMMemoryBufferRef object = NULL;
+      if (LLVMTargetMachineEmitToMemoryBuffer(backend->target_machine,
+                                              backend->module, LLVMObjectFile,
+                                              &message, &object)) {
+        fprintf(stderr, "Error: %s\n", message ? message : "codegen failed");
+        LLVMDisposeMessage(message);
+        ok = false;
+      } else {
+        object_size[direct_ssa] = LLVMGetBufferSize(object);
+        LLVMDisposeMemoryBuffer(object);
+      }
+      double generated = now_seconds();
+
+      if ((direct_ssa == 0 && run == 0) || lowered - start < best_lower) {
+        best_lower = lowered - start;
+      }
+      if (run == 0 || emitted - lowered < best_emit[direct_ssa]) {
+        best_emit[direct_ssa] = emitted - lowered;
+      }
+      if (run == 0 || generated - emitted < best_codegen[direct_ssa]) {
+        best_codegen[direct_ssa] = generated - emitted;
+      }
+      fc_ir_lower_destroy(lower);
+    }
+  }
+
+  if (ok) {
+    double calls = (double)(function_count * calls_per_function);
+    printf("%-12s %9.1f ms  %8.0f ns/call\n", "lower", best_lower * 1000.0,
+           best_lower * 1e9 / calls);
+    for (int direct_ssa = 0; direct_ssa < 2; direct_ssa++) {
+      printf("%-12s %9.1f ms  %8.0f ns/call  %8u instrs  -O0 object "
+             "%8.1f ms  %7.1f KB\n",
+             direct_ssa ? "emit (ssa)" : "emit (slots)",
+             best_emit[direct_ssa] * 1000.0,
+             best_emit[direct_ssa] * 1e9 / calls, instructions[direct_ssa],
+             best_codegen[direct_ssa] * 1000.0,
+             (double)object_size[direct_ssa] / 1024.0);
+    }
+  }
+
+  llvm_backend_destroy(backend);
+  ir_gen_destroy(gen);
+  free(statements);
+  parser_destroy(&parser);
+  token_buffer_destroy(&tokens);
+  free(source);
+  cleanup_operator_registry();
+  return ok ? 0 : 1;
+}
@@ -30,10 +30,6 @@ ErrorHandler* error_handler_create(void) {
     handler->continue_after_error = true;
     handler->max_errors = 100;  // Stop after 100 errors
     
-    handler->string_pool = NULL;
-    handler->string_pool_count = 0;
-    handler->string_pool_capacity = 0;
-    
     return handler;
 }
 
@@ -83,40 +79,15 @@ void error_handler_destroy(ErrorHandler* handler) {
     }
     free(handler->errors);
     
-    // Free string pool
-    for (size_t i = 0; i < handler->string_pool_count; i++) {
-        free(handler->string_pool[i]);
-    }
-    free(handler->string_pool);
-    
     free(handler);
 }
 
 // String interning for memory efficiency
+// Diagnostics share the compiler-wide interner, so filenames and names in
+// errors are the same pointers the rest of the compiler uses
 const char* error_handler_intern_string(ErrorHandler* handler, const char* str) {
-    if (!str) return NULL;
-    
-    // Check if string already exists in pool
-    for (size_t i = 0; i < handler->string_pool_count; i++) {
-        if (strcmp(handler->string_pool[i], str) == 0) {
-            return handler->string_pool[i];
-        }
-    }
-    
-    // Add new string to pool
-    if (handler->string_pool_count >= handler->string_pool_capacity) {
-        size_t new_capacity = handler->string_pool_capacity ? handler->string_pool_capacity * 2 : 16;
-        char** new_pool = realloc(handler->string_pool, new_capacity * sizeof(char*));
-        if (!new_pool) return NULL;
-        handler->string_pool = new_pool;
-        handler->string_pool_capacity = new_capacity;
-    }
-    
-    char* interned = strdup(str);
-    if (!interned) return NULL;
-    
-    handler->string_pool[handler->string_pool_count++] = interned;
-    return interned;
+    (void)handler;
+    return fcx_intern_cstr(str);
 }
 
 // Helper to add error to handler
@@ -96,11 +96,6 @@ typedef struct {
     
     bool continue_after_error;  // Error recovery flag
     size_t max_errors;  // Maximum errors before stopping
-    
-    // String pool for memory efficiency
-    char** string_pool;
-    size_t string_pool_count;
-    size_t string_pool_capacity;
 } ErrorHandler;
 
 // Initialize error handler
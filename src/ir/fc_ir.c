@@ -1,5 +1,6 @@
 #define _POSIX_C_SOURCE 200809L
 #include "fc_ir.h"
+#include "../lexer/intern.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -13,7 +14,7 @@ FcIRModule *fc_ir_module_create(const char *name) {
   if (!module)
     return NULL;
 
-  module->name = strdup(name);
+  module->name = fcx_intern_cstr(name);
   if (!module->name) {
     free(module);
     return NULL;
@@ -22,6 +23,11 @@ FcIRModule *fc_ir_module_create(const char *name) {
   module->functions = NULL;
   module->function_count = 0;
   module->function_capacity = 0;
+
+  // Initialize global variable storage
+  module->global_vars = NULL;
+  module->global_var_count = 0;
+  module->global_var_capacity = 0;
   
   // Initialize string literal storage
   module->string_literals = NULL;
@@ -64,18 +70,10 @@ void fc_ir_module_destroy(FcIRModule *module) {
   }
   free(module->string_literals);
   
-  // Free external function names
-  if (module->external_functions && module->external_func_count > 0) {
-    for (uint32_t i = 0; i < module->external_func_count; i++) {
-      if (module->external_functions[i]) {
-        free((void*)module->external_functions[i]);
-      }
-    }
-  }
+  // External function, global, function and block names are interned
   free(module->external_functions);
 
   free(module->functions);
-  free((void *)module->name);
   free(module);
 }
 
@@ -114,9 +112,11 @@ bool fc_ir_module_add_function(FcIRModule *module, FcIRFunction *function) {
 uint32_t fc_ir_module_add_external_func(FcIRModule* module, const char* func_name) {
   if (!module || !func_name) return UINT32_MAX;
   
-  // Check if function already exists
+  // Check if function already exists; interned names compare by pointer
+  const char* name = fcx_intern_cstr(func_name);
+  if (!name) return UINT32_MAX;
   for (uint32_t i = 0; i < module->external_func_count; i++) {
-    if (strcmp(module->external_functions[i], func_name) == 0) {
+    if (module->external_functions[i] == name) {
       return i; // Return existing index
     }
   }
@@ -132,7 +132,7 @@ uint32_t fc_ir_module_add_external_func(FcIRModule* module, const char* func_nam
     module->external_func_capacity = new_capacity;
   }
   
-  module->external_functions[module->external_func_count] = strdup(func_name);
+  module->external_functions[module->external_func_count] = name;
   return module->external_func_count++;
 }
 
@@ -145,7 +145,7 @@ FcIRFunction *fc_ir_function_create(const char *name, VRegType return_type) {
   if (!function)
     return NULL;
 
-  function->name = strdup(name);
+  function->name = fcx_intern_cstr(name);
   function->parameters = NULL;
   function->parameter_count = 0;
   function->return_type = return_type;
@@ -159,6 +159,11 @@ FcIRFunction *fc_ir_function_create(const char *name, VRegType return_type) {
   function->next_vreg_id = 1;
   function->next_label_id = 1;
   function->next_block_id = 1;
+  function->is_ssa = false;
+
+  function->bigint_limbs = NULL;
+  function->bigint_limb_count = 0;
+  function->bigint_limb_capacity = 0;
 
   function->calling_convention = CALLING_CONV_SYSV_AMD64;
 
@@ -174,12 +179,11 @@ void fc_ir_function_destroy(FcIRFunction *function) {
     free(block->instructions);
     free(block->successors);
     free(block->predecessors);
-    free((void *)block->name);
   }
 
   free(function->blocks);
   free(function->parameters);
-  free((void *)function->name);
+  free(function->bigint_limbs);
 }
 
 // ============================================================================
@@ -207,7 +211,7 @@ FcIRBasicBlock *fc_ir_block_create(FcIRFunction *function, const char *name) {
   memset(block, 0, sizeof(FcIRBasicBlock));
 
   block->id = function->next_block_id++;
-  block->name = name ? strdup(name) : NULL;
+  block->name = fcx_intern_cstr(name);
   block->instructions = NULL;
   block->instruction_count = 0;
   block->instruction_capacity = 0;
@@ -226,7 +230,7 @@ void fc_ir_block_add_successor(FcIRBasicBlock *block, uint32_t successor_id) {
     return;
 
   // Check if already exists
-  for (uint8_t i = 0; i < block->successor_count; i++) {
+  for (uint32_t i = 0; i < block->successor_count; i++) {
     if (block->successors[i] == successor_id)
       return;
   }
@@ -372,50 +376,84 @@ void fc_ir_compute_frame_layout(FcIRFunction *function) {
 // ============================================================================
 
 FcOperand fc_ir_operand_vreg(VirtualReg vreg) {
-  FcOperand op;
+  FcOperand op = {0};
   op.type = FC_OPERAND_VREG;
   op.u.vreg = vreg;
   return op;
 }
 
 FcOperand fc_ir_operand_imm(int64_t value) {
-  FcOperand op;
+  FcOperand op = {0};
   op.type = FC_OPERAND_IMMEDIATE;
   op.u.immediate = value;
   return op;
 }
 
-FcOperand fc_ir_operand_bigint(const uint64_t* limbs, uint8_t num_limbs) {
-  FcOperand op;
+// The limbs are appended to the function's bigint pool; if that fails the
+// operand refers to no limbs and fc_ir_operand_bigint_limbs returns NULL
+FcOperand fc_ir_operand_bigint(FcIRFunction *function, const uint64_t *limbs,
+                               uint8_t num_limbs) {
+  FcOperand op = {0};
   op.type = FC_OPERAND_BIGINT;
-  op.u.bigint.num_limbs = num_limbs;
-  for (uint8_t i = 0; i < 16; i++) {
-    op.u.bigint.limbs[i] = (i < num_limbs) ? limbs[i] : 0;
+  op.num_limbs = num_limbs;
+  op.u.bigint_index = UINT32_MAX;
+  if (!function || !limbs || num_limbs == 0 || num_limbs > 16)
+    return op;
+
+  if (function->bigint_limb_count + num_limbs > function->bigint_limb_capacity) {
+    uint32_t new_capacity = function->bigint_limb_capacity == 0
+                                ? 16
+                                : function->bigint_limb_capacity * 2;
+    while (new_capacity < function->bigint_limb_count + num_limbs) {
+      new_capacity *= 2;
+    }
+    uint64_t *new_limbs = (uint64_t *)realloc(
+        function->bigint_limbs, new_capacity * sizeof(uint64_t));
+
+    if (!new_limbs)
+      return op;
+
+    function->bigint_limbs = new_limbs;
+    function->bigint_limb_capacity = new_capacity;
   }
+
+  op.u.bigint_index = function->bigint_limb_count;
+  memcpy(&function->bigint_limbs[op.u.bigint_index], limbs,
+         num_limbs * sizeof(uint64_t));
+  function->bigint_limb_count += num_limbs;
   return op;
 }
 
+const uint64_t *fc_ir_operand_bigint_limbs(const FcIRFunction *function,
+                                           const FcOperand *op) {
+  if (!function || !op || op->type != FC_OPERAND_BIGINT)
+    return NULL;
+  if (op->u.bigint_index == UINT32_MAX ||
+      op->u.bigint_index + op->num_limbs > function->bigint_limb_count)
+    return NULL;
+  return &function->bigint_limbs[op->u.bigint_index];
+}
+
 FcOperand fc_ir_operand_mem(VirtualReg base, VirtualReg index, int32_t disp,
                             uint8_t scale) {
-  FcOperand op;
+  FcOperand op = {0};
   op.type = FC_OPERAND_MEMORY;
-  op.u.memory.base = base;
-  op.u.memory.index = index;
-  op.u.memory.displacement = disp;
-  op.u.memory.scale = scale;
-  op.u.memory.is_rip_relative = false;
+  op.scale = scale;
+  op.displacement = disp;
+  op.u.memory.base = base.id;
+  op.u.memory.index = index.id;
   return op;
 }
 
 FcOperand fc_ir_operand_label(uint32_t label_id) {
-  FcOperand op;
+  FcOperand op = {0};
   op.type = FC_OPERAND_LABEL;
   op.u.label_id = label_id;
   return op;
 }
 
 FcOperand fc_ir_operand_stack_slot(int32_t offset, uint8_t size) {
-  FcOperand op;
+  FcOperand op = {0};
   op.type = FC_OPERAND_STACK_SLOT;
   op.u.stack_slot.offset = offset;
   op.u.stack_slot.size = size;
@@ -424,16 +462,27 @@ FcOperand fc_ir_operand_stack_slot(int32_t offset, uint8_t size) {
 }
 
 FcOperand fc_ir_operand_external_func(uint32_t func_id) {
-  FcOperand op;
+  FcOperand op = {0};
   op.type = FC_OPERAND_EXTERNAL_FUNC;
   op.u.external_func_id = func_id;
   return op;
 }
 
+FcOperand fc_ir_operand_function(uint32_t function_id) {
+  FcOperand op = {0};
+  op.type = FC_OPERAND_FUNCTION;
+  op.u.function_id = function_id;
+  return op;
+}
+
 // ============================================================================
 // Helper: Add instruction to basic block
 // ============================================================================
 
+// Bigint limbs live in the function's pool so that operands stay small
+_Static_assert(sizeof(FcOperand) == 16, "FcOperand should stay 16 bytes");
+_Static_assert(sizeof(FcIRInstruction) <= 64, "FcIRInstruction should fit a cache line");
+
 static void add_instruction(FcIRBasicBlock *block, FcIRInstruction instr) {
   if (!block)
     return;
@@ -550,24 +599,12 @@ void fc_ir_build_jcc(FcIRBasicBlock *block, FcIROpcode condition,
   add_instruction(block, instr);
 }
 
-void fc_ir_build_call(FcIRBasicBlock *block, const char *function) {
+// Call to the module's function_id-th function, resolved during lowering
+void fc_ir_build_call(FcIRBasicBlock *block, uint32_t function_id) {
   FcIRInstruction instr = {0};
   instr.opcode = FCIR_CALL;
   instr.operand_count = 1;
-  
-  // Store function name hash as the label ID
-  // This will be resolved during linking using the symbol table
-  // Use a simple hash to identify the function
-  uint32_t hash = 0;
-  if (function) {
-    const char* p = function;
-    while (*p) {
-      hash = hash * 31 + (uint8_t)*p++;
-    }
-  }
-  
-  instr.operands[0].type = FC_OPERAND_LABEL;
-  instr.operands[0].u.label_id = hash;
+  instr.operands[0] = fc_ir_operand_function(function_id);
   add_instruction(block, instr);
 }
 
@@ -597,6 +634,17 @@ void fc_ir_build_syscall(FcIRBasicBlock *block) {
   add_instruction(block, instr);
 }
 
+void fc_ir_build_phi(FcIRBasicBlock *block, VirtualReg dest, VirtualReg value,
+                     uint32_t pred_label) {
+  FcIRInstruction instr = {0};
+  instr.opcode = FCIR_PHI;
+  instr.operand_count = 3;
+  instr.operands[0] = fc_ir_operand_vreg(dest);
+  instr.operands[1] = fc_ir_operand_vreg(value);
+  instr.operands[2] = fc_ir_operand_label(pred_label);
+  add_instruction(block, instr);
+}
+
 // ============================================================================
 // Atomic Operations
 // ============================================================================
@@ -929,6 +977,8 @@ static const char *opcode_to_string(FcIROpcode opcode) {
     return "ret";
   case FCIR_SYSCALL:
     return "syscall";
+  case FCIR_PHI:
+    return "phi";
   case FCIR_LABEL:
     return "label";
   case FCIR_ALIGN:
@@ -944,7 +994,7 @@ static const char *opcode_to_string(FcIROpcode opcode) {
   }
 }
 
-static void print_operand(const FcOperand *op) {
+static void print_operand(const FcIRFunction *function, const FcOperand *op) {
   if (!op)
     return;
 
@@ -957,31 +1007,37 @@ static void print_operand(const FcOperand *op) {
     printf("$%ld", op->u.immediate);
     break;
 
-  case FC_OPERAND_BIGINT:
+  case FC_OPERAND_BIGINT: {
+    const uint64_t *limbs = fc_ir_operand_bigint_limbs(function, op);
+    if (!limbs) {
+      printf("$<bigint #%u>", op->u.bigint_index);
+      break;
+    }
     printf("$0x");
     // Print limbs in big-endian order (most significant first)
-    for (int i = op->u.bigint.num_limbs - 1; i >= 0; i--) {
-      if (i == op->u.bigint.num_limbs - 1) {
-        printf("%lx", (unsigned long)op->u.bigint.limbs[i]);
+    for (int i = op->num_limbs - 1; i >= 0; i--) {
+      if (i == op->num_limbs - 1) {
+        printf("%lx", (unsigned long)limbs[i]);
       } else {
-        printf("%016lx", (unsigned long)op->u.bigint.limbs[i]);
+        printf("%016lx", (unsigned long)limbs[i]);
       }
     }
     break;
+  }
 
   case FC_OPERAND_MEMORY:
     printf("[");
-    if (op->u.memory.base.id != 0) {
-      printf("%%v%u", op->u.memory.base.id);
+    if (op->u.memory.base != 0) {
+      printf("%%v%u", op->u.memory.base);
     }
-    if (op->u.memory.index.id != 0) {
-      printf(" + %%v%u", op->u.memory.index.id);
-      if (op->u.memory.scale > 1) {
-        printf("*%u", op->u.memory.scale);
+    if (op->u.memory.index != 0) {
+      printf(" + %%v%u", op->u.memory.index);
+      if (op->scale > 1) {
+        printf("*%u", op->scale);
       }
     }
-    if (op->u.memory.displacement != 0) {
-      printf(" %+d", op->u.memory.displacement);
+    if (op->displacement != 0) {
+      printf(" %+d", op->displacement);
     }
     printf("]");
     break;
@@ -997,10 +1053,15 @@ static void print_operand(const FcOperand *op) {
   case FC_OPERAND_EXTERNAL_FUNC:
     printf("@func_%u", op->u.external_func_id);
     break;
+
+  case FC_OPERAND_FUNCTION:
+    printf("@fn_%u", op->u.function_id);
+    break;
   }
 }
 
-void fc_ir_print_instruction(const FcIRInstruction *instr) {
+void fc_ir_print_instruction(const FcIRFunction *function,
+                             const FcIRInstruction *instr) {
   if (!instr)
     return;
 
@@ -1014,7 +1075,7 @@ void fc_ir_print_instruction(const FcIRInstruction *instr) {
 
   for (uint8_t i = 0; i < instr->operand_count; i++) {
     printf(" ");
-    print_operand(&instr->operands[i]);
+    print_operand(function, &instr->operands[i]);
     if (i < instr->operand_count - 1) {
       printf(",");
     }
@@ -1023,7 +1084,8 @@ void fc_ir_print_instruction(const FcIRInstruction *instr) {
   printf("\n");
 }
 
-void fc_ir_print_block(const FcIRBasicBlock *block) {
+void fc_ir_print_block(const FcIRFunction *function,
+                       const FcIRBasicBlock *block) {
   if (!block)
     return;
 
@@ -1034,7 +1096,7 @@ void fc_ir_print_block(const FcIRBasicBlock *block) {
   printf(":\n");
 
   for (uint32_t i = 0; i < block->instruction_count; i++) {
-    fc_ir_print_instruction(&block->instructions[i]);
+    fc_ir_print_instruction(function, &block->instructions[i]);
   }
 }
 
@@ -1058,7 +1120,7 @@ void fc_ir_print_function(const FcIRFunction *function) {
   }
 
   for (uint32_t i = 0; i < function->block_count; i++) {
-    fc_ir_print_block(&function->blocks[i]);
+    fc_ir_print_block(function, &function->blocks[i]);
   }
 
   printf("\n");
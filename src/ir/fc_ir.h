@@ -119,6 +119,10 @@ typedef enum {
     FCIR_RET,
     FCIR_SYSCALL,
     
+    // SSA: phi dest, value, label(pred) - dest takes value when control
+    // arrives from block pred; one instruction per incoming edge
+    FCIR_PHI,
+    
     // Labels and directives
     FCIR_LABEL,
     FCIR_ALIGN,
@@ -145,21 +149,14 @@ typedef enum {
     FC_OPERAND_LABEL,          // Label reference
     FC_OPERAND_STACK_SLOT,     // Stack slot [rbp - offset]
     FC_OPERAND_EXTERNAL_FUNC,  // External function name
+    FC_OPERAND_FUNCTION,       // Function defined in this module
 } FcOperandType;
 
-// Bigint operand structure (for values > 64 bits)
-typedef struct {
-    uint64_t limbs[16];        // Up to 1024 bits (16 x 64-bit limbs), little-endian
-    uint8_t num_limbs;         // Number of limbs used (1-16)
-} FcBigintOperand;
-
-// Memory operand structure
+// Memory operand registers, by vreg id (0 if none). The displacement, scale
+// and flags of a memory operand are kept in the FcOperand header.
 typedef struct {
-    VirtualReg base;           // Base register (0 if none)
-    VirtualReg index;          // Index register (0 if none)
-    int32_t displacement;      // Memory displacement
-    uint8_t scale;             // Scale factor (1, 2, 4, 8)
-    bool is_rip_relative;      // RIP-relative addressing
+    uint32_t base;             // Base register
+    uint32_t index;            // Index register
 } FcMemoryOperand;
 
 // Stack slot structure
@@ -169,21 +166,31 @@ typedef struct {
     uint8_t alignment;         // Alignment requirement
 } StackSlot;
 
-// Generic operand structure
+// Generic operand structure, 16 bytes. Bigint limbs live in the function's
+// bigint pool, see fc_ir_operand_bigint_limbs.
 typedef struct {
-    FcOperandType type;
+    uint8_t type;              // FcOperandType
+    uint8_t flags;             // FC_OPERAND_FLAG_*
+    uint8_t scale;             // Memory: index scale factor (1, 2, 4, 8)
+    uint8_t num_limbs;         // Bigint: number of limbs used (1-16)
+    int32_t displacement;      // Memory: displacement
     
     union {
         VirtualReg vreg;
         int64_t immediate;
-        FcBigintOperand bigint;
+        uint32_t bigint_index;      // First limb in function->bigint_limbs
         FcMemoryOperand memory;
         uint32_t label_id;
         StackSlot stack_slot;
         uint32_t external_func_id;  // Index into external function table
+        uint32_t function_id;       // Index into module->functions
     } u;
 } FcOperand;
 
+// Operand flags
+#define FC_OPERAND_FLAG_RIP_RELATIVE (1 << 0)  // Memory: RIP-relative addressing
+#define FC_OPERAND_FLAG_GLOBAL       (1 << 1)  // Memory: base is UINT32_MAX - global index
+
 // ============================================================================
 // FC IR Instruction Structure
 // ============================================================================
@@ -196,9 +203,6 @@ typedef struct {
     
     // Flexible operand array (up to 3 operands for most instructions)
     FcOperand operands[3];
-    
-    // Optional: CPU feature requirements
-    uint64_t required_features;
 } FcIRInstruction;
 
 // Instruction flags
@@ -243,10 +247,10 @@ typedef struct FcIRBasicBlock {
     uint32_t instruction_capacity;
     
     uint32_t* successors;
-    uint8_t successor_count;
+    uint32_t successor_count;
     
     uint32_t* predecessors;
-    uint8_t predecessor_count;
+    uint32_t predecessor_count;
     
     bool is_entry;
     bool is_exit;
@@ -272,6 +276,15 @@ typedef struct {
     uint32_t next_label_id;
     uint32_t next_block_id;
     
+    // Lowered from an FCx IR function in SSA form: vregs other than the ABI
+    // registers are written in one block only and phis lead their blocks
+    bool is_ssa;
+    
+    // Limbs of bigint operands, little-endian, packed
+    uint64_t* bigint_limbs;
+    uint32_t bigint_limb_count;
+    uint32_t bigint_limb_capacity;
+    
     // Calling convention
     enum {
         CALLING_CONV_SYSV_AMD64,
@@ -353,11 +366,13 @@ void fc_ir_compute_frame_layout(FcIRFunction* function);
 // Operand creation helpers
 FcOperand fc_ir_operand_vreg(VirtualReg vreg);
 FcOperand fc_ir_operand_imm(int64_t value);
-FcOperand fc_ir_operand_bigint(const uint64_t* limbs, uint8_t num_limbs);
+FcOperand fc_ir_operand_bigint(FcIRFunction* function, const uint64_t* limbs, uint8_t num_limbs);
 FcOperand fc_ir_operand_mem(VirtualReg base, VirtualReg index, int32_t disp, uint8_t scale);
 FcOperand fc_ir_operand_label(uint32_t label_id);
 FcOperand fc_ir_operand_stack_slot(int32_t offset, uint8_t size);
 FcOperand fc_ir_operand_external_func(uint32_t func_id);
+FcOperand fc_ir_operand_function(uint32_t function_id);
+const uint64_t* fc_ir_operand_bigint_limbs(const FcIRFunction* function, const FcOperand* op);
 
 // Instruction building
 void fc_ir_build_mov(FcIRBasicBlock* block, FcOperand dest, FcOperand src);
@@ -372,10 +387,11 @@ void fc_ir_build_test(FcIRBasicBlock* block, FcOperand left, FcOperand right);
 // Control flow
 void fc_ir_build_jmp(FcIRBasicBlock* block, uint32_t label_id);
 void fc_ir_build_jcc(FcIRBasicBlock* block, FcIROpcode condition, uint32_t label_id);
-void fc_ir_build_call(FcIRBasicBlock* block, const char* function);
+void fc_ir_build_call(FcIRBasicBlock* block, uint32_t function_id);
 void fc_ir_build_call_external(FcIRBasicBlock* block, FcIRModule* module, const char* function);
 void fc_ir_build_ret(FcIRBasicBlock* block);
 void fc_ir_build_syscall(FcIRBasicBlock* block);
+void fc_ir_build_phi(FcIRBasicBlock* block, VirtualReg dest, VirtualReg value, uint32_t pred_label);
 
 // Atomic operations
 void fc_ir_build_lock_prefix(FcIRBasicBlock* block);
@@ -406,8 +422,8 @@ CpuFeatures fc_ir_detect_cpu_features(void);
 bool fc_ir_has_feature(const CpuFeatures* features, uint64_t feature_flag);
 
 // Debugging and printing
-void fc_ir_print_instruction(const FcIRInstruction* instr);
-void fc_ir_print_block(const FcIRBasicBlock* block);
+void fc_ir_print_instruction(const FcIRFunction* function, const FcIRInstruction* instr);
+void fc_ir_print_block(const FcIRFunction* function, const FcIRBasicBlock* block);
 void fc_ir_print_function(const FcIRFunction* function);
 void fc_ir_print_module(const FcIRModule* module);
 
@@ -1,5 +1,6 @@
 #define _POSIX_C_SOURCE 200809L
 #include "fc_ir_lower.h"
+#include "../lexer/intern.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -14,6 +15,7 @@ FcIRLowerContext* fc_ir_lower_create(void) {
     
     ctx->fc_module = NULL;
     ctx->fcx_module = NULL;
+    ctx->fcx_function = NULL;
     ctx->current_function = NULL;
     ctx->current_block = NULL;
     
@@ -23,6 +25,9 @@ FcIRLowerContext* fc_ir_lower_create(void) {
     ctx->label_map = NULL;
     ctx->label_map_capacity = 0;
     
+    ctx->function_map = NULL;
+    ctx->function_map_capacity = 0;
+    
     ctx->error_message = NULL;
     ctx->has_error = false;
     
@@ -34,6 +39,7 @@ void fc_ir_lower_destroy(FcIRLowerContext* ctx) {
     
     free(ctx->vreg_map);
     free(ctx->label_map);
+    free(ctx->function_map);
     
     if (ctx->error_message) {
         free(ctx->error_message);
@@ -60,6 +66,17 @@ const char* fc_ir_lower_get_error(const FcIRLowerContext* ctx) {
 // Virtual Register and Label Mapping
 // ============================================================================
 
+// Scratch register for a lowering sequence; numbered after the FCx IR
+// function's vregs and clear of the physical register ids
+static VirtualReg fc_ir_lower_temp_vreg(FcIRLowerContext* ctx) {
+    uint32_t id = ctx->current_function->next_vreg_id++;
+    if (id >= FCX_IR_RESERVED_VREG_FIRST && id <= FCX_IR_RESERVED_VREG_LAST) {
+        id = FCX_IR_RESERVED_VREG_LAST + 1;
+        ctx->current_function->next_vreg_id = id + 1;
+    }
+    return (VirtualReg){.id = id, .type = VREG_TYPE_I64, .size = 8, .flags = 0};
+}
+
 VirtualReg fc_ir_lower_map_vreg(FcIRLowerContext* ctx, VirtualReg fcx_vreg) {
     if (!ctx) return fcx_vreg;
     
@@ -204,7 +221,7 @@ bool fc_ir_lower_inline_asm(FcIRLowerContext* ctx, const FcxIRInstruction* instr
     // passed through to the LLVM backend which handles inline asm natively
     
     // Store the inline asm data pointer and emit the instruction
-    fc_ir_build_inline_asm_raw(ctx->current_block, (int64_t)(uintptr_t)&instr->u.inline_asm);
+    fc_ir_build_inline_asm_raw(ctx->current_block, (int64_t)(uintptr_t)instr->u.inline_asm);
     
     return true;
 }
@@ -268,19 +285,9 @@ bool fc_ir_lower_ptr_arithmetic(FcIRLowerContext* ctx, const FcxIRInstruction* i
     if (ptr.type == VREG_TYPE_PTR) {
         // Typed pointer - need to scale offset by element size
         // For now, assume 8-byte elements (will be refined with type info)
-        VirtualReg scaled_offset = {
-            .id = ctx->current_function->next_vreg_id++,
-            .type = VREG_TYPE_I64,
-            .size = 8,
-            .flags = 0
-        };
+        VirtualReg scaled_offset = fc_ir_lower_temp_vreg(ctx);
         
-        VirtualReg scale = {
-            .id = ctx->current_function->next_vreg_id++,
-            .type = VREG_TYPE_I64,
-            .size = 8,
-            .flags = 0
-        };
+        VirtualReg scale = fc_ir_lower_temp_vreg(ctx);
         
         // Get element size based on pointer type
         // For typed pointers, the element size is determined by the pointed-to type
@@ -666,6 +673,50 @@ bool fc_ir_lower_jump(FcIRLowerContext* ctx, const FcxIRInstruction* instr) {
     return true;
 }
 
+bool fc_ir_lower_phi(FcIRLowerContext* ctx, const FcxIRInstruction* instr) {
+    if (!ctx || !instr) return false;
+    
+    VirtualReg dest = fc_ir_lower_map_vreg(ctx, instr->u.phi_op.dest);
+    
+    // One FC IR phi per incoming edge, in predecessor order
+    for (uint32_t i = 0; i < instr->u.phi_op.incoming_count; i++) {
+        VirtualReg value = fc_ir_lower_map_vreg(ctx, instr->u.phi_op.incoming[i]);
+        uint32_t pred = fc_ir_lower_map_label(ctx, instr->u.phi_op.blocks[i]);
+        fc_ir_build_phi(ctx->current_block, dest, value, pred);
+    }
+    
+    return true;
+}
+
+// Index of the module function named `name` (interned), or UINT32_MAX
+static uint32_t lower_function_index(const FcIRLowerContext* ctx, const char* name) {
+    InternId id = fcx_intern_id(name);
+    if (id >= ctx->function_map_capacity || ctx->function_map[id] == 0) return UINT32_MAX;
+    return ctx->function_map[id] - 1;
+}
+
+// Maps every function name to its index once, so lowering a call is one
+// array lookup. FC IR functions keep their FCx IR indices
+static bool build_function_map(FcIRLowerContext* ctx, const FcxIRModule* fcx_module) {
+    InternId max_id = 0;
+    for (uint32_t i = 0; i < fcx_module->function_count; i++) {
+        InternId id = fcx_intern_id(fcx_module->functions[i].name);
+        if (id > max_id) max_id = id;
+    }
+    free(ctx->function_map);
+    ctx->function_map_capacity = (size_t)max_id + 1;
+    ctx->function_map = (uint32_t*)calloc(ctx->function_map_capacity, sizeof(uint32_t));
+    if (!ctx->function_map) {
+        ctx->function_map_capacity = 0;
+        return false;
+    }
+    // The first definition of a name wins, as the old linear search did
+    for (uint32_t i = fcx_module->function_count; i-- > 0;) {
+        ctx->function_map[fcx_intern_id(fcx_module->functions[i].name)] = i + 1;
+    }
+    return true;
+}
+
 bool fc_ir_lower_call(FcIRLowerContext* ctx, const FcxIRInstruction* instr) {
     if (!ctx || !instr) return false;
     
@@ -675,27 +726,17 @@ bool fc_ir_lower_call(FcIRLowerContext* ctx, const FcxIRInstruction* instr) {
     
     uint32_t arg_reg_ids[] = {1001, 1002, 1003, 1007, 1005, 1006};
     
-    // Check if this is a bigint print function that needs special handling
     const char* func_name = instr->u.call_op.function;
-    bool is_bigint_print = func_name && (
-        strcmp(func_name, "_fcx_println_i128") == 0 ||
-        strcmp(func_name, "_fcx_println_u128") == 0 ||
-        strcmp(func_name, "_fcx_println_i256") == 0 ||
-        strcmp(func_name, "_fcx_println_u256") == 0 ||
-        strcmp(func_name, "_fcx_println_i512") == 0 ||
-        strcmp(func_name, "_fcx_println_u512") == 0 ||
-        strcmp(func_name, "_fcx_println_i1024") == 0 ||
-        strcmp(func_name, "_fcx_println_u1024") == 0
-    );
     
-    // Move arguments to calling convention registers
+    // Move arguments to calling convention registers. Arguments wider than
+    // a register (i128 and up) keep their type, so bigint print functions
+    // and typed module functions receive the whole value
     for (uint8_t i = 0; i < instr->u.call_op.arg_count && i < 6; i++) {
         VirtualReg arg = fc_ir_lower_map_vreg(ctx, instr->u.call_op.args[i]);
         
-        // For bigint print functions, preserve the original type for the first argument
         VRegType arg_type = VREG_TYPE_I64;
         uint8_t arg_size = 8;
-        if (is_bigint_print && i == 0) {
+        if (arg.size > 8) {
             arg_type = arg.type;
             arg_size = arg.size;
         }
@@ -716,38 +757,32 @@ bool fc_ir_lower_call(FcIRLowerContext* ctx, const FcxIRInstruction* instr) {
     // 1. Runtime functions start with _fcx_
     // 2. Explicitly marked external functions start with _external_
     // 3. Functions not defined in the current module (C library functions like sqrt, printf, etc.)
-    bool is_external = false;
-    if (func_name) {
-        if (strncmp(func_name, "_fcx_", 5) == 0 || strncmp(func_name, "_external_", 10) == 0) {
-            is_external = true;
-        } else {
-            // Check if function is defined in current module
-            bool found_in_module = false;
-            for (uint32_t i = 0; i < ctx->fcx_module->function_count; i++) {
-                if (strcmp(ctx->fcx_module->functions[i].name, func_name) == 0) {
-                    found_in_module = true;
-                    break;
-                }
-            }
-            // If not found in module, it's external (C library function)
-            if (!found_in_module) {
-                is_external = true;
-                fprintf(stderr, "DEBUG: Function '%s' not found in module, treating as external\n", func_name);
-            }
-        }
+    uint32_t callee = UINT32_MAX;
+    if (func_name && strncmp(func_name, "_fcx_", 5) != 0 && strncmp(func_name, "_external_", 10) != 0) {
+        // If not found in module, it's external (C library function)
+        callee = lower_function_index(ctx, func_name);
     }
     
-    if (is_external) {
+    if (callee == UINT32_MAX) {
         // Use external function call
         fc_ir_build_call_external(ctx->current_block, ctx->fc_module, func_name);
     } else {
         // Use regular function call
-        fc_ir_build_call(ctx->current_block, func_name);
+        fc_ir_build_call(ctx->current_block, callee);
     }
     
-    // Move result from rax to destination
+    // Move result from rax to destination; as with arguments, a result
+    // wider than a register keeps its type
     VirtualReg dest = fc_ir_lower_map_vreg(ctx, instr->u.call_op.dest);
     VirtualReg rax_vreg = {.id = 1000, .type = VREG_TYPE_I64, .size = 8, .flags = 0};
+    if (callee != UINT32_MAX) {
+        VRegType return_type = ctx->fcx_module->functions[callee].return_type;
+        uint8_t return_size = fcx_ir_vreg_type_size(return_type);
+        if (return_size > 8) {
+            rax_vreg.type = return_type;
+            rax_vreg.size = return_size;
+        }
+    }
     
     fc_ir_build_mov(ctx->current_block,
                    fc_ir_operand_vreg(dest),
@@ -785,12 +820,7 @@ bool fc_ir_lower_mmio(FcIRLowerContext* ctx, const FcxIRInstruction* instr) {
         VirtualReg dest = fc_ir_lower_map_vreg(ctx, instr->u.mmio_op.dest);
         
         // Create memory operand with absolute address
-        VirtualReg addr_reg = {
-            .id = ctx->current_function->next_vreg_id++,
-            .type = VREG_TYPE_I64,
-            .size = 8,
-            .flags = 0
-        };
+        VirtualReg addr_reg = fc_ir_lower_temp_vreg(ctx);
         
         // Load absolute address
         fc_ir_build_mov(ctx->current_block,
@@ -807,12 +837,7 @@ bool fc_ir_lower_mmio(FcIRLowerContext* ctx, const FcxIRInstruction* instr) {
         VirtualReg value = fc_ir_lower_map_vreg(ctx, instr->u.mmio_op.value);
         
         // Create memory operand with absolute address
-        VirtualReg addr_reg = {
-            .id = ctx->current_function->next_vreg_id++,
-            .type = VREG_TYPE_I64,
-            .size = 8,
-            .flags = 0
-        };
+        VirtualReg addr_reg = fc_ir_lower_temp_vreg(ctx);
         
         // Load absolute address
         fc_ir_build_mov(ctx->current_block,
@@ -848,11 +873,16 @@ bool fc_ir_lower_instruction(FcIRLowerContext* ctx, const FcxIRInstruction* fcx_
         
         case FCXIR_CONST_BIGINT: {
             // Bigint constants - use bigint operand type
+            const uint64_t* limbs = fcx_ir_bigint_limbs(ctx->fcx_function, fcx_instr);
+            if (!limbs) {
+                fc_ir_lower_set_error(ctx, "Bigint constant outside the function's pool");
+                return false;
+            }
             VirtualReg dest = fc_ir_lower_map_vreg(ctx, fcx_instr->u.const_bigint_op.dest);
             fc_ir_build_mov(ctx->current_block,
                            fc_ir_operand_vreg(dest),
-                           fc_ir_operand_bigint(fcx_instr->u.const_bigint_op.limbs,
-                                               fcx_instr->u.const_bigint_op.num_limbs));
+                           fc_ir_operand_bigint(ctx->current_function, limbs,
+                                                fcx_instr->u.const_bigint_op.num_limbs));
             return true;
         }
         
@@ -915,8 +945,8 @@ bool fc_ir_lower_instruction(FcIRLowerContext* ctx, const FcxIRInstruction* fcx_
             // Use a special memory operand with negative base to signal global store
             VirtualReg special_base = {0};
             special_base.id = UINT32_MAX - global_index;
-            special_base.flags = 0x8000;  // Global variable flag
             FcOperand mem_op = fc_ir_operand_mem(special_base, (VirtualReg){0}, 0, 1);
+            mem_op.flags |= FC_OPERAND_FLAG_GLOBAL;  // Global variable flag
             fc_ir_build_mov(ctx->current_block,
                            mem_op,
                            fc_ir_operand_vreg(src));
@@ -1078,6 +1108,9 @@ bool fc_ir_lower_instruction(FcIRLowerContext* ctx, const FcxIRInstruction* fcx_
         case FCXIR_RETURN:
             return fc_ir_lower_return(ctx, fcx_instr);
         
+        case FCXIR_PHI:
+            return fc_ir_lower_phi(ctx, fcx_instr);
+        
         default:
             fc_ir_lower_set_error(ctx, "Unsupported FCx IR instruction");
             return false;
@@ -1114,6 +1147,8 @@ bool fc_ir_lower_block(FcIRLowerContext* ctx, const FcxIRBasicBlock* fcx_block)
 bool fc_ir_lower_function(FcIRLowerContext* ctx, const FcxIRFunction* fcx_function) {
     if (!ctx || !fcx_function) return false;
     
+    ctx->fcx_function = fcx_function;
+    
     // Create corresponding FC IR function
     ctx->current_function = fc_ir_function_create(fcx_function->name, fcx_function->return_type);
     if (!ctx->current_function) {
@@ -1121,6 +1156,14 @@ bool fc_ir_lower_function(FcIRLowerContext* ctx, const FcxIRFunction* fcx_functi
         return false;
     }
     
+    // Lowering temporaries are numbered after the function's own vregs, and
+    // vreg types are looked up afresh for each function
+    ctx->current_function->next_vreg_id = fcx_function->next_vreg_id;
+    ctx->current_function->is_ssa = fcx_function->is_ssa;
+    if (ctx->vreg_map) {
+        memset(ctx->vreg_map, 0, ctx->vreg_map_capacity * sizeof(VirtualReg));
+    }
+    
     // Copy parameter information
     if (fcx_function->parameter_count > 0 && fcx_function->parameters) {
         ctx->current_function->parameter_count = fcx_function->parameter_count;
@@ -1178,7 +1221,7 @@ bool fc_ir_lower_module(FcIRLowerContext* ctx, const FcxIRModule* fcx_module) {
             ctx->fc_module->global_var_count = fcx_module->global_count;
             ctx->fc_module->global_var_capacity = fcx_module->global_count;
             for (uint32_t i = 0; i < fcx_module->global_count; i++) {
-                ctx->fc_module->global_vars[i].name = strdup(fcx_module->globals[i].name);
+                ctx->fc_module->global_vars[i].name = fcx_module->globals[i].name;
                 ctx->fc_module->global_vars[i].type = fcx_module->globals[i].type;
                 ctx->fc_module->global_vars[i].init_value = fcx_module->globals[i].init_value;
                 ctx->fc_module->global_vars[i].is_const = fcx_module->globals[i].is_const;
@@ -1201,6 +1244,11 @@ bool fc_ir_lower_module(FcIRLowerContext* ctx, const FcxIRModule* fcx_module) {
         }
     }
     
+    if (!build_function_map(ctx, fcx_module)) {
+        fc_ir_lower_set_error(ctx, "Failed to allocate function map");
+        return false;
+    }
+    
     // Lower all functions
     for (uint32_t i = 0; i < fcx_module->function_count; i++) {
         if (!fc_ir_lower_function(ctx, &fcx_module->functions[i])) {
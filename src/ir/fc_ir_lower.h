@@ -14,6 +14,7 @@
 typedef struct {
     FcIRModule* fc_module;
     const FcxIRModule* fcx_module;  // Reference to source FCx module
+    const FcxIRFunction* fcx_function;  // Function being lowered
     FcIRFunction* current_function;
     FcIRBasicBlock* current_block;
     
@@ -25,6 +26,11 @@ typedef struct {
     uint32_t* label_map;
     size_t label_map_capacity;
     
+    // Call targets: InternId of a function name -> its index in the module
+    // plus one, or 0 if the module does not define it
+    uint32_t* function_map;
+    size_t function_map_capacity;
+    
     // Error tracking
     char* error_message;
     bool has_error;
@@ -81,6 +87,9 @@ bool fc_ir_lower_jump(FcIRLowerContext* ctx, const FcxIRInstruction* instr);
 bool fc_ir_lower_call(FcIRLowerContext* ctx, const FcxIRInstruction* instr);
 bool fc_ir_lower_return(FcIRLowerContext* ctx, const FcxIRInstruction* instr);
 
+// SSA: FCxIR::Phi -> one FCIR::Phi per incoming edge
+bool fc_ir_lower_phi(FcIRLowerContext* ctx, const FcxIRInstruction* instr);
+
 // MMIO operations
 bool fc_ir_lower_mmio(FcIRLowerContext* ctx, const FcxIRInstruction* instr);
 
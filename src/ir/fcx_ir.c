@@ -1,5 +1,6 @@
 #define _POSIX_C_SOURCE 200809L
 #include "fcx_ir.h"
+#include "../lexer/intern.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -12,7 +13,7 @@ FcxIRModule* fcx_ir_module_create(const char* name) {
     FcxIRModule* module = (FcxIRModule*)malloc(sizeof(FcxIRModule));
     if (!module) return NULL;
     
-    module->name = strdup(name);
+    module->name = fcx_intern_cstr(name);
     module->functions = NULL;
     module->function_count = 0;
     module->function_capacity = 0;
@@ -38,10 +39,7 @@ void fcx_ir_module_destroy(FcxIRModule* module) {
         fcx_ir_function_destroy(&module->functions[i]);
     }
     
-    // Free global variables
-    for (uint32_t i = 0; i < module->global_count; i++) {
-        free((void*)module->globals[i].name);
-    }
+    // Global, function and block names are interned
     free(module->globals);
     
     // Free string literals
@@ -51,7 +49,6 @@ void fcx_ir_module_destroy(FcxIRModule* module) {
     free(module->string_literals);
     
     free(module->functions);
-    free((void*)module->name);
     free(module);
 }
 
@@ -104,7 +101,13 @@ FcxIRFunction* fcx_ir_function_create(const char* name, VRegType return_type) {
     FcxIRFunction* function = (FcxIRFunction*)malloc(sizeof(FcxIRFunction));
     if (!function) return NULL;
     
-    function->name = strdup(name);
+    function->arena = ir_arena_create();
+    if (!function->arena) {
+        free(function);
+        return NULL;
+    }
+    
+    function->name = fcx_intern_cstr(name);
     function->parameters = NULL;
     function->parameter_count = 0;
     function->return_type = return_type;
@@ -117,39 +120,50 @@ FcxIRFunction* fcx_ir_function_create(const char* name, VRegType return_type) {
     function->next_label_id = 1;
     function->next_block_id = 1;
     
+    function->bigint_limbs = NULL;
+    function->bigint_limb_count = 0;
+    function->bigint_limb_capacity = 0;
+    
+    function->is_ssa = false;
+    function->cfg = NULL;
+    function->cfg_arena = NULL;
+    
+    function->uses = (FcxIRUseTable*)ir_arena_alloc(function->arena, sizeof(FcxIRUseTable));
+    if (!function->uses) {
+        ir_arena_destroy(function->arena);
+        free(function);
+        return NULL;
+    }
+    function->uses->arena = function->arena;
+    function->uses->counts = NULL;
+    function->uses->capacity = 0;
+    
     return function;
 }
 
+// Everything the function points to was allocated from its arena
 void fcx_ir_function_destroy(FcxIRFunction* function) {
     if (!function) return;
     
-    for (uint32_t i = 0; i < function->block_count; i++) {
-        FcxIRBasicBlock* block = &function->blocks[i];
-        
-        // Free instructions and their dynamic data
-        for (uint32_t j = 0; j < block->instruction_count; j++) {
-            FcxIRInstruction* instr = &block->instructions[j];
-            
-            // Free dynamic arrays in instructions
-            if (instr->opcode == FCXIR_SYSCALL && instr->u.syscall_op.args) {
-                free(instr->u.syscall_op.args);
-            } else if (instr->opcode == FCXIR_CALL && instr->u.call_op.args) {
-                free(instr->u.call_op.args);
-            } else if (instr->opcode == FCXIR_PHI) {
-                free(instr->u.phi_op.incoming);
-                free(instr->u.phi_op.blocks);
-            }
-        }
-        
-        free(block->instructions);
-        free(block->successors);
-        free(block->predecessors);
-        free((void*)block->name);
-    }
+    fcx_ir_invalidate_cfg(function);
+    ir_arena_destroy(function->cfg_arena);
+    function->cfg_arena = NULL;
+    ir_arena_destroy(function->arena);
+    function->arena = NULL;
+    function->blocks = NULL;
+    function->block_count = 0;
+    function->parameters = NULL;
+    function->bigint_limbs = NULL;
+    function->uses = NULL;
+}
+
+// Drops the cached control flow analysis (ir_cfg.h); its arena is kept for
+// the next one, since passes that change the CFG ask for it again right away
+void fcx_ir_invalidate_cfg(FcxIRFunction* function) {
+    if (!function) return;
     
-    free(function->blocks);
-    free(function->parameters);
-    free((void*)function->name);
+    if (function->cfg_arena) ir_arena_reset(function->cfg_arena);
+    function->cfg = NULL;
 }
 
 // ============================================================================
@@ -158,11 +172,18 @@ void fcx_ir_function_destroy(FcxIRFunction* function) {
 
 FcxIRBasicBlock* fcx_ir_block_create(FcxIRFunction* function, const char* name) {
     if (!function) return NULL;
+    return fcx_ir_block_insert(function, function->block_count, name);
+}
+
+FcxIRBasicBlock* fcx_ir_block_insert(FcxIRFunction* function, uint32_t index, const char* name) {
+    if (!function || index > function->block_count) return NULL;
     
     if (function->block_count >= function->block_capacity) {
         uint32_t new_capacity = function->block_capacity == 0 ? 8 : function->block_capacity * 2;
-        FcxIRBasicBlock* new_blocks = (FcxIRBasicBlock*)realloc(
-            function->blocks, new_capacity * sizeof(FcxIRBasicBlock));
+        FcxIRBasicBlock* new_blocks = (FcxIRBasicBlock*)ir_arena_grow(
+            function->arena, function->blocks,
+            function->block_capacity * sizeof(FcxIRBasicBlock),
+            new_capacity * sizeof(FcxIRBasicBlock));
         
         if (!new_blocks) return NULL;
         
@@ -170,19 +191,30 @@ FcxIRBasicBlock* fcx_ir_block_create(FcxIRFunction* function, const char* name)
         function->block_capacity = new_capacity;
     }
     
-    FcxIRBasicBlock* block = &function->blocks[function->block_count++];
+    fcx_ir_invalidate_cfg(function);
+    if (index < function->block_count) {
+        memmove(&function->blocks[index + 1], &function->blocks[index],
+                (function->block_count - index) * sizeof(FcxIRBasicBlock));
+    }
+    function->block_count++;
+    
+    FcxIRBasicBlock* block = &function->blocks[index];
     memset(block, 0, sizeof(FcxIRBasicBlock));
     
     block->id = function->next_block_id++;
-    block->name = name ? strdup(name) : NULL;
+    block->name = fcx_intern_cstr(name);
+    block->arena = function->arena;
+    block->uses = function->uses;
     block->instructions = NULL;
     block->instruction_count = 0;
     block->instruction_capacity = 0;
     block->successors = NULL;
     block->successor_count = 0;
+    block->successor_capacity = 0;
     block->predecessors = NULL;
     block->predecessor_count = 0;
-    block->is_entry = (function->block_count == 1);
+    block->predecessor_capacity = 0;
+    block->is_entry = (index == 0);
     block->is_exit = false;
     
     return block;
@@ -200,112 +232,434 @@ FcxIRBasicBlock* fcx_ir_block_get_by_id(FcxIRFunction* function, uint32_t id) {
     return NULL;
 }
 
-void fcx_ir_block_add_successor(FcxIRBasicBlock* block, uint32_t successor_id) {
-    if (!block) return;
-    
-    // Check if already exists
-    for (uint8_t i = 0; i < block->successor_count; i++) {
-        if (block->successors[i] == successor_id) return;
+// Append id to an edge list unless it is already there
+static void add_edge(IRArena* arena, uint32_t** edges, uint32_t* count, uint32_t* capacity, uint32_t id) {
+    for (uint32_t i = 0; i < *count; i++) {
+        if ((*edges)[i] == id) return;
     }
     
-    uint32_t* new_successors = (uint32_t*)realloc(
-        block->successors, (block->successor_count + 1) * sizeof(uint32_t));
-    
-    if (!new_successors) return;
+    if (*count >= *capacity) {
+        uint32_t new_capacity = *capacity == 0 ? 2 : *capacity * 2;
+        uint32_t* new_edges = (uint32_t*)ir_arena_grow(
+            arena, *edges, *capacity * sizeof(uint32_t), new_capacity * sizeof(uint32_t));
+        
+        if (!new_edges) return;
+        
+        *edges = new_edges;
+        *capacity = new_capacity;
+    }
     
-    block->successors = new_successors;
-    block->successors[block->successor_count++] = successor_id;
+    (*edges)[(*count)++] = id;
+}
+
+void fcx_ir_block_add_successor(FcxIRBasicBlock* block, uint32_t successor_id) {
+    if (!block) return;
+    add_edge(block->arena, &block->successors, &block->successor_count,
+             &block->successor_capacity, successor_id);
 }
 
 void fcx_ir_block_add_predecessor(FcxIRBasicBlock* block, uint32_t predecessor_id) {
     if (!block) return;
-    
-    // Check if already exists
-    for (uint8_t i = 0; i < block->predecessor_count; i++) {
-        if (block->predecessors[i] == predecessor_id) return;
-    }
-    
-    uint32_t* new_predecessors = (uint32_t*)realloc(
-        block->predecessors, (block->predecessor_count + 1) * sizeof(uint32_t));
-    
-    if (!new_predecessors) return;
-    
-    block->predecessors = new_predecessors;
-    block->predecessors[block->predecessor_count++] = predecessor_id;
+    add_edge(block->arena, &block->predecessors, &block->predecessor_count,
+             &block->predecessor_capacity, predecessor_id);
 }
 
 // ============================================================================
 // Virtual Register Allocation
 // ============================================================================
 
-VirtualReg fcx_ir_alloc_vreg(FcxIRFunction* function, VRegType type) {
-    VirtualReg vreg;
-    vreg.id = function->next_vreg_id++;
-    vreg.type = type;
-    vreg.flags = 0;
-    
-    // Set size based on type
+uint8_t fcx_ir_vreg_type_size(VRegType type) {
     switch (type) {
         case VREG_TYPE_I8:
         case VREG_TYPE_U8:
         case VREG_TYPE_BOOL:
-            vreg.size = 1;
-            break;
+            return 1;
         case VREG_TYPE_I16:
         case VREG_TYPE_U16:
-            vreg.size = 2;
-            break;
+            return 2;
         case VREG_TYPE_I32:
         case VREG_TYPE_U32:
         case VREG_TYPE_F32:
-            vreg.size = 4;
-            break;
+            return 4;
         case VREG_TYPE_I64:
         case VREG_TYPE_U64:
         case VREG_TYPE_F64:
         case VREG_TYPE_PTR:
         case VREG_TYPE_RAWPTR:
         case VREG_TYPE_BYTEPTR:
-            vreg.size = 8;
-            break;
+            return 8;
         case VREG_TYPE_I128:
         case VREG_TYPE_U128:
-            vreg.size = 16;
-            break;
+            return 16;
         case VREG_TYPE_I256:
         case VREG_TYPE_U256:
-            vreg.size = 32;
-            break;
+            return 32;
         case VREG_TYPE_I512:
         case VREG_TYPE_U512:
-            vreg.size = 64;
-            break;
+            return 64;
         case VREG_TYPE_I1024:
         case VREG_TYPE_U1024:
-            vreg.size = 128;
-            break;
+            return 128;
         case VREG_TYPE_VOID:
-            vreg.size = 0;
-            break;
+            return 0;
         default:
-            vreg.size = 8;
-            break;
+            return 8;
+    }
+}
+
+VirtualReg fcx_ir_alloc_vreg(FcxIRFunction* function, VRegType type) {
+    if (function->next_vreg_id >= FCX_IR_RESERVED_VREG_FIRST &&
+        function->next_vreg_id <= FCX_IR_RESERVED_VREG_LAST) {
+        function->next_vreg_id = FCX_IR_RESERVED_VREG_LAST + 1;
     }
     
+    VirtualReg vreg;
+    vreg.id = function->next_vreg_id++;
+    vreg.type = type;
+    vreg.flags = 0;
+    vreg.size = fcx_ir_vreg_type_size(type);
     return vreg;
 }
 
+// ============================================================================
+// Operand Access
+// ============================================================================
+
+VirtualReg* fcx_ir_instruction_def(FcxIRInstruction* instr, uint32_t n) {
+    if (!instr) return NULL;
+    
+    switch (instr->opcode) {
+        case FCXIR_CONST:
+            return n == 0 ? &instr->u.const_op.dest : NULL;
+        case FCXIR_CONST_BIGINT:
+            return n == 0 ? &instr->u.const_bigint_op.dest : NULL;
+        case FCXIR_LOAD:
+        case FCXIR_LOAD_VOLATILE:
+        case FCXIR_MOV:
+            return n == 0 ? &instr->u.load_store.dest : NULL;
+        case FCXIR_LOAD_GLOBAL:
+            return n == 0 ? &instr->u.global_op.vreg : NULL;
+        case FCXIR_NEG:
+        case FCXIR_NOT:
+        case FCXIR_ATOMIC_LOAD:
+            return n == 0 ? &instr->u.unary_op.dest : NULL;
+        case FCXIR_BITFIELD_EXTRACT:
+        case FCXIR_BITFIELD_INSERT:
+            return n == 0 ? &instr->u.bitfield_op.dest : NULL;
+        case FCXIR_ALLOC:
+        case FCXIR_STACK_ALLOC:
+        case FCXIR_ARENA_ALLOC:
+        case FCXIR_SLAB_ALLOC:
+        case FCXIR_POOL_ALLOC:
+            return n == 0 ? &instr->u.alloc_op.dest : NULL;
+        case FCXIR_ATOMIC_CAS:
+            return n == 0 ? &instr->u.atomic_cas.dest : NULL;
+        case FCXIR_SYSCALL:
+            return n == 0 ? &instr->u.syscall_op.dest : NULL;
+        case FCXIR_MMIO_READ:
+            return n == 0 ? &instr->u.mmio_op.dest : NULL;
+        case FCXIR_PTR_CAST:
+        case FCXIR_PTR_TO_INT:
+        case FCXIR_INT_TO_PTR:
+            return n == 0 ? &instr->u.ptr_op.dest : NULL;
+        case FCXIR_FIELD_ACCESS:
+        case FCXIR_FIELD_OFFSET:
+            return n == 0 ? &instr->u.field_op.dest : NULL;
+        case FCXIR_CALL:
+            return n == 0 ? &instr->u.call_op.dest : NULL;
+        case FCXIR_PHI:
+            return n == 0 ? &instr->u.phi_op.dest : NULL;
+        case FCXIR_INLINE_ASM:
+            return instr->u.inline_asm && n < instr->u.inline_asm->output_count
+                ? &instr->u.inline_asm->outputs[n] : NULL;
+        
+        case FCXIR_ADD:
+        case FCXIR_SUB:
+        case FCXIR_MUL:
+        case FCXIR_DIV:
+        case FCXIR_MOD:
+        case FCXIR_AND:
+        case FCXIR_OR:
+        case FCXIR_XOR:
+        case FCXIR_LSHIFT:
+        case FCXIR_RSHIFT:
+        case FCXIR_LOGICAL_RSHIFT:
+        case FCXIR_ROTATE_LEFT:
+        case FCXIR_ROTATE_RIGHT:
+        case FCXIR_CMP_EQ:
+        case FCXIR_CMP_NE:
+        case FCXIR_CMP_LT:
+        case FCXIR_CMP_LE:
+        case FCXIR_CMP_GT:
+        case FCXIR_CMP_GE:
+        case FCXIR_ALIGN_UP:
+        case FCXIR_ALIGN_DOWN:
+        case FCXIR_IS_ALIGNED:
+        case FCXIR_ATOMIC_SWAP:
+        case FCXIR_ATOMIC_ADD:
+        case FCXIR_ATOMIC_SUB:
+        case FCXIR_ATOMIC_AND:
+        case FCXIR_ATOMIC_OR:
+        case FCXIR_ATOMIC_XOR:
+        case FCXIR_PTR_ADD:
+        case FCXIR_PTR_SUB:
+        case FCXIR_PTR_DIFF:
+        case FCXIR_SIMD_ADD:
+        case FCXIR_SIMD_SUB:
+        case FCXIR_SIMD_MUL:
+        case FCXIR_SIMD_DIV:
+            return n == 0 ? &instr->u.binary_op.dest : NULL;
+        
+        default:
+            // Stores, frees, prefetches, fences and control flow write nothing
+            return NULL;
+    }
+}
+
+VirtualReg* fcx_ir_instruction_use(FcxIRInstruction* instr, uint32_t n) {
+    if (!instr) return NULL;
+    
+    switch (instr->opcode) {
+        case FCXIR_LOAD:
+        case FCXIR_LOAD_VOLATILE:
+        case FCXIR_MOV:
+            return n == 0 ? &instr->u.load_store.src : NULL;
+        case FCXIR_STORE:
+        case FCXIR_STORE_VOLATILE:
+        case FCXIR_ATOMIC_STORE:
+            // The address is in dest
+            if (n == 0) return &instr->u.load_store.dest;
+            return n == 1 ? &instr->u.load_store.src : NULL;
+        case FCXIR_STORE_GLOBAL:
+            return n == 0 ? &instr->u.global_op.vreg : NULL;
+        case FCXIR_NEG:
+        case FCXIR_NOT:
+        case FCXIR_ATOMIC_LOAD:
+        case FCXIR_DEALLOC:
+        case FCXIR_STACK_DEALLOC:
+        case FCXIR_PREFETCH:
+        case FCXIR_PREFETCH_WRITE:
+            return n == 0 ? &instr->u.unary_op.src : NULL;
+        case FCXIR_BITFIELD_EXTRACT:
+        case FCXIR_BITFIELD_INSERT:
+            if (n == 0) return &instr->u.bitfield_op.src;
+            if (n == 1) return &instr->u.bitfield_op.start;
+            return n == 2 ? &instr->u.bitfield_op.len : NULL;
+        case FCXIR_ALLOC:
+        case FCXIR_ARENA_ALLOC:
+            if (n == 0) return &instr->u.alloc_op.size;
+            return n == 1 ? &instr->u.alloc_op.align : NULL;
+        case FCXIR_STACK_ALLOC:
+        case FCXIR_SLAB_ALLOC:
+            return n == 0 ? &instr->u.alloc_op.size : NULL;
+        case FCXIR_SLAB_FREE:
+            return n == 0 ? &instr->u.slab_op.ptr : NULL;
+        case FCXIR_ATOMIC_CAS:
+            if (n == 0) return &instr->u.atomic_cas.ptr;
+            if (n == 1) return &instr->u.atomic_cas.expected;
+            return n == 2 ? &instr->u.atomic_cas.new_val : NULL;
+        case FCXIR_SYSCALL:
+            if (n == 0) return &instr->u.syscall_op.syscall_num;
+            return n - 1 < instr->u.syscall_op.arg_count ? &instr->u.syscall_op.args[n - 1] : NULL;
+        case FCXIR_MMIO_WRITE:
+            return n == 0 ? &instr->u.mmio_op.value : NULL;
+        case FCXIR_PTR_CAST:
+        case FCXIR_PTR_TO_INT:
+        case FCXIR_INT_TO_PTR:
+            return n == 0 ? &instr->u.ptr_op.ptr : NULL;
+        case FCXIR_FIELD_ACCESS:
+        case FCXIR_FIELD_OFFSET:
+            return n == 0 ? &instr->u.field_op.base : NULL;
+        case FCXIR_BRANCH:
+            return n == 0 ? &instr->u.branch_op.cond : NULL;
+        case FCXIR_CALL:
+            return n < instr->u.call_op.arg_count ? &instr->u.call_op.args[n] : NULL;
+        case FCXIR_RETURN:
+            return n == 0 && instr->u.return_op.has_value ? &instr->u.return_op.value : NULL;
+        case FCXIR_PHI:
+            return n < instr->u.phi_op.incoming_count ? &instr->u.phi_op.incoming[n] : NULL;
+        case FCXIR_INLINE_ASM:
+            return instr->u.inline_asm && n < instr->u.inline_asm->input_count
+                ? &instr->u.inline_asm->inputs[n] : NULL;
+        
+        case FCXIR_ADD:
+        case FCXIR_SUB:
+        case FCXIR_MUL:
+        case FCXIR_DIV:
+        case FCXIR_MOD:
+        case FCXIR_AND:
+        case FCXIR_OR:
+        case FCXIR_XOR:
+        case FCXIR_LSHIFT:
+        case FCXIR_RSHIFT:
+        case FCXIR_LOGICAL_RSHIFT:
+        case FCXIR_ROTATE_LEFT:
+        case FCXIR_ROTATE_RIGHT:
+        case FCXIR_CMP_EQ:
+        case FCXIR_CMP_NE:
+        case FCXIR_CMP_LT:
+        case FCXIR_CMP_LE:
+        case FCXIR_CMP_GT:
+        case FCXIR_CMP_GE:
+        case FCXIR_ALIGN_UP:
+        case FCXIR_ALIGN_DOWN:
+        case FCXIR_IS_ALIGNED:
+        case FCXIR_ATOMIC_SWAP:
+        case FCXIR_ATOMIC_ADD:
+        case FCXIR_ATOMIC_SUB:
+        case FCXIR_ATOMIC_AND:
+        case FCXIR_ATOMIC_OR:
+        case FCXIR_ATOMIC_XOR:
+        case FCXIR_PTR_ADD:
+        case FCXIR_PTR_SUB:
+        case FCXIR_PTR_DIFF:
+        case FCXIR_SIMD_ADD:
+        case FCXIR_SIMD_SUB:
+        case FCXIR_SIMD_MUL:
+        case FCXIR_SIMD_DIV:
+            if (n == 0) return &instr->u.binary_op.left;
+            return n == 1 ? &instr->u.binary_op.right : NULL;
+        
+        default:
+            // Constants, global loads, pool allocation, MMIO reads, fences,
+            // arena resets and jumps read no registers
+            return NULL;
+    }
+}
+
+bool fcx_ir_is_terminator(const FcxIRInstruction* instr) {
+    return instr && (instr->opcode == FCXIR_BRANCH ||
+                     instr->opcode == FCXIR_JUMP ||
+                     instr->opcode == FCXIR_RETURN);
+}
+
+// ============================================================================
+// Use Counts
+// ============================================================================
+
+static bool uses_reserve(FcxIRUseTable* uses, uint32_t id) {
+    if (id < uses->capacity) return true;
+    
+    uint32_t new_capacity = uses->capacity == 0 ? 64 : uses->capacity * 2;
+    if (new_capacity <= id) new_capacity = id + 1;
+    uint32_t* new_counts = (uint32_t*)ir_arena_grow(
+        uses->arena, uses->counts, uses->capacity * sizeof(uint32_t), new_capacity * sizeof(uint32_t));
+    
+    if (!new_counts) return false;
+    
+    memset(&new_counts[uses->capacity], 0, (new_capacity - uses->capacity) * sizeof(uint32_t));
+    uses->counts = new_counts;
+    uses->capacity = new_capacity;
+    return true;
+}
+
+void fcx_ir_uses_add(FcxIRUseTable* uses, FcxIRInstruction* instr) {
+    if (!uses) return;
+    
+    VirtualReg* reg;
+    for (uint32_t k = 0; (reg = fcx_ir_instruction_use(instr, k)) != NULL; k++) {
+        if (reg->id != 0 && uses_reserve(uses, reg->id)) {
+            uses->counts[reg->id]++;
+        }
+    }
+}
+
+void fcx_ir_uses_remove(FcxIRUseTable* uses, FcxIRInstruction* instr) {
+    if (!uses) return;
+    
+    VirtualReg* reg;
+    for (uint32_t k = 0; (reg = fcx_ir_instruction_use(instr, k)) != NULL; k++) {
+        if (reg->id < uses->capacity && uses->counts[reg->id] > 0) {
+            uses->counts[reg->id]--;
+        }
+    }
+}
+
+void fcx_ir_uses_replace(FcxIRUseTable* uses, VirtualReg* reg, uint32_t id) {
+    if (uses) {
+        if (reg->id < uses->capacity && uses->counts[reg->id] > 0) {
+            uses->counts[reg->id]--;
+        }
+        if (id != 0 && uses_reserve(uses, id)) {
+            uses->counts[id]++;
+        }
+    }
+    reg->id = id;
+}
+
+// Recounts every operand, for passes that rewrite too much to track
+void fcx_ir_rebuild_uses(FcxIRFunction* function) {
+    if (!function || !function->uses) return;
+    
+    FcxIRUseTable* uses = function->uses;
+    if (uses->capacity > 0) {
+        memset(uses->counts, 0, uses->capacity * sizeof(uint32_t));
+    }
+    for (uint32_t b = 0; b < function->block_count; b++) {
+        FcxIRBasicBlock* block = &function->blocks[b];
+        for (uint32_t i = 0; i < block->instruction_count; i++) {
+            fcx_ir_uses_add(uses, &block->instructions[i]);
+        }
+    }
+}
+
+// ============================================================================
+// Bigint Constant Pool
+// ============================================================================
+
+// Append the limbs to the function's pool and return the index of the first
+// one, or UINT32_MAX if they could not be stored
+uint32_t fcx_ir_function_add_bigint(FcxIRFunction* function, const uint64_t* limbs, uint8_t num_limbs) {
+    if (!function || !limbs || num_limbs == 0 || num_limbs > 16) return UINT32_MAX;
+    
+    if (function->bigint_limb_count + num_limbs > function->bigint_limb_capacity) {
+        uint32_t new_capacity = function->bigint_limb_capacity == 0 ? 16 : function->bigint_limb_capacity * 2;
+        while (new_capacity < function->bigint_limb_count + num_limbs) {
+            new_capacity *= 2;
+        }
+        uint64_t* new_limbs = (uint64_t*)ir_arena_grow(
+            function->arena, function->bigint_limbs,
+            function->bigint_limb_capacity * sizeof(uint64_t), new_capacity * sizeof(uint64_t));
+        
+        if (!new_limbs) return UINT32_MAX;
+        
+        function->bigint_limbs = new_limbs;
+        function->bigint_limb_capacity = new_capacity;
+    }
+    
+    uint32_t index = function->bigint_limb_count;
+    memcpy(&function->bigint_limbs[index], limbs, num_limbs * sizeof(uint64_t));
+    function->bigint_limb_count += num_limbs;
+    return index;
+}
+
+// Limbs of an FCXIR_CONST_BIGINT instruction of the function
+const uint64_t* fcx_ir_bigint_limbs(const FcxIRFunction* function, const FcxIRInstruction* instr) {
+    if (!function || !instr || instr->opcode != FCXIR_CONST_BIGINT) return NULL;
+    if (instr->u.const_bigint_op.limb_index + instr->u.const_bigint_op.num_limbs >
+        function->bigint_limb_count) return NULL;
+    return &function->bigint_limbs[instr->u.const_bigint_op.limb_index];
+}
+
 // ============================================================================
 // Helper: Add instruction to basic block
 // ============================================================================
 
-static void add_instruction(FcxIRBasicBlock* block, FcxIRInstruction instr) {
+// Bigint limbs and inline asm operands are kept out of line so that common
+// instructions stay small
+_Static_assert(sizeof(FcxIRInstruction) <= 48, "FcxIRInstruction should stay within 48 bytes");
+
+void fcx_ir_block_append(FcxIRBasicBlock* block, const FcxIRInstruction* instr) {
     if (!block) return;
     
+    // Most blocks hold a handful of instructions; start small since the arena
+    // keeps outgrown arrays until the function is destroyed
     if (block->instruction_count >= block->instruction_capacity) {
-        uint32_t new_capacity = block->instruction_capacity == 0 ? 16 : block->instruction_capacity * 2;
-        FcxIRInstruction* new_instructions = (FcxIRInstruction*)realloc(
-            block->instructions, new_capacity * sizeof(FcxIRInstruction));
+        uint32_t new_capacity = block->instruction_capacity == 0 ? 4 : block->instruction_capacity * 2;
+        FcxIRInstruction* new_instructions = (FcxIRInstruction*)ir_arena_grow(
+            block->arena, block->instructions,
+            block->instruction_capacity * sizeof(FcxIRInstruction),
+            new_capacity * sizeof(FcxIRInstruction));
         
         if (!new_instructions) return;
         
@@ -313,7 +667,12 @@ static void add_instruction(FcxIRBasicBlock* block, FcxIRInstruction instr) {
         block->instruction_capacity = new_capacity;
     }
     
-    block->instructions[block->instruction_count++] = instr;
+    block->instructions[block->instruction_count] = *instr;
+    fcx_ir_uses_add(block->uses, &block->instructions[block->instruction_count++]);
+}
+
+static void add_instruction(FcxIRBasicBlock* block, FcxIRInstruction instr) {
+    fcx_ir_block_append(block, &instr);
 }
 
 // ============================================================================
@@ -329,15 +688,17 @@ void fcx_ir_build_const(FcxIRBasicBlock* block, VirtualReg dest, int64_t value)
     add_instruction(block, instr);
 }
 
-void fcx_ir_build_const_bigint(FcxIRBasicBlock* block, VirtualReg dest, const uint64_t* limbs, uint8_t num_limbs) {
+void fcx_ir_build_const_bigint(FcxIRFunction* function, FcxIRBasicBlock* block, VirtualReg dest,
+                               const uint64_t* limbs, uint8_t num_limbs) {
+    uint32_t limb_index = fcx_ir_function_add_bigint(function, limbs, num_limbs);
+    if (limb_index == UINT32_MAX) return;
+    
     FcxIRInstruction instr = {0};
     instr.opcode = FCXIR_CONST_BIGINT;
     instr.operand_count = 1;
     instr.u.const_bigint_op.dest = dest;
+    instr.u.const_bigint_op.limb_index = limb_index;
     instr.u.const_bigint_op.num_limbs = num_limbs;
-    for (uint8_t i = 0; i < 16; i++) {
-        instr.u.const_bigint_op.limbs[i] = (i < num_limbs) ? limbs[i] : 0;
-    }
     add_instruction(block, instr);
 }
 
@@ -413,9 +774,10 @@ void fcx_ir_build_syscall(FcxIRBasicBlock* block, VirtualReg dest, VirtualReg sy
     instr.u.syscall_op.syscall_num = syscall_num;
     instr.u.syscall_op.arg_count = arg_count;
     
+    if (!block) return;
     if (arg_count > 0) {
-        instr.u.syscall_op.args = (VirtualReg*)malloc(arg_count * sizeof(VirtualReg));
-        memcpy(instr.u.syscall_op.args, args, arg_count * sizeof(VirtualReg));
+        instr.u.syscall_op.args = (VirtualReg*)ir_arena_dup(block->arena, args, arg_count * sizeof(VirtualReg));
+        if (!instr.u.syscall_op.args) return;
     } else {
         instr.u.syscall_op.args = NULL;
     }
@@ -447,12 +809,13 @@ void fcx_ir_build_call(FcxIRBasicBlock* block, VirtualReg dest, const char* func
     instr.opcode = FCXIR_CALL;
     instr.operand_count = 1 + arg_count;
     instr.u.call_op.dest = dest;
-    instr.u.call_op.function = strdup(function);
+    instr.u.call_op.function = fcx_intern_cstr(function);
     instr.u.call_op.arg_count = arg_count;
     
+    if (!block) return;
     if (arg_count > 0) {
-        instr.u.call_op.args = (VirtualReg*)malloc(arg_count * sizeof(VirtualReg));
-        memcpy(instr.u.call_op.args, args, arg_count * sizeof(VirtualReg));
+        instr.u.call_op.args = (VirtualReg*)ir_arena_dup(block->arena, args, arg_count * sizeof(VirtualReg));
+        if (!instr.u.call_op.args) return;
     } else {
         instr.u.call_op.args = NULL;
     }
@@ -610,19 +973,28 @@ void fcx_ir_build_inline_asm(FcxIRBasicBlock* block, const char* asm_template,
                              const char** output_constraints, VirtualReg* outputs, uint8_t output_count,
                              const char** input_constraints, VirtualReg* inputs, uint8_t input_count,
                              const char** clobbers, uint8_t clobber_count, bool is_volatile) {
+    // The outputs and inputs arrays are copied into the function's arena
+    if (!block) return;
+    FcxIRInlineAsm* inline_asm = (FcxIRInlineAsm*)ir_arena_alloc(block->arena, sizeof(FcxIRInlineAsm));
+    if (!inline_asm) return;
+    inline_asm->asm_template = asm_template;
+    inline_asm->output_constraints = output_constraints;
+    inline_asm->input_constraints = input_constraints;
+    inline_asm->outputs = output_count > 0
+        ? (VirtualReg*)ir_arena_dup(block->arena, outputs, output_count * sizeof(VirtualReg)) : NULL;
+    inline_asm->inputs = input_count > 0
+        ? (VirtualReg*)ir_arena_dup(block->arena, inputs, input_count * sizeof(VirtualReg)) : NULL;
+    if ((output_count > 0 && !inline_asm->outputs) || (input_count > 0 && !inline_asm->inputs)) return;
+    inline_asm->clobbers = clobbers;
+    inline_asm->output_count = output_count;
+    inline_asm->input_count = input_count;
+    inline_asm->clobber_count = clobber_count;
+    inline_asm->is_volatile = is_volatile;
+    
     FcxIRInstruction instr = {0};
     instr.opcode = FCXIR_INLINE_ASM;
     instr.operand_count = output_count + input_count;
-    instr.u.inline_asm.asm_template = asm_template;
-    instr.u.inline_asm.output_constraints = output_constraints;
-    instr.u.inline_asm.input_constraints = input_constraints;
-    instr.u.inline_asm.outputs = outputs;
-    instr.u.inline_asm.inputs = inputs;
-    instr.u.inline_asm.clobbers = clobbers;
-    instr.u.inline_asm.output_count = output_count;
-    instr.u.inline_asm.input_count = input_count;
-    instr.u.inline_asm.clobber_count = clobber_count;
-    instr.u.inline_asm.is_volatile = is_volatile;
+    instr.u.inline_asm = inline_asm;
     add_instruction(block, instr);
 }
 
@@ -738,7 +1110,7 @@ static const char* vreg_type_to_string(VRegType type) {
     }
 }
 
-void fcx_ir_print_instruction(const FcxIRInstruction* instr) {
+void fcx_ir_print_instruction(const FcxIRFunction* function, const FcxIRInstruction* instr) {
     if (!instr) return;
     
     printf("  %s ", opcode_to_string(instr->opcode));
@@ -749,13 +1121,19 @@ void fcx_ir_print_instruction(const FcxIRInstruction* instr) {
             break;
         
         case FCXIR_CONST_BIGINT: {
+            const uint64_t* limbs = fcx_ir_bigint_limbs(function, instr);
+            if (!limbs) {
+                printf("%%v%u = <bigint #%u>", instr->u.const_bigint_op.dest.id,
+                       instr->u.const_bigint_op.limb_index);
+                break;
+            }
             printf("%%v%u = 0x", instr->u.const_bigint_op.dest.id);
             // Print limbs in big-endian order (most significant first)
             for (int i = instr->u.const_bigint_op.num_limbs - 1; i >= 0; i--) {
                 if (i == instr->u.const_bigint_op.num_limbs - 1) {
-                    printf("%lx", (unsigned long)instr->u.const_bigint_op.limbs[i]);
+                    printf("%lx", (unsigned long)limbs[i]);
                 } else {
-                    printf("%016lx", (unsigned long)instr->u.const_bigint_op.limbs[i]);
+                    printf("%016lx", (unsigned long)limbs[i]);
                 }
             }
             break;
@@ -915,6 +1293,14 @@ void fcx_ir_print_instruction(const FcxIRInstruction* instr) {
                    instr->u.mmio_op.address,
                    instr->u.mmio_op.value.id);
             break;
+        
+        case FCXIR_PHI:
+            printf("%%v%u = ", instr->u.phi_op.dest.id);
+            for (uint32_t i = 0; i < instr->u.phi_op.incoming_count; i++) {
+                printf("[%%v%u, .L%u]", instr->u.phi_op.incoming[i].id, instr->u.phi_op.blocks[i]);
+                if (i < instr->u.phi_op.incoming_count - 1) printf(", ");
+            }
+            break;
             
         default:
             break;
@@ -923,7 +1309,7 @@ void fcx_ir_print_instruction(const FcxIRInstruction* instr) {
     printf("\n");
 }
 
-void fcx_ir_print_block(const FcxIRBasicBlock* block) {
+void fcx_ir_print_block(const FcxIRFunction* function, const FcxIRBasicBlock* block) {
     if (!block) return;
     
     printf("\n.BB%u", block->id);
@@ -934,7 +1320,7 @@ void fcx_ir_print_block(const FcxIRBasicBlock* block) {
     
     if (block->predecessor_count > 0) {
         printf("  ; predecessors: ");
-        for (uint8_t i = 0; i < block->predecessor_count; i++) {
+        for (uint32_t i = 0; i < block->predecessor_count; i++) {
             printf(".BB%u", block->predecessors[i]);
             if (i < block->predecessor_count - 1) printf(", ");
         }
@@ -942,12 +1328,12 @@ void fcx_ir_print_block(const FcxIRBasicBlock* block) {
     }
     
     for (uint32_t i = 0; i < block->instruction_count; i++) {
-        fcx_ir_print_instruction(&block->instructions[i]);
+        fcx_ir_print_instruction(function, &block->instructions[i]);
     }
     
     if (block->successor_count > 0) {
         printf("  ; successors: ");
-        for (uint8_t i = 0; i < block->successor_count; i++) {
+        for (uint32_t i = 0; i < block->successor_count; i++) {
             printf(".BB%u", block->successors[i]);
             if (i < block->successor_count - 1) printf(", ");
         }
@@ -963,7 +1349,7 @@ void fcx_ir_print_function(const FcxIRFunction* function) {
            vreg_type_to_string(function->return_type));
     
     for (uint32_t i = 0; i < function->block_count; i++) {
-        fcx_ir_print_block(&function->blocks[i]);
+        fcx_ir_print_block(function, &function->blocks[i]);
     }
     
     printf("}\n");
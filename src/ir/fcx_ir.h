@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include "ir_arena.h"
 
 // FCx IR (High-Level "FCx" Intermediate Representation)
 // This IR desugars the 275+ operators into a regular, LLVM-like IR for optimization and analysis
@@ -39,9 +40,14 @@ typedef enum {
     VREG_TYPE_COUNT
 } VRegType;
 
+// FC IR lowering names the physical registers v1000-v1015 (rax = v1000,
+// rdi = v1001, ...); fcx_ir_alloc_vreg never hands these ids out
+#define FCX_IR_RESERVED_VREG_FIRST 1000
+#define FCX_IR_RESERVED_VREG_LAST 1015
+
 typedef struct {
     uint32_t id;           // Virtual register ID (%v1, %v2, etc.)
-    VRegType type;         // Register type
+    uint8_t type;          // Register type (VRegType)
     uint8_t size;          // Size in bytes
     uint16_t flags;        // Additional flags for optimization
 } VirtualReg;
@@ -177,6 +183,21 @@ typedef enum {
 // FCx IR Instruction Structure
 // ============================================================================
 
+// Inline assembly operands, allocated separately so they do not widen
+// every instruction; owned by the instruction
+typedef struct {
+    const char* asm_template;
+    const char** output_constraints;
+    const char** input_constraints;
+    VirtualReg* outputs;
+    VirtualReg* inputs;
+    const char** clobbers;
+    uint8_t output_count;
+    uint8_t input_count;
+    uint8_t clobber_count;
+    bool is_volatile;
+} FcxIRInlineAsm;
+
 typedef struct {
     FcxIROpcode opcode;
     uint8_t operand_count;
@@ -190,11 +211,12 @@ typedef struct {
             int64_t value;
         } const_op;
         
-        // Bigint constant operation (for values > 64 bits)
+        // Bigint constant operation (for values > 64 bits); the limbs live in
+        // the function's bigint pool, see fcx_ir_bigint_limbs
         struct {
             VirtualReg dest;
-            uint64_t limbs[16];  // Up to 1024 bits (16 x 64-bit limbs), little-endian
-            uint8_t num_limbs;   // Number of limbs used (1-16)
+            uint32_t limb_index;   // First limb in function->bigint_limbs
+            uint8_t num_limbs;     // Number of limbs used (1-16)
         } const_bigint_op;
         
         // Load/Store operations
@@ -315,12 +337,13 @@ typedef struct {
             bool has_value;
         } return_op;
         
-        // Phi operation (for SSA form)
+        // Phi operation (for SSA form); incoming[i] is the value on the edge
+        // from block blocks[i], both arrays live in the function's arena
         struct {
             VirtualReg dest;
             VirtualReg* incoming;
             uint32_t* blocks;
-            uint8_t incoming_count;
+            uint32_t incoming_count;
         } phi_op;
         
         // Label
@@ -330,38 +353,48 @@ typedef struct {
         } label;
         
         // Inline assembly
-        struct {
-            const char* asm_template;
-            const char** output_constraints;
-            const char** input_constraints;
-            VirtualReg* outputs;
-            VirtualReg* inputs;
-            const char** clobbers;
-            uint8_t output_count;
-            uint8_t input_count;
-            uint8_t clobber_count;
-            bool is_volatile;
-        } inline_asm;
+        FcxIRInlineAsm* inline_asm;
     } u;
 } FcxIRInstruction;
 
+// ============================================================================
+// Use Counts
+// ============================================================================
+
+// How many operands of a function read each of its vregs. fcx_ir_block_append,
+// and so every builder, counts the operands of the instructions it adds. A
+// pass that rewrites or drops an instruction uncounts it first with
+// fcx_ir_uses_remove and counts the result with fcx_ir_uses_add, or calls
+// fcx_ir_rebuild_uses once it is done. The table sits in the function's arena
+// at a fixed address, so copies of the function and its blocks share it.
+typedef struct {
+    IRArena* arena;
+    uint32_t* counts;          // Indexed by vreg id
+    uint32_t capacity;
+} FcxIRUseTable;
+
 // ============================================================================
 // Basic Block Structure
 // ============================================================================
 
+// Instruction arrays and edge lists live in the owning function's arena
 typedef struct FcxIRBasicBlock {
     uint32_t id;
     const char* name;
+    IRArena* arena;
+    FcxIRUseTable* uses;       // The owning function's
     
     FcxIRInstruction* instructions;
     uint32_t instruction_count;
     uint32_t instruction_capacity;
     
     uint32_t* successors;
-    uint8_t successor_count;
+    uint32_t successor_count;
+    uint32_t successor_capacity;
     
     uint32_t* predecessors;
-    uint8_t predecessor_count;
+    uint32_t predecessor_count;
+    uint32_t predecessor_capacity;
     
     bool is_entry;
     bool is_exit;
@@ -371,8 +404,15 @@ typedef struct FcxIRBasicBlock {
 // Function Structure
 // ============================================================================
 
+// Control flow analysis cached on a function, see ir_cfg.h
+typedef struct IRCFG IRCFG;
+
+// All storage reachable from a function (blocks, instructions, edge lists,
+// argument vectors, inline asm operands, parameters, bigint limbs) is owned
+// by its arena and released in one go by fcx_ir_function_destroy
 typedef struct {
     const char* name;
+    IRArena* arena;
     VirtualReg* parameters;
     uint8_t parameter_count;
     VRegType return_type;
@@ -384,6 +424,23 @@ typedef struct {
     uint32_t next_vreg_id;
     uint32_t next_label_id;
     uint32_t next_block_id;
+    
+    // Limbs of the function's bigint constants, little-endian, packed
+    uint64_t* bigint_limbs;
+    uint32_t bigint_limb_count;
+    uint32_t bigint_limb_capacity;
+    
+    // Set by ir_ssa_construct_function: blocks are in reverse postorder, every
+    // block ends in a terminator, the edge lists are filled in and each vreg
+    // has a single definition that dominates its uses
+    bool is_ssa;
+    
+    // Cached control flow analysis, NULL until ir_cfg_get computes it, and
+    // the arena holding it
+    IRCFG* cfg;
+    IRArena* cfg_arena;
+    
+    FcxIRUseTable* uses;
 } FcxIRFunction;
 
 // ============================================================================
@@ -446,19 +503,49 @@ uint32_t fcx_ir_module_add_string(FcxIRModule* module, const char* str, size_t l
 FcxIRFunction* fcx_ir_function_create(const char* name, VRegType return_type);
 void fcx_ir_function_destroy(FcxIRFunction* function);
 void fcx_ir_module_add_function(FcxIRModule* module, FcxIRFunction* function);
+void fcx_ir_invalidate_cfg(FcxIRFunction* function);
 
 // Basic block management
 FcxIRBasicBlock* fcx_ir_block_create(FcxIRFunction* function, const char* name);
+FcxIRBasicBlock* fcx_ir_block_insert(FcxIRFunction* function, uint32_t index, const char* name);
 FcxIRBasicBlock* fcx_ir_block_get_by_id(FcxIRFunction* function, uint32_t id);
 void fcx_ir_block_add_successor(FcxIRBasicBlock* block, uint32_t successor_id);
 void fcx_ir_block_add_predecessor(FcxIRBasicBlock* block, uint32_t predecessor_id);
+void fcx_ir_block_append(FcxIRBasicBlock* block, const FcxIRInstruction* instr);
 
 // Virtual register allocation
 VirtualReg fcx_ir_alloc_vreg(FcxIRFunction* function, VRegType type);
+uint8_t fcx_ir_vreg_type_size(VRegType type);  // Bytes; 0 for void
+
+// Operand access: the n-th register an instruction writes or reads, or NULL
+// once n runs past the last one. Id 0 means "no register".
+VirtualReg* fcx_ir_instruction_def(FcxIRInstruction* instr, uint32_t n);
+VirtualReg* fcx_ir_instruction_use(FcxIRInstruction* instr, uint32_t n);
+bool fcx_ir_is_terminator(const FcxIRInstruction* instr);
+
+// Use counts, see FcxIRUseTable
+void fcx_ir_uses_add(FcxIRUseTable* uses, FcxIRInstruction* instr);
+void fcx_ir_uses_remove(FcxIRUseTable* uses, FcxIRInstruction* instr);
+// Points one operand at another vreg
+void fcx_ir_uses_replace(FcxIRUseTable* uses, VirtualReg* reg, uint32_t id);
+void fcx_ir_rebuild_uses(FcxIRFunction* function);
+
+static inline uint32_t fcx_ir_use_count(const FcxIRFunction* function, uint32_t id) {
+    return id < function->uses->capacity ? function->uses->counts[id] : 0;
+}
+
+static inline bool fcx_ir_has_uses(const FcxIRFunction* function, uint32_t id) {
+    return fcx_ir_use_count(function, id) != 0;
+}
+
+// Bigint constant pool
+uint32_t fcx_ir_function_add_bigint(FcxIRFunction* function, const uint64_t* limbs, uint8_t num_limbs);
+const uint64_t* fcx_ir_bigint_limbs(const FcxIRFunction* function, const FcxIRInstruction* instr);
 
 // Instruction building
 void fcx_ir_build_const(FcxIRBasicBlock* block, VirtualReg dest, int64_t value);
-void fcx_ir_build_const_bigint(FcxIRBasicBlock* block, VirtualReg dest, const uint64_t* limbs, uint8_t num_limbs);
+void fcx_ir_build_const_bigint(FcxIRFunction* function, FcxIRBasicBlock* block, VirtualReg dest,
+                               const uint64_t* limbs, uint8_t num_limbs);
 void fcx_ir_build_load(FcxIRBasicBlock* block, VirtualReg dest, VirtualReg src, int32_t offset);
 void fcx_ir_build_store(FcxIRBasicBlock* block, VirtualReg dest, VirtualReg src, int32_t offset);
 void fcx_ir_build_mov(FcxIRBasicBlock* block, VirtualReg dest, VirtualReg src);
@@ -500,8 +587,8 @@ void fcx_ir_build_inline_asm(FcxIRBasicBlock* block, const char* asm_template,
                              const char** clobbers, uint8_t clobber_count, bool is_volatile);
 
 // Debugging and printing
-void fcx_ir_print_instruction(const FcxIRInstruction* instr);
-void fcx_ir_print_block(const FcxIRBasicBlock* block);
+void fcx_ir_print_instruction(const FcxIRFunction* function, const FcxIRInstruction* instr);
+void fcx_ir_print_block(const FcxIRFunction* function, const FcxIRBasicBlock* block);
 void fcx_ir_print_function(const FcxIRFunction* function);
 void fcx_ir_print_module(const FcxIRModule* module);
 
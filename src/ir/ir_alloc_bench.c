@@ -0,0 +1,137 @@
+// FCx IR allocation benchmark
+// Generates a multi-function FCx source, parses it once, then repeatedly
+// generates FCx IR for it and destroys the module, reporting malloc calls
+// (malloc, calloc and realloc) per function and per instruction, and the
+// time spent building and tearing down the IR. Calls are counted by
+// interposing the allocator entry points over glibc's.
+// Usage: ir_alloc_bench [functions] [iterations]
+
+#include "ir_gen.h"
+#include "../bench_source.h"
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// glibc's allocator, reachable under these names when malloc is interposed
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static size_t alloc_calls;
+static size_t free_calls;
+
+void *malloc(size_t size) {
+  alloc_calls++;
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+  alloc_calls++;
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  alloc_calls++;
+  return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) {
+  if (ptr) {
+    free_calls++;
+  }
+  __libc_free(ptr);
+}
+
+int main(int argc, char **argv) {
+  size_t function_count = argc > 1 ? strtoul(argv[1], NULL, 10) : 5000;
+  size_t iterations = argc > 2 ? strtoul(argv[2], NULL, 10) : 10;
+  if (function_count == 0 || iterations == 0) {
+    fprintf(stderr, "Usage: %s [functions] [iterations]\n", argv[0]);
+    return 1;
+  }
+
+  // Keep freed memory in the heap between iterations; otherwise glibc hands
+  // the destroyed IR back to the kernel and the next build mostly measures
+  // page faults
+  mallopt(M_TRIM_THRESHOLD, 1 << 30);
+
+  init_operator_registry();
+  char *source = generate_bench_source(BENCH_HELPER, BENCH_FUNCTION_TEMPLATE,
+                                       function_count, NULL);
+  TokenBuffer tokens;
+  if (!source || !token_buffer_fill(&tokens, source)) {
+    fprintf(stderr, "failed to generate or lex the source\n");
+    return 1;
+  }
+  Parser parser;
+  parser_init_tokens(&parser, &tokens);
+  Stmt **statements = NULL;
+  size_t stmt_count = 0;
+  if (!parse_program(&parser, 1, &statements, &stmt_count)) {
+    fprintf(stderr, "failed to parse the source\n");
+    return 1;
+  }
+
+  printf("=== FCx IR Allocation Benchmark ===\n");
+  printf("%zu functions, %zu iterations\n\n", function_count + 1, iterations);
+
+  size_t instructions = 0;
+  size_t build_allocs = 0;
+  size_t destroy_frees = 0;
+  size_t arena_bytes = 0;
+  double build_time = 0.0;
+  double destroy_time = 0.0;
+  for (size_t iter = 0; iter < iterations; iter++) {
+    size_t allocs_before = alloc_calls;
+    double start = now_seconds();
+    IRGenerator *gen = ir_gen_create("bench_module");
+    if (!gen || !ir_gen_generate_module(gen, statements, stmt_count)) {
+      fprintf(stderr, "failed to generate IR\n");
+      return 1;
+    }
+    build_time += now_seconds() - start;
+    build_allocs = alloc_calls - allocs_before;
+
+    instructions = 0;
+    arena_bytes = 0;
+    for (uint32_t f = 0; f < gen->module->function_count; f++) {
+      const FcxIRFunction *function = &gen->module->functions[f];
+      arena_bytes += function->arena->bytes_reserved;
+      for (uint32_t b = 0; b < function->block_count; b++) {
+        instructions += function->blocks[b].instruction_count;
+      }
+    }
+
+    size_t frees_before = free_calls;
+    start = now_seconds();
+    ir_gen_destroy(gen);
+    destroy_time += now_seconds() - start;
+    destroy_frees = free_calls - frees_before;
+  }
+
+  double functions = (double)(function_count + 1);
+  printf("instructions:        %zu (%.1f per function)\n", instructions,
+         (double)instructions / functions);
+  printf("arena bytes:         %zu (%.1f per instruction)\n", arena_bytes,
+         (double)arena_bytes / (double)instructions);
+  printf("allocs per build:    %zu (%.2f per function, %.3f per instruction)\n",
+         build_allocs, (double)build_allocs / functions,
+         (double)build_allocs / (double)instructions);
+  printf("frees per destroy:   %zu (%.2f per function)\n", destroy_frees,
+         (double)destroy_frees / functions);
+  printf("build time:          %.3f ms\n", build_time * 1e3 / (double)iterations);
+  printf("destroy time:        %.3f ms\n", destroy_time * 1e3 / (double)iterations);
+
+  for (size_t i = 0; i < stmt_count; i++) {
+    free_stmt(statements[i]);
+  }
+  free(statements);
+  parser_destroy(&parser);
+  token_buffer_destroy(&tokens);
+  free(source);
+  cleanup_operator_registry();
+  return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef IR_ARENA_H
+#define IR_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../parser/ast_arena.h"
+
+// Bump allocator owning the storage of one FcxIRFunction
+// Blocks, instruction arrays, edge lists, argument vectors, inline asm
+// operands, parameters and bigint limbs are carved out of chunks and released
+// together by ir_arena_destroy; nothing is freed individually. This is the
+// AST's allocator (ast_arena.h) with a different chunk policy: chunks start
+// small and double, so small functions stay cheap.
+
+typedef AstArena IRArena;
+
+// Most functions fit in the first chunk or two; large ones quickly reach
+// the maximum chunk size
+#define IR_ARENA_FIRST_CHUNK_SIZE (2 * 1024)
+#define IR_ARENA_MAX_CHUNK_SIZE (64 * 1024)
+
+static inline IRArena* ir_arena_create(void) {
+    return ast_arena_create_sized(IR_ARENA_FIRST_CHUNK_SIZE, IR_ARENA_MAX_CHUNK_SIZE);
+}
+
+static inline void ir_arena_destroy(IRArena* arena) {
+    ast_arena_destroy(arena);
+}
+
+// Empty the arena for reuse, keeping its current chunk
+static inline void ir_arena_reset(IRArena* arena) {
+    ast_arena_reset(arena);
+}
+
+// Uninitialized storage aligned for any IR type; NULL on OOM
+static inline void* ir_arena_alloc(IRArena* arena, size_t size) {
+    return ast_arena_alloc(arena, size);
+}
+
+// Copy of size bytes of src
+static inline void* ir_arena_dup(IRArena* arena, const void* src, size_t size) {
+    return ast_arena_dup(arena, src, size);
+}
+
+// Resize an array allocated from the arena; see ast_arena_grow
+static inline void* ir_arena_grow(IRArena* arena, void* ptr, size_t old_size, size_t new_size) {
+    return ast_arena_grow(arena, ptr, old_size, new_size);
+}
+
+#endif // IR_ARENA_H
@@ -0,0 +1,514 @@
+#include "ir_cfg.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Only terminators are branches, jumps and returns, so a block has at most
+// two successors
+#define IR_CFG_MAX_SUCCS 2
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static uint32_t* cfg_indices(IRArena* arena, size_t count) {
+    uint32_t* array = (uint32_t*)ir_arena_alloc(arena, count * sizeof(uint32_t));
+    for (size_t i = 0; array && i < count; i++) {
+        array[i] = IR_CFG_NONE;
+    }
+    return array;
+}
+
+static uint32_t* cfg_zeroed(IRArena* arena, size_t count) {
+    uint32_t* array = (uint32_t*)ir_arena_alloc(arena, count * sizeof(uint32_t));
+    if (array) {
+        memset(array, 0, count * sizeof(uint32_t));
+    }
+    return array;
+}
+
+// Block index of each label; labels are block ids
+static uint32_t* label_index_map(FcxIRFunction* function, IRArena* arena) {
+    uint32_t* index_of = cfg_indices(arena, function->next_block_id);
+    if (!index_of) return NULL;
+
+    for (uint32_t i = 0; i < function->block_count; i++) {
+        uint32_t id = function->blocks[i].id;
+        if (id < function->next_block_id) index_of[id] = i;
+    }
+    return index_of;
+}
+
+static uint32_t label_index(const FcxIRFunction* function, const uint32_t* index_of, uint32_t label) {
+    return label < function->next_block_id ? index_of[label] : IR_CFG_NONE;
+}
+
+// Successor indices of block b in terminator order (a branch's true side
+// first), each once. Labels that name no block are ignored.
+static uint32_t block_successors(const FcxIRFunction* function, const uint32_t* index_of,
+                                 uint32_t b, uint32_t succs[IR_CFG_MAX_SUCCS]) {
+    const FcxIRBasicBlock* block = &function->blocks[b];
+    const FcxIRInstruction* term = NULL;
+    for (uint32_t i = 0; i < block->instruction_count; i++) {
+        if (fcx_ir_is_terminator(&block->instructions[i])) {
+            term = &block->instructions[i];
+            break;
+        }
+    }
+
+    uint32_t labels[IR_CFG_MAX_SUCCS];
+    uint32_t label_count = 0;
+    if (!term) {
+        if (b + 1 < function->block_count) {
+            succs[0] = b + 1;
+            return 1;
+        }
+        return 0;
+    }
+    if (term->opcode == FCXIR_JUMP) {
+        labels[label_count++] = term->u.jump_op.label_id;
+    } else if (term->opcode == FCXIR_BRANCH) {
+        labels[label_count++] = term->u.branch_op.true_label;
+        labels[label_count++] = term->u.branch_op.false_label;
+    }
+
+    uint32_t count = 0;
+    for (uint32_t k = 0; k < label_count; k++) {
+        uint32_t s = label_index(function, index_of, labels[k]);
+        if (s == IR_CFG_NONE || (count > 0 && succs[0] == s)) continue;
+        succs[count++] = s;
+    }
+    return count;
+}
+
+// ============================================================================
+// Edges and Reverse Postorder
+// ============================================================================
+
+// Edges out of unreachable blocks are not recorded, so every predecessor of
+// a reachable block is reachable
+static bool compute_edges(FcxIRFunction* function, IRCFG* cfg, IRArena* arena) {
+    uint32_t n = function->block_count;
+    uint32_t* index_of = label_index_map(function, arena);
+    uint32_t* succ_buf = (uint32_t*)ir_arena_alloc(arena, (size_t)n * IR_CFG_MAX_SUCCS * sizeof(uint32_t));
+    if (!index_of || !succ_buf) return false;
+
+    for (uint32_t b = 0; b < n; b++) {
+        cfg->blocks[b].succs = &succ_buf[(size_t)b * IR_CFG_MAX_SUCCS];
+        cfg->blocks[b].succ_count = block_successors(function, index_of, b, cfg->blocks[b].succs);
+    }
+
+    // Depth-first search from the entry for the postorder. Successors are
+    // visited last to first so that a branch's true side comes first in
+    // reverse postorder.
+    uint32_t* postorder = cfg_indices(arena, n);
+    uint32_t* stack = cfg_indices(arena, n);
+    uint32_t* next_succ = cfg_zeroed(arena, n);
+    if (!postorder || !stack || !next_succ) return false;
+
+    uint32_t reachable = 0;
+    uint32_t depth = 0;
+    stack[depth++] = 0;
+    cfg->blocks[0].rpo = 0;
+    while (depth > 0) {
+        uint32_t b = stack[depth - 1];
+        const IRCFGBlock* info = &cfg->blocks[b];
+        if (next_succ[b] < info->succ_count) {
+            uint32_t s = info->succs[info->succ_count - 1 - next_succ[b]];
+            next_succ[b]++;
+            if (cfg->blocks[s].rpo == IR_CFG_NONE) {
+                cfg->blocks[s].rpo = 0;
+                stack[depth++] = s;
+            }
+        } else {
+            postorder[reachable++] = b;
+            depth--;
+        }
+    }
+
+    cfg->rpo = postorder;
+    cfg->rpo_count = reachable;
+    for (uint32_t i = 0; i < reachable / 2; i++) {
+        uint32_t tmp = postorder[i];
+        postorder[i] = postorder[reachable - 1 - i];
+        postorder[reachable - 1 - i] = tmp;
+    }
+    for (uint32_t i = 0; i < reachable; i++) {
+        cfg->blocks[cfg->rpo[i]].rpo = i;
+    }
+
+    // Predecessors in block order, then in each predecessor's successor order
+    uint32_t* pred_counts = cfg_zeroed(arena, n);
+    if (!pred_counts) return false;
+    for (uint32_t b = 0; b < n; b++) {
+        if (cfg->blocks[b].rpo == IR_CFG_NONE) {
+            cfg->blocks[b].succ_count = 0;
+            continue;
+        }
+        for (uint32_t s = 0; s < cfg->blocks[b].succ_count; s++) {
+            pred_counts[cfg->blocks[b].succs[s]]++;
+        }
+    }
+    for (uint32_t b = 0; b < n; b++) {
+        if (pred_counts[b] == 0) continue;
+        cfg->blocks[b].preds = (uint32_t*)ir_arena_alloc(arena, pred_counts[b] * sizeof(uint32_t));
+        if (!cfg->blocks[b].preds) return false;
+    }
+    for (uint32_t b = 0; b < n; b++) {
+        for (uint32_t s = 0; s < cfg->blocks[b].succ_count; s++) {
+            IRCFGBlock* succ = &cfg->blocks[cfg->blocks[b].succs[s]];
+            succ->preds[succ->pred_count++] = b;
+        }
+    }
+
+    return true;
+}
+
+// ============================================================================
+// Dominators
+// ============================================================================
+
+// Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm"
+static uint32_t intersect(const IRCFGBlock* blocks, uint32_t a, uint32_t b) {
+    while (a != b) {
+        while (blocks[a].rpo > blocks[b].rpo) a = blocks[a].idom;
+        while (blocks[b].rpo > blocks[a].rpo) b = blocks[b].idom;
+    }
+    return a;
+}
+
+static bool compute_dominators(IRCFG* cfg, IRArena* arena) {
+    IRCFGBlock* blocks = cfg->blocks;
+    uint32_t n = cfg->block_count;
+    uint32_t entry = cfg->rpo[0];
+
+    blocks[entry].idom = entry;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (uint32_t r = 1; r < cfg->rpo_count; r++) {
+            uint32_t b = cfg->rpo[r];
+            uint32_t new_idom = IR_CFG_NONE;
+            for (uint32_t p = 0; p < blocks[b].pred_count; p++) {
+                uint32_t pred = blocks[b].preds[p];
+                if (blocks[pred].idom == IR_CFG_NONE) continue;
+                new_idom = new_idom == IR_CFG_NONE ? pred : intersect(blocks, pred, new_idom);
+            }
+            if (blocks[b].idom != new_idom) {
+                blocks[b].idom = new_idom;
+                changed = true;
+            }
+        }
+    }
+    blocks[entry].idom = IR_CFG_NONE;
+
+    // Children in reverse postorder
+    for (uint32_t r = 1; r < cfg->rpo_count; r++) {
+        blocks[blocks[cfg->rpo[r]].idom].child_count++;
+    }
+    for (uint32_t b = 0; b < n; b++) {
+        if (blocks[b].child_count == 0) continue;
+        blocks[b].children = (uint32_t*)ir_arena_alloc(arena, blocks[b].child_count * sizeof(uint32_t));
+        if (!blocks[b].children) return false;
+        blocks[b].child_count = 0;
+    }
+    for (uint32_t r = 1; r < cfg->rpo_count; r++) {
+        IRCFGBlock* parent = &blocks[blocks[cfg->rpo[r]].idom];
+        parent->children[parent->child_count++] = cfg->rpo[r];
+    }
+
+    // Number the dominator tree for constant-time dominance queries
+    uint32_t* stack = cfg_indices(arena, n);
+    uint32_t* next_child = cfg_zeroed(arena, n);
+    if (!stack || !next_child) return false;
+
+    uint32_t counter = 0;
+    uint32_t depth = 0;
+    stack[depth++] = entry;
+    blocks[entry].dom_pre = counter++;
+    while (depth > 0) {
+        uint32_t b = stack[depth - 1];
+        if (next_child[b] < blocks[b].child_count) {
+            uint32_t child = blocks[b].children[next_child[b]++];
+            blocks[child].dom_pre = counter++;
+            stack[depth++] = child;
+        } else {
+            blocks[b].dom_post = counter++;
+            depth--;
+        }
+    }
+
+    return true;
+}
+
+// ============================================================================
+// Loops
+// ============================================================================
+
+// A loop per block that is the target of a back edge (an edge from a block
+// it dominates). Headers are taken in reverse postorder, so a loop comes
+// after every loop containing it and each block ends up pointing at its
+// innermost loop.
+static bool find_loops(IRCFG* cfg, IRArena* arena) {
+    IRCFGBlock* blocks = cfg->blocks;
+    uint32_t n = cfg->block_count;
+
+    uint32_t header_count = 0;
+    for (uint32_t r = 0; r < cfg->rpo_count; r++) {
+        uint32_t h = cfg->rpo[r];
+        for (uint32_t p = 0; p < blocks[h].pred_count; p++) {
+            if (ir_cfg_dominates(cfg, h, blocks[h].preds[p])) {
+                header_count++;
+                break;
+            }
+        }
+    }
+    if (header_count == 0) return true;
+
+    cfg->loops = (IRLoop*)ir_arena_alloc(arena, header_count * sizeof(IRLoop));
+    uint32_t* in_loop = cfg_indices(arena, n);
+    uint32_t* worklist = cfg_indices(arena, n);
+    if (!cfg->loops || !in_loop || !worklist) return false;
+
+    for (uint32_t r = 0; r < cfg->rpo_count; r++) {
+        uint32_t h = cfg->rpo[r];
+        uint32_t l = cfg->loop_count;
+
+        // Walk backwards from the latches; the header stops the walk
+        uint32_t body_count = 1;
+        uint32_t last_rpo = r;
+        uint32_t pending = 0;
+        bool self_loop = false;
+        for (uint32_t p = 0; p < blocks[h].pred_count; p++) {
+            uint32_t latch = blocks[h].preds[p];
+            if (latch == h) {
+                self_loop = true;
+            } else if (ir_cfg_dominates(cfg, h, latch) && in_loop[latch] != l) {
+                in_loop[latch] = l;
+                worklist[pending++] = latch;
+            }
+        }
+        if (pending == 0 && !self_loop) continue;
+        in_loop[h] = l;
+
+        while (pending > 0) {
+            uint32_t b = worklist[--pending];
+            body_count++;
+            if (blocks[b].rpo > last_rpo) last_rpo = blocks[b].rpo;
+            for (uint32_t p = 0; p < blocks[b].pred_count; p++) {
+                uint32_t pred = blocks[b].preds[p];
+                if (in_loop[pred] == l) continue;
+                in_loop[pred] = l;
+                worklist[pending++] = pred;
+            }
+        }
+
+        IRLoop* loop = &cfg->loops[l];
+        loop->header = h;
+        loop->parent = blocks[h].loop;
+        loop->depth = loop->parent == IR_CFG_NONE ? 1 : cfg->loops[loop->parent].depth + 1;
+        loop->preheader = IR_CFG_NONE;
+        loop->block_count = 0;
+        loop->blocks = (uint32_t*)ir_arena_alloc(arena, body_count * sizeof(uint32_t));
+        if (!loop->blocks) return false;
+
+        // Every body block is dominated by the header, so it comes after it
+        // in reverse postorder
+        for (uint32_t i = r; i <= last_rpo; i++) {
+            uint32_t b = cfg->rpo[i];
+            if (in_loop[b] != l) continue;
+            loop->blocks[loop->block_count++] = b;
+            blocks[b].loop = l;
+        }
+        if (loop->depth > cfg->max_loop_depth) cfg->max_loop_depth = loop->depth;
+
+        uint32_t outside = IR_CFG_NONE;
+        uint32_t outside_count = 0;
+        for (uint32_t p = 0; p < blocks[h].pred_count; p++) {
+            if (in_loop[blocks[h].preds[p]] == l) continue;
+            outside = blocks[h].preds[p];
+            outside_count++;
+        }
+        if (outside_count == 1 && blocks[outside].succ_count == 1) {
+            loop->preheader = outside;
+        }
+        cfg->loop_count++;
+    }
+
+    return true;
+}
+
+// ============================================================================
+// Public Interface
+// ============================================================================
+
+static IRCFG* compute_cfg(FcxIRFunction* function, IRArena* arena) {
+    uint32_t n = function->block_count;
+    IRCFG* cfg = (IRCFG*)ir_arena_alloc(arena, sizeof(IRCFG));
+    if (!cfg) return NULL;
+    memset(cfg, 0, sizeof(IRCFG));
+
+    cfg->block_count = n;
+    if (n == 0) return cfg;
+
+    cfg->blocks = (IRCFGBlock*)ir_arena_alloc(arena, n * sizeof(IRCFGBlock));
+    if (!cfg->blocks) return NULL;
+    for (uint32_t b = 0; b < n; b++) {
+        IRCFGBlock* info = &cfg->blocks[b];
+        memset(info, 0, sizeof(IRCFGBlock));
+        info->rpo = IR_CFG_NONE;
+        info->idom = IR_CFG_NONE;
+        info->dom_pre = IR_CFG_NONE;
+        info->loop = IR_CFG_NONE;
+    }
+
+    if (!compute_edges(function, cfg, arena) ||
+        !compute_dominators(cfg, arena) ||
+        !find_loops(cfg, arena)) {
+        return NULL;
+    }
+    return cfg;
+}
+
+const IRCFG* ir_cfg_get(FcxIRFunction* function) {
+    if (!function) return NULL;
+    if (function->cfg) return function->cfg;
+
+    fcx_ir_invalidate_cfg(function);
+    if (!function->cfg_arena) function->cfg_arena = ir_arena_create();
+    if (!function->cfg_arena) return NULL;
+
+    function->cfg = compute_cfg(function, function->cfg_arena);
+    if (!function->cfg) {
+        fcx_ir_invalidate_cfg(function);
+        return NULL;
+    }
+    return function->cfg;
+}
+
+bool ir_cfg_loop_contains(const IRCFG* cfg, uint32_t l, uint32_t b) {
+    if (!cfg || b >= cfg->block_count) return false;
+
+    for (uint32_t inner = cfg->blocks[b].loop; inner != IR_CFG_NONE; inner = cfg->loops[inner].parent) {
+        if (inner == l) return true;
+    }
+    return false;
+}
+
+bool ir_cfg_update_edge_lists(FcxIRFunction* function) {
+    const IRCFG* cfg = ir_cfg_get(function);
+    if (!cfg) return false;
+
+    for (uint32_t b = 0; b < function->block_count; b++) {
+        function->blocks[b].successor_count = 0;
+        function->blocks[b].predecessor_count = 0;
+    }
+    for (uint32_t b = 0; b < function->block_count; b++) {
+        FcxIRBasicBlock* block = &function->blocks[b];
+        block->is_entry = (b == 0);
+        block->is_exit = block->instruction_count > 0 &&
+                         block->instructions[block->instruction_count - 1].opcode == FCXIR_RETURN;
+
+        for (uint32_t k = 0; k < cfg->blocks[b].succ_count; k++) {
+            FcxIRBasicBlock* succ = &function->blocks[cfg->blocks[b].succs[k]];
+            fcx_ir_block_add_successor(block, succ->id);
+            fcx_ir_block_add_predecessor(succ, block->id);
+        }
+    }
+    return true;
+}
+
+// Point every edge of block pred that goes to label old_label at new_label
+static void retarget_terminator(FcxIRBasicBlock* pred, uint32_t old_label, uint32_t new_label) {
+    for (uint32_t i = 0; i < pred->instruction_count; i++) {
+        FcxIRInstruction* term = &pred->instructions[i];
+        if (!fcx_ir_is_terminator(term)) continue;
+
+        if (term->opcode == FCXIR_JUMP && term->u.jump_op.label_id == old_label) {
+            term->u.jump_op.label_id = new_label;
+        } else if (term->opcode == FCXIR_BRANCH) {
+            if (term->u.branch_op.true_label == old_label) term->u.branch_op.true_label = new_label;
+            if (term->u.branch_op.false_label == old_label) term->u.branch_op.false_label = new_label;
+        }
+        return;
+    }
+}
+
+static void replace_edge(uint32_t* ids, uint32_t count, uint32_t old_id, uint32_t new_id) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (ids[i] == old_id) ids[i] = new_id;
+    }
+}
+
+bool ir_cfg_insert_preheaders(FcxIRFunction* function) {
+    const IRCFG* cfg = ir_cfg_get(function);
+    if (!cfg || cfg->loop_count == 0) return false;
+
+    // Collect the headers by id first: inserting a block shifts the indices
+    // and drops the analysis
+    uint32_t* headers = (uint32_t*)malloc(cfg->loop_count * sizeof(uint32_t));
+    uint32_t* entries = (uint32_t*)malloc(cfg->loop_count * sizeof(uint32_t));
+    if (!headers || !entries) {
+        free(headers);
+        free(entries);
+        return false;
+    }
+
+    uint32_t count = 0;
+    for (uint32_t l = 0; l < cfg->loop_count; l++) {
+        const IRLoop* loop = &cfg->loops[l];
+        const IRCFGBlock* header = &cfg->blocks[loop->header];
+        if (loop->preheader != IR_CFG_NONE || loop->header == 0) continue;
+
+        uint32_t outside = IR_CFG_NONE;
+        uint32_t outside_count = 0;
+        for (uint32_t p = 0; p < header->pred_count; p++) {
+            if (ir_cfg_loop_contains(cfg, l, header->preds[p])) continue;
+            outside = header->preds[p];
+            outside_count++;
+        }
+        if (outside_count != 1) continue;
+
+        headers[count] = function->blocks[loop->header].id;
+        entries[count] = function->blocks[outside].id;
+        count++;
+    }
+
+    uint32_t inserted = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t header_index = 0;
+        while (function->blocks[header_index].id != headers[i]) header_index++;
+
+        // A block from inside the loop that falls through into the header
+        // would fall into the preheader instead
+        const FcxIRBasicBlock* before = &function->blocks[header_index - 1];
+        if (before->id != entries[i] &&
+            (before->instruction_count == 0 ||
+             !fcx_ir_is_terminator(&before->instructions[before->instruction_count - 1]))) {
+            continue;
+        }
+
+        FcxIRBasicBlock* preheader = fcx_ir_block_insert(function, header_index, "preheader");
+        if (!preheader) break;
+        uint32_t preheader_id = preheader->id;
+        fcx_ir_build_jump(preheader, headers[i]);
+        fcx_ir_block_add_successor(preheader, headers[i]);
+        fcx_ir_block_add_predecessor(preheader, entries[i]);
+
+        FcxIRBasicBlock* header = &function->blocks[header_index + 1];
+        FcxIRBasicBlock* entry = fcx_ir_block_get_by_id(function, entries[i]);
+        retarget_terminator(entry, headers[i], preheader_id);
+        replace_edge(entry->successors, entry->successor_count, headers[i], preheader_id);
+        replace_edge(header->predecessors, header->predecessor_count, entries[i], preheader_id);
+
+        for (uint32_t k = 0; k < header->instruction_count; k++) {
+            FcxIRInstruction* phi = &header->instructions[k];
+            if (phi->opcode != FCXIR_PHI) break;
+            replace_edge(phi->u.phi_op.blocks, phi->u.phi_op.incoming_count, entries[i], preheader_id);
+        }
+        inserted++;
+    }
+
+    free(headers);
+    free(entries);
+    return inserted > 0;
+}
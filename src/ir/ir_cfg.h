@@ -0,0 +1,85 @@
+#ifndef IR_CFG_H
+#define IR_CFG_H
+
+#include "fcx_ir.h"
+#include <stdbool.h>
+
+// Control flow analysis for FCx IR
+// Successor and predecessor lists, reverse postorder, the dominator tree
+// (Cooper, Harvey and Kennedy) and the natural loop nest of a function,
+// computed on first use and cached on the function until the CFG changes.
+// Edges come from each block's terminator; a block without one falls
+// through to the next block. Everything is indexed by block index, not by
+// block id, and lives in function->cfg_arena.
+//
+// Creating a block drops the cached analysis. A pass that adds, rewrites or
+// removes terminators, or reorders blocks, must call fcx_ir_invalidate_cfg
+// itself before asking for the analysis again.
+
+#define IR_CFG_NONE UINT32_MAX
+
+typedef struct {
+    uint32_t* succs;         // Successor block indices, each once
+    uint32_t* preds;         // Predecessor block indices, each once
+    uint32_t succ_count;
+    uint32_t pred_count;
+
+    uint32_t rpo;            // Reverse postorder number, IR_CFG_NONE if unreachable
+    uint32_t idom;           // Immediate dominator; IR_CFG_NONE for the entry
+                             // and unreachable blocks
+    uint32_t* children;      // Dominator tree children
+    uint32_t child_count;
+    uint32_t dom_pre;        // Dominator tree interval, see ir_cfg_dominates
+    uint32_t dom_post;
+
+    uint32_t loop;           // Innermost loop containing the block, or IR_CFG_NONE
+} IRCFGBlock;
+
+// A natural loop: the header and every block that reaches a back edge to it
+// without passing through it
+typedef struct {
+    uint32_t header;
+    uint32_t parent;         // Enclosing loop, or IR_CFG_NONE
+    uint32_t depth;          // 1 for an outermost loop
+    uint32_t* blocks;        // Body in reverse postorder, header first
+    uint32_t block_count;
+    uint32_t preheader;      // Only predecessor of the header from outside the
+                             // loop, if it has no other successor; else IR_CFG_NONE
+} IRLoop;
+
+struct IRCFG {
+    IRCFGBlock* blocks;      // One per function block
+    uint32_t block_count;
+
+    uint32_t* rpo;           // Reachable block indices in reverse postorder
+    uint32_t rpo_count;
+
+    IRLoop* loops;           // Outer loops before the loops they contain
+    uint32_t loop_count;
+    uint32_t max_loop_depth;
+};
+
+// The function's analysis, computed if there is no cached one; NULL on OOM
+const IRCFG* ir_cfg_get(FcxIRFunction* function);
+
+// Whether block a dominates block b (both reachable); every block dominates itself
+static inline bool ir_cfg_dominates(const IRCFG* cfg, uint32_t a, uint32_t b) {
+    return cfg->blocks[a].dom_pre <= cfg->blocks[b].dom_pre &&
+           cfg->blocks[b].dom_post <= cfg->blocks[a].dom_post;
+}
+
+// Whether block b belongs to loop l or to a loop nested in it
+bool ir_cfg_loop_contains(const IRCFG* cfg, uint32_t l, uint32_t b);
+
+// Rewrites the blocks' successor and predecessor lists, is_entry and is_exit
+// from the analysis, for passes that changed the CFG. False on OOM.
+bool ir_cfg_update_edge_lists(FcxIRFunction* function);
+
+// Gives every loop whose header has exactly one predecessor from outside
+// the loop, and no preheader yet, an empty block that jumps to the header,
+// placed right before it. Phis in the header are retargeted and the blocks'
+// edge lists updated, so a reverse postorder layout and SSA form stay
+// intact. Returns true if blocks were inserted, which drops the analysis.
+bool ir_cfg_insert_preheaders(FcxIRFunction* function);
+
+#endif // IR_CFG_H
@@ -18,12 +18,14 @@ IRGenerator* ir_gen_create(const char* module_name) {
     gen->current_function = NULL;
     gen->current_block = NULL;
     
-    gen->symbol_table.names = NULL;
-    gen->symbol_table.vregs = NULL;
-    gen->symbol_table.is_global = NULL;
-    gen->symbol_table.global_index = NULL;
+    gen->symbol_table.innermost = NULL;
+    gen->symbol_table.innermost_capacity = 0;
+    gen->symbol_table.bindings = NULL;
     gen->symbol_table.count = 0;
     gen->symbol_table.capacity = 0;
+    gen->symbol_table.scope_marks = NULL;
+    gen->symbol_table.scope_depth = 0;
+    gen->symbol_table.scope_capacity = 0;
     
     gen->next_label_id = 1;
     gen->current_scope_id = 1;  // Start at scope 1 (0 is global)
@@ -47,13 +49,9 @@ void ir_gen_destroy(IRGenerator* gen) {
         fcx_ir_module_destroy(gen->module);
     }
     
-    for (size_t i = 0; i < gen->symbol_table.count; i++) {
-        free(gen->symbol_table.names[i]);
-    }
-    free(gen->symbol_table.names);
-    free(gen->symbol_table.vregs);
-    free(gen->symbol_table.is_global);
-    free(gen->symbol_table.global_index);
+    free(gen->symbol_table.innermost);
+    free(gen->symbol_table.bindings);
+    free(gen->symbol_table.scope_marks);
     
     // Free loop stack
     free(gen->loop_stack.break_targets);
@@ -70,47 +68,83 @@ void ir_gen_destroy(IRGenerator* gen) {
 // Symbol Table Management
 // ============================================================================
 
-static void ensure_symbol_table_capacity(IRGenerator* gen) {
+// Symbol names are interned (every AST name is), so each has a dense
+// InternId and `innermost` maps it straight to its innermost binding.
+// Bindings live on a stack, each remembering the one it shadowed, so leaving
+// a scope just pops its bindings and restores the shadowed ones. A lookup is
+// one array index; names are never hashed or compared here.
+
+// Innermost-binding entry for `name`. With `grow`, the map is extended to
+// cover the name's id; otherwise NULL for ids never bound.
+static int32_t* symbol_entry(IRGenerator* gen, const char* name, bool grow) {
+    InternId id = fcx_intern_id(name);
+    if (id >= gen->symbol_table.innermost_capacity) {
+        if (!grow) return NULL;
+        size_t old_capacity = gen->symbol_table.innermost_capacity;
+        size_t new_capacity = old_capacity == 0 ? 256 : old_capacity;
+        while (new_capacity <= id) {
+            new_capacity *= 2;
+        }
+        int32_t* new_map = (int32_t*)realloc(gen->symbol_table.innermost,
+                                             new_capacity * sizeof(int32_t));
+        if (!new_map) return NULL;
+        for (size_t i = old_capacity; i < new_capacity; i++) {
+            new_map[i] = -1;
+        }
+        gen->symbol_table.innermost = new_map;
+        gen->symbol_table.innermost_capacity = new_capacity;
+    }
+    return &gen->symbol_table.innermost[id];
+}
+
+// Innermost binding of `name`, or NULL
+static IRSymbolBinding* find_symbol(IRGenerator* gen, const char* name) {
+    int32_t* entry = symbol_entry(gen, name, false);
+    if (!entry || *entry < 0) return NULL;
+    return &gen->symbol_table.bindings[*entry];
+}
+
+static IRSymbolBinding* push_symbol(IRGenerator* gen, const char* name) {
+    int32_t* entry = symbol_entry(gen, name, true);
+    if (!entry) return NULL;
+
     if (gen->symbol_table.count >= gen->symbol_table.capacity) {
         size_t new_capacity = gen->symbol_table.capacity == 0 ? 16 : gen->symbol_table.capacity * 2;
-        
-        char** new_names = (char**)realloc(gen->symbol_table.names, new_capacity * sizeof(char*));
-        VirtualReg* new_vregs = (VirtualReg*)realloc(gen->symbol_table.vregs, new_capacity * sizeof(VirtualReg));
-        bool* new_is_global = (bool*)realloc(gen->symbol_table.is_global, new_capacity * sizeof(bool));
-        uint32_t* new_global_index = (uint32_t*)realloc(gen->symbol_table.global_index, new_capacity * sizeof(uint32_t));
-        
-        if (!new_names || !new_vregs || !new_is_global || !new_global_index) return;
-        
-        gen->symbol_table.names = new_names;
-        gen->symbol_table.vregs = new_vregs;
-        gen->symbol_table.is_global = new_is_global;
-        gen->symbol_table.global_index = new_global_index;
+        IRSymbolBinding* new_bindings = (IRSymbolBinding*)realloc(
+            gen->symbol_table.bindings, new_capacity * sizeof(IRSymbolBinding));
+        if (!new_bindings) return NULL;
+        gen->symbol_table.bindings = new_bindings;
         gen->symbol_table.capacity = new_capacity;
     }
+
+    size_t index = gen->symbol_table.count++;
+    IRSymbolBinding* binding = &gen->symbol_table.bindings[index];
+    binding->name = fcx_intern_id(name);
+    binding->shadowed = *entry;
+    binding->vreg = (VirtualReg){0};
+    binding->is_global = false;
+    binding->global_index = 0;
+    *entry = (int32_t)index;
+    return binding;
 }
 
 void ir_gen_add_symbol(IRGenerator* gen, const char* name, VirtualReg vreg) {
     if (!gen || !name) return;
     
-    ensure_symbol_table_capacity(gen);
-    
-    gen->symbol_table.names[gen->symbol_table.count] = strdup(name);
-    gen->symbol_table.vregs[gen->symbol_table.count] = vreg;
-    gen->symbol_table.is_global[gen->symbol_table.count] = false;
-    gen->symbol_table.global_index[gen->symbol_table.count] = 0;
-    gen->symbol_table.count++;
+    IRSymbolBinding* binding = push_symbol(gen, name);
+    if (binding) {
+        binding->vreg = vreg;
+    }
 }
 
 void ir_gen_add_global_symbol(IRGenerator* gen, const char* name, uint32_t global_index) {
     if (!gen || !name) return;
     
-    ensure_symbol_table_capacity(gen);
-    
-    gen->symbol_table.names[gen->symbol_table.count] = strdup(name);
-    gen->symbol_table.vregs[gen->symbol_table.count] = (VirtualReg){0};  // Not used for globals
-    gen->symbol_table.is_global[gen->symbol_table.count] = true;
-    gen->symbol_table.global_index[gen->symbol_table.count] = global_index;
-    gen->symbol_table.count++;
+    IRSymbolBinding* binding = push_symbol(gen, name);
+    if (binding) {
+        binding->is_global = true;
+        binding->global_index = global_index;
+    }
 }
 
 VirtualReg ir_gen_lookup_symbol(IRGenerator* gen, const char* name, bool* found) {
@@ -119,47 +153,32 @@ VirtualReg ir_gen_lookup_symbol(IRGenerator* gen, const char* name, bool* found)
     
     if (!gen || !name) return invalid;
     
-    for (size_t i = gen->symbol_table.count; i > 0; i--) {
-        if (strcmp(gen->symbol_table.names[i - 1], name) == 0) {
-            *found = true;
-            return gen->symbol_table.vregs[i - 1];
-        }
-    }
-    
-    return invalid;
+    IRSymbolBinding* binding = find_symbol(gen, name);
+    if (!binding) return invalid;
+    *found = true;
+    return binding->vreg;
 }
 
 bool ir_gen_is_global_symbol(IRGenerator* gen, const char* name, uint32_t* global_index) {
     if (!gen || !name) return false;
     
-    for (size_t i = gen->symbol_table.count; i > 0; i--) {
-        if (strcmp(gen->symbol_table.names[i - 1], name) == 0) {
-            if (gen->symbol_table.is_global[i - 1]) {
-                if (global_index) {
-                    *global_index = gen->symbol_table.global_index[i - 1];
-                }
-                return true;
-            }
-            return false;
-        }
+    // Only the innermost binding counts: a local shadows a global
+    IRSymbolBinding* binding = find_symbol(gen, name);
+    if (!binding || !binding->is_global) return false;
+    if (global_index) {
+        *global_index = binding->global_index;
     }
-    
-    return false;
+    return true;
 }
 
 // Update an existing symbol's vreg value
 bool ir_gen_update_symbol(IRGenerator* gen, const char* name, VirtualReg vreg) {
     if (!gen || !name) return false;
     
-    // Search from end to find most recent definition
-    for (size_t i = gen->symbol_table.count; i > 0; i--) {
-        if (strcmp(gen->symbol_table.names[i - 1], name) == 0) {
-            gen->symbol_table.vregs[i - 1] = vreg;
-            return true;
-        }
-    }
-    
-    return false;
+    IRSymbolBinding* binding = find_symbol(gen, name);
+    if (!binding) return false;
+    binding->vreg = vreg;
+    return true;
 }
 
 // ============================================================================
@@ -170,13 +189,32 @@ uint32_t ir_gen_alloc_label(IRGenerator* gen) {
     return gen->next_label_id++;
 }
 
-// Allocate a new scope ID for arena allocations
+// Allocate a new scope ID for arena allocations and open a symbol scope
 uint32_t ir_gen_enter_scope(IRGenerator* gen) {
+    if (gen->symbol_table.scope_depth >= gen->symbol_table.scope_capacity) {
+        size_t new_capacity = gen->symbol_table.scope_capacity == 0 ? 8 : gen->symbol_table.scope_capacity * 2;
+        size_t* new_marks = (size_t*)realloc(gen->symbol_table.scope_marks,
+                                             new_capacity * sizeof(size_t));
+        if (new_marks) {
+            gen->symbol_table.scope_marks = new_marks;
+            gen->symbol_table.scope_capacity = new_capacity;
+        }
+    }
+    if (gen->symbol_table.scope_depth < gen->symbol_table.scope_capacity) {
+        gen->symbol_table.scope_marks[gen->symbol_table.scope_depth++] = gen->symbol_table.count;
+    }
     return ++gen->current_scope_id;
 }
 
-// Exit current scope
+// Exit current scope, dropping its symbols and unshadowing outer ones
 void ir_gen_exit_scope(IRGenerator* gen) {
+    if (gen->symbol_table.scope_depth > 0) {
+        size_t mark = gen->symbol_table.scope_marks[--gen->symbol_table.scope_depth];
+        while (gen->symbol_table.count > mark) {
+            IRSymbolBinding* binding = &gen->symbol_table.bindings[--gen->symbol_table.count];
+            gen->symbol_table.innermost[binding->name] = binding->shadowed;
+        }
+    }
     if (gen->current_scope_id > 1) {
         gen->current_scope_id--;
     }
@@ -483,16 +521,7 @@ VirtualReg ir_gen_desugar_memory_op(IRGenerator* gen, Expr* expr) {
             instr.operand_count = 1;
             instr.u.unary_op.src = ptr;
             // Add instruction manually since we don't have a builder for dealloc
-            if (gen->current_block->instruction_count >= gen->current_block->instruction_capacity) {
-                uint32_t new_capacity = gen->current_block->instruction_capacity == 0 ? 16 : gen->current_block->instruction_capacity * 2;
-                FcxIRInstruction* new_instructions = (FcxIRInstruction*)realloc(
-                    gen->current_block->instructions, new_capacity * sizeof(FcxIRInstruction));
-                if (new_instructions) {
-                    gen->current_block->instructions = new_instructions;
-                    gen->current_block->instruction_capacity = new_capacity;
-                }
-            }
-            gen->current_block->instructions[gen->current_block->instruction_count++] = instr;
+            fcx_ir_block_append(gen->current_block, &instr);
             result = ptr;
             break;
         }
@@ -507,16 +536,7 @@ VirtualReg ir_gen_desugar_memory_op(IRGenerator* gen, Expr* expr) {
             instr.u.alloc_op.dest = result;
             instr.u.alloc_op.size = size;
             // Add instruction manually
-            if (gen->current_block->instruction_count >= gen->current_block->instruction_capacity) {
-                uint32_t new_capacity = gen->current_block->instruction_capacity == 0 ? 16 : gen->current_block->instruction_capacity * 2;
-                FcxIRInstruction* new_instructions = (FcxIRInstruction*)realloc(
-                    gen->current_block->instructions, new_capacity * sizeof(FcxIRInstruction));
-                if (new_instructions) {
-                    gen->current_block->instructions = new_instructions;
-                    gen->current_block->instruction_capacity = new_capacity;
-                }
-            }
-            gen->current_block->instructions[gen->current_block->instruction_count++] = instr;
+            fcx_ir_block_append(gen->current_block, &instr);
             break;
         }
         
@@ -581,16 +601,7 @@ VirtualReg ir_gen_desugar_memory_op(IRGenerator* gen, Expr* expr) {
             instr.operand_count = 1;
             instr.u.arena_op.scope_id = scope_id;
             // Add instruction
-            if (gen->current_block->instruction_count >= gen->current_block->instruction_capacity) {
-                uint32_t new_capacity = gen->current_block->instruction_capacity == 0 ? 16 : gen->current_block->instruction_capacity * 2;
-                FcxIRInstruction* new_instructions = (FcxIRInstruction*)realloc(
-                    gen->current_block->instructions, new_capacity * sizeof(FcxIRInstruction));
-                if (new_instructions) {
-                    gen->current_block->instructions = new_instructions;
-                    gen->current_block->instruction_capacity = new_capacity;
-                }
-            }
-            gen->current_block->instructions[gen->current_block->instruction_count++] = instr;
+            fcx_ir_block_append(gen->current_block, &instr);
             break;
         }
         
@@ -608,16 +619,7 @@ VirtualReg ir_gen_desugar_memory_op(IRGenerator* gen, Expr* expr) {
             instr.u.slab_op.ptr = ptr;
             instr.u.slab_op.type_hash = type_hash;
             // Add instruction
-            if (gen->current_block->instruction_count >= gen->current_block->instruction_capacity) {
-                uint32_t new_capacity = gen->current_block->instruction_capacity == 0 ? 16 : gen->current_block->instruction_capacity * 2;
-                FcxIRInstruction* new_instructions = (FcxIRInstruction*)realloc(
-                    gen->current_block->instructions, new_capacity * sizeof(FcxIRInstruction));
-                if (new_instructions) {
-                    gen->current_block->instructions = new_instructions;
-                    gen->current_block->instruction_capacity = new_capacity;
-                }
-            }
-            gen->current_block->instructions[gen->current_block->instruction_count++] = instr;
+            fcx_ir_block_append(gen->current_block, &instr);
             result = ptr;
             break;
         }
@@ -694,16 +696,7 @@ VirtualReg ir_gen_desugar_memory_op(IRGenerator* gen, Expr* expr) {
             instr.u.unary_op.src = ptr;
             instr.u.unary_op.dest = result;
             // Add instruction
-            if (gen->current_block->instruction_count >= gen->current_block->instruction_capacity) {
-                uint32_t new_capacity = gen->current_block->instruction_capacity == 0 ? 16 : gen->current_block->instruction_capacity * 2;
-                FcxIRInstruction* new_instructions = (FcxIRInstruction*)realloc(
-                    gen->current_block->instructions, new_capacity * sizeof(FcxIRInstruction));
-                if (new_instructions) {
-                    gen->current_block->instructions = new_instructions;
-                    gen->current_block->instruction_capacity = new_capacity;
-                }
-            }
-            gen->current_block->instructions[gen->current_block->instruction_count++] = instr;
+            fcx_ir_block_append(gen->current_block, &instr);
             result = ptr;
             break;
         }
@@ -717,16 +710,7 @@ VirtualReg ir_gen_desugar_memory_op(IRGenerator* gen, Expr* expr) {
             instr.u.unary_op.src = ptr;
             instr.u.unary_op.dest = result;
             // Add instruction
-            if (gen->current_block->instruction_count >= gen->current_block->instruction_capacity) {
-                uint32_t new_capacity = gen->current_block->instruction_capacity == 0 ? 16 : gen->current_block->instruction_capacity * 2;
-                FcxIRInstruction* new_instructions = (FcxIRInstruction*)realloc(
-                    gen->current_block->instructions, new_capacity * sizeof(FcxIRInstruction));
-                if (new_instructions) {
-                    gen->current_block->instructions = new_instructions;
-                    gen->current_block->instruction_capacity = new_capacity;
-                }
-            }
-            gen->current_block->instructions[gen->current_block->instruction_count++] = instr;
+            fcx_ir_block_append(gen->current_block, &instr);
             result = ptr;
             break;
         }
@@ -994,7 +978,7 @@ VirtualReg ir_gen_generate_expression(IRGenerator* gen, Expr* expr) {
                 
                 case LIT_BIGINT: {
                     // Bigint literal - use limb-based constant builder
-                    fcx_ir_build_const_bigint(gen->current_block, result, 
+                    fcx_ir_build_const_bigint(gen->current_function, gen->current_block, result,
                                               expr->data.literal.value.bigint.limbs,
                                               expr->data.literal.value.bigint.num_limbs);
                     break;
@@ -1024,16 +1008,7 @@ VirtualReg ir_gen_generate_expression(IRGenerator* gen, Expr* expr) {
                 instr.u.global_op.global_index = global_index;
                 
                 // Add instruction to current block
-                if (gen->current_block->instruction_count >= gen->current_block->instruction_capacity) {
-                    uint32_t new_capacity = gen->current_block->instruction_capacity == 0 ? 16 : gen->current_block->instruction_capacity * 2;
-                    FcxIRInstruction* new_instructions = (FcxIRInstruction*)realloc(
-                        gen->current_block->instructions, new_capacity * sizeof(FcxIRInstruction));
-                    if (new_instructions) {
-                        gen->current_block->instructions = new_instructions;
-                        gen->current_block->instruction_capacity = new_capacity;
-                    }
-                }
-                gen->current_block->instructions[gen->current_block->instruction_count++] = instr;
+                fcx_ir_block_append(gen->current_block, &instr);
                 
                 return result;
             }
@@ -1249,23 +1224,21 @@ VirtualReg ir_gen_generate_expression(IRGenerator* gen, Expr* expr) {
             
             // Then block
             gen->current_block = fcx_ir_block_get_by_id(gen->current_function, then_label);
+            // Both arms write the result; SSA construction turns it into a phi
             VirtualReg then_val = ir_gen_generate_expression(gen, expr->data.ternary.second);
+            VirtualReg result = ir_gen_alloc_temp(gen, then_val.type);
+            fcx_ir_build_mov(gen->current_block, result, then_val);
             fcx_ir_build_jump(gen->current_block, merge_label);
             
             // Else block
             gen->current_block = fcx_ir_block_get_by_id(gen->current_function, else_label);
             VirtualReg else_val = ir_gen_generate_expression(gen, expr->data.ternary.third);
-            (void)else_val;  // Suppress unused warning - used in PHI node in full SSA
+            fcx_ir_build_mov(gen->current_block, result, else_val);
             fcx_ir_build_jump(gen->current_block, merge_label);
             
             // Merge block
             gen->current_block = fcx_ir_block_get_by_id(gen->current_function, merge_label);
             
-            // For proper SSA, we need a PHI node. Since we don't have full PHI support,
-            // we use a stack slot to hold the result from both branches.
-            VirtualReg result = ir_gen_alloc_temp(gen, then_val.type);
-            fcx_ir_build_mov(gen->current_block, result, then_val);
-            
             return result;
         }
         
@@ -1317,16 +1290,7 @@ VirtualReg ir_gen_generate_expression(IRGenerator* gen, Expr* expr) {
                     instr.u.global_op.global_index = global_index;
                     
                     // Add instruction to current block
-                    if (gen->current_block->instruction_count >= gen->current_block->instruction_capacity) {
-                        uint32_t new_capacity = gen->current_block->instruction_capacity == 0 ? 16 : gen->current_block->instruction_capacity * 2;
-                        FcxIRInstruction* new_instructions = (FcxIRInstruction*)realloc(
-                            gen->current_block->instructions, new_capacity * sizeof(FcxIRInstruction));
-                        if (new_instructions) {
-                            gen->current_block->instructions = new_instructions;
-                            gen->current_block->instruction_capacity = new_capacity;
-                        }
-                    }
-                    gen->current_block->instructions[gen->current_block->instruction_count++] = instr;
+                    fcx_ir_block_append(gen->current_block, &instr);
                     
                     return value;
                 }
@@ -1429,22 +1393,21 @@ VirtualReg ir_gen_generate_expression(IRGenerator* gen, Expr* expr) {
             
             // Then block
             gen->current_block = fcx_ir_block_get_by_id(gen->current_function, then_label);
+            // Both arms write the result; SSA construction turns it into a phi
             VirtualReg then_val = ir_gen_generate_expression(gen, expr->data.conditional.then_expr);
+            VirtualReg result = ir_gen_alloc_temp(gen, then_val.type);
+            fcx_ir_build_mov(gen->current_block, result, then_val);
             fcx_ir_build_jump(gen->current_block, merge_label);
             
             // Else block
             gen->current_block = fcx_ir_block_get_by_id(gen->current_function, else_label);
             VirtualReg else_val = ir_gen_generate_expression(gen, expr->data.conditional.else_expr);
-            (void)else_val;  // Suppress unused warning - used in PHI node in full SSA
+            fcx_ir_build_mov(gen->current_block, result, else_val);
             fcx_ir_build_jump(gen->current_block, merge_label);
             
-            // Merge block with PHI
+            // Merge block
             gen->current_block = fcx_ir_block_get_by_id(gen->current_function, merge_label);
             
-            // For proper SSA, we need a PHI node. Using simplified approach:
-            VirtualReg result = ir_gen_alloc_temp(gen, then_val.type);
-            fcx_ir_build_mov(gen->current_block, result, then_val);
-            
             return result;
         }
         
@@ -1507,11 +1470,11 @@ VirtualReg ir_gen_generate_expression(IRGenerator* gen, Expr* expr) {
             // Inline assembly: asm% "template" : outputs : inputs : clobbers
             // Generate input values
             VirtualReg* inputs = NULL;
-            if (expr->data.inline_asm.input_count > 0) {
-                inputs = malloc(expr->data.inline_asm.input_count * sizeof(VirtualReg));
-                for (size_t i = 0; i < expr->data.inline_asm.input_count; i++) {
-                    if (expr->data.inline_asm.input_exprs[i]) {
-                        inputs[i] = ir_gen_generate_expression(gen, expr->data.inline_asm.input_exprs[i]);
+            if (expr->data.inline_asm->input_count > 0) {
+                inputs = malloc(expr->data.inline_asm->input_count * sizeof(VirtualReg));
+                for (size_t i = 0; i < expr->data.inline_asm->input_count; i++) {
+                    if (expr->data.inline_asm->input_exprs[i]) {
+                        inputs[i] = ir_gen_generate_expression(gen, expr->data.inline_asm->input_exprs[i]);
                     } else {
                         inputs[i] = (VirtualReg){0};
                     }
@@ -1521,9 +1484,9 @@ VirtualReg ir_gen_generate_expression(IRGenerator* gen, Expr* expr) {
             // Allocate output registers
             VirtualReg* outputs = NULL;
             VirtualReg result = {0};
-            if (expr->data.inline_asm.output_count > 0) {
-                outputs = malloc(expr->data.inline_asm.output_count * sizeof(VirtualReg));
-                for (size_t i = 0; i < expr->data.inline_asm.output_count; i++) {
+            if (expr->data.inline_asm->output_count > 0) {
+                outputs = malloc(expr->data.inline_asm->output_count * sizeof(VirtualReg));
+                for (size_t i = 0; i < expr->data.inline_asm->output_count; i++) {
                     outputs[i] = ir_gen_alloc_temp(gen, VREG_TYPE_I64);
                 }
                 result = outputs[0]; // First output is the result
@@ -1533,21 +1496,21 @@ VirtualReg ir_gen_generate_expression(IRGenerator* gen, Expr* expr) {
             
             // Build inline asm instruction
             fcx_ir_build_inline_asm(gen->current_block,
-                                    expr->data.inline_asm.asm_template,
-                                    (const char**)expr->data.inline_asm.output_constraints,
+                                    expr->data.inline_asm->asm_template,
+                                    (const char**)expr->data.inline_asm->output_constraints,
                                     outputs,
-                                    (uint8_t)expr->data.inline_asm.output_count,
-                                    (const char**)expr->data.inline_asm.input_constraints,
+                                    (uint8_t)expr->data.inline_asm->output_count,
+                                    (const char**)expr->data.inline_asm->input_constraints,
                                     inputs,
-                                    (uint8_t)expr->data.inline_asm.input_count,
-                                    (const char**)expr->data.inline_asm.clobbers,
-                                    (uint8_t)expr->data.inline_asm.clobber_count,
-                                    expr->data.inline_asm.is_volatile);
+                                    (uint8_t)expr->data.inline_asm->input_count,
+                                    (const char**)expr->data.inline_asm->clobbers,
+                                    (uint8_t)expr->data.inline_asm->clobber_count,
+                                    expr->data.inline_asm->is_volatile);
             
             // Store outputs back to their target variables
-            for (size_t i = 0; i < expr->data.inline_asm.output_count; i++) {
-                if (expr->data.inline_asm.output_exprs && expr->data.inline_asm.output_exprs[i]) {
-                    Expr* out_expr = expr->data.inline_asm.output_exprs[i];
+            for (size_t i = 0; i < expr->data.inline_asm->output_count; i++) {
+                if (expr->data.inline_asm->output_exprs && expr->data.inline_asm->output_exprs[i]) {
+                    Expr* out_expr = expr->data.inline_asm->output_exprs[i];
                     if (out_expr->type == EXPR_IDENTIFIER) {
                         // Look up the variable and copy the output to it
                         const char* var_name = out_expr->data.identifier;
@@ -1561,6 +1524,8 @@ VirtualReg ir_gen_generate_expression(IRGenerator* gen, Expr* expr) {
                 }
             }
             
+            free(inputs);
+            free(outputs);
             return result;
         }
             
@@ -2041,8 +2006,9 @@ bool ir_gen_generate_function(IRGenerator* gen, Stmt* func_stmt) {
         return false;
     }
     
-    // Map return type from function declaration
-    VRegType return_type = VREG_TYPE_I32;  // Default to i32
+    // Map return type from function declaration; unannotated functions
+    // return the full 64-bit rax their callers read
+    VRegType return_type = VREG_TYPE_I64;
     if (func_stmt->data.function.return_type) {
         return_type = ir_gen_map_type_kind(func_stmt->data.function.return_type->kind);
     }
@@ -2062,7 +2028,8 @@ bool ir_gen_generate_function(IRGenerator* gen, Stmt* func_stmt) {
     // Allocate parameter array if there are parameters
     if (func_stmt->data.function.param_count > 0) {
         gen->current_function->parameter_count = (uint8_t)func_stmt->data.function.param_count;
-        gen->current_function->parameters = malloc(func_stmt->data.function.param_count * sizeof(VirtualReg));
+        gen->current_function->parameters = ir_arena_alloc(gen->current_function->arena,
+                                                           func_stmt->data.function.param_count * sizeof(VirtualReg));
     }
     
     // Add function parameters to symbol table
@@ -2085,6 +2052,10 @@ bool ir_gen_generate_function(IRGenerator* gen, Stmt* func_stmt) {
     for (size_t i = 0; i < func_stmt->data.function.body.count; i++) {
         if (!ir_gen_generate_statement(gen, func_stmt->data.function.body.statements[i])) {
             ir_gen_exit_scope(gen);
+            fcx_ir_function_destroy(gen->current_function);
+            free(gen->current_function);
+            gen->current_function = NULL;
+            gen->current_block = NULL;
             return false;
         }
     }
@@ -2092,9 +2063,12 @@ bool ir_gen_generate_function(IRGenerator* gen, Stmt* func_stmt) {
     // Exit function scope
     ir_gen_exit_scope(gen);
     
-    // Add function to module
+    // Add function to module; the module keeps a copy of the struct
     fcx_ir_module_add_function(gen->module, gen->current_function);
-    
+    free(gen->current_function);
+    gen->current_function = NULL;
+    gen->current_block = NULL;
+
     return !gen->has_error;
 }
 
@@ -2123,7 +2097,7 @@ bool ir_gen_generate_module(IRGenerator* gen, Stmt** statements, size_t stmt_cou
                 
                 uint32_t global_index = gen->module->global_count;
                 FcxIRGlobal* global = &gen->module->globals[gen->module->global_count++];
-                global->name = strdup(name);
+                global->name = name;
                 global->vreg = (VirtualReg){0};  // Not used - globals are accessed by name
                 global->type = VREG_TYPE_I64;
                 global->is_const = stmt->data.let.is_const;
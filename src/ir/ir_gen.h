@@ -4,20 +4,32 @@
 #include "fcx_ir.h"
 #include "../parser/parser.h"
 
+// One binding of a name. The binding stack doubles as the undo log: popping
+// a binding restores the one it shadowed.
+typedef struct {
+    InternId name;          // Name this binding belongs to
+    int32_t shadowed;       // Binding hidden by this one, -1 if none
+    VirtualReg vreg;
+    bool is_global;         // Track if symbol is a global variable
+    uint32_t global_index;  // Index into module->globals for global vars
+} IRSymbolBinding;
+
 // IR Generator context
 typedef struct {
     FcxIRModule* module;
     FcxIRFunction* current_function;
     FcxIRBasicBlock* current_block;
     
-    // Symbol table for variable to vreg mapping
+    // Scoped symbol table for variable to vreg mapping
     struct {
-        char** names;
-        VirtualReg* vregs;
-        bool* is_global;        // Track if symbol is a global variable
-        uint32_t* global_index; // Index into module->globals for global vars
+        int32_t* innermost;         // Per InternId: innermost binding, -1 if none
+        size_t innermost_capacity;
+        IRSymbolBinding* bindings;  // Stack of live bindings, innermost last
         size_t count;
         size_t capacity;
+        size_t* scope_marks;        // Binding count at each ir_gen_enter_scope
+        size_t scope_depth;
+        size_t scope_capacity;
     } symbol_table;
     
     // Label management
@@ -55,7 +67,7 @@ VirtualReg ir_gen_desugar_syscall(IRGenerator* gen, Expr* expr);
 VirtualReg ir_gen_desugar_atomic_op(IRGenerator* gen, Expr* expr);
 VirtualReg ir_gen_desugar_memory_op(IRGenerator* gen, Expr* expr);
 
-// Symbol table management
+// Symbol table management (names must be interned, as AST names are)
 void ir_gen_add_symbol(IRGenerator* gen, const char* name, VirtualReg vreg);
 void ir_gen_add_global_symbol(IRGenerator* gen, const char* name, uint32_t global_index);
 VirtualReg ir_gen_lookup_symbol(IRGenerator* gen, const char* name, bool* found);
@@ -0,0 +1,111 @@
+// IR generation symbol table benchmark
+// Generates functions with thousands of locals, each initialised from the
+// previous ones, and times ir_gen_generate_module on the parsed AST. Symbol
+// lookups used to scan every binding with strcmp, making IR generation
+// quadratic in the number of locals; time per local should now stay flat.
+// Usage: ir_gen_bench [max_locals]
+
+#include "ir_gen.h"
+#include "../bench_source.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Four functions of `locals` locals each. Later functions reuse the names of
+// earlier ones so scope exit is exercised as well.
+static char *generate_source(size_t locals, size_t *out_size) {
+  size_t capacity = 4 * (locals + 4) * 96 + 256;
+  char *source = malloc(capacity);
+  if (!source) {
+    return NULL;
+  }
+
+  size_t size = 0;
+  for (size_t f = 0; f < 4; f++) {
+    size += (size_t)snprintf(source + size, capacity - size,
+                             "fn many_locals_%zu(seed) -> i64 {\n"
+                             "    let local_variable_0 := seed\n",
+                             f);
+    for (size_t i = 1; i < locals; i++) {
+      size += (size_t)snprintf(
+          source + size, capacity - size,
+          "    let local_variable_%zu := local_variable_%zu + "
+          "local_variable_%zu\n",
+          i, i - 1, i / 2);
+    }
+    size += (size_t)snprintf(source + size, capacity - size,
+                             "    ret local_variable_%zu\n}\n\n", locals - 1);
+  }
+  *out_size = size;
+  return source;
+}
+
+static bool run_benchmark(size_t locals) {
+  size_t size = 0;
+  char *source = generate_source(locals, &size);
+  if (!source) {
+    fprintf(stderr, "Error: Failed to allocate benchmark source\n");
+    return false;
+  }
+
+  TokenBuffer tokens;
+  if (!token_buffer_fill(&tokens, source)) {
+    fprintf(stderr, "Error: Failed to lex benchmark source\n");
+    free(source);
+    return false;
+  }
+  Parser parser;
+  parser_init_tokens(&parser, &tokens);
+  Stmt **statements = NULL;
+  size_t stmt_count = 0;
+  bool ok = parse_program(&parser, 1, &statements, &stmt_count);
+
+  double elapsed = 0.0;
+  uint32_t instructions = 0;
+  if (ok) {
+    IRGenerator *gen = ir_gen_create("bench_module");
+    double start = now_seconds();
+    ok = gen && ir_gen_generate_module(gen, statements, stmt_count);
+    elapsed = now_seconds() - start;
+
+    for (uint32_t f = 0; ok && f < gen->module->function_count; f++) {
+      FcxIRFunction *function = &gen->module->functions[f];
+      for (uint32_t b = 0; b < function->block_count; b++) {
+        instructions += function->blocks[b].instruction_count;
+      }
+    }
+    ir_gen_destroy(gen);
+  }
+
+  size_t references = 4 * (2 * locals);
+  printf("%7zu locals/fn  %9zu refs  %8u instrs  %9.4f s  %8.1f ns/ref%s\n",
+         locals, references, instructions, elapsed,
+         elapsed * 1e9 / (double)references, ok ? "" : "  (failed)");
+
+  free(statements);
+  parser_destroy(&parser);
+  token_buffer_destroy(&tokens);
+  free(source);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  size_t max_locals = 16000;
+  if (argc > 1) {
+    max_locals = (size_t)strtoul(argv[1], NULL, 10);
+    if (max_locals < 1000) {
+      max_locals = 1000;
+    }
+  }
+
+  init_operator_registry();
+  printf("=== FCx IR Generation Symbol Table Benchmark ===\n");
+  for (size_t locals = 1000; locals <= max_locals; locals *= 2) {
+    if (!run_benchmark(locals)) {
+      break;
+    }
+  }
+  cleanup_operator_registry();
+  return 0;
+}
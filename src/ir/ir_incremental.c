@@ -0,0 +1,539 @@
+#define _POSIX_C_SOURCE 200809L
+#include "ir_incremental.h"
+#include "../lexer/lexer_simd.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Chunks
+// ============================================================================
+
+// Text, tokens and AST nodes of one re-lexed window. Every item cut from the
+// window points into it; it is released with the last of them.
+struct IncrementalChunk {
+    char* text;
+    TokenBuffer tokens;
+    AstArena* arena;
+    size_t refs;
+};
+
+static void chunk_destroy(IncrementalChunk* chunk) {
+    token_buffer_destroy(&chunk->tokens);
+    ast_arena_destroy(chunk->arena);
+    free(chunk->text);
+    free(chunk);
+}
+
+static void chunk_release(IncrementalChunk* chunk) {
+    if (chunk && --chunk->refs == 0) {
+        chunk_destroy(chunk);
+    }
+}
+
+// Lex bytes [start, end) of the current source, keeping line and column
+// numbers of the whole file
+static IncrementalChunk* chunk_lex(const IncrementalFrontend* frontend, size_t start, size_t end) {
+    IncrementalChunk* chunk = calloc(1, sizeof(IncrementalChunk));
+    if (!chunk) return NULL;
+
+    chunk->text = malloc(end - start + 1);
+    chunk->arena = ast_arena_create();
+    if (!chunk->text || !chunk->arena) {
+        ast_arena_destroy(chunk->arena);
+        free(chunk->text);
+        free(chunk);
+        return NULL;
+    }
+    memcpy(chunk->text, frontend->source + start, end - start);
+    chunk->text[end - start] = '\0';
+
+    const char* window = frontend->source + start;
+    const char* last_newline = NULL;
+    size_t line = 1 + lexer_count_newlines(frontend->source, window, &last_newline);
+    size_t column = last_newline ? (size_t)(window - last_newline) : start + 1;
+    if (!token_buffer_fill_at(&chunk->tokens, chunk->text, line, column)) {
+        ast_arena_destroy(chunk->arena);
+        free(chunk->text);
+        free(chunk);
+        return NULL;
+    }
+    return chunk;
+}
+
+// The window must start a top-level item unless it starts the file
+static bool window_starts_item(const TokenBuffer* tokens) {
+    TokenKind first = (TokenKind)tokens->tokens[0].kind;
+    return first == KW_FN ||
+           (first == KW_PUB && tokens->count > 2 && tokens->tokens[1].kind == KW_FN);
+}
+
+// Comments after the last token must be closed inside the window. The lexer
+// lets a block comment run to the end of its input, so without this check a
+// window could swallow part of the next item without noticing.
+static bool trailing_comments_closed(const char* p) {
+    for (;;) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+        if (p[0] == '/' && p[1] == '/') {
+            p = strchr(p, '\n');
+            if (!p) return false;
+        } else if (p[0] == '/' && p[1] == '*') {
+            p = strstr(p + 2, "*/");
+            if (!p) return false;
+            p += 2;
+        } else {
+            return *p == '\0';
+        }
+    }
+}
+
+// The item after the window must still start an item: the window has to end
+// at brace depth 0 on a `;` or `}`, outside any token or comment
+static bool window_ends_on_boundary(const TokenBuffer* tokens) {
+    if (tokens->had_error || tokens->count < 2) {
+        return false;
+    }
+    size_t depth = 0;
+    for (size_t i = 0; i + 1 < tokens->count; i++) {
+        TokenKind kind = (TokenKind)tokens->tokens[i].kind;
+        if (kind == TOK_LBRACE) {
+            depth++;
+        } else if (kind == TOK_RBRACE && depth > 0) {
+            depth--;
+        }
+    }
+    const CompactToken* last = &tokens->tokens[tokens->count - 2];
+    return depth == 0 && (last->kind == TOK_SEMICOLON || last->kind == TOK_RBRACE) &&
+           trailing_comments_closed(tokens->source + last->offset + last->length);
+}
+
+// ============================================================================
+// Items
+// ============================================================================
+
+static void item_clear_ir(IncrementalItem* item) {
+    for (size_t i = 0; i < item->function_count; i++) {
+        fcx_ir_function_destroy(&item->functions[i]);
+    }
+    free(item->functions);
+    item->functions = NULL;
+    item->function_count = 0;
+    item->ir_ready = false;
+}
+
+static void item_clear(IncrementalItem* item) {
+    item_clear_ir(item);
+    for (size_t i = 0; i < item->stmt_count; i++) {
+        free_stmt(item->statements[i]);
+    }
+    free(item->statements);
+    chunk_release(item->chunk);
+    memset(item, 0, sizeof(*item));
+}
+
+// Top-level lets become module globals that every function can see
+static bool item_defines_globals(const IncrementalItem* item) {
+    for (size_t i = 0; i < item->stmt_count; i++) {
+        if (item->statements[i]->type == STMT_LET) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool item_parse(const IncrementalFrontend* frontend, IncrementalItem* item) {
+    Parser parser;
+    parser_init_token_range(&parser, &item->chunk->tokens, item->token_begin,
+                            item->token_end, item->chunk->arena);
+    parser.quiet = frontend->quiet;
+    parser.disallow_ambiguous_ops = frontend->disallow_ambiguous_ops;
+    parser.strict_parsing = frontend->strict_parsing;
+
+    // Errors the parser recovered from count as failures too
+    bool ok = parse_program(&parser, 1, &item->statements, &item->stmt_count) &&
+              !parser.had_error;
+    parser_destroy(&parser);
+    if (!ok) {
+        for (size_t i = 0; i < item->stmt_count; i++) {
+            free_stmt(item->statements[i]);
+        }
+        free(item->statements);
+        item->statements = NULL;
+        item->stmt_count = 0;
+    }
+    item->failed = !ok;
+    return ok;
+}
+
+// Last item starting at or before `offset`
+static size_t find_item(const IncrementalFrontend* frontend, size_t offset) {
+    size_t low = 0;
+    size_t high = frontend->item_count;
+    while (high - low > 1) {
+        size_t mid = low + (high - low) / 2;
+        if (frontend->items[mid].start <= offset) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Replace items [first, last) with the items of `chunk`, which holds the new
+// source bytes from `start` on. Items after the window move by `delta`.
+static bool splice_window(IncrementalFrontend* frontend, IncrementalChunk* chunk, size_t first,
+                          size_t last, size_t start, ptrdiff_t delta, bool* globals_changed) {
+    size_t token_count = chunk->tokens.count - 1; // Without the EOF
+    size_t* starts = NULL;
+    size_t piece_count =
+        parser_split_top_level_items(&chunk->tokens, 0, token_count, &starts);
+    if (piece_count == 0) {
+        chunk_destroy(chunk);
+        return false;
+    }
+
+    size_t new_count = frontend->item_count - (last - first) + piece_count;
+    if (new_count > frontend->item_capacity) {
+        size_t capacity = frontend->item_capacity ? frontend->item_capacity * 2 : 64;
+        while (capacity < new_count) capacity *= 2;
+        IncrementalItem* items = realloc(frontend->items, capacity * sizeof(IncrementalItem));
+        if (!items) {
+            free(starts);
+            chunk_destroy(chunk);
+            return false;
+        }
+        frontend->items = items;
+        frontend->item_capacity = capacity;
+    }
+
+    for (size_t i = first; i < last; i++) {
+        IncrementalItem* item = &frontend->items[i];
+        *globals_changed |= item_defines_globals(item);
+        frontend->failed_count -= item->failed;
+        item_clear(item);
+    }
+    memmove(&frontend->items[first + piece_count], &frontend->items[last],
+            (frontend->item_count - last) * sizeof(IncrementalItem));
+    frontend->item_count = new_count;
+    for (size_t i = first + piece_count; i < new_count; i++) {
+        frontend->items[i].start = (size_t)((ptrdiff_t)frontend->items[i].start + delta);
+    }
+
+    // The first piece also owns any leading whitespace of the window
+    bool ok = true;
+    for (size_t p = 0; p < piece_count; p++) {
+        IncrementalItem* item = &frontend->items[first + p];
+        memset(item, 0, sizeof(*item));
+        item->start = p == 0 ? start : start + chunk->tokens.tokens[starts[p]].offset;
+        item->chunk = chunk;
+        item->token_begin = starts[p];
+        item->token_end = p + 1 < piece_count ? starts[p + 1] : token_count;
+        chunk->refs++;
+
+        if (item_parse(frontend, item)) {
+            *globals_changed |= item_defines_globals(item);
+        } else {
+            frontend->failed_count++;
+            ok = false;
+        }
+    }
+    free(starts);
+
+    // Items outside the window keep their lengths
+    for (size_t i = first; i < first + piece_count; i++) {
+        size_t next = i + 1 < new_count ? frontend->items[i + 1].start : frontend->length;
+        frontend->items[i].length = next - frontend->items[i].start;
+    }
+
+    frontend->stats.items_reparsed += piece_count;
+    frontend->stats.bytes_relexed += strlen(chunk->text);
+    return ok;
+}
+
+// ============================================================================
+// IR
+// ============================================================================
+
+// Generate the functions of one item with the existing generator, whose
+// symbol table already holds the module globals
+static bool item_generate(IncrementalFrontend* frontend, IncrementalItem* item) {
+    IRGenerator* gen = frontend->gen;
+    FcxIRModule* module = gen->module;
+
+    size_t function_count = 0;
+    for (size_t i = 0; i < item->stmt_count; i++) {
+        function_count += item->statements[i]->type == STMT_FUNCTION;
+    }
+    if (function_count > 0) {
+        item->functions = malloc(function_count * sizeof(FcxIRFunction));
+        if (!item->functions) return false;
+    }
+
+    for (size_t i = 0; i < item->stmt_count; i++) {
+        if (item->statements[i]->type != STMT_FUNCTION) continue;
+
+        // module->functions only mirrors the items, so slot 0 is free
+        module->function_count = 0;
+        gen->has_error = false;
+        bool ok = ir_gen_generate_function(gen, item->statements[i]);
+        if (module->function_count == 1) {
+            item->functions[item->function_count++] = module->functions[0];
+        }
+        if (!ok || module->function_count != 1) {
+            item_clear_ir(item);
+            return false;
+        }
+    }
+    frontend->stats.functions_generated += item->function_count;
+    item->ir_ready = true;
+    return true;
+}
+
+// Regenerate the whole module the way ir_gen_generate_module does for a full
+// compile, then hand each item its functions
+static bool rebuild_ir(IncrementalFrontend* frontend) {
+    for (size_t i = 0; i < frontend->item_count; i++) {
+        item_clear_ir(&frontend->items[i]);
+    }
+    if (frontend->gen) {
+        frontend->gen->module->function_count = 0; // Copies of the items' functions
+        ir_gen_destroy(frontend->gen);
+    }
+    frontend->gen = ir_gen_create(frontend->module_name);
+    if (!frontend->gen || !frontend->gen->module) return false;
+
+    size_t stmt_count = 0;
+    for (size_t i = 0; i < frontend->item_count; i++) {
+        stmt_count += frontend->items[i].stmt_count;
+    }
+    Stmt** statements = malloc((stmt_count ? stmt_count : 1) * sizeof(Stmt*));
+    if (!statements) return false;
+    size_t n = 0;
+    for (size_t i = 0; i < frontend->item_count; i++) {
+        if (frontend->items[i].stmt_count > 0) {
+            memcpy(&statements[n], frontend->items[i].statements,
+                   frontend->items[i].stmt_count * sizeof(Stmt*));
+            n += frontend->items[i].stmt_count;
+        }
+    }
+    bool ok = ir_gen_generate_module(frontend->gen, statements, stmt_count);
+    free(statements);
+
+    FcxIRModule* module = frontend->gen->module;
+    if (!ok) {
+        for (uint32_t f = 0; f < module->function_count; f++) {
+            fcx_ir_function_destroy(&module->functions[f]);
+        }
+        module->function_count = 0;
+        return false;
+    }
+
+    // The module already lists the functions in item order
+    uint32_t next = 0;
+    for (size_t i = 0; i < frontend->item_count && ok; i++) {
+        IncrementalItem* item = &frontend->items[i];
+        for (size_t s = 0; s < item->stmt_count; s++) {
+            item->function_count += item->statements[s]->type == STMT_FUNCTION;
+        }
+        if (item->function_count > 0) {
+            item->functions = malloc(item->function_count * sizeof(FcxIRFunction));
+            ok = item->functions != NULL;
+        }
+        if (ok && item->function_count > 0) {
+            memcpy(item->functions, &module->functions[next],
+                   item->function_count * sizeof(FcxIRFunction));
+        }
+        next += (uint32_t)item->function_count;
+        item->ir_ready = ok;
+    }
+    frontend->stats.functions_generated += next;
+    frontend->stats.full_ir_rebuild = true;
+    return ok;
+}
+
+// Point module->functions at the items' functions, in source order
+static bool assemble_module(IncrementalFrontend* frontend) {
+    FcxIRModule* module = frontend->gen->module;
+    size_t total = 0;
+    for (size_t i = 0; i < frontend->item_count; i++) {
+        total += frontend->items[i].function_count;
+    }
+    if (total > UINT32_MAX) return false;
+    if (total > module->function_capacity) {
+        FcxIRFunction* functions = realloc(module->functions, total * sizeof(FcxIRFunction));
+        if (!functions) return false;
+        module->functions = functions;
+        module->function_capacity = (uint32_t)total;
+    }
+    uint32_t n = 0;
+    for (size_t i = 0; i < frontend->item_count; i++) {
+        const IncrementalItem* item = &frontend->items[i];
+        if (item->function_count > 0) {
+            memcpy(&module->functions[n], item->functions,
+                   item->function_count * sizeof(FcxIRFunction));
+            n += (uint32_t)item->function_count;
+        }
+    }
+    module->function_count = n;
+    return true;
+}
+
+// Bring the IR up to date once every item parses
+static bool update_ir(IncrementalFrontend* frontend, bool globals_changed) {
+    frontend->ir_valid = false;
+    frontend->globals_stale |= globals_changed;
+    if (frontend->failed_count > 0) {
+        return false;
+    }
+
+    if (frontend->globals_stale || !frontend->gen) {
+        if (!rebuild_ir(frontend)) return false;
+        frontend->globals_stale = false;
+    } else {
+        for (size_t i = 0; i < frontend->item_count; i++) {
+            IncrementalItem* item = &frontend->items[i];
+            if (!item->ir_ready && !item_generate(frontend, item)) {
+                return false;
+            }
+        }
+    }
+    frontend->ir_valid = assemble_module(frontend);
+    return frontend->ir_valid;
+}
+
+// ============================================================================
+// Public Interface
+// ============================================================================
+
+IncrementalFrontend* incremental_frontend_create(const char* module_name) {
+    IncrementalFrontend* frontend = calloc(1, sizeof(IncrementalFrontend));
+    if (!frontend) return NULL;
+    frontend->module_name = fcx_intern_cstr(module_name ? module_name : "main");
+    frontend->source = calloc(1, 1);
+    if (!frontend->source) {
+        free(frontend);
+        return NULL;
+    }
+    return frontend;
+}
+
+void incremental_frontend_destroy(IncrementalFrontend* frontend) {
+    if (!frontend) return;
+    for (size_t i = 0; i < frontend->item_count; i++) {
+        item_clear(&frontend->items[i]);
+    }
+    free(frontend->items);
+    if (frontend->gen) {
+        frontend->gen->module->function_count = 0; // Owned by the items
+        ir_gen_destroy(frontend->gen);
+    }
+    free(frontend->source);
+    free(frontend);
+}
+
+bool incremental_frontend_set_source(IncrementalFrontend* frontend, const char* source) {
+    if (!frontend || !source) return false;
+    size_t length = strlen(source);
+    char* copy = malloc(length + 1);
+    if (!copy) return false;
+    memcpy(copy, source, length + 1);
+
+    for (size_t i = 0; i < frontend->item_count; i++) {
+        item_clear(&frontend->items[i]);
+    }
+    frontend->item_count = 0;
+    frontend->failed_count = 0;
+    free(frontend->source);
+    frontend->source = copy;
+    frontend->length = length;
+    memset(&frontend->stats, 0, sizeof(frontend->stats));
+
+    IncrementalChunk* chunk = chunk_lex(frontend, 0, length);
+    bool globals_changed = true;
+    bool ok = chunk && splice_window(frontend, chunk, 0, 0, 0, 0, &globals_changed);
+    frontend->stats.items = frontend->item_count;
+    return update_ir(frontend, true) && ok;
+}
+
+bool incremental_frontend_edit(IncrementalFrontend* frontend, size_t offset, size_t removed,
+                               const char* text, size_t length) {
+    if (!frontend || offset > frontend->length || removed > frontend->length - offset ||
+        (!text && length > 0)) {
+        return false;
+    }
+    if (frontend->item_count == 0) {
+        // Nothing to reuse yet
+        char* source = malloc(length + 1);
+        if (!source) return false;
+        if (length > 0) memcpy(source, text, length);
+        source[length] = '\0';
+        bool ok = incremental_frontend_set_source(frontend, source);
+        free(source);
+        return ok;
+    }
+
+    // Items touched by the edit, in old offsets. Inserting right at an item
+    // start may extend the item before it as well.
+    size_t first = find_item(frontend, offset);
+    if (first > 0 && frontend->items[first].start == offset) {
+        first--;
+    }
+    size_t last = find_item(frontend, offset + removed);
+    for (size_t i = 0; frontend->failed_count > 0 && i < frontend->item_count; i++) {
+        if (frontend->items[i].failed) {
+            first = i < first ? i : first;
+            last = i > last ? i : last;
+        }
+    }
+
+    // Apply the edit to the source
+    size_t new_length = frontend->length - removed + length;
+    char* source = malloc(new_length + 1);
+    if (!source) return false;
+    memcpy(source, frontend->source, offset);
+    if (length > 0) memcpy(source + offset, text, length);
+    memcpy(source + offset + length, frontend->source + offset + removed,
+           frontend->length - offset - removed + 1);
+    free(frontend->source);
+    frontend->source = source;
+    frontend->length = new_length;
+    ptrdiff_t delta = (ptrdiff_t)length - (ptrdiff_t)removed;
+    memset(&frontend->stats, 0, sizeof(frontend->stats));
+
+    // Re-lex the touched items, widening the window until it starts and ends
+    // on item boundaries of the new source
+    IncrementalChunk* chunk = NULL;
+    for (;;) {
+        size_t start = frontend->items[first].start;
+        const IncrementalItem* end_item = &frontend->items[last];
+        size_t end = (size_t)((ptrdiff_t)(end_item->start + end_item->length) + delta);
+        chunk = chunk_lex(frontend, start, end);
+        if (!chunk) {
+            frontend->ir_valid = false;
+            return false;
+        }
+
+        bool head_ok = first == 0 || window_starts_item(&chunk->tokens);
+        bool tail_ok = last + 1 == frontend->item_count || window_ends_on_boundary(&chunk->tokens);
+        if (head_ok && tail_ok) break;
+
+        chunk_destroy(chunk);
+        size_t widen = last - first + 1;
+        if (!head_ok) {
+            first = first > widen ? first - widen : 0;
+        }
+        if (!tail_ok) {
+            last = last + widen < frontend->item_count ? last + widen : frontend->item_count - 1;
+        }
+    }
+
+    bool globals_changed = false;
+    bool ok = splice_window(frontend, chunk, first, last + 1, frontend->items[first].start,
+                            delta, &globals_changed);
+    frontend->stats.items = frontend->item_count;
+    return update_ir(frontend, globals_changed) && ok;
+}
+
+const FcxIRModule* incremental_frontend_module(const IncrementalFrontend* frontend) {
+    return frontend && frontend->ir_valid ? frontend->gen->module : NULL;
+}
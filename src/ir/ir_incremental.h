@@ -0,0 +1,86 @@
+#ifndef IR_INCREMENTAL_H
+#define IR_INCREMENTAL_H
+
+#include "ir_gen.h"
+
+// Incremental frontend for editor-style workloads
+// Keeps the tokens, top-level AST and FCx IR of the last version of a source
+// and, given an edit, re-lexes and re-parses only the top-level items the
+// edit touches. Unchanged items keep their Stmt subtrees and FcxIRFunctions.
+//
+// The source is cut into items at the boundaries parse_program -j uses
+// (`fn` / `pub fn` at brace depth 0 after `;` or `}`); items tile the source,
+// trailing whitespace and comments belonging to the item before them. An edit
+// is re-lexed over the items it touches, widened until the re-lexed window
+// ends on a boundary again, so the result is always what a full parse of the
+// new source would give. The source is taken as-is: it is not preprocessed.
+//
+// Line and column numbers in reused items are those of the version they were
+// parsed in; nothing below the AST records them.
+
+typedef struct IncrementalChunk IncrementalChunk;
+
+// One top-level item
+typedef struct {
+    size_t start;                // Byte offset in the current source
+    size_t length;               // Bytes up to the next item
+    IncrementalChunk* chunk;     // Tokens and AST arena (shared, refcounted)
+    size_t token_begin;          // Token range in chunk->tokens
+    size_t token_end;
+    Stmt** statements;           // Usually one STMT_FUNCTION
+    size_t stmt_count;
+    FcxIRFunction* functions;    // IR of each STMT_FUNCTION, in order
+    size_t function_count;
+    bool failed;                 // Did not parse; reparsed with the next edit
+    bool ir_ready;               // `functions` is up to date
+} IncrementalItem;
+
+// Work done by the last update
+typedef struct {
+    size_t items;                // Items in the source
+    size_t items_reparsed;       // Items lexed and parsed again
+    size_t bytes_relexed;
+    size_t functions_generated;  // FcxIRFunctions generated again
+    bool full_ir_rebuild;        // Top-level lets changed; all IR regenerated
+} IncrementalStats;
+
+typedef struct {
+    char* source;                // Current source text, NUL-terminated
+    size_t length;
+    IncrementalItem* items;
+    size_t item_count;
+    size_t item_capacity;
+    size_t failed_count;         // Items with `failed` set
+
+    IRGenerator* gen;            // Holds the module, globals and strings
+    const char* module_name;     // Interned
+    bool ir_valid;               // gen->module matches the current source
+    bool globals_stale;          // Top-level lets changed since the last IR build
+
+    // Parser settings
+    bool quiet;                  // Do not print parse errors
+    bool disallow_ambiguous_ops;
+    bool strict_parsing;
+
+    IncrementalStats stats;
+} IncrementalFrontend;
+
+IncrementalFrontend* incremental_frontend_create(const char* module_name);
+void incremental_frontend_destroy(IncrementalFrontend* frontend);
+
+// Replace the whole source and rebuild everything
+bool incremental_frontend_set_source(IncrementalFrontend* frontend, const char* source);
+
+// Replace `removed` bytes at `offset` of the current source with `length`
+// bytes of `text`, then bring the AST and IR up to date. Returns false on a
+// parse or IR generation error; the source is updated regardless and the
+// items that failed are parsed again with the next edit.
+bool incremental_frontend_edit(IncrementalFrontend* frontend, size_t offset, size_t removed,
+                               const char* text, size_t length);
+
+// IR of the current source, NULL after a failed update. The module and its
+// functions belong to the frontend and must not be modified; they stay
+// valid until the next update.
+const FcxIRModule* incremental_frontend_module(const IncrementalFrontend* frontend);
+
+#endif // IR_INCREMENTAL_H
@@ -0,0 +1,209 @@
+// Incremental frontend latency benchmark
+// Generates a ~10k-line FCx source, builds it once with the incremental
+// frontend, then times edit-to-IR latency for one-line edits in a function in
+// the middle of the file: rewriting a constant, and inserting then deleting a
+// statement line. The IR after the edits is compared against a from-scratch
+// build of the final source.
+// Usage: ir_incremental_bench [lines] [edits]
+
+#include "ir_incremental.h"
+#include "../bench_source.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Source ahead of the generated functions; bench_helper reads a global
+static const char *PRELUDE =
+    "let bench_scale := 3\n\n"
+    "fn bench_helper(p, q, r) -> i64 {\n    ret p + q + r * bench_scale\n}\n\n";
+
+static uint64_t hash_mix(uint64_t hash, uint64_t value) {
+  return (hash ^ value) * 1099511628211ULL;
+}
+
+// Function names, block shapes, opcodes and constants of every function
+static uint64_t hash_module(const FcxIRModule *module) {
+  uint64_t hash = 1469598103934665603ULL;
+  hash = hash_mix(hash, module->function_count);
+  hash = hash_mix(hash, module->global_count);
+  for (uint32_t f = 0; f < module->function_count; f++) {
+    const FcxIRFunction *function = &module->functions[f];
+    hash = hash_mix(hash, fcx_intern_id(function->name));
+    hash = hash_mix(hash, function->parameter_count);
+    hash = hash_mix(hash, function->block_count);
+    for (uint32_t b = 0; b < function->block_count; b++) {
+      const FcxIRBasicBlock *block = &function->blocks[b];
+      hash = hash_mix(hash, block->instruction_count);
+      for (uint32_t i = 0; i < block->instruction_count; i++) {
+        const FcxIRInstruction *instr = &block->instructions[i];
+        hash = hash_mix(hash, instr->opcode);
+        if (instr->opcode == FCXIR_CONST) {
+          hash = hash_mix(hash, (uint64_t)instr->u.const_op.value);
+        }
+      }
+    }
+  }
+  return hash;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static void report(const char *label, double *samples, size_t count,
+                   const IncrementalStats *stats) {
+  qsort(samples, count, sizeof(double), compare_doubles);
+  double total = 0.0;
+  for (size_t i = 0; i < count; i++) {
+    total += samples[i];
+  }
+  printf("%-22s median %8.1f us  min %8.1f us  mean %8.1f us  "
+         "(%zu items reparsed, %zu bytes relexed, %zu fns generated)\n",
+         label, samples[count / 2] * 1e6, samples[0] * 1e6,
+         total / (double)count * 1e6, stats->items_reparsed,
+         stats->bytes_relexed, stats->functions_generated);
+}
+
+int main(int argc, char **argv) {
+  size_t line_count = 10000;
+  size_t edit_count = 200;
+  if (argc > 1) {
+    line_count = (size_t)strtoul(argv[1], NULL, 10);
+  }
+  if (argc > 2) {
+    edit_count = (size_t)strtoul(argv[2], NULL, 10);
+  }
+  if (line_count < 100) {
+    line_count = 100;
+  }
+  if (edit_count < 2) {
+    edit_count = 2;
+  }
+
+  size_t function_count = line_count / BENCH_FUNCTION_TEMPLATE_LINES;
+  char *source = generate_bench_source(PRELUDE, BENCH_FUNCTION_TEMPLATE,
+                                       function_count, NULL);
+  if (!source) {
+    fprintf(stderr, "Error: Failed to allocate benchmark source\n");
+    return 1;
+  }
+
+  init_operator_registry();
+  printf("=== FCx Incremental Frontend Benchmark ===\n");
+
+  IncrementalFrontend *frontend = incremental_frontend_create("bench_module");
+  if (!frontend) {
+    fprintf(stderr, "Error: Failed to create incremental frontend\n");
+    free(source);
+    return 1;
+  }
+  frontend->quiet = getenv("LOUD") == NULL;
+
+  double start = now_seconds();
+  bool ok = incremental_frontend_set_source(frontend, source);
+  double full = now_seconds() - start;
+  free(source);
+  if (!ok) {
+    fprintf(stderr, "Error: Benchmark source failed to build\n");
+    incremental_frontend_destroy(frontend);
+    return 1;
+  }
+
+  size_t lines = 1;
+  for (const char *p = frontend->source; *p; p++) {
+    lines += *p == '\n';
+  }
+  printf("%zu lines, %zu items, %u functions\n\n", lines,
+         frontend->stats.items, incremental_frontend_module(frontend)->function_count);
+  printf("%-22s %8.1f us\n", "full build", full * 1e6);
+
+  // The `* N` constant of the middle function, and the line after `total`
+  // is declared
+  char needle[64];
+  snprintf(needle, sizeof(needle), "let x := a + b * %zu\n", function_count / 2);
+  const char *found = strstr(frontend->source, needle);
+  if (!found) {
+    fprintf(stderr, "Error: Edit target not found\n");
+    incremental_frontend_destroy(frontend);
+    return 1;
+  }
+  size_t constant = (size_t)(found - frontend->source) + strlen(needle) - 1;
+  while (frontend->source[constant - 1] != ' ') {
+    constant--;
+  }
+  size_t constant_length =
+      (size_t)(found - frontend->source) + strlen(needle) - 1 - constant;
+  size_t next_line = (size_t)(strstr(found, "let total := 0\n") - frontend->source) +
+                     strlen("let total := 0\n");
+
+  double *samples = malloc(edit_count * sizeof(double));
+  if (!samples) {
+    incremental_frontend_destroy(frontend);
+    return 1;
+  }
+
+  // Rewrite the constant, alternating between two widths
+  IncrementalStats stats = {0};
+  char replacement[32];
+  size_t current_length = constant_length;
+  for (size_t i = 0; ok && i < edit_count; i++) {
+    int length = snprintf(replacement, sizeof(replacement), "%zu",
+                          i % 2 ? i : 100000 + i);
+    start = now_seconds();
+    ok = incremental_frontend_edit(frontend, constant, current_length,
+                                   replacement, (size_t)length);
+    samples[i] = now_seconds() - start;
+    current_length = (size_t)length;
+    stats = frontend->stats;
+  }
+  if (ok) {
+    report("edit constant", samples, edit_count, &stats);
+  }
+
+  // Insert a statement line, then delete it again
+  static const char LINE[] = "    total := total + x * 3\n";
+  size_t line_length = sizeof(LINE) - 1;
+  next_line = (size_t)((ptrdiff_t)next_line +
+                       (ptrdiff_t)current_length - (ptrdiff_t)constant_length);
+  for (size_t i = 0; ok && i < edit_count; i++) {
+    start = now_seconds();
+    if (i % 2 == 0) {
+      ok = incremental_frontend_edit(frontend, next_line, 0, LINE, line_length);
+    } else {
+      ok = incremental_frontend_edit(frontend, next_line, line_length, "", 0);
+    }
+    samples[i] = now_seconds() - start;
+    stats = frontend->stats;
+  }
+  if (ok) {
+    report("insert/delete line", samples, edit_count, &stats);
+  }
+
+  // The incrementally maintained IR must match a fresh build
+  if (ok) {
+    IncrementalFrontend *fresh = incremental_frontend_create("bench_module");
+    if (fresh) {
+      fresh->quiet = true;
+      start = now_seconds();
+      ok = incremental_frontend_set_source(fresh, frontend->source);
+      full = now_seconds() - start;
+      bool same = ok && hash_module(incremental_frontend_module(frontend)) ==
+                            hash_module(incremental_frontend_module(fresh));
+      printf("%-22s %8.1f us\n\nIR after %zu edits %s a full rebuild\n",
+             "full rebuild", full * 1e6, 2 * edit_count,
+             same ? "matches" : "DOES NOT MATCH");
+      ok = same;
+      incremental_frontend_destroy(fresh);
+    }
+  } else {
+    fprintf(stderr, "Error: Edit failed\n");
+  }
+
+  free(samples);
+  incremental_frontend_destroy(frontend);
+  cleanup_operator_registry();
+  return ok ? 0 : 1;
+}
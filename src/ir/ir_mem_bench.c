@@ -0,0 +1,184 @@
+// FCx IR memory benchmark
+// Lexes, parses and generates FCx IR for each source file given and reports
+// the bytes the IR occupies per instruction: the instruction arrays as
+// allocated (capacity, not count) plus the out-of-line payloads an
+// instruction owns (call and syscall arguments, phi operands, inline asm
+// operands, bigint limbs). The arena column is what the function arenas
+// actually reserved for all of it. The source is not preprocessed.
+// Usage: ir_mem_bench file.fcx...
+
+#include "ir_gen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  size_t instructions;
+  size_t instruction_bytes; // Instruction arrays, by capacity
+  size_t payload_bytes;     // Out-of-line operands owned by instructions
+  size_t bigint_bytes;      // Bigint constant pools
+  size_t block_bytes;       // Block arrays and successor/predecessor lists
+  size_t arena_bytes;       // Chunks reserved by the function arenas
+} IRMemory;
+
+static char *read_file(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    return NULL;
+  }
+  char *source = NULL;
+  if (fseek(file, 0, SEEK_END) == 0) {
+    long size = ftell(file);
+    if (size >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+      source = malloc((size_t)size + 1);
+      if (source && fread(source, 1, (size_t)size, file) != (size_t)size) {
+        free(source);
+        source = NULL;
+      } else if (source) {
+        source[size] = '\0';
+      }
+    }
+  }
+  fclose(file);
+  return source;
+}
+
+static void measure_function(const FcxIRFunction *function, IRMemory *memory) {
+  memory->block_bytes += function->block_capacity * sizeof(FcxIRBasicBlock);
+  memory->bigint_bytes += function->bigint_limb_capacity * sizeof(uint64_t);
+  memory->arena_bytes += function->arena->bytes_reserved;
+  for (uint32_t b = 0; b < function->block_count; b++) {
+    const FcxIRBasicBlock *block = &function->blocks[b];
+    memory->instructions += block->instruction_count;
+    memory->instruction_bytes +=
+        block->instruction_capacity * sizeof(FcxIRInstruction);
+    memory->block_bytes +=
+        (block->successor_capacity + block->predecessor_capacity) *
+        sizeof(uint32_t);
+    for (uint32_t i = 0; i < block->instruction_count; i++) {
+      const FcxIRInstruction *instr = &block->instructions[i];
+      switch (instr->opcode) {
+      case FCXIR_CALL:
+        memory->payload_bytes += instr->u.call_op.arg_count * sizeof(VirtualReg);
+        break;
+      case FCXIR_SYSCALL:
+        memory->payload_bytes +=
+            instr->u.syscall_op.arg_count * sizeof(VirtualReg);
+        break;
+      case FCXIR_PHI:
+        memory->payload_bytes += instr->u.phi_op.incoming_count *
+                                 (sizeof(VirtualReg) + sizeof(uint32_t));
+        break;
+      case FCXIR_INLINE_ASM:
+        if (instr->u.inline_asm) {
+          memory->payload_bytes +=
+              sizeof(FcxIRInlineAsm) +
+              (instr->u.inline_asm->output_count +
+               instr->u.inline_asm->input_count) *
+                  sizeof(VirtualReg);
+        }
+        break;
+      default:
+        break;
+      }
+    }
+  }
+}
+
+static size_t total_bytes(const IRMemory *memory) {
+  return memory->instruction_bytes + memory->payload_bytes +
+         memory->bigint_bytes + memory->block_bytes;
+}
+
+static void report(const char *label, const IRMemory *memory) {
+  double instructions = memory->instructions ? (double)memory->instructions : 1.0;
+  printf("%-28s %7zu instrs  %9zu bytes  %6.1f B/instr  "
+         "(array %5.1f, payload %4.1f, bigint %4.1f, blocks %4.1f)  "
+         "arena %6.1f B/instr\n",
+         label, memory->instructions, total_bytes(memory),
+         (double)total_bytes(memory) / instructions,
+         (double)memory->instruction_bytes / instructions,
+         (double)memory->payload_bytes / instructions,
+         (double)memory->bigint_bytes / instructions,
+         (double)memory->block_bytes / instructions,
+         (double)memory->arena_bytes / instructions);
+}
+
+static bool measure_file(const char *path, IRMemory *memory) {
+  char *source = read_file(path);
+  if (!source) {
+    fprintf(stderr, "%s: cannot read\n", path);
+    return false;
+  }
+
+  TokenBuffer tokens;
+  if (!token_buffer_fill(&tokens, source)) {
+    fprintf(stderr, "%s: failed to lex\n", path);
+    free(source);
+    return false;
+  }
+  Parser parser;
+  parser_init_tokens(&parser, &tokens);
+  Stmt **statements = NULL;
+  size_t stmt_count = 0;
+  bool ok = parse_program(&parser, 1, &statements, &stmt_count);
+
+  if (ok) {
+    IRGenerator *gen = ir_gen_create("bench_module");
+    ok = gen && ir_gen_generate_module(gen, statements, stmt_count);
+    for (uint32_t f = 0; ok && f < gen->module->function_count; f++) {
+      measure_function(&gen->module->functions[f], memory);
+    }
+    ir_gen_destroy(gen);
+  }
+  if (!ok) {
+    fprintf(stderr, "%s: failed to generate IR\n", path);
+  }
+
+  for (size_t i = 0; i < stmt_count; i++) {
+    free_stmt(statements[i]);
+  }
+  free(statements);
+  parser_destroy(&parser);
+  token_buffer_destroy(&tokens);
+  free(source);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s file.fcx...\n", argv[0]);
+    return 1;
+  }
+
+  init_operator_registry();
+  printf("=== FCx IR Memory Benchmark ===\n");
+  printf("sizeof(FcxIRInstruction) = %zu, sizeof(VirtualReg) = %zu\n\n",
+         sizeof(FcxIRInstruction), sizeof(VirtualReg));
+
+  IRMemory total = {0};
+  size_t failed = 0;
+  for (int i = 1; i < argc; i++) {
+    IRMemory memory = {0};
+    if (!measure_file(argv[i], &memory)) {
+      failed++;
+      continue;
+    }
+    const char *name = strrchr(argv[i], '/');
+    report(name ? name + 1 : argv[i], &memory);
+    total.instructions += memory.instructions;
+    total.instruction_bytes += memory.instruction_bytes;
+    total.payload_bytes += memory.payload_bytes;
+    total.bigint_bytes += memory.bigint_bytes;
+    total.block_bytes += memory.block_bytes;
+    total.arena_bytes += memory.arena_bytes;
+  }
+  printf("\n");
+  report("total", &total);
+  if (failed > 0) {
+    printf("%zu file(s) skipped\n", failed);
+  }
+
+  cleanup_operator_registry();
+  return 0;
+}
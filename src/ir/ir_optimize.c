@@ -1,80 +1,65 @@
 #define _POSIX_C_SOURCE 200809L
 #include "ir_optimize.h"
+#include "ir_cfg.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
+#include <unistd.h>
 
 // ============================================================================
 // Constant Folding Pass - Comprehensive Implementation
 // ============================================================================
 
-// Hash table for O(1) constant lookup
-#define CONST_TABLE_SIZE 1024
-
-typedef struct ConstEntry {
-    uint32_t vreg_id;
-    int64_t value;
+// Constants seen so far, indexed by vreg id; one allocation per pass
+typedef struct {
+    bool known;
     bool is_bigint;
-    uint64_t bigint_limbs[16];
     uint8_t num_limbs;
-    struct ConstEntry* next;
+    uint32_t limb_index;       // Bigint limbs in function->bigint_limbs
+    int64_t value;
 } ConstEntry;
 
 typedef struct {
-    ConstEntry* buckets[CONST_TABLE_SIZE];
+    ConstEntry* entries;
+    uint32_t limit;
 } ConstTable;
 
-static uint32_t hash_vreg(uint32_t vreg_id) {
-    return vreg_id % CONST_TABLE_SIZE;
-}
-
-static void const_table_init(ConstTable* table) {
-    memset(table->buckets, 0, sizeof(table->buckets));
+static bool const_table_init(ConstTable* table, const FcxIRFunction* function) {
+    table->limit = function->next_vreg_id;
+    table->entries = (ConstEntry*)calloc(table->limit, sizeof(ConstEntry));
+    return table->entries != NULL;
 }
 
 static void const_table_destroy(ConstTable* table) {
-    for (int i = 0; i < CONST_TABLE_SIZE; i++) {
-        ConstEntry* entry = table->buckets[i];
-        while (entry) {
-            ConstEntry* next = entry->next;
-            free(entry);
-            entry = next;
-        }
-    }
+    free(table->entries);
+    table->entries = NULL;
 }
 
 static void const_table_insert(ConstTable* table, uint32_t vreg_id, int64_t value) {
-    uint32_t bucket = hash_vreg(vreg_id);
-    ConstEntry* entry = (ConstEntry*)malloc(sizeof(ConstEntry));
-    entry->vreg_id = vreg_id;
-    entry->value = value;
+    if (vreg_id >= table->limit) return;
+    ConstEntry* entry = &table->entries[vreg_id];
+    entry->known = true;
     entry->is_bigint = false;
-    entry->next = table->buckets[bucket];
-    table->buckets[bucket] = entry;
+    entry->value = value;
 }
 
 static void const_table_insert_bigint(ConstTable* table, uint32_t vreg_id, 
-                                     const uint64_t* limbs, uint8_t num_limbs) {
-    uint32_t bucket = hash_vreg(vreg_id);
-    ConstEntry* entry = (ConstEntry*)malloc(sizeof(ConstEntry));
-    entry->vreg_id = vreg_id;
+                                     uint32_t limb_index, uint8_t num_limbs) {
+    if (vreg_id >= table->limit) return;
+    ConstEntry* entry = &table->entries[vreg_id];
+    entry->known = true;
     entry->is_bigint = true;
+    entry->limb_index = limb_index;
     entry->num_limbs = num_limbs;
-    memcpy(entry->bigint_limbs, limbs, num_limbs * sizeof(uint64_t));
-    entry->next = table->buckets[bucket];
-    table->buckets[bucket] = entry;
 }
 
 static ConstEntry* const_table_lookup(ConstTable* table, uint32_t vreg_id) {
-    uint32_t bucket = hash_vreg(vreg_id);
-    ConstEntry* entry = table->buckets[bucket];
-    while (entry) {
-        if (entry->vreg_id == vreg_id) {
-            return entry;
-        }
-        entry = entry->next;
-    }
-    return NULL;
+    if (vreg_id >= table->limit || !table->entries[vreg_id].known) return NULL;
+    return &table->entries[vreg_id];
 }
 
 // Bigint arithmetic helpers
@@ -143,12 +128,139 @@ static bool is_power_of_2(int64_t value, int* shift_amount) {
     return true;
 }
 
+// Value of a binary operation on two 64-bit constants, with wrapping
+// arithmetic; false if it has none (division by zero, out-of-range shift
+// counts) or the opcode is not foldable
+static bool fold_binary(FcxIROpcode opcode, int64_t left_val, int64_t right_val, int64_t* result) {
+    uint64_t left = (uint64_t)left_val;
+    uint64_t right = (uint64_t)right_val;
+    
+    switch (opcode) {
+        // Arithmetic operations
+        case FCXIR_ADD:
+            *result = (int64_t)(left + right);
+            return true;
+        case FCXIR_SUB:
+            *result = (int64_t)(left - right);
+            return true;
+        case FCXIR_MUL:
+            *result = (int64_t)(left * right);
+            return true;
+        case FCXIR_DIV:
+        case FCXIR_MOD:
+            // Don't fold division by zero or the one overflowing quotient
+            if (right_val == 0 || (left_val == INT64_MIN && right_val == -1)) return false;
+            *result = opcode == FCXIR_DIV ? left_val / right_val : left_val % right_val;
+            return true;
+            
+        // Bitwise operations
+        case FCXIR_AND:
+            *result = (int64_t)(left & right);
+            return true;
+        case FCXIR_OR:
+            *result = (int64_t)(left | right);
+            return true;
+        case FCXIR_XOR:
+            *result = (int64_t)(left ^ right);
+            return true;
+            
+        // Shift operations; don't fold invalid shift counts
+        case FCXIR_LSHIFT:
+            if (right_val < 0 || right_val >= 64) return false;
+            *result = (int64_t)(left << right);
+            return true;
+        case FCXIR_RSHIFT:
+            if (right_val < 0 || right_val >= 64) return false;
+            *result = left_val >> right_val;  // Arithmetic shift
+            return true;
+        case FCXIR_LOGICAL_RSHIFT:
+            if (right_val < 0 || right_val >= 64) return false;
+            *result = (int64_t)(left >> right);
+            return true;
+        case FCXIR_ROTATE_LEFT:
+            if (right_val < 0 || right_val >= 64) return false;
+            *result = right == 0 ? left_val : (int64_t)((left << right) | (left >> (64 - right)));
+            return true;
+        case FCXIR_ROTATE_RIGHT:
+            if (right_val < 0 || right_val >= 64) return false;
+            *result = right == 0 ? left_val : (int64_t)((left >> right) | (left << (64 - right)));
+            return true;
+            
+        // Comparison operations
+        case FCXIR_CMP_EQ:
+            *result = (left_val == right_val) ? 1 : 0;
+            return true;
+        case FCXIR_CMP_NE:
+            *result = (left_val != right_val) ? 1 : 0;
+            return true;
+        case FCXIR_CMP_LT:
+            *result = (left_val < right_val) ? 1 : 0;
+            return true;
+        case FCXIR_CMP_LE:
+            *result = (left_val <= right_val) ? 1 : 0;
+            return true;
+        case FCXIR_CMP_GT:
+            *result = (left_val > right_val) ? 1 : 0;
+            return true;
+        case FCXIR_CMP_GE:
+            *result = (left_val >= right_val) ? 1 : 0;
+            return true;
+            
+        default:
+            return false;
+    }
+}
+
+static bool fold_unary(FcxIROpcode opcode, int64_t src_val, int64_t* result) {
+    switch (opcode) {
+        case FCXIR_NEG:
+            *result = (int64_t)(0 - (uint64_t)src_val);
+            return true;
+        case FCXIR_NOT:
+            *result = ~src_val;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Adds the result of a binary operation on two bigint constants to the
+// function's pool; returns its limb index, or UINT32_MAX if it is not folded
+static uint32_t fold_bigint(FcxIRFunction* function, FcxIROpcode opcode,
+                            uint32_t left_index, uint8_t left_num_limbs,
+                            uint32_t right_index, uint8_t right_num_limbs,
+                            uint8_t* result_num_limbs) {
+    uint64_t result_limbs[16];
+    bool can_fold = true;
+    const uint64_t* left_limbs = &function->bigint_limbs[left_index];
+    const uint64_t* right_limbs = &function->bigint_limbs[right_index];
+    
+    switch (opcode) {
+        case FCXIR_ADD:
+            can_fold = bigint_add(left_limbs, left_num_limbs, right_limbs, right_num_limbs,
+                                  result_limbs, result_num_limbs);
+            break;
+        case FCXIR_SUB:
+            can_fold = bigint_sub(left_limbs, left_num_limbs, right_limbs, right_num_limbs,
+                                  result_limbs, result_num_limbs);
+            break;
+        // TODO: Implement bigint MUL, DIV, MOD, bitwise operations
+        default:
+            can_fold = false;
+            break;
+    }
+    
+    // The result goes into the pool; this may move it, so left_limbs and
+    // right_limbs are not used past here
+    return can_fold ? fcx_ir_function_add_bigint(function, result_limbs, *result_num_limbs) : UINT32_MAX;
+}
+
 bool opt_constant_folding(FcxIRFunction* function) {
     if (!function) return false;
     
     bool changed = false;
     ConstTable const_table;
-    const_table_init(&const_table);
+    if (!const_table_init(&const_table, function)) return false;
     
     for (uint32_t b = 0; b < function->block_count; b++) {
         FcxIRBasicBlock* block = &function->blocks[b];
@@ -164,7 +276,7 @@ bool opt_constant_folding(FcxIRFunction* function) {
             
             if (instr->opcode == FCXIR_CONST_BIGINT) {
                 const_table_insert_bigint(&const_table, instr->u.const_bigint_op.dest.id,
-                                        instr->u.const_bigint_op.limbs, instr->u.const_bigint_op.num_limbs);
+                                        instr->u.const_bigint_op.limb_index, instr->u.const_bigint_op.num_limbs);
                 continue;
             }
             
@@ -178,111 +290,9 @@ bool opt_constant_folding(FcxIRFunction* function) {
                 
                 // Handle regular 64-bit constant folding
                 if (left_const && right_const && !left_const->is_bigint && !right_const->is_bigint) {
-                    int64_t left_val = left_const->value;
-                    int64_t right_val = right_const->value;
                     int64_t result = 0;
-                    bool can_fold = true;
-                    
-                    switch (instr->opcode) {
-                        // Arithmetic operations
-                        case FCXIR_ADD:
-                            result = left_val + right_val;
-                            break;
-                        case FCXIR_SUB:
-                            result = left_val - right_val;
-                            break;
-                        case FCXIR_MUL:
-                            result = left_val * right_val;
-                            break;
-                        case FCXIR_DIV:
-                            if (right_val != 0) {
-                                result = left_val / right_val;
-                            } else {
-                                can_fold = false;  // Don't fold division by zero
-                            }
-                            break;
-                        case FCXIR_MOD:
-                            if (right_val != 0) {
-                                result = left_val % right_val;
-                            } else {
-                                can_fold = false;  // Don't fold modulo by zero
-                            }
-                            break;
-                            
-                        // Bitwise operations
-                        case FCXIR_AND:
-                            result = left_val & right_val;
-                            break;
-                        case FCXIR_OR:
-                            result = left_val | right_val;
-                            break;
-                        case FCXIR_XOR:
-                            result = left_val ^ right_val;
-                            break;
-                            
-                        // Shift operations
-                        case FCXIR_LSHIFT:
-                            if (right_val >= 0 && right_val < 64) {
-                                result = left_val << right_val;
-                            } else {
-                                can_fold = false;  // Don't fold invalid shifts
-                            }
-                            break;
-                        case FCXIR_RSHIFT:
-                            if (right_val >= 0 && right_val < 64) {
-                                result = left_val >> right_val;  // Arithmetic shift
-                            } else {
-                                can_fold = false;
-                            }
-                            break;
-                        case FCXIR_LOGICAL_RSHIFT:
-                            if (right_val >= 0 && right_val < 64) {
-                                result = (int64_t)((uint64_t)left_val >> right_val);  // Logical shift
-                            } else {
-                                can_fold = false;
-                            }
-                            break;
-                        case FCXIR_ROTATE_LEFT:
-                            if (right_val >= 0 && right_val < 64) {
-                                uint64_t uval = (uint64_t)left_val;
-                                result = (int64_t)((uval << right_val) | (uval >> (64 - right_val)));
-                            } else {
-                                can_fold = false;
-                            }
-                            break;
-                        case FCXIR_ROTATE_RIGHT:
-                            if (right_val >= 0 && right_val < 64) {
-                                uint64_t uval = (uint64_t)left_val;
-                                result = (int64_t)((uval >> right_val) | (uval << (64 - right_val)));
-                            } else {
-                                can_fold = false;
-                            }
-                            break;
-                            
-                        // Comparison operations
-                        case FCXIR_CMP_EQ:
-                            result = (left_val == right_val) ? 1 : 0;
-                            break;
-                        case FCXIR_CMP_NE:
-                            result = (left_val != right_val) ? 1 : 0;
-                            break;
-                        case FCXIR_CMP_LT:
-                            result = (left_val < right_val) ? 1 : 0;
-                            break;
-                        case FCXIR_CMP_LE:
-                            result = (left_val <= right_val) ? 1 : 0;
-                            break;
-                        case FCXIR_CMP_GT:
-                            result = (left_val > right_val) ? 1 : 0;
-                            break;
-                        case FCXIR_CMP_GE:
-                            result = (left_val >= right_val) ? 1 : 0;
-                            break;
-                            
-                        default:
-                            can_fold = false;
-                            break;
-                    }
+                    bool can_fold = fold_binary(instr->opcode, left_const->value,
+                                                right_const->value, &result);
                     
                     if (can_fold) {
                         // Replace with constant
@@ -298,38 +308,22 @@ bool opt_constant_folding(FcxIRFunction* function) {
                 
                 // Handle bigint constant folding
                 else if (left_const && right_const && left_const->is_bigint && right_const->is_bigint) {
-                    uint64_t result_limbs[16];
-                    uint8_t result_num_limbs;
-                    bool can_fold = true;
-                    
-                    switch (instr->opcode) {
-                        case FCXIR_ADD:
-                            can_fold = bigint_add(left_const->bigint_limbs, left_const->num_limbs,
-                                                right_const->bigint_limbs, right_const->num_limbs,
-                                                result_limbs, &result_num_limbs);
-                            break;
-                        case FCXIR_SUB:
-                            can_fold = bigint_sub(left_const->bigint_limbs, left_const->num_limbs,
-                                                right_const->bigint_limbs, right_const->num_limbs,
-                                                result_limbs, &result_num_limbs);
-                            break;
-                        // TODO: Implement bigint MUL, DIV, MOD, bitwise operations
-                        default:
-                            can_fold = false;
-                            break;
-                    }
+                    uint8_t result_num_limbs = 0;
+                    uint32_t limb_index = fold_bigint(function, instr->opcode,
+                                                      left_const->limb_index, left_const->num_limbs,
+                                                      right_const->limb_index, right_const->num_limbs,
+                                                      &result_num_limbs);
                     
-                    if (can_fold) {
+                    if (limb_index != UINT32_MAX) {
                         // Replace with bigint constant
                         instr->opcode = FCXIR_CONST_BIGINT;
                         instr->u.const_bigint_op.dest = instr->u.binary_op.dest;
-                        memcpy(instr->u.const_bigint_op.limbs, result_limbs, 
-                              result_num_limbs * sizeof(uint64_t));
+                        instr->u.const_bigint_op.limb_index = limb_index;
                         instr->u.const_bigint_op.num_limbs = result_num_limbs;
                         
                         // Track the new bigint constant
                         const_table_insert_bigint(&const_table, instr->u.const_bigint_op.dest.id,
-                                                result_limbs, result_num_limbs);
+                                                limb_index, result_num_limbs);
                         changed = true;
                     }
                 }
@@ -339,21 +333,9 @@ bool opt_constant_folding(FcxIRFunction* function) {
             else if (instr->opcode == FCXIR_NEG || instr->opcode == FCXIR_NOT) {
                 ConstEntry* src_const = const_table_lookup(&const_table, instr->u.unary_op.src.id);
                 
-                if (src_const && !src_const->is_bigint) {
-                    int64_t src_val = src_const->value;
-                    int64_t result = 0;
-                    
-                    switch (instr->opcode) {
-                        case FCXIR_NEG:
-                            result = -src_val;
-                            break;
-                        case FCXIR_NOT:
-                            result = ~src_val;
-                            break;
-                        default:
-                            continue;
-                    }
-                    
+                int64_t result = 0;
+                if (src_const && !src_const->is_bigint &&
+                    fold_unary(instr->opcode, src_const->value, &result)) {
                     // Replace with constant
                     instr->opcode = FCXIR_CONST;
                     instr->u.const_op.dest = instr->u.unary_op.dest;
@@ -367,6 +349,8 @@ bool opt_constant_folding(FcxIRFunction* function) {
         }
     }
     
+    // Instructions were rewritten in place
+    if (changed) fcx_ir_rebuild_uses(function);
     const_table_destroy(&const_table);
     return changed;
 }
@@ -380,7 +364,7 @@ bool opt_algebraic_simplification(FcxIRFunction* function) {
     
     bool changed = false;
     ConstTable const_table;
-    const_table_init(&const_table);
+    if (!const_table_init(&const_table, function)) return false;
     
     for (uint32_t b = 0; b < function->block_count; b++) {
         FcxIRBasicBlock* block = &function->blocks[b];
@@ -599,6 +583,7 @@ bool opt_algebraic_simplification(FcxIRFunction* function) {
         }
     }
     
+    if (changed) fcx_ir_rebuild_uses(function);
     const_table_destroy(&const_table);
     return changed;
 }
@@ -612,7 +597,7 @@ bool opt_strength_reduction(FcxIRFunction* function) {
     
     bool changed = false;
     ConstTable const_table;
-    const_table_init(&const_table);
+    if (!const_table_init(&const_table, function)) return false;
     
     for (uint32_t b = 0; b < function->block_count; b++) {
         FcxIRBasicBlock* block = &function->blocks[b];
@@ -723,211 +708,1560 @@ bool opt_strength_reduction(FcxIRFunction* function) {
         }
     }
     
+    if (changed) fcx_ir_rebuild_uses(function);
     const_table_destroy(&const_table);
     return changed;
 }
 
-bool opt_dead_code_elimination(FcxIRFunction* function) {
-    if (!function) return false;
-    
-    bool changed = false;
+// ============================================================================
+// Scratch Storage
+// ============================================================================
+
+// Working storage of the sparse passes. A module optimization gives each
+// thread one arena that every pass empties and reuses, so that optimizing
+// many small functions does not create and release an arena per pass and
+// function; on their own, the passes use an arena of their own.
+static _Thread_local IRArena* opt_scratch;
+
+static IRArena* opt_scratch_begin(void) {
+    if (!opt_scratch) return ir_arena_create();
+    ir_arena_reset(opt_scratch);
+    return opt_scratch;
+}
+
+static void opt_scratch_end(IRArena* scratch) {
+    if (scratch != opt_scratch) ir_arena_destroy(scratch);
+}
+
+// ============================================================================
+// Sparse Conditional Constant Propagation
+// ============================================================================
+
+// Wegman and Zadeck's SCCP over the SSA form: every vreg starts out unknown
+// (TOP) and only moves down the lattice, only blocks reached through edges
+// that can be taken are evaluated, and when a value changes only the
+// instructions that read it are visited again. The algebraic identities,
+// annihilators and strength reductions of the passes above are applied on
+// the way, so one sweep reaches the fixpoint they iterate towards.
+
+typedef enum {
+    LATTICE_TOP,
+    LATTICE_CONST,
+    LATTICE_BIGINT,
+    LATTICE_BOTTOM
+} LatticeKind;
+
+typedef struct {
+    uint8_t kind;
+    uint8_t num_limbs;
+    uint32_t limb_index;
+    int64_t value;
+} LatticeValue;
+
+typedef struct {
+    uint32_t* items;
+    uint32_t count;
+    uint32_t capacity;
+} SparseList;
+
+typedef struct {
+    uint32_t instr;
+    uint32_t next;              // Next reader of the same vreg, or IR_CFG_NONE
+} SparseUse;
+
+typedef struct {
+    FcxIRFunction* function;
+    const IRCFG* cfg;
+    IRArena* scratch;           // Everything below; released when the pass ends
+    uint32_t vreg_limit;
     
-    // Track which virtual registers are used
-    bool* used = (bool*)calloc(function->next_vreg_id, sizeof(bool));
-    if (!used) return false;
+    // Instructions are numbered consecutively across blocks
+    uint32_t* first_instr;      // Number of each block's first instruction
+    uint32_t* instr_block;
+    uint32_t instr_count;
+    uint32_t* block_index;      // Block index of each block id
     
-    // Mark all used registers
-    for (uint32_t b = 0; b < function->block_count; b++) {
-        FcxIRBasicBlock* block = &function->blocks[b];
-        
-        for (uint32_t i = 0; i < block->instruction_count; i++) {
-            FcxIRInstruction* instr = &block->instructions[i];
-            
-            switch (instr->opcode) {
-                case FCXIR_MOV:
-                    // MOV is register-to-register, mark source as used
-                    used[instr->u.load_store.src.id] = true;
-                    break;
-                case FCXIR_LOAD:
-                case FCXIR_STORE:
-                case FCXIR_LOAD_VOLATILE:
-                case FCXIR_STORE_VOLATILE:
-                    used[instr->u.load_store.src.id] = true;
-                    break;
-                    
-                case FCXIR_ADD:
-                case FCXIR_SUB:
-                case FCXIR_MUL:
-                case FCXIR_DIV:
-                case FCXIR_MOD:
-                case FCXIR_AND:
-                case FCXIR_OR:
-                case FCXIR_XOR:
-                case FCXIR_LSHIFT:
-                case FCXIR_RSHIFT:
-                case FCXIR_LOGICAL_RSHIFT:
-                case FCXIR_ROTATE_LEFT:
-                case FCXIR_ROTATE_RIGHT:
-                case FCXIR_CMP_EQ:
-                case FCXIR_CMP_NE:
-                case FCXIR_CMP_LT:
-                case FCXIR_CMP_LE:
-                case FCXIR_CMP_GT:
-                case FCXIR_CMP_GE:
-                case FCXIR_PTR_ADD:
-                case FCXIR_PTR_SUB:
-                    used[instr->u.binary_op.left.id] = true;
-                    used[instr->u.binary_op.right.id] = true;
-                    break;
-                    
-                case FCXIR_NEG:
-                case FCXIR_NOT:
-                case FCXIR_ATOMIC_LOAD:
-                    used[instr->u.unary_op.src.id] = true;
-                    break;
-                    
-                case FCXIR_BRANCH:
-                    used[instr->u.branch_op.cond.id] = true;
-                    break;
-                
-                case FCXIR_STORE_GLOBAL:
-                    // Mark the source vreg as used (the value being stored)
-                    used[instr->u.global_op.vreg.id] = true;
-                    break;
-                    
-                case FCXIR_RETURN:
-                    if (instr->u.return_op.has_value) {
-                        used[instr->u.return_op.value.id] = true;
-                    }
-                    break;
-                
-                case FCXIR_CALL:
-                    // Mark all arguments as used
-                    for (uint8_t j = 0; j < instr->u.call_op.arg_count; j++) {
-                        used[instr->u.call_op.args[j].id] = true;
-                    }
-                    break;
-                    
-                default:
-                    break;
-            }
-        }
-    }
+    uint32_t* def_count;        // Parameters count as a definition
+    uint32_t* def_instr;        // Defining instruction of single-def vregs
+    uint32_t* use_head;         // First reader of each vreg in uses, or IR_CFG_NONE
+    SparseUse* uses;
+    uint32_t use_count;
+    uint32_t use_capacity;
     
-    // Remove instructions that define unused registers
-    for (uint32_t b = 0; b < function->block_count; b++) {
-        FcxIRBasicBlock* block = &function->blocks[b];
-        uint32_t write_idx = 0;
+    LatticeValue* values;
+    bool* block_live;           // Reached through an executable edge
+    bool* edge_live;            // Per block and successor slot
+    bool* queued;
+    SparseList instr_worklist;
+    bool* block_pending;        // Live but not evaluated yet
+    uint32_t next_block;        // No pending block before this index
+    uint32_t scan_pos;          // Block scan in progress: instruction being
+    uint32_t scan_end;          // evaluated and end of the block
+    uint64_t visits;
+} SparseState;
+
+static const LatticeValue LATTICE_TOP_VALUE = { LATTICE_TOP, 0, 0, 0 };
+static const LatticeValue LATTICE_BOTTOM_VALUE = { LATTICE_BOTTOM, 0, 0, 0 };
+
+static void sparse_push(SparseState* state, SparseList* list, uint32_t value) {
+    if (list->count >= list->capacity) {
+        uint32_t new_capacity = list->capacity == 0 ? 64 : list->capacity * 2;
+        uint32_t* new_items = (uint32_t*)ir_arena_grow(
+            state->scratch, list->items, list->capacity * sizeof(uint32_t), new_capacity * sizeof(uint32_t));
         
-        for (uint32_t read_idx = 0; read_idx < block->instruction_count; read_idx++) {
-            FcxIRInstruction* instr = &block->instructions[read_idx];
-            bool keep = true;
-            
-            // Check if this instruction defines a register
-            switch (instr->opcode) {
-                case FCXIR_CONST:
-                    keep = used[instr->u.const_op.dest.id];
-                    break;
-                case FCXIR_CONST_BIGINT:
-                    keep = used[instr->u.const_bigint_op.dest.id];
-                    break;
-                case FCXIR_MOV:
-                case FCXIR_LOAD:
-                case FCXIR_LOAD_VOLATILE:
-                    keep = used[instr->u.load_store.dest.id];
-                    break;
-                case FCXIR_LOAD_GLOBAL:
-                    keep = used[instr->u.global_op.vreg.id];
-                    break;
-                case FCXIR_ADD:
-                case FCXIR_SUB:
-                case FCXIR_MUL:
-                case FCXIR_DIV:
-                case FCXIR_MOD:
-                case FCXIR_AND:
-                case FCXIR_OR:
-                case FCXIR_XOR:
-                case FCXIR_LSHIFT:
-                case FCXIR_RSHIFT:
-                case FCXIR_LOGICAL_RSHIFT:
-                case FCXIR_ROTATE_LEFT:
-                case FCXIR_ROTATE_RIGHT:
-                case FCXIR_CMP_EQ:
-                case FCXIR_CMP_NE:
-                case FCXIR_CMP_LT:
-                case FCXIR_CMP_LE:
-                case FCXIR_CMP_GT:
-                case FCXIR_CMP_GE:
-                case FCXIR_PTR_ADD:
-                case FCXIR_PTR_SUB:
-                    keep = used[instr->u.binary_op.dest.id];
-                    break;
-                default:
-                    // Keep all other instructions (stores, branches, etc.)
-                    keep = true;
-                    break;
-            }
-            
-            if (keep) {
-                if (write_idx != read_idx) {
-                    block->instructions[write_idx] = block->instructions[read_idx];
-                }
-                write_idx++;
-            } else {
-                changed = true;
-            }
-        }
+        if (!new_items) return;
         
-        block->instruction_count = write_idx;
+        list->items = new_items;
+        list->capacity = new_capacity;
     }
     
-    free(used);
-    return changed;
+    list->items[list->count++] = value;
 }
 
-// ============================================================================
-// Loop Invariant Code Motion (Simplified)
-// ============================================================================
+static void* sparse_array(SparseState* state, size_t count, size_t size) {
+    void* array = ir_arena_alloc(state->scratch, count * size);
+    if (array) {
+        memset(array, 0, count * size);
+    }
+    return array;
+}
 
-bool opt_loop_invariant_code_motion(FcxIRFunction* function) {
-    if (!function) return false;
-    
-    // This is a placeholder for loop optimization
-    // A full implementation would:
-    // 1. Identify loops in the CFG
-    // 2. Find loop-invariant computations
-    // 3. Move them outside the loop
-    
-    // For now, just return false (no changes)
-    return false;
+static FcxIRInstruction* sparse_instr(SparseState* state, uint32_t n) {
+    uint32_t b = state->instr_block[n];
+    return &state->function->blocks[b].instructions[n - state->first_instr[b]];
 }
 
-// ============================================================================
-// Type Checking Pass
-// ============================================================================
+static LatticeValue lattice_const(int64_t value) {
+    LatticeValue result = { LATTICE_CONST, 0, 0, value };
+    return result;
+}
 
-bool opt_type_checking(FcxIRFunction* function) {
-    if (!function) return false;
+static LatticeValue lattice_of(const SparseState* state, const VirtualReg* reg) {
+    return reg->id < state->vreg_limit ? state->values[reg->id] : LATTICE_BOTTOM_VALUE;
+}
+
+static bool lattice_is_const(LatticeValue value, int64_t constant) {
+    return value.kind == LATTICE_CONST && value.value == constant;
+}
+
+static bool lattice_equal(const SparseState* state, LatticeValue a, LatticeValue b) {
+    if (a.kind != b.kind) return false;
+    switch (a.kind) {
+        case LATTICE_CONST:
+            return a.value == b.value;
+        case LATTICE_BIGINT:
+            return a.num_limbs == b.num_limbs &&
+                   memcmp(&state->function->bigint_limbs[a.limb_index],
+                          &state->function->bigint_limbs[b.limb_index],
+                          a.num_limbs * sizeof(uint64_t)) == 0;
+        default:
+            return true;
+    }
+}
+
+static LatticeValue lattice_meet(const SparseState* state, LatticeValue a, LatticeValue b) {
+    if (a.kind == LATTICE_TOP) return b;
+    if (b.kind == LATTICE_TOP) return a;
+    return lattice_equal(state, a, b) ? a : LATTICE_BOTTOM_VALUE;
+}
+
+// A vreg copied into another of a different type may be converted on the
+// way, so its value is only passed on between registers of the same type
+static LatticeValue lattice_copy(const SparseState* state, const VirtualReg* src, const VirtualReg* dest) {
+    if (src->type != dest->type || src->size != dest->size) return LATTICE_BOTTOM_VALUE;
+    return lattice_of(state, src);
+}
+
+static void sparse_queue(SparseState* state, uint32_t n) {
+    if (state->queued[n]) return;
+    state->queued[n] = true;
+    sparse_push(state, &state->instr_worklist, n);
+}
+
+static void sparse_set_value(SparseState* state, uint32_t id, LatticeValue value) {
+    if (id == 0 || id >= state->vreg_limit || state->def_count[id] != 1) return;
     
-    // Track types of virtual registers
-    VRegType* types = (VRegType*)calloc(function->next_vreg_id, sizeof(VRegType));
-    if (!types) return false;
+    LatticeValue old_value = state->values[id];
+    LatticeValue new_value = lattice_meet(state, old_value, value);
+    if (lattice_equal(state, old_value, new_value)) return;
     
-    // Initialize all types to I64 (default integer type)
-    // This prevents false positives from untracked types
-    for (uint32_t i = 0; i < function->next_vreg_id; i++) {
-        types[i] = VREG_TYPE_I64;
+    state->values[id] = new_value;
+    for (uint32_t u = state->use_head[id]; u != IR_CFG_NONE; u = state->uses[u].next) {
+        // Readers in blocks that are still to be scanned see the new value then
+        uint32_t n = state->uses[u].instr;
+        uint32_t b = state->instr_block[n];
+        if (!state->block_live[b] || state->block_pending[b] ||
+            (n > state->scan_pos && n < state->scan_end)) {
+            continue;
+        }
+        sparse_queue(state, n);
+    }
+}
+
+// Successor slot of block b that leads to the block with the given id
+static uint32_t sparse_edge_slot(const SparseState* state, uint32_t b, uint32_t label) {
+    const IRCFGBlock* info = &state->cfg->blocks[b];
+    for (uint32_t k = 0; k < info->succ_count; k++) {
+        if (state->function->blocks[info->succs[k]].id == label) return k;
+    }
+    return IR_CFG_NONE;
+}
+
+static bool sparse_edge_is_live(const SparseState* state, uint32_t pred, uint32_t b) {
+    const IRCFGBlock* info = &state->cfg->blocks[pred];
+    for (uint32_t k = 0; k < info->succ_count; k++) {
+        if (info->succs[k] == b && state->edge_live[pred * 2 + k]) return true;
     }
+    return false;
+}
+
+static void sparse_mark_edge(SparseState* state, uint32_t b, uint32_t label) {
+    uint32_t k = sparse_edge_slot(state, b, label);
+    if (k == IR_CFG_NONE || state->edge_live[b * 2 + k]) return;
+    state->edge_live[b * 2 + k] = true;
     
-    bool has_error = false;
+    uint32_t succ = state->cfg->blocks[b].succs[k];
+    if (!state->block_live[succ]) {
+        state->block_live[succ] = true;
+        state->block_pending[succ] = true;
+        if (succ < state->next_block) state->next_block = succ;
+        return;
+    }
     
-    for (uint32_t b = 0; b < function->block_count; b++) {
-        FcxIRBasicBlock* block = &function->blocks[b];
+    // A new way into a block that already runs only changes its phis
+    const FcxIRBasicBlock* block = &state->function->blocks[succ];
+    for (uint32_t i = 0; i < block->instruction_count && block->instructions[i].opcode == FCXIR_PHI; i++) {
+        sparse_queue(state, state->first_instr[succ] + i);
+    }
+}
+
+static LatticeValue sparse_eval_phi(SparseState* state, uint32_t b, const FcxIRInstruction* instr) {
+    LatticeValue result = LATTICE_TOP_VALUE;
+    for (uint32_t k = 0; k < instr->u.phi_op.incoming_count; k++) {
+        uint32_t pred_id = instr->u.phi_op.blocks[k];
+        uint32_t pred = pred_id < state->function->next_block_id ? state->block_index[pred_id] : IR_CFG_NONE;
+        if (pred == IR_CFG_NONE || !sparse_edge_is_live(state, pred, b)) continue;
         
-        for (uint32_t i = 0; i < block->instruction_count; i++) {
-            FcxIRInstruction* instr = &block->instructions[i];
-            
-            switch (instr->opcode) {
+        result = lattice_meet(state, result, lattice_copy(state, &instr->u.phi_op.incoming[k], &instr->u.phi_op.dest));
+        if (result.kind == LATTICE_BOTTOM) break;
+    }
+    return result;
+}
+
+// Identity element of a binary operation on the given side, if any
+static bool is_right_identity(FcxIROpcode opcode, int64_t value) {
+    switch (opcode) {
+        case FCXIR_ADD:
+        case FCXIR_SUB:
+        case FCXIR_OR:
+        case FCXIR_XOR:
+            return value == 0;
+        case FCXIR_MUL:
+        case FCXIR_DIV:
+            return value == 1;
+        case FCXIR_AND:
+            return value == -1;  // All bits set
+        default:
+            return false;
+    }
+}
+
+static bool is_left_identity(FcxIROpcode opcode, int64_t value) {
+    return opcode != FCXIR_SUB && opcode != FCXIR_DIV && is_right_identity(opcode, value);
+}
+
+static bool is_algebraic_opcode(FcxIROpcode opcode) {
+    return (opcode >= FCXIR_ADD && opcode <= FCXIR_MOD) ||
+           (opcode >= FCXIR_AND && opcode <= FCXIR_XOR);
+}
+
+static bool is_foldable_binary(FcxIROpcode opcode) {
+    return (opcode >= FCXIR_ADD && opcode <= FCXIR_MOD) ||
+           (opcode >= FCXIR_AND && opcode <= FCXIR_ROTATE_RIGHT && opcode != FCXIR_NOT) ||
+           (opcode >= FCXIR_CMP_EQ && opcode <= FCXIR_CMP_GE);
+}
+
+static LatticeValue sparse_eval_binary(SparseState* state, const FcxIRInstruction* instr) {
+    FcxIROpcode opcode = instr->opcode;
+    const VirtualReg* dest = &instr->u.binary_op.dest;
+    const VirtualReg* left_reg = &instr->u.binary_op.left;
+    const VirtualReg* right_reg = &instr->u.binary_op.right;
+    LatticeValue left = lattice_of(state, left_reg);
+    LatticeValue right = lattice_of(state, right_reg);
+    
+    if (is_algebraic_opcode(opcode)) {
+        // Self operations: x op x
+        if (left_reg->id == right_reg->id) {
+            if (opcode == FCXIR_SUB || opcode == FCXIR_XOR) return lattice_const(0);
+            if (opcode == FCXIR_AND || opcode == FCXIR_OR) return lattice_copy(state, left_reg, dest);
+        }
+        // Annihilators: x * 0, x & 0
+        if ((opcode == FCXIR_MUL || opcode == FCXIR_AND) &&
+            (lattice_is_const(left, 0) || lattice_is_const(right, 0))) {
+            return lattice_const(0);
+        }
+        if (right.kind == LATTICE_CONST && is_right_identity(opcode, right.value)) {
+            return lattice_copy(state, left_reg, dest);
+        }
+        if (left.kind == LATTICE_CONST && is_left_identity(opcode, left.value)) {
+            return lattice_copy(state, right_reg, dest);
+        }
+    }
+    
+    if (left.kind == LATTICE_CONST && right.kind == LATTICE_CONST) {
+        int64_t result = 0;
+        return fold_binary(opcode, left.value, right.value, &result) ? lattice_const(result) : LATTICE_BOTTOM_VALUE;
+    }
+    if (left.kind == LATTICE_BIGINT && right.kind == LATTICE_BIGINT) {
+        // Operands only go down the lattice, so a folded result stays valid
+        LatticeValue current = dest->id < state->vreg_limit ? state->values[dest->id] : LATTICE_BOTTOM_VALUE;
+        if (current.kind == LATTICE_BIGINT) return current;
+        
+        LatticeValue result = { LATTICE_BIGINT, 0, 0, 0 };
+        result.limb_index = fold_bigint(state->function, opcode, left.limb_index, left.num_limbs,
+                                        right.limb_index, right.num_limbs, &result.num_limbs);
+        return result.limb_index != UINT32_MAX ? result : LATTICE_BOTTOM_VALUE;
+    }
+    if (left.kind == LATTICE_TOP || right.kind == LATTICE_TOP) return LATTICE_TOP_VALUE;
+    return LATTICE_BOTTOM_VALUE;
+}
+
+static LatticeValue sparse_eval(SparseState* state, uint32_t b, const FcxIRInstruction* instr) {
+    switch (instr->opcode) {
+        case FCXIR_CONST:
+            return lattice_const(instr->u.const_op.value);
+        case FCXIR_CONST_BIGINT: {
+            LatticeValue result = { LATTICE_BIGINT, instr->u.const_bigint_op.num_limbs,
+                                    instr->u.const_bigint_op.limb_index, 0 };
+            return result;
+        }
+        case FCXIR_MOV:
+            return lattice_copy(state, &instr->u.load_store.src, &instr->u.load_store.dest);
+        case FCXIR_PHI:
+            return sparse_eval_phi(state, b, instr);
+        case FCXIR_NEG:
+        case FCXIR_NOT: {
+            LatticeValue src = lattice_of(state, &instr->u.unary_op.src);
+            int64_t result = 0;
+            if (src.kind == LATTICE_CONST && fold_unary(instr->opcode, src.value, &result)) {
+                return lattice_const(result);
+            }
+            return src.kind == LATTICE_TOP ? LATTICE_TOP_VALUE : LATTICE_BOTTOM_VALUE;
+        }
+        default:
+            if (is_foldable_binary(instr->opcode)) return sparse_eval_binary(state, instr);
+            return LATTICE_BOTTOM_VALUE;
+    }
+}
+
+static void sparse_visit(SparseState* state, uint32_t n) {
+    uint32_t b = state->instr_block[n];
+    if (!state->block_live[b]) return;
+    
+    FcxIRInstruction* instr = sparse_instr(state, n);
+    state->visits++;
+    
+    switch (instr->opcode) {
+        case FCXIR_JUMP:
+            sparse_mark_edge(state, b, instr->u.jump_op.label_id);
+            return;
+        case FCXIR_BRANCH: {
+            // A condition that is still unknown takes both ways, like one
+            // that is not constant
+            LatticeValue cond = lattice_of(state, &instr->u.branch_op.cond);
+            if (cond.kind != LATTICE_CONST || cond.value != 0) {
+                sparse_mark_edge(state, b, instr->u.branch_op.true_label);
+            }
+            if (cond.kind != LATTICE_CONST || cond.value == 0) {
+                sparse_mark_edge(state, b, instr->u.branch_op.false_label);
+            }
+            return;
+        }
+        case FCXIR_RETURN:
+            return;
+        default:
+            break;
+    }
+    
+    VirtualReg* def = fcx_ir_instruction_def(instr, 0);
+    if (def) {
+        sparse_set_value(state, def->id, sparse_eval(state, b, instr));
+    }
+}
+
+static bool sparse_add_use(SparseState* state, uint32_t id, uint32_t n) {
+    if (state->use_count >= state->use_capacity) {
+        uint32_t new_capacity = state->use_capacity * 2;
+        SparseUse* new_uses = (SparseUse*)ir_arena_grow(
+            state->scratch, state->uses, state->use_capacity * sizeof(SparseUse), new_capacity * sizeof(SparseUse));
+        if (!new_uses) return false;
+        
+        state->uses = new_uses;
+        state->use_capacity = new_capacity;
+    }
+    
+    SparseUse* use = &state->uses[state->use_count];
+    use->instr = n;
+    use->next = state->use_head[id];
+    state->use_head[id] = state->use_count++;
+    return true;
+}
+
+// Numbers the instructions and builds the def-use chains in one scan
+static bool sparse_build(SparseState* state) {
+    FcxIRFunction* function = state->function;
+    uint32_t limit = state->vreg_limit;
+    uint32_t n = function->block_count;
+    
+    state->first_instr = (uint32_t*)sparse_array(state, n + 1, sizeof(uint32_t));
+    state->block_index = (uint32_t*)ir_arena_alloc(state->scratch, function->next_block_id * sizeof(uint32_t));
+    if (!state->first_instr || (!state->block_index && function->next_block_id > 0)) return false;
+    
+    memset(state->block_index, 0xff, function->next_block_id * sizeof(uint32_t));  // IR_CFG_NONE
+    for (uint32_t b = 0; b < n; b++) {
+        state->first_instr[b] = state->instr_count;
+        state->instr_count += function->blocks[b].instruction_count;
+        if (function->blocks[b].id < function->next_block_id) {
+            state->block_index[function->blocks[b].id] = b;
+        }
+    }
+    state->first_instr[n] = state->instr_count;
+    
+    state->use_capacity = state->instr_count * 2 + 16;
+    state->uses = (SparseUse*)ir_arena_alloc(state->scratch, state->use_capacity * sizeof(SparseUse));
+    state->use_head = (uint32_t*)ir_arena_alloc(state->scratch, limit * sizeof(uint32_t));
+    state->instr_block = (uint32_t*)ir_arena_alloc(state->scratch, state->instr_count * sizeof(uint32_t));
+    state->queued = (bool*)sparse_array(state, state->instr_count, sizeof(bool));
+    state->def_count = (uint32_t*)sparse_array(state, limit, sizeof(uint32_t));
+    state->def_instr = (uint32_t*)ir_arena_alloc(state->scratch, limit * sizeof(uint32_t));
+    state->values = (LatticeValue*)ir_arena_alloc(state->scratch, limit * sizeof(LatticeValue));
+    state->block_live = (bool*)sparse_array(state, n, sizeof(bool));
+    state->edge_live = (bool*)sparse_array(state, (size_t)n * 2, sizeof(bool));
+    state->block_pending = (bool*)sparse_array(state, n, sizeof(bool));
+    if (!state->uses || !state->use_head || !state->instr_block || !state->queued || !state->def_count ||
+        !state->def_instr || !state->values || !state->block_live || !state->edge_live ||
+        !state->block_pending) {
+        return false;
+    }
+    memset(state->use_head, 0xff, limit * sizeof(uint32_t));  // IR_CFG_NONE
+    
+    for (uint8_t i = 0; i < function->parameter_count; i++) {
+        uint32_t id = function->parameters[i].id;
+        if (id < limit) state->def_count[id] += 2;  // Never a single definition
+    }
+    
+    uint32_t num = 0;
+    for (uint32_t b = 0; b < n; b++) {
+        FcxIRBasicBlock* block = &function->blocks[b];
+        for (uint32_t i = 0; i < block->instruction_count; i++, num++) {
+            FcxIRInstruction* instr = &block->instructions[i];
+            state->instr_block[num] = b;
+            
+            // Only inline assembly defines more than one vreg
+            VirtualReg* reg = fcx_ir_instruction_def(instr, 0);
+            for (uint32_t k = 1; reg != NULL; k++) {
+                if (reg->id != 0 && reg->id < limit) {
+                    state->def_count[reg->id]++;
+                    state->def_instr[reg->id] = num;
+                }
+                reg = instr->opcode == FCXIR_INLINE_ASM ? fcx_ir_instruction_def(instr, k) : NULL;
+            }
+            for (uint32_t k = 0; (reg = fcx_ir_instruction_use(instr, k)) != NULL; k++) {
+                if (reg->id != 0 && reg->id < limit && !sparse_add_use(state, reg->id, num)) return false;
+            }
+        }
+    }
+    
+    for (uint32_t id = 0; id < limit; id++) {
+        state->values[id] = state->def_count[id] == 1 ? LATTICE_TOP_VALUE : LATTICE_BOTTOM_VALUE;
+    }
+    
+    return true;
+}
+
+// Blocks are evaluated in index order, which after SSA construction is
+// reverse postorder, so that a block's operands are mostly final by the time
+// it is scanned; only values carried around loops are revisited
+static void sparse_propagate(SparseState* state) {
+    uint32_t block_count = state->function->block_count;
+    state->block_live[0] = true;
+    state->block_pending[0] = true;
+    
+    for (;;) {
+        if (state->instr_worklist.count > 0) {
+            uint32_t n = state->instr_worklist.items[--state->instr_worklist.count];
+            state->queued[n] = false;
+            sparse_visit(state, n);
+            continue;
+        }
+        
+        while (state->next_block < block_count && !state->block_pending[state->next_block]) {
+            state->next_block++;
+        }
+        if (state->next_block == block_count) break;
+        
+        uint32_t b = state->next_block;
+        state->block_pending[b] = false;
+        state->scan_end = state->first_instr[b + 1];
+        for (state->scan_pos = state->first_instr[b]; state->scan_pos < state->scan_end; state->scan_pos++) {
+            sparse_visit(state, state->scan_pos);
+        }
+        state->scan_end = 0;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Rewriting
+// ----------------------------------------------------------------------------
+
+// Constant shift amounts and masks created by strength reduction; they go at
+// the top of the entry block, which dominates every use
+typedef struct {
+    FcxIRInstruction* instrs;
+    uint32_t count;
+    uint32_t capacity;
+} SparseConstPool;
+
+static VirtualReg sparse_pool_const(SparseState* state, SparseConstPool* pool, VirtualReg like, int64_t value) {
+    for (uint32_t i = 0; i < pool->count; i++) {
+        const FcxIRInstruction* existing = &pool->instrs[i];
+        if (existing->u.const_op.value == value && existing->u.const_op.dest.type == like.type) {
+            return existing->u.const_op.dest;
+        }
+    }
+    
+    if (pool->count >= pool->capacity) {
+        uint32_t new_capacity = pool->capacity == 0 ? 8 : pool->capacity * 2;
+        FcxIRInstruction* new_instrs = (FcxIRInstruction*)ir_arena_grow(
+            state->scratch, pool->instrs, pool->capacity * sizeof(FcxIRInstruction),
+            new_capacity * sizeof(FcxIRInstruction));
+        if (!new_instrs) return (VirtualReg){0};
+        pool->instrs = new_instrs;
+        pool->capacity = new_capacity;
+    }
+    
+    VirtualReg dest = fcx_ir_alloc_vreg(state->function, (VRegType)like.type);
+    FcxIRInstruction* instr = &pool->instrs[pool->count++];
+    memset(instr, 0, sizeof(FcxIRInstruction));
+    instr->opcode = FCXIR_CONST;
+    instr->operand_count = 1;
+    instr->u.const_op.dest = dest;
+    instr->u.const_op.value = value;
+    return dest;
+}
+
+static bool is_unsigned_type(uint8_t type) {
+    return type >= VREG_TYPE_U8 && type <= VREG_TYPE_U64;
+}
+
+static void make_mov(FcxIRInstruction* instr, VirtualReg dest, VirtualReg src) {
+    instr->opcode = FCXIR_MOV;
+    instr->operand_count = 2;
+    instr->u.load_store.dest = dest;
+    instr->u.load_store.src = src;
+    instr->u.load_store.offset = 0;
+}
+
+static void make_const(FcxIRInstruction* instr, VirtualReg dest, LatticeValue value) {
+    if (value.kind == LATTICE_BIGINT) {
+        instr->opcode = FCXIR_CONST_BIGINT;
+        instr->operand_count = 1;
+        instr->u.const_bigint_op.dest = dest;
+        instr->u.const_bigint_op.limb_index = value.limb_index;
+        instr->u.const_bigint_op.num_limbs = value.num_limbs;
+    } else {
+        instr->opcode = FCXIR_CONST;
+        instr->operand_count = 1;
+        instr->u.const_op.dest = dest;
+        instr->u.const_op.value = value.value;
+    }
+}
+
+// Algebraic identities and strength reductions for a binary operation whose
+// result is not constant; returns true if the instruction was rewritten
+static bool sparse_simplify_binary(SparseState* state, SparseConstPool* pool, FcxIRInstruction* instr) {
+    FcxIROpcode opcode = instr->opcode;
+    VirtualReg dest = instr->u.binary_op.dest;
+    VirtualReg left_reg = instr->u.binary_op.left;
+    VirtualReg right_reg = instr->u.binary_op.right;
+    LatticeValue left = lattice_of(state, &left_reg);
+    LatticeValue right = lattice_of(state, &right_reg);
+    
+    if (is_algebraic_opcode(opcode)) {
+        if (left_reg.id == right_reg.id && (opcode == FCXIR_AND || opcode == FCXIR_OR)) {
+            make_mov(instr, dest, left_reg);
+            return true;
+        }
+        if (right.kind == LATTICE_CONST && is_right_identity(opcode, right.value)) {
+            make_mov(instr, dest, left_reg);
+            return true;
+        }
+        if (left.kind == LATTICE_CONST && is_left_identity(opcode, left.value)) {
+            make_mov(instr, dest, right_reg);
+            return true;
+        }
+    }
+    
+    // Multiplication by a power of 2 becomes a shift. Division and modulo
+    // only do for unsigned operands; a signed shift rounds the wrong way.
+    int shift = 0;
+    if (opcode == FCXIR_MUL) {
+        if (right.kind == LATTICE_CONST && is_power_of_2(right.value, &shift)) {
+            // x * 2^n
+        } else if (left.kind == LATTICE_CONST && is_power_of_2(left.value, &shift)) {
+            left_reg = right_reg;
+            right_reg = instr->u.binary_op.left;
+        } else {
+            return false;
+        }
+        VirtualReg amount = sparse_pool_const(state, pool, right_reg, shift);
+        if (amount.id == 0) return false;
+        instr->opcode = FCXIR_LSHIFT;
+        instr->u.binary_op.left = left_reg;
+        instr->u.binary_op.right = amount;
+        return true;
+    }
+    if ((opcode == FCXIR_DIV || opcode == FCXIR_MOD) && is_unsigned_type(left_reg.type) &&
+        right.kind == LATTICE_CONST && is_power_of_2(right.value, &shift)) {
+        VirtualReg amount = sparse_pool_const(state, pool, right_reg,
+                                              opcode == FCXIR_DIV ? shift : right.value - 1);
+        if (amount.id == 0) return false;
+        instr->opcode = opcode == FCXIR_DIV ? FCXIR_LOGICAL_RSHIFT : FCXIR_AND;
+        instr->u.binary_op.right = amount;
+        return true;
+    }
+    return false;
+}
+
+// -(-x) and ~(~x)
+static bool sparse_simplify_unary(SparseState* state, FcxIRInstruction* instr) {
+    uint32_t src = instr->u.unary_op.src.id;
+    if (src == 0 || src >= state->vreg_limit || state->def_count[src] != 1) return false;
+    
+    const FcxIRInstruction* inner = sparse_instr(state, state->def_instr[src]);
+    if (inner->opcode != instr->opcode) return false;
+    
+    make_mov(instr, instr->u.unary_op.dest, inner->u.unary_op.src);
+    return true;
+}
+
+static void sparse_uncount(FcxIRFunction* function, VirtualReg reg) {
+    FcxIRUseTable* uses = function->uses;
+    if (uses && reg.id < uses->capacity && uses->counts[reg.id] > 0) uses->counts[reg.id]--;
+}
+
+// Drops phi operands from edges that are never taken, then turns constant
+// and single-operand phis into CONST and MOV after the remaining phis
+static bool sparse_rewrite_phis(SparseState* state, uint32_t b) {
+    FcxIRBasicBlock* block = &state->function->blocks[b];
+    uint32_t phi_count = 0;
+    while (phi_count < block->instruction_count && block->instructions[phi_count].opcode == FCXIR_PHI) {
+        phi_count++;
+    }
+    if (phi_count == 0) return false;
+    
+    bool changed = false;
+    uint32_t converted = 0;
+    for (uint32_t i = 0; i < phi_count; i++) {
+        FcxIRInstruction* phi = &block->instructions[i];
+        uint32_t write = 0;
+        for (uint32_t k = 0; k < phi->u.phi_op.incoming_count; k++) {
+            uint32_t pred_id = phi->u.phi_op.blocks[k];
+            uint32_t pred = pred_id < state->function->next_block_id ? state->block_index[pred_id] : IR_CFG_NONE;
+            if (pred == IR_CFG_NONE || !sparse_edge_is_live(state, pred, b)) {
+                sparse_uncount(state->function, phi->u.phi_op.incoming[k]);
+                continue;
+            }
+            phi->u.phi_op.incoming[write] = phi->u.phi_op.incoming[k];
+            phi->u.phi_op.blocks[write] = phi->u.phi_op.blocks[k];
+            write++;
+        }
+        if (write != phi->u.phi_op.incoming_count) {
+            phi->u.phi_op.incoming_count = write;
+            phi->operand_count = write < UINT8_MAX ? (uint8_t)(write + 1) : UINT8_MAX;
+            changed = true;
+        }
+        
+        LatticeValue value = lattice_of(state, &phi->u.phi_op.dest);
+        if (value.kind == LATTICE_CONST || value.kind == LATTICE_BIGINT) {
+            fcx_ir_uses_remove(state->function->uses, phi);
+            make_const(phi, phi->u.phi_op.dest, value);
+            converted++;
+        } else if (write == 1) {
+            make_mov(phi, phi->u.phi_op.dest, phi->u.phi_op.incoming[0]);
+            converted++;
+        }
+    }
+    if (converted == 0) return changed;
+    
+    // Stable partition: remaining phis first
+    FcxIRInstruction* group = (FcxIRInstruction*)ir_arena_dup(
+        state->scratch, block->instructions, phi_count * sizeof(FcxIRInstruction));
+    if (!group) return true;
+    
+    uint32_t write = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (uint32_t i = 0; i < phi_count; i++) {
+            bool is_phi = group[i].opcode == FCXIR_PHI;
+            if (is_phi == (pass == 0)) block->instructions[write++] = group[i];
+        }
+    }
+    return true;
+}
+
+static uint32_t sparse_rewrite(SparseState* state, IROptPassStats* stats) {
+    FcxIRFunction* function = state->function;
+    SparseConstPool pool = {0};
+    uint32_t changes = 0;
+    bool cfg_changed = false;
+    
+    // Blocks that never run go first, so that what only they read is unused
+    for (uint32_t b = 0; b < function->block_count; b++) {
+        if (state->block_live[b]) continue;
+        FcxIRBasicBlock* block = &function->blocks[b];
+        for (uint32_t i = 0; i < block->instruction_count; i++) {
+            fcx_ir_uses_remove(function->uses, &block->instructions[i]);
+        }
+        cfg_changed = true;
+    }
+    
+    for (uint32_t b = 0; b < function->block_count; b++) {
+        if (!state->block_live[b]) continue;
+        
+        FcxIRBasicBlock* block = &function->blocks[b];
+        if (sparse_rewrite_phis(state, b)) changes++;
+        
+        for (uint32_t i = 0; i < block->instruction_count; i++) {
+            FcxIRInstruction* instr = &block->instructions[i];
+            if (instr->opcode == FCXIR_PHI) continue;
+            
+            if (instr->opcode == FCXIR_BRANCH) {
+                // Fold branches that can only go one way
+                uint32_t taken = IR_CFG_NONE;
+                uint32_t live = 0;
+                for (uint32_t k = 0; k < state->cfg->blocks[b].succ_count; k++) {
+                    if (!state->edge_live[b * 2 + k]) continue;
+                    taken = state->cfg->blocks[b].succs[k];
+                    live++;
+                }
+                if (live == 1 && state->cfg->blocks[b].succ_count == 2) {
+                    fcx_ir_uses_remove(function->uses, instr);
+                    instr->opcode = FCXIR_JUMP;
+                    instr->operand_count = 1;
+                    instr->u.jump_op.label_id = function->blocks[taken].id;
+                    cfg_changed = true;
+                    changes++;
+                }
+                continue;
+            }
+            
+            // Results nobody reads are left for DCE
+            VirtualReg* def = fcx_ir_instruction_def(instr, 0);
+            if (!def || def->id == 0 || def->id >= state->vreg_limit || state->def_count[def->id] != 1 ||
+                !fcx_ir_has_uses(function, def->id)) {
+                continue;
+            }
+            
+            LatticeValue value = state->values[def->id];
+            if ((value.kind == LATTICE_CONST && instr->opcode != FCXIR_CONST) ||
+                (value.kind == LATTICE_BIGINT && instr->opcode != FCXIR_CONST_BIGINT)) {
+                fcx_ir_uses_remove(function->uses, instr);
+                make_const(instr, *def, value);
+                changes++;
+                continue;
+            }
+            
+            FcxIRInstruction original = *instr;
+            bool simplified = false;
+            if (is_foldable_binary(instr->opcode)) {
+                simplified = sparse_simplify_binary(state, &pool, instr);
+            } else if (instr->opcode == FCXIR_NEG || instr->opcode == FCXIR_NOT) {
+                simplified = sparse_simplify_unary(state, instr);
+            }
+            if (simplified) {
+                fcx_ir_uses_remove(function->uses, &original);
+                fcx_ir_uses_add(function->uses, instr);
+                changes++;
+            }
+        }
+    }
+    
+    // Drop the blocks that never run
+    if (cfg_changed) {
+        uint32_t write = 0;
+        for (uint32_t b = 0; b < function->block_count; b++) {
+            if (!state->block_live[b]) {
+                changes++;
+                continue;
+            }
+            if (write != b) function->blocks[write] = function->blocks[b];
+            write++;
+        }
+        function->block_count = write;
+        fcx_ir_invalidate_cfg(function);
+        ir_cfg_update_edge_lists(function);
+    }
+    
+    if (pool.count > 0) {
+        FcxIRBasicBlock* entry = &function->blocks[0];
+        uint32_t count = pool.count + entry->instruction_count;
+        FcxIRInstruction* instructions = (FcxIRInstruction*)ir_arena_alloc(
+            function->arena, count * sizeof(FcxIRInstruction));
+        if (instructions) {
+            memcpy(instructions, pool.instrs, pool.count * sizeof(FcxIRInstruction));
+            memcpy(instructions + pool.count, entry->instructions,
+                   entry->instruction_count * sizeof(FcxIRInstruction));
+            entry->instructions = instructions;
+            entry->instruction_count = count;
+            entry->instruction_capacity = count;
+        }
+    }
+    
+    if (stats) {
+        stats->changes += changes;
+    }
+    return changes;
+}
+
+bool opt_sparse_constant_propagation(FcxIRFunction* function, IROptPassStats* stats) {
+    if (!function || !function->is_ssa) return false;
+    
+    SparseState state = {0};
+    state.function = function;
+    state.cfg = ir_cfg_get(function);
+    state.scratch = opt_scratch_begin();
+    state.vreg_limit = function->next_vreg_id;
+    if (!state.cfg || !state.scratch || state.cfg->blocks[0].pred_count != 0 || !sparse_build(&state)) {
+        opt_scratch_end(state.scratch);
+        return false;
+    }
+    
+    sparse_propagate(&state);
+    uint32_t changes = sparse_rewrite(&state, stats);
+    
+    if (stats) {
+        // Building the chains and rewriting scan every instruction once
+        stats->visits += 2 * (uint64_t)state.instr_count + state.visits;
+    }
+    opt_scratch_end(state.scratch);
+    return changes > 0;
+}
+
+// ============================================================================
+// Global Value Numbering
+// ============================================================================
+
+// Hash-consing along the dominator tree: an instruction that applies the
+// same operation to the same operands as one in a dominating block is
+// dropped and its readers use the earlier result, and a copy is replaced by
+// its source. Loads also match on a memory generation, which anything that
+// may write memory (stores, atomics, fences, calls, syscalls, allocation)
+// bumps, and which a block only inherits from its immediate dominator when
+// that is its single predecessor. Needs SSA form, where a vreg holds the
+// same value everywhere it is read.
+
+typedef struct {
+    uint32_t opcode;
+    uint32_t a;                 // Operands, global index or limb index
+    uint32_t b;
+    uint32_t mem;               // Memory generation, for loads
+    int64_t imm;                // Constant, offset, or hash of the limbs
+    uint8_t type;               // Of the result
+    uint8_t size;
+    uint8_t a_type;
+    uint8_t b_type;
+} GVNKey;
+
+typedef struct {
+    GVNKey key;
+    uint32_t value;             // Vreg holding the result
+    uint32_t hash;
+    uint32_t next;              // Next entry in the bucket, or IR_CFG_NONE
+} GVNEntry;
+
+typedef struct {
+    FcxIRFunction* function;
+    const IRCFG* cfg;
+    IRArena* scratch;
+    uint32_t vreg_limit;
+    uint32_t* def_count;        // Parameters count as a definition
+    uint32_t* leader;           // Vreg to read instead of each vreg, 0 if none
+    
+    // Entries of the enclosing dominator tree scopes, innermost last
+    GVNEntry* entries;
+    uint32_t entry_count;
+    uint32_t* buckets;
+    uint32_t bucket_mask;
+    
+    uint32_t* mem_out;          // Memory generation at the end of each block
+    uint32_t next_mem;
+    uint64_t visits;
+    uint64_t removed;
+} GVNState;
+
+static bool is_reserved_vreg(uint32_t id) {
+    return id >= FCX_IR_RESERVED_VREG_FIRST && id <= FCX_IR_RESERVED_VREG_LAST;
+}
+
+// Everything that may write memory, or order memory accesses
+static bool gvn_clobbers_memory(FcxIROpcode opcode) {
+    switch (opcode) {
+        case FCXIR_CONST:
+        case FCXIR_CONST_BIGINT:
+        case FCXIR_LOAD:
+        case FCXIR_MOV:
+        case FCXIR_LOAD_GLOBAL:
+        case FCXIR_NEG:
+        case FCXIR_NOT:
+        case FCXIR_BITFIELD_EXTRACT:
+        case FCXIR_BITFIELD_INSERT:
+        case FCXIR_ALIGN_UP:
+        case FCXIR_ALIGN_DOWN:
+        case FCXIR_IS_ALIGNED:
+        case FCXIR_PREFETCH:
+        case FCXIR_PREFETCH_WRITE:
+        case FCXIR_PTR_ADD:
+        case FCXIR_PTR_SUB:
+        case FCXIR_PTR_DIFF:
+        case FCXIR_PTR_CAST:
+        case FCXIR_PTR_TO_INT:
+        case FCXIR_INT_TO_PTR:
+        case FCXIR_FIELD_ACCESS:
+        case FCXIR_FIELD_OFFSET:
+        case FCXIR_BRANCH:
+        case FCXIR_JUMP:
+        case FCXIR_RETURN:
+        case FCXIR_PHI:
+        case FCXIR_LABEL:
+        case FCXIR_BASIC_BLOCK:
+        case FCXIR_SIMD_ADD:
+        case FCXIR_SIMD_SUB:
+        case FCXIR_SIMD_MUL:
+        case FCXIR_SIMD_DIV:
+            return false;
+        default:
+            return !is_foldable_binary(opcode);
+    }
+}
+
+static bool gvn_is_commutative(FcxIROpcode opcode) {
+    return opcode == FCXIR_ADD || opcode == FCXIR_MUL || opcode == FCXIR_AND ||
+           opcode == FCXIR_OR || opcode == FCXIR_XOR ||
+           opcode == FCXIR_CMP_EQ || opcode == FCXIR_CMP_NE;
+}
+
+// Operands must hold one value throughout the function
+static bool gvn_operand(const GVNState* state, const VirtualReg* reg, uint32_t* id, uint8_t* type) {
+    if (reg->id >= state->vreg_limit || is_reserved_vreg(reg->id) || state->def_count[reg->id] > 1) {
+        return false;
+    }
+    *id = reg->id;
+    *type = reg->type;
+    return true;
+}
+
+// Describes the value an instruction computes; false if it is not one to share
+static bool gvn_key(const GVNState* state, FcxIRInstruction* instr, const VirtualReg* dest,
+                    uint32_t mem, GVNKey* key) {
+    memset(key, 0, sizeof(*key));
+    key->opcode = instr->opcode;
+    key->type = dest->type;
+    key->size = dest->size;
+    
+    switch (instr->opcode) {
+        case FCXIR_CONST:
+            key->imm = instr->u.const_op.value;
+            return true;
+        case FCXIR_CONST_BIGINT: {
+            const uint64_t* limbs = fcx_ir_bigint_limbs(state->function, instr);
+            if (!limbs) return false;
+            uint64_t hash = 0xcbf29ce484222325ULL;
+            for (uint8_t i = 0; i < instr->u.const_bigint_op.num_limbs; i++) {
+                hash = (hash ^ limbs[i]) * 0x100000001b3ULL;
+            }
+            key->a = instr->u.const_bigint_op.limb_index;
+            key->b = instr->u.const_bigint_op.num_limbs;
+            key->imm = (int64_t)hash;
+            return true;
+        }
+        case FCXIR_LOAD:
+            key->mem = mem;
+            key->imm = instr->u.load_store.offset;
+            return gvn_operand(state, &instr->u.load_store.src, &key->a, &key->a_type);
+        case FCXIR_LOAD_GLOBAL:
+            key->mem = mem;
+            key->a = instr->u.global_op.global_index;
+            return true;
+        case FCXIR_NEG:
+        case FCXIR_NOT:
+            return gvn_operand(state, &instr->u.unary_op.src, &key->a, &key->a_type);
+        case FCXIR_PTR_CAST:
+        case FCXIR_PTR_TO_INT:
+        case FCXIR_INT_TO_PTR:
+            key->imm = instr->u.ptr_op.target_type;
+            return gvn_operand(state, &instr->u.ptr_op.ptr, &key->a, &key->a_type);
+        case FCXIR_FIELD_ACCESS:
+            key->mem = mem;
+            // Fall through
+        case FCXIR_FIELD_OFFSET:
+            key->imm = instr->u.field_op.field_offset;
+            return gvn_operand(state, &instr->u.field_op.base, &key->a, &key->a_type);
+        case FCXIR_PTR_ADD:
+        case FCXIR_PTR_SUB:
+        case FCXIR_PTR_DIFF:
+        case FCXIR_ALIGN_UP:
+        case FCXIR_ALIGN_DOWN:
+        case FCXIR_IS_ALIGNED:
+            break;
+        default:
+            if (!is_foldable_binary(instr->opcode)) return false;
+            break;
+    }
+    
+    if (!gvn_operand(state, &instr->u.binary_op.left, &key->a, &key->a_type) ||
+        !gvn_operand(state, &instr->u.binary_op.right, &key->b, &key->b_type)) {
+        return false;
+    }
+    if (gvn_is_commutative(instr->opcode) && key->a > key->b) {
+        uint32_t id = key->a;
+        uint8_t type = key->a_type;
+        key->a = key->b;
+        key->a_type = key->b_type;
+        key->b = id;
+        key->b_type = type;
+    }
+    return true;
+}
+
+static uint32_t gvn_hash(const GVNKey* key) {
+    // A bigint's limb index only says where its limbs are pooled; equal
+    // constants must hash alike, so only their content and length count
+    uint32_t a = key->opcode == FCXIR_CONST_BIGINT ? 0 : key->a;
+    uint64_t hash = key->opcode;
+    hash = hash * 0x9e3779b97f4a7c15ULL + a;
+    hash = hash * 0x9e3779b97f4a7c15ULL + key->b;
+    hash = hash * 0x9e3779b97f4a7c15ULL + key->mem;
+    hash = hash * 0x9e3779b97f4a7c15ULL + (uint64_t)key->imm;
+    hash = hash * 0x9e3779b97f4a7c15ULL + ((uint32_t)key->type << 24 | (uint32_t)key->size << 16 |
+                                            (uint32_t)key->a_type << 8 | key->b_type);
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+static bool gvn_key_equal(const GVNState* state, const GVNKey* x, const GVNKey* y) {
+    if (x->opcode != y->opcode || x->b != y->b || x->mem != y->mem || x->imm != y->imm ||
+        x->type != y->type || x->size != y->size || x->a_type != y->a_type || x->b_type != y->b_type) {
+        return false;
+    }
+    if (x->opcode == FCXIR_CONST_BIGINT && x->a != y->a) {
+        return memcmp(&state->function->bigint_limbs[x->a], &state->function->bigint_limbs[y->a],
+                      x->b * sizeof(uint64_t)) == 0;
+    }
+    return x->a == y->a;
+}
+
+// Points operands at their leaders
+static void gvn_rename(GVNState* state, FcxIRInstruction* instr) {
+    VirtualReg* reg;
+    for (uint32_t k = 0; (reg = fcx_ir_instruction_use(instr, k)) != NULL; k++) {
+        if (reg->id < state->vreg_limit && state->leader[reg->id] != 0) {
+            fcx_ir_uses_replace(state->function->uses, reg, state->leader[reg->id]);
+        }
+    }
+}
+
+// True if the instruction's result is already available, in which case its
+// readers are sent to the earlier vreg
+static bool gvn_is_redundant(GVNState* state, FcxIRInstruction* instr, uint32_t mem) {
+    // Results nobody reads are left for DCE
+    VirtualReg* dest = fcx_ir_instruction_def(instr, 0);
+    if (!dest || dest->id == 0 || dest->id >= state->vreg_limit || is_reserved_vreg(dest->id) ||
+        state->def_count[dest->id] != 1 || !fcx_ir_has_uses(state->function, dest->id)) {
+        return false;
+    }
+    
+    if (instr->opcode == FCXIR_MOV) {
+        const VirtualReg* src = &instr->u.load_store.src;
+        if (src->id == 0 || src->id >= state->vreg_limit || is_reserved_vreg(src->id) ||
+            state->def_count[src->id] > 1 || src->type != dest->type || src->size != dest->size) {
+            return false;
+        }
+        state->leader[dest->id] = src->id;
+        return true;
+    }
+    
+    GVNKey key;
+    if (!gvn_key(state, instr, dest, mem, &key)) return false;
+    
+    uint32_t hash = gvn_hash(&key);
+    for (uint32_t e = state->buckets[hash & state->bucket_mask]; e != IR_CFG_NONE; e = state->entries[e].next) {
+        if (state->entries[e].hash == hash && gvn_key_equal(state, &state->entries[e].key, &key)) {
+            state->leader[dest->id] = state->entries[e].value;
+            return true;
+        }
+    }
+    
+    GVNEntry* entry = &state->entries[state->entry_count];
+    entry->key = key;
+    entry->value = dest->id;
+    entry->hash = hash;
+    entry->next = state->buckets[hash & state->bucket_mask];
+    state->buckets[hash & state->bucket_mask] = state->entry_count++;
+    return false;
+}
+
+static void gvn_block(GVNState* state, uint32_t b) {
+    FcxIRFunction* function = state->function;
+    FcxIRBasicBlock* block = &function->blocks[b];
+    const IRCFGBlock* node = &state->cfg->blocks[b];
+    
+    uint32_t mem;
+    if (node->idom != IR_CFG_NONE && node->pred_count == 1 && node->preds[0] == node->idom) {
+        mem = state->mem_out[node->idom];
+    } else {
+        mem = state->next_mem++;
+    }
+    
+    uint32_t write_idx = 0;
+    for (uint32_t read_idx = 0; read_idx < block->instruction_count; read_idx++) {
+        FcxIRInstruction* instr = &block->instructions[read_idx];
+        state->visits++;
+        gvn_rename(state, instr);
+        
+        if (gvn_clobbers_memory(instr->opcode)) {
+            mem = state->next_mem++;
+        } else if (gvn_is_redundant(state, instr, mem)) {
+            fcx_ir_uses_remove(function->uses, instr);
+            state->removed++;
+            continue;
+        }
+        
+        if (write_idx != read_idx) {
+            block->instructions[write_idx] = *instr;
+        }
+        write_idx++;
+    }
+    block->instruction_count = write_idx;
+    state->mem_out[b] = mem;
+}
+
+bool opt_global_value_numbering(FcxIRFunction* function, IROptPassStats* stats) {
+    if (!function || !function->is_ssa || function->block_count == 0) return false;
+    
+    GVNState state = {0};
+    state.function = function;
+    state.cfg = ir_cfg_get(function);
+    state.vreg_limit = function->next_vreg_id;
+    if (!state.cfg) return false;
+    
+    uint32_t instr_count = 0;
+    for (uint32_t b = 0; b < function->block_count; b++) {
+        instr_count += function->blocks[b].instruction_count;
+    }
+    uint32_t bucket_count = 16;
+    while (bucket_count < 2 * instr_count) bucket_count *= 2;
+    
+    uint32_t limit = state.vreg_limit;
+    uint32_t block_count = function->block_count;
+    state.scratch = opt_scratch_begin();
+    IRArena* scratch = state.scratch;
+    state.def_count = scratch ? (uint32_t*)ir_arena_alloc(scratch, limit * sizeof(uint32_t)) : NULL;
+    state.leader = scratch ? (uint32_t*)ir_arena_alloc(scratch, limit * sizeof(uint32_t)) : NULL;
+    state.entries = scratch ? (GVNEntry*)ir_arena_alloc(scratch, (instr_count + 1) * sizeof(GVNEntry)) : NULL;
+    state.buckets = scratch ? (uint32_t*)ir_arena_alloc(scratch, bucket_count * sizeof(uint32_t)) : NULL;
+    state.mem_out = scratch ? (uint32_t*)ir_arena_alloc(scratch, block_count * sizeof(uint32_t)) : NULL;
+    uint32_t* stack = scratch ? (uint32_t*)ir_arena_alloc(scratch, 3 * block_count * sizeof(uint32_t)) : NULL;
+    if (!state.def_count || !state.leader || !state.entries || !state.buckets || !state.mem_out || !stack) {
+        opt_scratch_end(scratch);
+        return false;
+    }
+    memset(state.def_count, 0, limit * sizeof(uint32_t));
+    memset(state.leader, 0, limit * sizeof(uint32_t));
+    memset(state.buckets, 0xff, bucket_count * sizeof(uint32_t));  // IR_CFG_NONE
+    state.bucket_mask = bucket_count - 1;
+    
+    for (uint8_t i = 0; i < function->parameter_count; i++) {
+        if (function->parameters[i].id < limit) state.def_count[function->parameters[i].id]++;
+    }
+    for (uint32_t b = 0; b < block_count; b++) {
+        FcxIRBasicBlock* block = &function->blocks[b];
+        for (uint32_t i = 0; i < block->instruction_count; i++) {
+            VirtualReg* def;
+            for (uint32_t k = 0; (def = fcx_ir_instruction_def(&block->instructions[i], k)) != NULL; k++) {
+                if (def->id < limit) state.def_count[def->id]++;
+            }
+        }
+    }
+    
+    // Preorder walk of the dominator tree; each frame holds the block, the
+    // next child to visit and the table size to return to
+    gvn_block(&state, 0);
+    stack[0] = 0;
+    stack[1] = 0;
+    stack[2] = 0;
+    uint32_t depth = 1;
+    while (depth > 0) {
+        uint32_t* frame = &stack[3 * (depth - 1)];
+        const IRCFGBlock* node = &state.cfg->blocks[frame[0]];
+        if (frame[1] < node->child_count) {
+            uint32_t child = node->children[frame[1]++];
+            uint32_t mark = state.entry_count;
+            gvn_block(&state, child);
+            uint32_t* next = &stack[3 * depth++];
+            next[0] = child;
+            next[1] = 0;
+            next[2] = mark;
+            continue;
+        }
+        
+        while (state.entry_count > frame[2]) {
+            const GVNEntry* entry = &state.entries[--state.entry_count];
+            state.buckets[entry->hash & state.bucket_mask] = entry->next;
+        }
+        depth--;
+    }
+    
+    // Phis read values from blocks visited after them, and blocks outside
+    // the dominator tree were not visited at all
+    if (state.removed > 0) {
+        for (uint32_t b = 0; b < block_count; b++) {
+            FcxIRBasicBlock* block = &function->blocks[b];
+            for (uint32_t i = 0; i < block->instruction_count; i++) {
+                gvn_rename(&state, &block->instructions[i]);
+            }
+        }
+    }
+    
+    if (stats) {
+        stats->visits += state.visits + (state.removed > 0 ? instr_count : 0);
+        stats->changes += state.removed;
+    }
+    opt_scratch_end(scratch);
+    return state.removed > 0;
+}
+
+// ============================================================================
+// Dead Code Elimination
+// ============================================================================
+
+// Instructions whose only effect is their result. LOAD_VOLATILE stays, and so
+// does everything that writes memory, calls or transfers control.
+static bool dce_is_removable(const FcxIRInstruction* instr) {
+    switch (instr->opcode) {
+        case FCXIR_CONST:
+        case FCXIR_CONST_BIGINT:
+        case FCXIR_MOV:
+        case FCXIR_LOAD:
+        case FCXIR_LOAD_GLOBAL:
+        case FCXIR_NEG:
+        case FCXIR_NOT:
+        case FCXIR_PHI:
+        case FCXIR_PTR_ADD:
+        case FCXIR_PTR_SUB:
+            return true;
+        default:
+            return is_foldable_binary(instr->opcode);
+    }
+}
+
+// Marks every instruction that is not removable as live, then every
+// definition of a register that a live instruction reads, and deletes the
+// rest. Unlike dropping unused results one at a time this also removes dead
+// cycles, such as a loop counter nothing else reads. Works with or without
+// SSA form: a register with several definitions keeps all of them.
+bool opt_dead_code_elimination(FcxIRFunction* function, IROptPassStats* stats) {
+    if (!function) return false;
+    
+    uint32_t limit = function->next_vreg_id;
+    uint32_t instr_count = 0;
+    for (uint32_t b = 0; b < function->block_count; b++) {
+        instr_count += function->blocks[b].instruction_count;
+    }
+    if (instr_count == 0) return false;
+    
+    IRArena* scratch = opt_scratch_begin();
+    FcxIRInstruction** instrs = scratch ? (FcxIRInstruction**)ir_arena_alloc(
+        scratch, instr_count * sizeof(FcxIRInstruction*)) : NULL;
+    uint32_t* def_head = scratch ? (uint32_t*)ir_arena_alloc(scratch, limit * sizeof(uint32_t)) : NULL;
+    uint32_t* def_next = scratch ? (uint32_t*)ir_arena_alloc(scratch, instr_count * sizeof(uint32_t)) : NULL;
+    uint32_t* worklist = scratch ? (uint32_t*)ir_arena_alloc(scratch, instr_count * sizeof(uint32_t)) : NULL;
+    bool* live = scratch ? (bool*)ir_arena_alloc(scratch, instr_count * sizeof(bool)) : NULL;
+    if (!instrs || (!def_head && limit > 0) || !def_next || !worklist || !live) {
+        opt_scratch_end(scratch);
+        return false;
+    }
+    memset(def_head, 0xff, limit * sizeof(uint32_t));  // IR_CFG_NONE
+    memset(live, 0, instr_count * sizeof(bool));
+    
+    // Roots, and a chain of the removable definitions of each register
+    uint32_t n = 0;
+    uint32_t pending = 0;
+    for (uint32_t b = 0; b < function->block_count; b++) {
+        FcxIRBasicBlock* block = &function->blocks[b];
+        for (uint32_t i = 0; i < block->instruction_count; i++, n++) {
+            FcxIRInstruction* instr = &block->instructions[i];
+            VirtualReg* def = dce_is_removable(instr) ? fcx_ir_instruction_def(instr, 0) : NULL;
+            instrs[n] = instr;
+            if (def && def->id != 0 && def->id < limit) {
+                def_next[n] = def_head[def->id];
+                def_head[def->id] = n;
+            } else {
+                live[n] = true;
+                worklist[pending++] = n;
+            }
+        }
+    }
+    
+    // Each chain is walked once; afterwards all its definitions are live
+    uint64_t visits = instr_count;
+    while (pending > 0) {
+        FcxIRInstruction* instr = instrs[worklist[--pending]];
+        VirtualReg* use;
+        visits++;
+        for (uint32_t k = 0; (use = fcx_ir_instruction_use(instr, k)) != NULL; k++) {
+            if (use->id >= limit) continue;
+            for (uint32_t d = def_head[use->id]; d != IR_CFG_NONE; d = def_next[d]) {
+                live[d] = true;
+                worklist[pending++] = d;
+            }
+            def_head[use->id] = IR_CFG_NONE;
+        }
+    }
+    
+    uint64_t removed = 0;
+    n = 0;
+    for (uint32_t b = 0; b < function->block_count; b++) {
+        FcxIRBasicBlock* block = &function->blocks[b];
+        uint32_t write_idx = 0;
+        for (uint32_t read_idx = 0; read_idx < block->instruction_count; read_idx++, n++) {
+            if (!live[n]) {
+                fcx_ir_uses_remove(function->uses, &block->instructions[read_idx]);
+                removed++;
+                continue;
+            }
+            if (write_idx != read_idx) {
+                block->instructions[write_idx] = block->instructions[read_idx];
+            }
+            write_idx++;
+        }
+        block->instruction_count = write_idx;
+    }
+    
+    if (stats) {
+        stats->visits += visits;
+        stats->changes += removed;
+    }
+    opt_scratch_end(scratch);
+    return removed > 0;
+}
+
+
+// ============================================================================
+// Loop Invariant Code Motion
+// ============================================================================
+
+// Instructions without side effects that cannot trap, so they can run in the
+// preheader even if the loop body would not have reached them
+static bool licm_is_hoistable(const FcxIRInstruction* instr) {
+    switch (instr->opcode) {
+        case FCXIR_CONST:
+        case FCXIR_MOV:
+        case FCXIR_ADD:
+        case FCXIR_SUB:
+        case FCXIR_MUL:
+        case FCXIR_AND:
+        case FCXIR_OR:
+        case FCXIR_XOR:
+        case FCXIR_LSHIFT:
+        case FCXIR_RSHIFT:
+        case FCXIR_LOGICAL_RSHIFT:
+        case FCXIR_ROTATE_LEFT:
+        case FCXIR_ROTATE_RIGHT:
+        case FCXIR_CMP_EQ:
+        case FCXIR_CMP_NE:
+        case FCXIR_CMP_LT:
+        case FCXIR_CMP_LE:
+        case FCXIR_CMP_GT:
+        case FCXIR_CMP_GE:
+        case FCXIR_PTR_ADD:
+        case FCXIR_PTR_SUB:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Moves every instruction of a loop whose operands are all defined outside
+// it to the loop's preheader, innermost loops first so that values hoisted
+// out of an inner loop can move on out of the enclosing one. Needs SSA form,
+// where a register defined outside the loop keeps its value inside it.
+bool opt_loop_invariant_code_motion(FcxIRFunction* function) {
+    if (!function || !function->is_ssa) return false;
+    
+    bool changed = ir_cfg_insert_preheaders(function);
+    const IRCFG* cfg = ir_cfg_get(function);
+    if (!cfg || cfg->loop_count == 0) return changed;
+    
+    uint32_t vreg_limit = function->next_vreg_id;
+    uint32_t* def_count = (uint32_t*)calloc(vreg_limit, sizeof(uint32_t));
+    uint32_t* def_block = (uint32_t*)malloc(vreg_limit * sizeof(uint32_t));
+    if (!def_count || !def_block) {
+        free(def_count);
+        free(def_block);
+        return changed;
+    }
+    
+    // Parameters are defined on entry
+    for (uint32_t id = 0; id < vreg_limit; id++) {
+        def_block[id] = 0;
+    }
+    for (uint8_t i = 0; i < function->parameter_count; i++) {
+        if (function->parameters[i].id < vreg_limit) def_count[function->parameters[i].id]++;
+    }
+    for (uint32_t b = 0; b < function->block_count; b++) {
+        FcxIRBasicBlock* block = &function->blocks[b];
+        for (uint32_t i = 0; i < block->instruction_count; i++) {
+            VirtualReg* def;
+            for (uint32_t k = 0; (def = fcx_ir_instruction_def(&block->instructions[i], k)) != NULL; k++) {
+                if (def->id >= vreg_limit) continue;
+                def_count[def->id]++;
+                def_block[def->id] = b;
+            }
+        }
+    }
+    
+    for (uint32_t l = cfg->loop_count; l-- > 0;) {
+        const IRLoop* loop = &cfg->loops[l];
+        if (loop->preheader == IR_CFG_NONE) continue;
+        
+        FcxIRBasicBlock* preheader = &function->blocks[loop->preheader];
+        for (uint32_t lb = 0; lb < loop->block_count; lb++) {
+            FcxIRBasicBlock* block = &function->blocks[loop->blocks[lb]];
+            uint32_t write_idx = 0;
+            
+            for (uint32_t read_idx = 0; read_idx < block->instruction_count; read_idx++) {
+                FcxIRInstruction* instr = &block->instructions[read_idx];
+                bool invariant = licm_is_hoistable(instr);
+                
+                VirtualReg* reg;
+                for (uint32_t k = 0; invariant && (reg = fcx_ir_instruction_def(instr, k)) != NULL; k++) {
+                    invariant = reg->id < vreg_limit && def_count[reg->id] == 1 && !is_reserved_vreg(reg->id);
+                }
+                for (uint32_t k = 0; invariant && (reg = fcx_ir_instruction_use(instr, k)) != NULL; k++) {
+                    if (reg->id >= vreg_limit || is_reserved_vreg(reg->id)) {
+                        invariant = false;
+                    } else if (def_count[reg->id] > 0) {
+                        invariant = def_count[reg->id] == 1 &&
+                                    !ir_cfg_loop_contains(cfg, l, def_block[reg->id]);
+                    }
+                }
+                
+                // Append to the preheader, then swap with its jump
+                uint32_t preheader_count = preheader->instruction_count;
+                if (invariant) {
+                    fcx_ir_block_append(preheader, instr);
+                }
+                if (!invariant || preheader->instruction_count == preheader_count) {
+                    if (write_idx != read_idx) {
+                        block->instructions[write_idx] = *instr;
+                    }
+                    write_idx++;
+                    continue;
+                }
+                
+                // The copy in the preheader counted its operands
+                fcx_ir_uses_remove(function->uses, instr);
+                FcxIRInstruction* tail = &preheader->instructions[preheader_count - 1];
+                FcxIRInstruction jump = tail[0];
+                tail[0] = tail[1];
+                tail[1] = jump;
+                for (uint32_t k = 0; (reg = fcx_ir_instruction_def(&tail[0], k)) != NULL; k++) {
+                    def_block[reg->id] = loop->preheader;
+                }
+                changed = true;
+            }
+            
+            block->instruction_count = write_idx;
+        }
+    }
+    
+    free(def_count);
+    free(def_block);
+    return changed;
+}
+
+// ============================================================================
+// Analysis Diagnostics
+// ============================================================================
+
+// Warnings of the analysis passes go to stderr, except on the worker threads
+// of a parallel module optimization, which collect them per function so that
+// they can be printed in function order afterwards
+typedef struct {
+    char* text;
+    size_t length;
+    size_t capacity;
+} OptDiagnostics;
+
+static _Thread_local OptDiagnostics* opt_diagnostics;
+
+static void opt_warn(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    OptDiagnostics* out = opt_diagnostics;
+    if (!out) {
+        vfprintf(stderr, format, args);
+        va_end(args);
+        return;
+    }
+    
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+    if (length > 0 && out->length + (size_t)length + 1 > out->capacity) {
+        size_t capacity = out->capacity ? out->capacity * 2 : 256;
+        while (capacity < out->length + (size_t)length + 1) capacity *= 2;
+        char* text = (char*)realloc(out->text, capacity);
+        if (!text) {
+            va_end(args);
+            return;
+        }
+        out->text = text;
+        out->capacity = capacity;
+    }
+    if (length > 0) {
+        vsnprintf(out->text + out->length, out->capacity - out->length, format, args);
+        out->length += (size_t)length;
+    }
+    va_end(args);
+}
+
+// ============================================================================
+// Type Checking Pass
+// ============================================================================
+
+bool opt_type_checking(FcxIRFunction* function) {
+    if (!function) return false;
+    
+    // Track types of virtual registers
+    VRegType* types = (VRegType*)calloc(function->next_vreg_id, sizeof(VRegType));
+    if (!types) return false;
+    
+    // Initialize all types to I64 (default integer type)
+    // This prevents false positives from untracked types
+    for (uint32_t i = 0; i < function->next_vreg_id; i++) {
+        types[i] = VREG_TYPE_I64;
+    }
+    
+    bool has_error = false;
+    
+    for (uint32_t b = 0; b < function->block_count; b++) {
+        FcxIRBasicBlock* block = &function->blocks[b];
+        
+        for (uint32_t i = 0; i < block->instruction_count; i++) {
+            FcxIRInstruction* instr = &block->instructions[i];
+            
+            switch (instr->opcode) {
                 case FCXIR_CONST:
                     types[instr->u.const_op.dest.id] = instr->u.const_op.dest.type;
                     break;
@@ -1044,7 +2378,7 @@ bool opt_pointer_analysis(FcxIRFunction* function) {
                 case FCXIR_STORE_VOLATILE:
                     // Check for null pointer dereference
                     if (ptr_info[instr->u.load_store.src.id].is_null) {
-                        fprintf(stderr, "Warning: Potential null pointer dereference\n");
+                        opt_warn("Warning: Potential null pointer dereference\n");
                         has_error = true;
                     }
                     break;
@@ -1107,11 +2441,11 @@ bool opt_memory_safety_analysis(FcxIRFunction* function) {
                     
                 case FCXIR_DEALLOC:
                     if (freed[instr->u.unary_op.src.id]) {
-                        fprintf(stderr, "Warning: Double free detected\n");
+                        opt_warn("Warning: Double free detected\n");
                         has_error = true;
                     }
                     if (!allocated[instr->u.unary_op.src.id]) {
-                        fprintf(stderr, "Warning: Freeing unallocated memory\n");
+                        opt_warn("Warning: Freeing unallocated memory\n");
                         has_error = true;
                     }
                     freed[instr->u.unary_op.src.id] = true;
@@ -1127,7 +2461,7 @@ bool opt_memory_safety_analysis(FcxIRFunction* function) {
                 case FCXIR_LOAD:
                 case FCXIR_STORE:
                     if (freed[instr->u.load_store.src.id]) {
-                        fprintf(stderr, "Warning: Use after free detected\n");
+                        opt_warn("Warning: Use after free detected\n");
                         has_error = true;
                     }
                     break;
@@ -1206,7 +2540,7 @@ bool opt_leak_detection(FcxIRFunction* function) {
     bool has_leaks = false;
     for (uint32_t i = 0; i < function->next_vreg_id; i++) {
         if (allocated[i] && !freed[i] && !escaped[i]) {
-            fprintf(stderr, "Warning: Potential memory leak for %%v%u\n", i);
+            opt_warn("Warning: Potential memory leak for %%v%u\n", i);
             has_leaks = true;
         }
     }
@@ -1222,33 +2556,41 @@ bool opt_leak_detection(FcxIRFunction* function) {
 // Run All Optimization Passes
 // ============================================================================
 
-bool ir_optimize_function_with_level(FcxIRFunction* function, int opt_level) {
-    if (!function) return false;
-    
-    bool changed = false;
-    
-    // O0: No optimizations
-    if (opt_level == 0) {
-        return false;
+static double opt_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Adds the time since start to a pass's counters, if there are any
+static void opt_record(IROptStats* stats, IROptPass pass, double start) {
+    if (!stats) return;
+    stats->passes[pass].seconds += opt_now() - start;
+    stats->passes[pass].runs++;
+}
+
+static uint64_t count_instructions(const FcxIRFunction* function) {
+    uint64_t count = 0;
+    for (uint32_t b = 0; b < function->block_count; b++) {
+        count += function->blocks[b].instruction_count;
     }
+    return count;
+}
+
+// The whole-function passes: one round at O1, iterated to a fixpoint for
+// functions that could not be put into SSA form; every pass scans every
+// instruction
+static bool optimize_fixpoint(FcxIRFunction* function, int opt_level, IROptPassStats* stats) {
+    bool changed = false;
     
-    // O1: Basic optimizations only
+    // O1: one round of the basic passes
     if (opt_level == 1) {
-        if (opt_constant_folding(function)) {
-            changed = true;
-        }
-        if (opt_dead_code_elimination(function)) {
-            changed = true;
-        }
-        
-        // Run analysis passes (silently, only report errors)
-        opt_type_checking(function);
-        opt_pointer_analysis(function);
-        
+        if (stats) stats->visits += 2 * count_instructions(function);
+        changed |= opt_constant_folding(function);
+        changed |= opt_dead_code_elimination(function, NULL);
         return changed;
     }
     
-    // O2 and above: Full optimization pipeline
     bool pass_changed = true;
     int iteration = 0;
     const int max_iterations = (opt_level >= 3) ? 15 : 10;  // More iterations for O3+
@@ -1258,62 +2600,352 @@ bool ir_optimize_function_with_level(FcxIRFunction* function, int opt_level) {
         pass_changed = false;
         iteration++;
         
-        // Run constant folding first
-        if (opt_constant_folding(function)) {
-            pass_changed = true;
-            changed = true;
+        if (stats) stats->visits += 4 * count_instructions(function);
+        pass_changed |= opt_constant_folding(function);
+        pass_changed |= opt_algebraic_simplification(function);
+        pass_changed |= opt_strength_reduction(function);
+        pass_changed |= opt_dead_code_elimination(function, NULL);
+        changed |= pass_changed;
+    }
+    
+    return changed;
+}
+
+// Below this size a function without loops is not worth SCCP: building the
+// def-use chains and the lattice takes about twice as long as a round of the
+// whole-function folding passes, and without values carried around a loop
+// all it finds beyond them is the odd branch on a constant
+#define SPARSE_MIN_INSTRUCTIONS 64
+
+static bool use_sparse_passes(FcxIRFunction* function) {
+    if (count_instructions(function) >= SPARSE_MIN_INSTRUCTIONS) return true;
+    const IRCFG* cfg = ir_cfg_get(function);
+    return !cfg || cfg->loop_count > 0;
+}
+
+// One round of folding, algebraic simplification and strength reduction for
+// small loop-free functions in SSA form; none of them changes the CFG
+static bool optimize_small_ssa(FcxIRFunction* function, IROptPassStats* stats) {
+    if (stats) stats->visits += 3 * count_instructions(function);
+    bool changed = opt_constant_folding(function);
+    changed |= opt_algebraic_simplification(function);
+    changed |= opt_strength_reduction(function);
+    return changed;
+}
+
+static bool optimize_function(FcxIRFunction* function, int opt_level, IROptStats* stats) {
+    if (!function) return false;
+    
+    // O0: No optimizations
+    if (opt_level == 0) {
+        return false;
+    }
+    
+    if (stats) {
+        stats->functions++;
+        stats->instructions += count_instructions(function);
+    }
+    
+    bool changed = false;
+    double start = stats ? opt_now() : 0.0;
+    
+    if (function->is_ssa && opt_level >= 2) {
+        // One sparse sweep each reaches the fixpoint of folding, algebraic
+        // simplification, strength reduction and DCE; GVN in between shares
+        // what SCCP left equal, and LICM only hoists, which creates nothing
+        // for them to find
+        bool sparse = use_sparse_passes(function);
+        if (sparse) {
+            changed |= opt_sparse_constant_propagation(function, stats ? &stats->passes[IR_OPT_PASS_SCCP] : NULL);
+            opt_record(stats, IR_OPT_PASS_SCCP, start);
         }
         
-        // Run algebraic simplification
-        if (opt_algebraic_simplification(function)) {
-            pass_changed = true;
-            changed = true;
-        }
+        start = stats ? opt_now() : 0.0;
+        changed |= opt_global_value_numbering(function, stats ? &stats->passes[IR_OPT_PASS_GVN] : NULL);
+        opt_record(stats, IR_OPT_PASS_GVN, start);
         
-        // Run strength reduction
-        if (opt_strength_reduction(function)) {
-            pass_changed = true;
-            changed = true;
+        // Without SCCP, folding comes after GVN, which has pointed the
+        // readers of copies at their sources
+        if (!sparse) {
+            start = stats ? opt_now() : 0.0;
+            changed |= optimize_small_ssa(function, stats ? &stats->passes[IR_OPT_PASS_FIXPOINT] : NULL);
+            opt_record(stats, IR_OPT_PASS_FIXPOINT, start);
         }
         
-        // Run dead code elimination to clean up
-        if (opt_dead_code_elimination(function)) {
-            pass_changed = true;
-            changed = true;
-        }
+        start = stats ? opt_now() : 0.0;
+        changed |= opt_dead_code_elimination(function, stats ? &stats->passes[IR_OPT_PASS_DCE] : NULL);
+        opt_record(stats, IR_OPT_PASS_DCE, start);
         
         // O3+: Run loop optimizations
         if (opt_level >= 3) {
-            if (opt_loop_invariant_code_motion(function)) {
-                pass_changed = true;
-                changed = true;
-            }
+            start = stats ? opt_now() : 0.0;
+            changed |= opt_loop_invariant_code_motion(function);
+            opt_record(stats, IR_OPT_PASS_LICM, start);
         }
+    } else {
+        changed |= optimize_fixpoint(function, opt_level, stats ? &stats->passes[IR_OPT_PASS_FIXPOINT] : NULL);
+        opt_record(stats, IR_OPT_PASS_FIXPOINT, start);
     }
     
     // Run analysis passes (silently, only report errors)
+    start = stats ? opt_now() : 0.0;
     opt_type_checking(function);
     opt_pointer_analysis(function);
-    opt_memory_safety_analysis(function);
-    opt_leak_detection(function);
+    if (opt_level >= 2) {
+        opt_memory_safety_analysis(function);
+        opt_leak_detection(function);
+    }
+    opt_record(stats, IR_OPT_PASS_ANALYSIS, start);
     
     return changed;
 }
 
-bool ir_optimize_module_with_level(FcxIRModule* module, int opt_level) {
+bool ir_optimize_function_with_level(FcxIRFunction* function, int opt_level) {
+    return optimize_function(function, opt_level, NULL);
+}
+
+// ============================================================================
+// Parallel Module Optimization
+// ============================================================================
+
+// Functions are optimized independently, so a module is spread over worker
+// threads. Each worker starts with a contiguous share of the functions of
+// about equal instruction count, takes functions from the front of it, and
+// once it runs dry steals the back half of another worker's remaining share.
+// A share is one atomic word, first function in the high half and end in the
+// low half, so taking and stealing are single compare-and-swaps. Each
+// function's result does not depend on which thread optimized it; counters
+// are summed in worker order and warnings printed in function order, so the
+// output is the same as a serial run's.
+
+typedef struct {
+    _Alignas(64) _Atomic uint64_t range;
+} OptShare;
+
+typedef struct {
+    FcxIRModule* module;
+    int opt_level;
+    OptShare* shares;
+    size_t worker_count;
+    OptDiagnostics* diagnostics;    // One per function
+} ParallelOptimize;
+
+typedef struct {
+    ParallelOptimize* work;
+    size_t index;
+    IROptStats stats;
+    bool collect_stats;
+    bool changed;
+    pthread_t thread;
+    bool started;
+} OptWorker;
+
+static uint64_t share_range(uint32_t first, uint32_t end) {
+    return (uint64_t)first << 32 | end;
+}
+
+// Next function of the worker's own share, or UINT32_MAX
+static uint32_t share_take(OptShare* share) {
+    uint64_t range = atomic_load(&share->range);
+    for (;;) {
+        uint32_t first = (uint32_t)(range >> 32);
+        uint32_t end = (uint32_t)range;
+        if (first >= end) return UINT32_MAX;
+        if (atomic_compare_exchange_weak(&share->range, &range, share_range(first + 1, end))) {
+            return first;
+        }
+    }
+}
+
+// Moves the back half of another share into the thief's empty one and
+// returns its first function, or UINT32_MAX if every share is empty
+static uint32_t share_steal(ParallelOptimize* work, size_t thief) {
+    for (size_t k = 1; k < work->worker_count; k++) {
+        OptShare* victim = &work->shares[(thief + k) % work->worker_count];
+        uint64_t range = atomic_load(&victim->range);
+        for (;;) {
+            uint32_t first = (uint32_t)(range >> 32);
+            uint32_t end = (uint32_t)range;
+            if (first >= end) break;
+            
+            uint32_t middle = first + (end - first) / 2;
+            if (atomic_compare_exchange_weak(&victim->range, &range, share_range(first, middle))) {
+                atomic_store(&work->shares[thief].range, share_range(middle + 1, end));
+                return middle;
+            }
+        }
+    }
+    return UINT32_MAX;
+}
+
+static void* optimize_worker(void* arg) {
+    OptWorker* worker = (OptWorker*)arg;
+    ParallelOptimize* work = worker->work;
+    IROptStats* stats = worker->collect_stats ? &worker->stats : NULL;
+    opt_scratch = ir_arena_create();
+    
+    for (;;) {
+        uint32_t f = share_take(&work->shares[worker->index]);
+        if (f == UINT32_MAX) f = share_steal(work, worker->index);
+        if (f == UINT32_MAX) break;
+        
+        opt_diagnostics = &work->diagnostics[f];
+        worker->changed |= optimize_function(&work->module->functions[f], work->opt_level, stats);
+        opt_diagnostics = NULL;
+    }
+    
+    ir_arena_destroy(opt_scratch);
+    opt_scratch = NULL;
+    return NULL;
+}
+
+static void add_stats(IROptStats* total, const IROptStats* part) {
+    for (int p = 0; p < IR_OPT_PASS_COUNT; p++) {
+        total->passes[p].seconds += part->passes[p].seconds;
+        total->passes[p].runs += part->passes[p].runs;
+        total->passes[p].visits += part->passes[p].visits;
+        total->passes[p].changes += part->passes[p].changes;
+    }
+    total->functions += part->functions;
+    total->instructions += part->instructions;
+}
+
+static size_t online_cores(void) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (size_t)cores : 1;
+}
+
+// Returns false if the threads could not be set up; nothing has been
+// optimized in that case
+static bool optimize_module_parallel(FcxIRModule* module, int opt_level, size_t jobs,
+                                     IROptStats* stats, bool* changed) {
+    uint32_t function_count = module->function_count;
+    size_t worker_count = jobs < function_count ? jobs : function_count;
+    
+    ParallelOptimize work = {
+        .module = module,
+        .opt_level = opt_level,
+        .shares = (OptShare*)aligned_alloc(_Alignof(OptShare), worker_count * sizeof(OptShare)),
+        .worker_count = worker_count,
+        .diagnostics = (OptDiagnostics*)calloc(function_count, sizeof(OptDiagnostics)),
+    };
+    OptWorker* workers = (OptWorker*)calloc(worker_count, sizeof(OptWorker));
+    if (!work.shares || !work.diagnostics || !workers) {
+        free(work.shares);
+        free(work.diagnostics);
+        free(workers);
+        return false;
+    }
+    
+    // Shares of about equal instruction count
+    uint64_t total = 0;
+    for (uint32_t f = 0; f < function_count; f++) {
+        total += count_instructions(&module->functions[f]);
+    }
+    uint32_t first = 0;
+    uint64_t weight = 0;
+    for (size_t w = 0; w < worker_count; w++) {
+        uint64_t target = total * (w + 1) / worker_count;
+        uint32_t end = first;
+        while (end < function_count && (weight < target || w + 1 == worker_count)) {
+            weight += count_instructions(&module->functions[end++]);
+        }
+        atomic_init(&work.shares[w].range, share_range(first, end));
+        first = end;
+        
+        workers[w].work = &work;
+        workers[w].index = w;
+        workers[w].collect_stats = stats != NULL;
+    }
+    
+    // The calling thread is worker 0
+    for (size_t w = 1; w < worker_count; w++) {
+        workers[w].started = pthread_create(&workers[w].thread, NULL, optimize_worker, &workers[w]) == 0;
+    }
+    optimize_worker(&workers[0]);
+    for (size_t w = 1; w < worker_count; w++) {
+        if (workers[w].started) pthread_join(workers[w].thread, NULL);
+    }
+    
+    for (size_t w = 0; w < worker_count; w++) {
+        *changed |= workers[w].changed;
+        if (stats) add_stats(stats, &workers[w].stats);
+    }
+    for (uint32_t f = 0; f < function_count; f++) {
+        if (work.diagnostics[f].length > 0) {
+            fwrite(work.diagnostics[f].text, 1, work.diagnostics[f].length, stderr);
+        }
+        free(work.diagnostics[f].text);
+    }
+    free(work.diagnostics);
+    free(work.shares);
+    free(workers);
+    return true;
+}
+
+bool ir_optimize_module_with_jobs(FcxIRModule* module, int opt_level, size_t jobs, IROptStats* stats) {
     if (!module) return false;
     
     bool changed = false;
+    double start = stats ? opt_now() : 0.0;
+    if (jobs == 0) jobs = online_cores();
     
-    for (uint32_t i = 0; i < module->function_count; i++) {
-        if (ir_optimize_function_with_level(&module->functions[i], opt_level)) {
-            changed = true;
+    if (opt_level > 0 && jobs > 1 && module->function_count > 1 &&
+        optimize_module_parallel(module, opt_level, jobs, stats, &changed)) {
+        if (stats) stats->threads = jobs < module->function_count ? (uint32_t)jobs : module->function_count;
+    } else {
+        opt_scratch = ir_arena_create();
+        for (uint32_t i = 0; i < module->function_count; i++) {
+            if (optimize_function(&module->functions[i], opt_level, stats)) {
+                changed = true;
+            }
         }
+        ir_arena_destroy(opt_scratch);
+        opt_scratch = NULL;
+        if (stats) stats->threads = 1;
     }
     
+    if (stats) stats->seconds += opt_now() - start;
     return changed;
 }
 
+bool ir_optimize_module_with_stats(FcxIRModule* module, int opt_level, IROptStats* stats) {
+    return ir_optimize_module_with_jobs(module, opt_level, 1, stats);
+}
+
+bool ir_optimize_module_with_level(FcxIRModule* module, int opt_level) {
+    return ir_optimize_module_with_stats(module, opt_level, NULL);
+}
+
+void ir_optimize_print_stats(const IROptStats* stats, FILE* out) {
+    static const char* const pass_names[IR_OPT_PASS_COUNT] = {
+        [IR_OPT_PASS_SCCP] = "sccp",
+        [IR_OPT_PASS_GVN] = "gvn",
+        [IR_OPT_PASS_DCE] = "dce",
+        [IR_OPT_PASS_LICM] = "licm",
+        [IR_OPT_PASS_FIXPOINT] = "whole-function",
+        [IR_OPT_PASS_ANALYSIS] = "analysis",
+    };
+    
+    if (!stats || !out) return;
+    
+    double total = 0.0;
+    fprintf(out, "IR optimization: %llu functions, %llu instructions, %u thread%s\n",
+            (unsigned long long)stats->functions, (unsigned long long)stats->instructions,
+            stats->threads, stats->threads == 1 ? "" : "s");
+    fprintf(out, "  %-20s %10s %8s %12s %10s\n", "pass", "ms", "runs", "visits", "changes");
+    for (int p = 0; p < IR_OPT_PASS_COUNT; p++) {
+        const IROptPassStats* pass = &stats->passes[p];
+        if (pass->runs == 0) continue;
+        fprintf(out, "  %-20s %10.3f %8llu %12llu %10llu\n", pass_names[p], pass->seconds * 1000.0,
+                (unsigned long long)pass->runs, (unsigned long long)pass->visits,
+                (unsigned long long)pass->changes);
+        total += pass->seconds;
+    }
+    fprintf(out, "  %-20s %10.3f\n", "total", total * 1000.0);
+    fprintf(out, "  %-20s %10.3f\n", "wall", stats->seconds * 1000.0);
+}
+
 bool ir_optimize_function(FcxIRFunction* function) {
     // Default to O2 optimization level
     return ir_optimize_function_with_level(function, 2);
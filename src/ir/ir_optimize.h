@@ -3,6 +3,7 @@
 
 #include "fcx_ir.h"
 #include <stdbool.h>
+#include <stdio.h>
 
 // Optimization pass interface
 typedef struct {
@@ -10,6 +11,33 @@ typedef struct {
     bool (*run)(FcxIRFunction* function);
 } OptimizationPass;
 
+// Per-pass counters for --time-passes
+typedef enum {
+    IR_OPT_PASS_SCCP,
+    IR_OPT_PASS_GVN,
+    IR_OPT_PASS_DCE,
+    IR_OPT_PASS_LICM,
+    IR_OPT_PASS_FIXPOINT,       // Whole-function passes: O1, functions not in SSA form, and
+                                // small loop-free ones instead of SCCP
+    IR_OPT_PASS_ANALYSIS,
+    IR_OPT_PASS_COUNT
+} IROptPass;
+
+typedef struct {
+    double seconds;
+    uint64_t runs;
+    uint64_t visits;            // Instructions evaluated
+    uint64_t changes;           // Instructions rewritten or removed
+} IROptPassStats;
+
+typedef struct {
+    IROptPassStats passes[IR_OPT_PASS_COUNT];    // Summed over all threads
+    uint64_t functions;
+    uint64_t instructions;      // In the optimized functions, before optimizing
+    uint32_t threads;
+    double seconds;             // Wall-clock time of the whole module
+} IROptStats;
+
 // Constant folding pass
 bool opt_constant_folding(FcxIRFunction* function);
 
@@ -19,8 +47,18 @@ bool opt_algebraic_simplification(FcxIRFunction* function);
 // Strength reduction pass
 bool opt_strength_reduction(FcxIRFunction* function);
 
-// Dead code elimination pass
-bool opt_dead_code_elimination(FcxIRFunction* function);
+// Dead code elimination from the instructions with side effects, which also
+// removes dead cycles; stats may be NULL
+bool opt_dead_code_elimination(FcxIRFunction* function, IROptPassStats* stats);
+
+// Sparse conditional constant propagation over SSA form, applying the
+// algebraic simplifications and strength reductions above as it goes; stats
+// may be NULL
+bool opt_sparse_constant_propagation(FcxIRFunction* function, IROptPassStats* stats);
+
+// Dominator-scoped global value numbering over SSA form, also removing
+// redundant loads and copies; stats may be NULL
+bool opt_global_value_numbering(FcxIRFunction* function, IROptPassStats* stats);
 
 // Basic loop optimizations
 bool opt_loop_invariant_code_motion(FcxIRFunction* function);
@@ -41,4 +79,12 @@ bool ir_optimize_function_with_level(FcxIRFunction* function, int opt_level);
 bool ir_optimize_module(FcxIRModule* module);
 bool ir_optimize_module_with_level(FcxIRModule* module, int opt_level);
 
+// Same, adding the time spent in each pass to stats
+bool ir_optimize_module_with_stats(FcxIRModule* module, int opt_level, IROptStats* stats);
+
+// Same, optimizing functions on up to jobs threads, or one per online core
+// if jobs is 0; the result and the warnings printed do not depend on it
+bool ir_optimize_module_with_jobs(FcxIRModule* module, int opt_level, size_t jobs, IROptStats* stats);
+void ir_optimize_print_stats(const IROptStats* stats, FILE* out);
+
 #endif // IR_OPTIMIZE_H
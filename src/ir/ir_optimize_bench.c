@@ -0,0 +1,192 @@
+// Parallel FCx IR optimization benchmark
+// Generates a module of a few hundred independent functions, then runs
+// ir_optimize_module_with_jobs on fresh copies of its SSA form at increasing
+// -j values and reports the speedup over one thread. Every run must leave
+// the same IR behind; a hash of opcodes, operands and constants is compared
+// against the serial run.
+// Usage: ir_optimize_bench [functions] [max_jobs]  (max_jobs defaults to #CPUs)
+
+#include "ir_gen.h"
+#include "ir_optimize.h"
+#include "ir_ssa.h"
+#include "../bench_source.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// One generated function; %zu is replaced by the function number. Unlike
+// BENCH_FUNCTION_TEMPLATE it has a loop, which gives LICM work to do
+static const char *FUNCTION_TEMPLATE =
+    "fn bench_func_%zu(a, b) -> i64 {\n"
+    "    let x := a + b * %zu\n"
+    "    let y := (x << 2) ^ (b >> 1)\n"
+    "    let total := 0\n"
+    "    let i := 0\n"
+    "    while i < 64 {\n"
+    "        let t := x * 3 + y\n"
+    "        let u := (x * 3 + y) & 255\n"
+    "        total := total + t - u + i * 8\n"
+    "        if total > 100000 {\n"
+    "            total := total - 100000\n"
+    "        }\n"
+    "        i := i + 1\n"
+    "    }\n"
+    "    if x > y {\n"
+    "        total := total + x - y\n"
+    "    } else {\n"
+    "        total := total + y - x\n"
+    "    }\n"
+    "    if b >= 48 {\n"
+    "        if b <= 57 {\n"
+    "            total := total * 10 + b - 48\n"
+    "        }\n"
+    "    }\n"
+    "    ret total + bench_helper(x, y, a & 255)\n"
+    "}\n"
+    "\n";
+
+static uint64_t hash_mix(uint64_t hash, uint64_t value) {
+  return (hash ^ value) * 1099511628211ULL;
+}
+
+// Block shapes, opcodes, operand ids and constants of every function
+static uint64_t hash_module(FcxIRModule *module, uint64_t *instructions) {
+  uint64_t hash = 1469598103934665603ULL;
+  *instructions = 0;
+  for (uint32_t f = 0; f < module->function_count; f++) {
+    FcxIRFunction *function = &module->functions[f];
+    hash = hash_mix(hash, function->block_count);
+    for (uint32_t b = 0; b < function->block_count; b++) {
+      FcxIRBasicBlock *block = &function->blocks[b];
+      hash = hash_mix(hash, block->instruction_count);
+      *instructions += block->instruction_count;
+      for (uint32_t i = 0; i < block->instruction_count; i++) {
+        FcxIRInstruction *instr = &block->instructions[i];
+        hash = hash_mix(hash, instr->opcode);
+        VirtualReg *reg;
+        for (uint32_t k = 0; (reg = fcx_ir_instruction_def(instr, k)); k++) {
+          hash = hash_mix(hash, reg->id);
+        }
+        for (uint32_t k = 0; (reg = fcx_ir_instruction_use(instr, k)); k++) {
+          hash = hash_mix(hash, reg->id);
+        }
+        if (instr->opcode == FCXIR_CONST) {
+          hash = hash_mix(hash, (uint64_t)instr->u.const_op.value);
+        }
+      }
+    }
+  }
+  return hash;
+}
+
+// Builds the module's SSA form and optimizes it at -O2 with `jobs` threads;
+// returns the seconds spent optimizing, or a negative value on failure
+static double optimize_once(Stmt **statements, size_t stmt_count, size_t jobs,
+                            uint64_t *ir_hash, uint64_t *instructions) {
+  IRGenerator *gen = ir_gen_create("bench_module");
+  if (!gen || !ir_gen_generate_module(gen, statements, stmt_count)) {
+    ir_gen_destroy(gen);
+    return -1.0;
+  }
+  ir_ssa_construct_module(gen->module);
+
+  double start = now_seconds();
+  ir_optimize_module_with_jobs(gen->module, 2, jobs, NULL);
+  double elapsed = now_seconds() - start;
+
+  *ir_hash = hash_module(gen->module, instructions);
+  ir_gen_destroy(gen);
+  return elapsed;
+}
+
+int main(int argc, char **argv) {
+  size_t function_count = 500;
+  if (argc > 1) {
+    function_count = (size_t)strtoul(argv[1], NULL, 10);
+    if (function_count == 0) {
+      function_count = 1;
+    }
+  }
+  long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t max_jobs = cpu_count > 0 ? (size_t)cpu_count : 1;
+  if (argc > 2) {
+    max_jobs = (size_t)strtoul(argv[2], NULL, 10);
+    if (max_jobs == 0) {
+      max_jobs = 1;
+    }
+  }
+
+  char *source = generate_bench_source(BENCH_HELPER, FUNCTION_TEMPLATE,
+                                       function_count, NULL);
+  if (!source) {
+    fprintf(stderr, "Error: Failed to allocate benchmark source\n");
+    return 1;
+  }
+
+  init_operator_registry();
+  TokenBuffer tokens;
+  if (!token_buffer_fill(&tokens, source)) {
+    fprintf(stderr, "Error: Failed to lex benchmark source\n");
+    free(source);
+    return 1;
+  }
+  Parser parser;
+  parser_init_tokens(&parser, &tokens);
+  Stmt **statements = NULL;
+  size_t stmt_count = 0;
+  if (!parse_program(&parser, 1, &statements, &stmt_count)) {
+    fprintf(stderr, "Error: Failed to parse benchmark source\n");
+    parser_destroy(&parser);
+    token_buffer_destroy(&tokens);
+    free(source);
+    return 1;
+  }
+
+  printf("=== FCx Parallel IR Optimization Benchmark ===\n");
+  printf("%zu functions, %ld CPUs\n\n", function_count + 1, cpu_count);
+
+  double serial = 0.0;
+  uint64_t reference_hash = 0;
+  for (size_t jobs = 1; jobs <= max_jobs; jobs *= 2) {
+    // Best of three to keep thread start-up noise out of the numbers
+    double best = 0.0;
+    uint64_t hash = 0;
+    uint64_t instructions = 0;
+    for (int run = 0; run < 3; run++) {
+      double elapsed =
+          optimize_once(statements, stmt_count, jobs, &hash, &instructions);
+      if (elapsed < 0.0) {
+        fprintf(stderr, "Error: Failed to generate benchmark IR\n");
+        best = -1.0;
+        break;
+      }
+      if (run == 0 || elapsed < best) {
+        best = elapsed;
+      }
+    }
+    if (best < 0.0) {
+      break;
+    }
+    if (jobs == 1) {
+      serial = best;
+      reference_hash = hash;
+    }
+
+    printf("-j %-3zu %9llu instrs after  %8.3f ms  %6.2fx%s\n", jobs,
+           (unsigned long long)instructions, best * 1000.0,
+           best > 0 ? serial / best : 0.0,
+           hash != reference_hash ? "  IR MISMATCH" : "");
+    if (jobs < max_jobs && jobs * 2 > max_jobs) {
+      jobs = max_jobs / 2; // Always finish with every CPU
+    }
+  }
+
+  free(statements);
+  parser_destroy(&parser);
+  token_buffer_destroy(&tokens);
+  free(source);
+  cleanup_operator_registry();
+  return 0;
+}
@@ -0,0 +1,788 @@
+#include "ir_ssa.h"
+#include "ir_cfg.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SSA_NONE UINT32_MAX
+
+// Growable list of block, variable or vreg indices in the scratch arena
+typedef struct {
+    uint32_t* items;
+    uint32_t count;
+    uint32_t capacity;
+} SSAList;
+
+// Edges, dominators and phi operand order (the predecessor order) come from
+// the function's ir_cfg analysis
+typedef struct {
+    SSAList frontier;       // Dominance frontier
+    SSAList phi_vars;       // Variable of each phi at the start of the block
+    uint32_t log_mark;      // Rename log length when the block was entered
+} SSABlock;
+
+// A vreg that is written more than once, or whose only write does not
+// dominate all of its reads
+typedef struct {
+    VirtualReg reg;         // Register as ir_gen wrote it
+    SSAList def_blocks;     // Blocks that write it, each once
+    SSAList names;          // Stack of current names while renaming
+    uint32_t undef_id;      // Zero constant for reads nothing reaches
+    bool is_global;         // Read in some block before being written there
+} SSAVariable;
+
+typedef struct {
+    FcxIRFunction* function;
+    IRArena* scratch;       // Everything below; released when the pass ends
+    const IRCFG* cfg;
+    SSABlock* blocks;
+    uint32_t block_count;
+    uint32_t vreg_limit;    // next_vreg_id before renaming
+    uint32_t* var_of;       // Variable index of each original vreg, or SSA_NONE
+    SSAVariable* vars;
+    uint32_t var_count;
+    SSAList log;            // Variables whose name stack was pushed, in order
+    SSAList undefs;         // Variables that needed an undef_id
+    bool failed;            // An allocation failed while renaming
+} SSABuilder;
+
+// A register stored outside its instruction (call arguments, inline asm
+// operands), which copying the instruction does not preserve
+typedef struct {
+    VirtualReg* reg;
+    uint32_t id;
+} SSASavedOperand;
+
+// The function as it was before phi insertion, to put back if a later step
+// fails part way through
+typedef struct {
+    FcxIRInstruction** instructions;   // Each block's array and its contents
+    FcxIRInstruction** copies;
+    uint32_t* counts;
+    uint32_t* capacities;
+    SSASavedOperand* operands;
+    uint32_t operand_count;
+    uint32_t next_vreg_id;
+} SSASnapshot;
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+// False if the list could not grow; the value is then not added
+static bool list_push(IRArena* arena, SSAList* list, uint32_t value) {
+    if (list->count >= list->capacity) {
+        uint32_t new_capacity = list->capacity == 0 ? 4 : list->capacity * 2;
+        uint32_t* new_items = (uint32_t*)ir_arena_grow(
+            arena, list->items, list->capacity * sizeof(uint32_t), new_capacity * sizeof(uint32_t));
+
+        if (!new_items) return false;
+
+        list->items = new_items;
+        list->capacity = new_capacity;
+    }
+
+    list->items[list->count++] = value;
+    return true;
+}
+
+static void* scratch_array(SSABuilder* ssa, size_t count, size_t size) {
+    void* array = ir_arena_alloc(ssa->scratch, count * size);
+    if (array) {
+        memset(array, 0, count * size);
+    }
+    return array;
+}
+
+static uint32_t* scratch_indices(SSABuilder* ssa, size_t count) {
+    uint32_t* array = (uint32_t*)ir_arena_alloc(ssa->scratch, count * sizeof(uint32_t));
+    for (size_t i = 0; array && i < count; i++) {
+        array[i] = SSA_NONE;
+    }
+    return array;
+}
+
+static uint32_t first_terminator(const FcxIRBasicBlock* block) {
+    for (uint32_t i = 0; i < block->instruction_count; i++) {
+        if (fcx_ir_is_terminator(&block->instructions[i])) return i;
+    }
+    return SSA_NONE;
+}
+
+// Replace a block's instructions with prefix followed by the current ones
+static bool prepend_instructions(FcxIRFunction* function, FcxIRBasicBlock* block,
+                                 const FcxIRInstruction* prefix, uint32_t prefix_count) {
+    uint32_t count = prefix_count + block->instruction_count;
+    FcxIRInstruction* instructions = (FcxIRInstruction*)ir_arena_alloc(
+        function->arena, count * sizeof(FcxIRInstruction));
+    if (!instructions) return false;
+
+    memcpy(instructions, prefix, prefix_count * sizeof(FcxIRInstruction));
+    if (block->instruction_count > 0) {
+        memcpy(instructions + prefix_count, block->instructions,
+               block->instruction_count * sizeof(FcxIRInstruction));
+    }
+    block->instructions = instructions;
+    block->instruction_count = count;
+    block->instruction_capacity = count;
+    return true;
+}
+
+// ============================================================================
+// CFG Normalization
+// ============================================================================
+
+// Ends every block in a terminator, drops unreachable blocks, puts the rest in
+// reverse postorder and records the edges. Jump targets are checked first: a
+// jump to a label that names no block returns false with the function
+// untouched. The later failures are allocation failures; the rewrites done
+// by then each keep the function's meaning, so it stays valid, only not
+// fully normalized.
+static bool normalize_cfg(SSABuilder* ssa) {
+    FcxIRFunction* function = ssa->function;
+    uint32_t n = function->block_count;
+    uint32_t label_limit = function->next_block_id;
+
+    uint32_t* index_of = scratch_indices(ssa, label_limit);
+    if (!index_of) return false;
+    for (uint32_t i = 0; i < n; i++) {
+        if (function->blocks[i].id >= label_limit) return false;
+        index_of[function->blocks[i].id] = i;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        const FcxIRBasicBlock* block = &function->blocks[i];
+        uint32_t term = first_terminator(block);
+        if (term == SSA_NONE) continue;
+
+        const FcxIRInstruction* instr = &block->instructions[term];
+        uint32_t targets[2] = {0, 0};
+        if (instr->opcode == FCXIR_JUMP) {
+            targets[0] = instr->u.jump_op.label_id;
+            targets[1] = targets[0];
+        } else if (instr->opcode == FCXIR_BRANCH) {
+            targets[0] = instr->u.branch_op.true_label;
+            targets[1] = instr->u.branch_op.false_label;
+        } else {
+            continue;
+        }
+        for (int t = 0; t < 2; t++) {
+            if (targets[t] >= label_limit || index_of[targets[t]] == SSA_NONE) return false;
+        }
+    }
+
+    // Code after the first terminator never runs; a block without one falls
+    // through to the next block, or returns 0 if it is the last
+    for (uint32_t i = 0; i < n; i++) {
+        FcxIRBasicBlock* block = &function->blocks[i];
+        uint32_t term = first_terminator(block);
+        if (term != SSA_NONE) {
+            block->instruction_count = term + 1;
+        } else if (i + 1 < n) {
+            fcx_ir_build_jump(block, function->blocks[i + 1].id);
+        } else {
+            VirtualReg zero = fcx_ir_alloc_vreg(function, VREG_TYPE_I64);
+            fcx_ir_build_const(block, zero, 0);
+            fcx_ir_build_return(block, zero, true);
+        }
+        if (block->instruction_count == 0) return false;
+    }
+
+    const IRCFG* cfg = ir_cfg_get(function);
+    if (!cfg) return false;
+
+    uint32_t reachable = cfg->rpo_count;
+    FcxIRBasicBlock* blocks = (FcxIRBasicBlock*)ir_arena_alloc(
+        function->arena, reachable * sizeof(FcxIRBasicBlock));
+    if (!blocks) return false;
+
+    for (uint32_t i = 0; i < reachable; i++) {
+        blocks[i] = function->blocks[cfg->rpo[i]];
+    }
+    function->blocks = blocks;
+    function->block_count = reachable;
+    function->block_capacity = reachable;
+    fcx_ir_invalidate_cfg(function);
+
+    // With the blocks in reverse postorder, block indices are reverse
+    // postorder numbers
+    if (!ir_cfg_update_edge_lists(function)) return false;
+    ssa->cfg = ir_cfg_get(function);
+    ssa->blocks = (SSABlock*)scratch_array(ssa, reachable, sizeof(SSABlock));
+    if (!ssa->blocks) return false;
+    ssa->block_count = reachable;
+
+    return true;
+}
+
+// ============================================================================
+// Dominance Frontiers
+// ============================================================================
+
+// A join block is in the frontier of every block on the dominator tree path
+// from each predecessor up to its idom
+static bool compute_frontiers(SSABuilder* ssa) {
+    const IRCFGBlock* blocks = ssa->cfg->blocks;
+
+    for (uint32_t b = 0; b < ssa->block_count; b++) {
+        if (blocks[b].pred_count < 2) continue;
+        for (uint32_t p = 0; p < blocks[b].pred_count; p++) {
+            uint32_t runner = blocks[b].preds[p];
+            while (runner != blocks[b].idom) {
+                SSAList* frontier = &ssa->blocks[runner].frontier;
+                if ((frontier->count == 0 || frontier->items[frontier->count - 1] != b) &&
+                    !list_push(ssa->scratch, frontier, b)) {
+                    return false;
+                }
+                runner = blocks[runner].idom;
+            }
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Variables
+// ============================================================================
+
+// Finds the vregs that need renaming, the blocks that write each of them and
+// whether each is live into some block. Returns false if the function cannot
+// be put into SSA form (phis already present, registers out of range).
+static bool find_variables(SSABuilder* ssa) {
+    FcxIRFunction* function = ssa->function;
+    uint32_t limit = ssa->vreg_limit;
+
+    uint32_t* def_count = (uint32_t*)scratch_array(ssa, limit, sizeof(uint32_t));
+    uint32_t* def_block = scratch_indices(ssa, limit);
+    uint32_t* defined_in = (uint32_t*)scratch_array(ssa, limit, sizeof(uint32_t));
+    VirtualReg* def_reg = (VirtualReg*)scratch_array(ssa, limit, sizeof(VirtualReg));
+    bool* is_param = (bool*)scratch_array(ssa, limit, sizeof(bool));
+    bool* is_var = (bool*)scratch_array(ssa, limit, sizeof(bool));
+    ssa->var_of = scratch_indices(ssa, limit);
+    if (!def_count || !def_block || !defined_in || !def_reg || !is_param || !is_var || !ssa->var_of) {
+        return false;
+    }
+
+    // A parameter is written on entry
+    for (uint8_t i = 0; i < function->parameter_count; i++) {
+        VirtualReg param = function->parameters[i];
+        if (param.id == 0 || param.id >= limit) return false;
+        if (def_count[param.id]++ == 0) {
+            def_block[param.id] = 0;
+            def_reg[param.id] = param;
+        }
+        is_param[param.id] = true;
+    }
+
+    for (uint32_t b = 0; b < ssa->block_count; b++) {
+        FcxIRBasicBlock* block = &function->blocks[b];
+        for (uint32_t i = 0; i < block->instruction_count; i++) {
+            FcxIRInstruction* instr = &block->instructions[i];
+            if (instr->opcode == FCXIR_PHI) return false;
+
+            VirtualReg* reg;
+            for (uint32_t k = 0; (reg = fcx_ir_instruction_use(instr, k)) != NULL; k++) {
+                if (reg->id >= limit) return false;
+            }
+            for (uint32_t k = 0; (reg = fcx_ir_instruction_def(instr, k)) != NULL; k++) {
+                if (reg->id == 0) continue;
+                if (reg->id >= limit) return false;
+                if (def_count[reg->id]++ == 0) {
+                    def_block[reg->id] = b;
+                    def_reg[reg->id] = *reg;
+                }
+            }
+        }
+    }
+
+    // Registers written once keep their name as long as that write dominates
+    // every read; reads of a never-written register are left alone
+    for (uint32_t b = 0; b < ssa->block_count; b++) {
+        FcxIRBasicBlock* block = &function->blocks[b];
+        for (uint32_t i = 0; i < block->instruction_count; i++) {
+            FcxIRInstruction* instr = &block->instructions[i];
+            VirtualReg* reg;
+            for (uint32_t k = 0; (reg = fcx_ir_instruction_use(instr, k)) != NULL; k++) {
+                uint32_t id = reg->id;
+                if (id == 0 || def_count[id] == 0 || is_var[id]) continue;
+                if (def_count[id] > 1) {
+                    is_var[id] = true;
+                } else if (is_param[id]) {
+                    continue;
+                } else if (def_block[id] == b) {
+                    is_var[id] = defined_in[id] != b + 1;
+                } else {
+                    is_var[id] = !ir_cfg_dominates(ssa->cfg, def_block[id], b);
+                }
+            }
+            for (uint32_t k = 0; (reg = fcx_ir_instruction_def(instr, k)) != NULL; k++) {
+                if (reg->id == 0) continue;
+                defined_in[reg->id] = b + 1;
+                if (def_count[reg->id] > 1) is_var[reg->id] = true;
+            }
+        }
+    }
+    for (uint8_t i = 0; i < function->parameter_count; i++) {
+        if (def_count[function->parameters[i].id] > 1) is_var[function->parameters[i].id] = true;
+    }
+
+    for (uint32_t id = 1; id < limit; id++) {
+        if (is_var[id]) ssa->var_count++;
+    }
+    if (ssa->var_count == 0) return true;
+
+    ssa->vars = (SSAVariable*)scratch_array(ssa, ssa->var_count, sizeof(SSAVariable));
+    uint32_t* killed = (uint32_t*)scratch_array(ssa, ssa->var_count, sizeof(uint32_t));
+    if (!ssa->vars || !killed) return false;
+
+    uint32_t v = 0;
+    for (uint32_t id = 1; id < limit; id++) {
+        if (!is_var[id]) continue;
+        ssa->var_of[id] = v;
+        ssa->vars[v].reg = def_reg[id];
+        v++;
+    }
+
+    // Semi-pruned SSA: only variables read before being written in some
+    // block can need a phi
+    for (uint32_t b = 0; b < ssa->block_count; b++) {
+        if (b == 0) {
+            for (uint8_t i = 0; i < function->parameter_count; i++) {
+                uint32_t var = ssa->var_of[function->parameters[i].id];
+                if (var == SSA_NONE || killed[var] == 1) continue;
+                killed[var] = 1;
+                if (!list_push(ssa->scratch, &ssa->vars[var].def_blocks, 0)) return false;
+            }
+        }
+
+        FcxIRBasicBlock* block = &function->blocks[b];
+        for (uint32_t i = 0; i < block->instruction_count; i++) {
+            FcxIRInstruction* instr = &block->instructions[i];
+            VirtualReg* reg;
+            for (uint32_t k = 0; (reg = fcx_ir_instruction_use(instr, k)) != NULL; k++) {
+                uint32_t var = reg->id != 0 ? ssa->var_of[reg->id] : SSA_NONE;
+                if (var != SSA_NONE && killed[var] != b + 1) {
+                    ssa->vars[var].is_global = true;
+                }
+            }
+            for (uint32_t k = 0; (reg = fcx_ir_instruction_def(instr, k)) != NULL; k++) {
+                uint32_t var = reg->id != 0 ? ssa->var_of[reg->id] : SSA_NONE;
+                if (var == SSA_NONE || killed[var] == b + 1) continue;
+                killed[var] = b + 1;
+                if (!list_push(ssa->scratch, &ssa->vars[var].def_blocks, b)) return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// ============================================================================
+// Phi Insertion
+// ============================================================================
+
+static bool insert_phis(SSABuilder* ssa) {
+    FcxIRFunction* function = ssa->function;
+    uint32_t n = ssa->block_count;
+
+    uint32_t* has_phi = (uint32_t*)scratch_array(ssa, n, sizeof(uint32_t));
+    uint32_t* in_worklist = (uint32_t*)scratch_array(ssa, n, sizeof(uint32_t));
+    if (!has_phi || !in_worklist) return false;
+
+    // Iterated dominance frontier of each variable's definitions
+    SSAList worklist = {0};
+    for (uint32_t v = 0; v < ssa->var_count; v++) {
+        SSAVariable* var = &ssa->vars[v];
+        if (!var->is_global) continue;
+
+        worklist.count = 0;
+        for (uint32_t d = 0; d < var->def_blocks.count; d++) {
+            in_worklist[var->def_blocks.items[d]] = v + 1;
+            if (!list_push(ssa->scratch, &worklist, var->def_blocks.items[d])) return false;
+        }
+        for (uint32_t w = 0; w < worklist.count; w++) {
+            const SSAList* frontier = &ssa->blocks[worklist.items[w]].frontier;
+            for (uint32_t f = 0; f < frontier->count; f++) {
+                uint32_t y = frontier->items[f];
+                if (has_phi[y] == v + 1) continue;
+                has_phi[y] = v + 1;
+                if (!list_push(ssa->scratch, &ssa->blocks[y].phi_vars, v)) return false;
+                if (in_worklist[y] != v + 1) {
+                    in_worklist[y] = v + 1;
+                    if (!list_push(ssa->scratch, &worklist, y)) return false;
+                }
+            }
+        }
+    }
+
+    // Phis go in front of the block's instructions, one operand per
+    // predecessor; the operands are filled in while renaming
+    for (uint32_t b = 0; b < n; b++) {
+        const SSABlock* info = &ssa->blocks[b];
+        if (info->phi_vars.count == 0) continue;
+
+        const IRCFGBlock* edges = &ssa->cfg->blocks[b];
+        uint32_t pred_count = edges->pred_count;
+        FcxIRInstruction* phis = (FcxIRInstruction*)scratch_array(
+            ssa, info->phi_vars.count, sizeof(FcxIRInstruction));
+        if (!phis) return false;
+
+        for (uint32_t k = 0; k < info->phi_vars.count; k++) {
+            FcxIRInstruction* phi = &phis[k];
+            phi->opcode = FCXIR_PHI;
+            phi->operand_count = pred_count < UINT8_MAX ? (uint8_t)(pred_count + 1) : UINT8_MAX;
+            phi->u.phi_op.dest = ssa->vars[info->phi_vars.items[k]].reg;
+            phi->u.phi_op.incoming = (VirtualReg*)ir_arena_alloc(
+                function->arena, pred_count * sizeof(VirtualReg));
+            phi->u.phi_op.blocks = (uint32_t*)ir_arena_alloc(
+                function->arena, pred_count * sizeof(uint32_t));
+            if (!phi->u.phi_op.incoming || !phi->u.phi_op.blocks) return false;
+
+            for (uint32_t p = 0; p < pred_count; p++) {
+                phi->u.phi_op.incoming[p] = (VirtualReg){0};
+                phi->u.phi_op.blocks[p] = function->blocks[edges->preds[p]].id;
+            }
+            phi->u.phi_op.incoming_count = pred_count;
+        }
+        if (!prepend_instructions(function, &function->blocks[b], phis, info->phi_vars.count)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ============================================================================
+// Renaming
+// ============================================================================
+
+static uint32_t fresh_id(SSABuilder* ssa) {
+    return fcx_ir_alloc_vreg(ssa->function, VREG_TYPE_VOID).id;
+}
+
+static void push_name(SSABuilder* ssa, uint32_t var, uint32_t id) {
+    if (!list_push(ssa->scratch, &ssa->vars[var].names, id)) {
+        ssa->failed = true;
+    } else if (!list_push(ssa->scratch, &ssa->log, var)) {
+        ssa->vars[var].names.count--;
+        ssa->failed = true;
+    }
+}
+
+static uint32_t current_name(SSABuilder* ssa, uint32_t var) {
+    SSAVariable* v = &ssa->vars[var];
+    if (v->names.count > 0) return v->names.items[v->names.count - 1];
+
+    if (v->undef_id == 0) {
+        v->undef_id = fresh_id(ssa);
+        if (!list_push(ssa->scratch, &ssa->undefs, var)) ssa->failed = true;
+    }
+    return v->undef_id;
+}
+
+static uint32_t var_of(const SSABuilder* ssa, uint32_t id) {
+    return id != 0 && id < ssa->vreg_limit ? ssa->var_of[id] : SSA_NONE;
+}
+
+static void rename_block(SSABuilder* ssa, uint32_t b) {
+    FcxIRFunction* function = ssa->function;
+    FcxIRBasicBlock* block = &function->blocks[b];
+    const SSABlock* info = &ssa->blocks[b];
+
+    if (b == 0) {
+        for (uint8_t i = 0; i < function->parameter_count; i++) {
+            uint32_t var = var_of(ssa, function->parameters[i].id);
+            if (var != SSA_NONE) push_name(ssa, var, function->parameters[i].id);
+        }
+    }
+
+    for (uint32_t i = 0; i < block->instruction_count; i++) {
+        FcxIRInstruction* instr = &block->instructions[i];
+        VirtualReg* reg;
+
+        if (i < info->phi_vars.count) {
+            instr->u.phi_op.dest.id = fresh_id(ssa);
+            push_name(ssa, info->phi_vars.items[i], instr->u.phi_op.dest.id);
+            continue;
+        }
+
+        for (uint32_t k = 0; (reg = fcx_ir_instruction_use(instr, k)) != NULL; k++) {
+            uint32_t var = var_of(ssa, reg->id);
+            if (var != SSA_NONE) reg->id = current_name(ssa, var);
+        }
+        for (uint32_t k = 0; (reg = fcx_ir_instruction_def(instr, k)) != NULL; k++) {
+            uint32_t var = var_of(ssa, reg->id);
+            if (var == SSA_NONE) continue;
+            reg->id = fresh_id(ssa);
+            push_name(ssa, var, reg->id);
+        }
+    }
+
+    // Fill in this block's operand of the phis in its successors
+    const IRCFGBlock* edges = &ssa->cfg->blocks[b];
+    for (uint32_t s = 0; s < edges->succ_count; s++) {
+        uint32_t succ = edges->succs[s];
+        const SSABlock* succ_info = &ssa->blocks[succ];
+        if (succ_info->phi_vars.count == 0) continue;
+
+        uint32_t p = 0;
+        while (ssa->cfg->blocks[succ].preds[p] != b) p++;
+
+        for (uint32_t k = 0; k < succ_info->phi_vars.count; k++) {
+            uint32_t var = succ_info->phi_vars.items[k];
+            FcxIRInstruction* phi = &function->blocks[succ].instructions[k];
+            phi->u.phi_op.incoming[p] = ssa->vars[var].reg;
+            phi->u.phi_op.incoming[p].id = current_name(ssa, var);
+        }
+    }
+}
+
+// Preorder walk of the dominator tree; each block's names are popped again
+// once its subtree is done
+static bool rename_variables(SSABuilder* ssa) {
+    uint32_t n = ssa->block_count;
+    uint32_t* stack = scratch_indices(ssa, n);
+    uint32_t* next_child = (uint32_t*)scratch_array(ssa, n, sizeof(uint32_t));
+    if (!stack || !next_child) return false;
+
+    uint32_t depth = 0;
+    stack[depth++] = 0;
+    ssa->blocks[0].log_mark = ssa->log.count;
+    rename_block(ssa, 0);
+    while (depth > 0 && !ssa->failed) {
+        uint32_t b = stack[depth - 1];
+        const IRCFGBlock* node = &ssa->cfg->blocks[b];
+        if (next_child[b] < node->child_count) {
+            uint32_t child = node->children[next_child[b]++];
+            ssa->blocks[child].log_mark = ssa->log.count;
+            rename_block(ssa, child);
+            stack[depth++] = child;
+        } else {
+            while (ssa->log.count > ssa->blocks[b].log_mark) {
+                ssa->vars[ssa->log.items[--ssa->log.count]].names.count--;
+            }
+            depth--;
+        }
+    }
+
+    if (ssa->failed) return false;
+
+    // Reads that no write reaches see zero
+    if (ssa->undefs.count > 0) {
+        FcxIRInstruction* zeros = (FcxIRInstruction*)scratch_array(
+            ssa, ssa->undefs.count, sizeof(FcxIRInstruction));
+        if (!zeros) return false;
+
+        for (uint32_t u = 0; u < ssa->undefs.count; u++) {
+            const SSAVariable* var = &ssa->vars[ssa->undefs.items[u]];
+            zeros[u].opcode = FCXIR_CONST;
+            zeros[u].operand_count = 1;
+            zeros[u].u.const_op.dest = var->reg;
+            zeros[u].u.const_op.dest.id = var->undef_id;
+            zeros[u].u.const_op.value = 0;
+        }
+        if (!prepend_instructions(ssa->function, &ssa->function->blocks[0], zeros, ssa->undefs.count)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ============================================================================
+// Dead Phi Removal
+// ============================================================================
+
+// Semi-pruned placement leaves phis for variables that are dead at the join;
+// keep only phis that some other instruction reads, directly or through
+// other live phis
+static bool remove_dead_phis(SSABuilder* ssa) {
+    FcxIRFunction* function = ssa->function;
+    uint32_t limit = function->next_vreg_id;
+
+    uint32_t* phi_block = scratch_indices(ssa, limit);
+    uint32_t* phi_index = (uint32_t*)scratch_array(ssa, limit, sizeof(uint32_t));
+    bool* live = (bool*)scratch_array(ssa, limit, sizeof(bool));
+    if (!phi_block || !phi_index || !live) return false;
+
+    bool any_phi = false;
+    for (uint32_t b = 0; b < ssa->block_count; b++) {
+        FcxIRBasicBlock* block = &function->blocks[b];
+        for (uint32_t i = 0; i < block->instruction_count && block->instructions[i].opcode == FCXIR_PHI; i++) {
+            phi_block[block->instructions[i].u.phi_op.dest.id] = b;
+            phi_index[block->instructions[i].u.phi_op.dest.id] = i;
+            any_phi = true;
+        }
+    }
+    if (!any_phi) return true;
+
+    SSAList worklist = {0};
+    for (uint32_t b = 0; b < ssa->block_count; b++) {
+        FcxIRBasicBlock* block = &function->blocks[b];
+        for (uint32_t i = 0; i < block->instruction_count; i++) {
+            FcxIRInstruction* instr = &block->instructions[i];
+            if (instr->opcode == FCXIR_PHI) continue;
+
+            VirtualReg* reg;
+            for (uint32_t k = 0; (reg = fcx_ir_instruction_use(instr, k)) != NULL; k++) {
+                if (reg->id < limit && phi_block[reg->id] != SSA_NONE && !live[reg->id]) {
+                    live[reg->id] = true;
+                    if (!list_push(ssa->scratch, &worklist, reg->id)) return false;
+                }
+            }
+        }
+    }
+    for (uint32_t w = 0; w < worklist.count; w++) {
+        uint32_t id = worklist.items[w];
+        FcxIRInstruction* phi = &function->blocks[phi_block[id]].instructions[phi_index[id]];
+        for (uint32_t k = 0; k < phi->u.phi_op.incoming_count; k++) {
+            uint32_t in = phi->u.phi_op.incoming[k].id;
+            if (in < limit && phi_block[in] != SSA_NONE && !live[in]) {
+                live[in] = true;
+                if (!list_push(ssa->scratch, &worklist, in)) return false;
+            }
+        }
+    }
+
+    for (uint32_t b = 0; b < ssa->block_count; b++) {
+        FcxIRBasicBlock* block = &function->blocks[b];
+        uint32_t write = 0;
+        for (uint32_t read = 0; read < block->instruction_count; read++) {
+            const FcxIRInstruction* instr = &block->instructions[read];
+            if (instr->opcode == FCXIR_PHI && !live[instr->u.phi_op.dest.id]) continue;
+            if (write != read) block->instructions[write] = *instr;
+            write++;
+        }
+        block->instruction_count = write;
+    }
+
+    return true;
+}
+
+// ============================================================================
+// Rollback
+// ============================================================================
+
+static bool is_outside(const VirtualReg* reg, const FcxIRInstruction* instr) {
+    return (const void*)reg < (const void*)instr || (const void*)reg >= (const void*)(instr + 1);
+}
+
+// Phi insertion and renaming rewrite the function in place; this records
+// what they can change so snapshot_restore can undo a failed attempt
+static bool snapshot_take(SSABuilder* ssa, SSASnapshot* snap) {
+    FcxIRFunction* function = ssa->function;
+    uint32_t n = function->block_count;
+    memset(snap, 0, sizeof(*snap));
+    snap->next_vreg_id = function->next_vreg_id;
+    snap->instructions = (FcxIRInstruction**)scratch_array(ssa, n, sizeof(FcxIRInstruction*));
+    snap->copies = (FcxIRInstruction**)scratch_array(ssa, n, sizeof(FcxIRInstruction*));
+    snap->counts = (uint32_t*)scratch_array(ssa, n, sizeof(uint32_t));
+    snap->capacities = (uint32_t*)scratch_array(ssa, n, sizeof(uint32_t));
+    if (!snap->instructions || !snap->copies || !snap->counts || !snap->capacities) return false;
+
+    uint32_t outside = 0;
+    for (uint32_t b = 0; b < n; b++) {
+        FcxIRBasicBlock* block = &function->blocks[b];
+        snap->instructions[b] = block->instructions;
+        snap->counts[b] = block->instruction_count;
+        snap->capacities[b] = block->instruction_capacity;
+        if (block->instruction_count == 0) continue;
+        snap->copies[b] = (FcxIRInstruction*)ir_arena_alloc(
+            ssa->scratch, block->instruction_count * sizeof(FcxIRInstruction));
+        if (!snap->copies[b]) return false;
+        memcpy(snap->copies[b], block->instructions, block->instruction_count * sizeof(FcxIRInstruction));
+
+        for (uint32_t i = 0; i < block->instruction_count; i++) {
+            FcxIRInstruction* instr = &block->instructions[i];
+            VirtualReg* reg;
+            for (uint32_t k = 0; (reg = fcx_ir_instruction_use(instr, k)) != NULL; k++) {
+                outside += is_outside(reg, instr);
+            }
+            for (uint32_t k = 0; (reg = fcx_ir_instruction_def(instr, k)) != NULL; k++) {
+                outside += is_outside(reg, instr);
+            }
+        }
+    }
+    if (outside == 0) return true;
+
+    snap->operands = (SSASavedOperand*)ir_arena_alloc(ssa->scratch, outside * sizeof(SSASavedOperand));
+    if (!snap->operands) return false;
+    for (uint32_t b = 0; b < n; b++) {
+        FcxIRBasicBlock* block = &function->blocks[b];
+        for (uint32_t i = 0; i < block->instruction_count; i++) {
+            FcxIRInstruction* instr = &block->instructions[i];
+            VirtualReg* reg;
+            for (uint32_t k = 0; (reg = fcx_ir_instruction_use(instr, k)) != NULL; k++) {
+                if (is_outside(reg, instr)) snap->operands[snap->operand_count++] = (SSASavedOperand){reg, reg->id};
+            }
+            for (uint32_t k = 0; (reg = fcx_ir_instruction_def(instr, k)) != NULL; k++) {
+                if (is_outside(reg, instr)) snap->operands[snap->operand_count++] = (SSASavedOperand){reg, reg->id};
+            }
+        }
+    }
+    return true;
+}
+
+static void snapshot_restore(SSABuilder* ssa, const SSASnapshot* snap) {
+    FcxIRFunction* function = ssa->function;
+    for (uint32_t b = 0; b < function->block_count; b++) {
+        FcxIRBasicBlock* block = &function->blocks[b];
+        block->instructions = snap->instructions[b];
+        block->instruction_count = snap->counts[b];
+        block->instruction_capacity = snap->capacities[b];
+        if (snap->counts[b] > 0) {
+            memcpy(block->instructions, snap->copies[b], snap->counts[b] * sizeof(FcxIRInstruction));
+        }
+    }
+    for (uint32_t k = 0; k < snap->operand_count; k++) {
+        snap->operands[k].reg->id = snap->operands[k].id;
+    }
+    function->next_vreg_id = snap->next_vreg_id;
+}
+
+// ============================================================================
+// Driver
+// ============================================================================
+
+bool ir_ssa_construct_function(FcxIRFunction* function) {
+    if (!function) return false;
+    if (function->is_ssa) return true;
+    if (function->block_count == 0) return false;
+
+    SSABuilder ssa = {0};
+    ssa.function = function;
+    ssa.scratch = ir_arena_create();
+    if (!ssa.scratch) return false;
+
+    // The entry block must have no predecessors so that parameters and the
+    // zero constants for undefined reads can live there
+    bool ok = normalize_cfg(&ssa) && ssa.cfg->blocks[0].pred_count == 0;
+    if (ok) {
+        ssa.vreg_limit = function->next_vreg_id;
+        ok = compute_frontiers(&ssa) && find_variables(&ssa);
+    }
+    // Up to here the function keeps its meaning whatever fails; past the
+    // snapshot a failure puts it back as it was
+    SSASnapshot snapshot;
+    if (ok && ssa.var_count > 0 && (ok = snapshot_take(&ssa, &snapshot))) {
+        ok = insert_phis(&ssa) && rename_variables(&ssa) && remove_dead_phis(&ssa);
+        if (!ok) snapshot_restore(&ssa, &snapshot);
+    }
+
+    // Renaming rewrites operands wholesale, so the use counts are redone
+    fcx_ir_rebuild_uses(function);
+    function->is_ssa = ok;
+    ir_arena_destroy(ssa.scratch);
+    return ok;
+}
+
+bool ir_ssa_construct_module(FcxIRModule* module) {
+    if (!module) return false;
+
+    bool all_ssa = true;
+    for (uint32_t i = 0; i < module->function_count; i++) {
+        if (!ir_ssa_construct_function(&module->functions[i])) {
+            all_ssa = false;
+        }
+    }
+    return all_ssa;
+}
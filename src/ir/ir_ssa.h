@@ -0,0 +1,25 @@
+#ifndef IR_SSA_H
+#define IR_SSA_H
+
+#include "fcx_ir.h"
+#include <stdbool.h>
+
+// SSA construction for FCx IR
+// ir_gen gives every source variable one vreg and reassigns it with MOV. This
+// pass rewrites a function so that each vreg is defined once: it normalizes
+// the CFG (explicit fall-through jumps, unreachable blocks dropped, blocks in
+// reverse postorder, edge lists filled in), computes dominators and dominance
+// frontiers, inserts FCXIR_PHI instructions at the iterated dominance
+// frontier of each reassigned vreg and renames along the dominator tree.
+// Phis that end up unused are removed again.
+//
+// A vreg read on a path where it was never written reads zero, as it did
+// through the backend's zero-initialized stack slots.
+
+// Returns true if the function is in SSA form afterwards (function->is_ssa)
+bool ir_ssa_construct_function(FcxIRFunction* function);
+
+// Returns true if every function of the module is in SSA form afterwards
+bool ir_ssa_construct_module(FcxIRModule* module);
+
+#endif // IR_SSA_H
@@ -0,0 +1,221 @@
+#include "intern.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Names are bump-allocated into chunks, each preceded by an InternHeader.
+// An open-addressing table of name pointers (load factor at most 1/2) finds
+// existing names; a two-level page table maps ids back to names without
+// taking the lock.
+
+#define INTERN_CHUNK_SIZE (64 * 1024)
+#define INTERN_PAGE_BITS 12
+#define INTERN_PAGE_SIZE ((size_t)1 << INTERN_PAGE_BITS)
+#define INTERN_MAX_PAGES 16384 // 64M names
+
+typedef struct {
+  uint32_t hash;
+  InternId id;
+  uint32_t length;
+} InternHeader;
+
+typedef struct InternChunk InternChunk;
+struct InternChunk {
+  InternChunk *next;
+  size_t used;
+  size_t capacity;
+  _Alignas(max_align_t) unsigned char data[];
+};
+
+static pthread_mutex_t intern_lock = PTHREAD_MUTEX_INITIALIZER;
+static InternChunk *intern_chunks; // Chunk being filled first
+static const char **intern_table;  // NULL marks an empty slot
+static size_t intern_table_capacity;
+static InternStats intern_stats;
+static _Atomic(const char **) intern_pages[INTERN_MAX_PAGES];
+static _Atomic InternId intern_max_id;
+
+static const InternHeader *header_of(const char *name) {
+  return (const InternHeader *)name - 1;
+}
+
+static uint32_t intern_hash(const char *str, size_t length) {
+  uint32_t hash = 2166136261u; // FNV-1a
+  for (size_t i = 0; i < length; i++) {
+    hash ^= (uint8_t)str[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Slot holding the name, or the empty slot where it would go
+static size_t intern_probe(const char **table, size_t capacity, const char *str,
+                           size_t length, uint32_t hash) {
+  size_t mask = capacity - 1;
+  size_t index = hash & mask;
+  while (table[index]) {
+    const InternHeader *header = header_of(table[index]);
+    if (header->hash == hash && header->length == length &&
+        memcmp(table[index], str, length) == 0) {
+      break;
+    }
+    index = (index + 1) & mask;
+  }
+  return index;
+}
+
+static bool grow_table(void) {
+  size_t new_capacity =
+      intern_table_capacity == 0 ? 1024 : intern_table_capacity * 2;
+  const char **new_table = calloc(new_capacity, sizeof(const char *));
+  if (!new_table) {
+    return false;
+  }
+  for (size_t i = 0; i < intern_table_capacity; i++) {
+    const char *name = intern_table[i];
+    if (name) {
+      const InternHeader *header = header_of(name);
+      new_table[intern_probe(new_table, new_capacity, name, header->length,
+                             header->hash)] = name;
+    }
+  }
+  free(intern_table);
+  intern_table = new_table;
+  intern_table_capacity = new_capacity;
+  return true;
+}
+
+static void *chunk_alloc(size_t size) {
+  InternChunk *chunk = intern_chunks;
+  if (!chunk || chunk->capacity - chunk->used < size) {
+    size_t capacity = size > INTERN_CHUNK_SIZE ? size : INTERN_CHUNK_SIZE;
+    chunk = malloc(sizeof(InternChunk) + capacity);
+    if (!chunk) {
+      return NULL;
+    }
+    chunk->used = 0;
+    chunk->capacity = capacity;
+    chunk->next = intern_chunks;
+    intern_chunks = chunk;
+    intern_stats.bytes_reserved += capacity;
+  }
+  void *result = chunk->data + chunk->used;
+  chunk->used += size;
+  intern_stats.bytes_used += size;
+  return result;
+}
+
+// Store a name that is not in the table yet; caller holds the lock
+static const char *new_name(const char *str, size_t length, uint32_t hash) {
+  InternId id = (InternId)(intern_stats.strings + 1);
+  size_t page_index = id >> INTERN_PAGE_BITS;
+  if (page_index >= INTERN_MAX_PAGES) {
+    return NULL;
+  }
+  const char **page =
+      atomic_load_explicit(&intern_pages[page_index], memory_order_relaxed);
+  if (!page) {
+    page = calloc(INTERN_PAGE_SIZE, sizeof(const char *));
+    if (!page) {
+      return NULL;
+    }
+    atomic_store_explicit(&intern_pages[page_index], page,
+                          memory_order_release);
+  }
+
+  // Keep the next header 4-byte aligned
+  size_t size = (sizeof(InternHeader) + length + 1 + 3) & ~(size_t)3;
+  InternHeader *header = chunk_alloc(size);
+  if (!header) {
+    return NULL;
+  }
+  header->hash = hash;
+  header->id = id;
+  header->length = (uint32_t)length;
+  char *name = (char *)(header + 1);
+  memcpy(name, str, length);
+  name[length] = '\0';
+
+  page[id & (INTERN_PAGE_SIZE - 1)] = name;
+  atomic_store_explicit(&intern_max_id, id, memory_order_release);
+  intern_stats.strings++;
+  return name;
+}
+
+const char *fcx_intern(const char *str, size_t length) {
+  if (!str || length > UINT32_MAX / 2) {
+    return NULL;
+  }
+  uint32_t hash = intern_hash(str, length);
+
+  pthread_mutex_lock(&intern_lock);
+  intern_stats.lookups++;
+  const char *name = NULL;
+  if ((intern_stats.strings + 1) * 2 <= intern_table_capacity ||
+      grow_table()) {
+    size_t index = intern_probe(intern_table, intern_table_capacity, str,
+                                length, hash);
+    name = intern_table[index];
+    if (!name) {
+      name = new_name(str, length, hash);
+      intern_table[index] = name;
+    }
+  }
+  pthread_mutex_unlock(&intern_lock);
+  return name;
+}
+
+const char *fcx_intern_cstr(const char *str) {
+  return str ? fcx_intern(str, strlen(str)) : NULL;
+}
+
+InternId fcx_intern_id(const char *name) {
+  return name ? header_of(name)->id : 0;
+}
+
+size_t fcx_intern_length(const char *name) {
+  return name ? header_of(name)->length : 0;
+}
+
+const char *fcx_intern_name(InternId id) {
+  if (id == 0 ||
+      id > atomic_load_explicit(&intern_max_id, memory_order_acquire)) {
+    return NULL;
+  }
+  const char **page = atomic_load_explicit(
+      &intern_pages[id >> INTERN_PAGE_BITS], memory_order_acquire);
+  return page ? page[id & (INTERN_PAGE_SIZE - 1)] : NULL;
+}
+
+InternId fcx_intern_max_id(void) {
+  return atomic_load_explicit(&intern_max_id, memory_order_acquire);
+}
+
+void fcx_intern_stats(InternStats *stats) {
+  pthread_mutex_lock(&intern_lock);
+  *stats = intern_stats;
+  pthread_mutex_unlock(&intern_lock);
+}
+
+void fcx_intern_reset(void) {
+  pthread_mutex_lock(&intern_lock);
+  while (intern_chunks) {
+    InternChunk *next = intern_chunks->next;
+    free(intern_chunks);
+    intern_chunks = next;
+  }
+  free(intern_table);
+  intern_table = NULL;
+  intern_table_capacity = 0;
+
+  size_t page_count = ((size_t)intern_stats.strings >> INTERN_PAGE_BITS) + 1;
+  for (size_t i = 0; i < page_count && i < INTERN_MAX_PAGES; i++) {
+    free(atomic_exchange(&intern_pages[i], NULL));
+  }
+  atomic_store(&intern_max_id, 0);
+  memset(&intern_stats, 0, sizeof(intern_stats));
+  pthread_mutex_unlock(&intern_lock);
+}
@@ -0,0 +1,45 @@
+#ifndef FCX_INTERN_H
+#define FCX_INTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Compiler-wide string interner
+// Identifiers are interned by the lexer and the same canonical pointer is
+// carried through the AST, both IRs and the LLVM backend, so two interned
+// names are equal exactly when their pointers are. Every name also gets a
+// dense, stable InternId (1, 2, ...) that tables can index directly; 0 never
+// names a string. Names live in arena chunks until fcx_intern_reset.
+//
+// Interning takes a lock and may be called from any thread.
+// fcx_intern_id, fcx_intern_name and fcx_intern_length never lock.
+
+typedef uint32_t InternId;
+
+typedef struct {
+  size_t strings;        // Distinct names
+  size_t lookups;        // fcx_intern calls, hits and misses
+  size_t bytes_used;     // Name bytes including headers and padding
+  size_t bytes_reserved; // Chunk memory obtained from malloc
+} InternStats;
+
+// Canonical copy of the first length bytes of str; NULL on OOM
+const char *fcx_intern(const char *str, size_t length);
+const char *fcx_intern_cstr(const char *str);
+
+// Id and length of a pointer returned by fcx_intern
+InternId fcx_intern_id(const char *name);
+size_t fcx_intern_length(const char *name);
+
+// Name for an id returned by fcx_intern_id; NULL for 0 or unknown ids
+const char *fcx_intern_name(InternId id);
+
+// Highest id handed out so far
+InternId fcx_intern_max_id(void);
+
+void fcx_intern_stats(InternStats *stats);
+
+// Release every name. No interned pointer or id may be used afterwards.
+void fcx_intern_reset(void);
+
+#endif // FCX_INTERN_H
@@ -1,4 +1,5 @@
 #include "lexer.h"
+#include "lexer_simd.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,23 +7,39 @@
 // Stub implementation of FCx lexer
 // This would be fully implemented with operator trie in the complete compiler
 
+// Forward declaration
+static void build_keyword_hash(void);
+
 void lexer_init(Lexer *lexer, const char *source) {
   lexer->source = source;
   lexer->current = source;
   lexer->start = source;
+  lexer->end = source + strlen(source);
   lexer->line = 1;
   lexer->column = 1;
   lexer->had_error = false;
 
-  // Ensure operator registry is initialized
+  // Ensure operator registry and keyword hash are initialized
   static bool registry_initialized = false;
   if (!registry_initialized) {
     init_operator_registry();
+    build_keyword_hash();
     registry_initialized = true;
   }
 }
 
-bool lexer_is_at_end(const Lexer *lexer) { return *lexer->current == '\0'; }
+bool lexer_is_at_end(const Lexer *lexer) {
+  return lexer->current >= lexer->end;
+}
+
+// Bytes left before the end of the source. Operator lookahead is capped by
+// this instead of strlen() so lexing stays linear in the source size.
+static inline size_t lexer_remaining(const Lexer *lexer) {
+  return (size_t)(lexer->end - lexer->current);
+}
+
+// Longest operator symbol we ever try to match
+#define MAX_OPERATOR_LOOKAHEAD 20
 
 char peek(const Lexer *lexer) { return *lexer->current; }
 
@@ -46,6 +63,29 @@ char advance(Lexer *lexer) {
   return c;
 }
 
+// Move to `to` in one step, fixing up line/column from the newlines in the
+// skipped span instead of per byte
+static void lexer_skip_to(Lexer *lexer, const char *to) {
+  if (to == lexer->current) {
+    return;
+  }
+  const char *last_newline = NULL;
+  size_t newlines = lexer_count_newlines(lexer->current, to, &last_newline);
+  if (newlines > 0) {
+    lexer->line += newlines;
+    lexer->column = (size_t)(to - last_newline);
+  } else {
+    lexer->column += (size_t)(to - lexer->current);
+  }
+  lexer->current = to;
+}
+
+// Same as lexer_skip_to for spans known not to contain a newline
+static inline void lexer_skip_within_line(Lexer *lexer, const char *to) {
+  lexer->column += (size_t)(to - lexer->current);
+  lexer->current = to;
+}
+
 bool match(Lexer *lexer, char expected) {
   if (lexer_is_at_end(lexer))
     return false;
@@ -111,40 +151,37 @@ bool is_alnum(char c) { return is_alpha(c) || is_digit(c); }
 // Skip whitespace
 static void skip_whitespace(Lexer *lexer) {
   while (true) {
+    // Tokens are mostly separated by a single space; only go wide for runs
     char c = peek(lexer);
-    switch (c) {
-    case ' ':
-    case '\r':
-    case '\t':
+    if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
       advance(lexer);
-      break;
-    case '\n':
-      advance(lexer);
-      break;
-    case '/':
-      // Check for comments
-      if (peek_next(lexer) == '/') {
-        // Line comment - skip until end of line
-        while (peek(lexer) != '\n' && !lexer_is_at_end(lexer)) {
-          advance(lexer);
+      lexer_skip_to(lexer, lexer_scan_blanks(lexer->current, lexer->end));
+    }
+    if (peek(lexer) != '/') {
+      return;
+    }
+
+    // Check for comments
+    if (peek_next(lexer) == '/') {
+      // Line comment - skip until end of line
+      lexer_skip_within_line(
+          lexer, lexer_scan_for_byte(lexer->current, lexer->end, '\n'));
+    } else if (peek_next(lexer) == '*') {
+      // Block comment - skip until */ (or to the end if unterminated)
+      const char *p = lexer->current + 2;
+      while (true) {
+        p = lexer_scan_for_byte(p, lexer->end, '*');
+        if (p == lexer->end) {
+          break;
         }
-      } else if (peek_next(lexer) == '*') {
-        // Block comment - skip until */
-        advance(lexer); // Skip /
-        advance(lexer); // Skip *
-        while (!lexer_is_at_end(lexer)) {
-          if (peek(lexer) == '*' && peek_next(lexer) == '/') {
-            advance(lexer); // Skip *
-            advance(lexer); // Skip /
-            break;
-          }
-          advance(lexer);
+        if (p + 1 < lexer->end && p[1] == '/') {
+          p += 2;
+          break;
         }
-      } else {
-        return;
+        p++;
       }
-      break;
-    default:
+      lexer_skip_to(lexer, p);
+    } else {
       return;
     }
   }
@@ -162,11 +199,14 @@ static Token make_token(Lexer *lexer, TokenKind kind) {
 }
 
 // Create error token
+// The message is copied into the lexer so the token stays valid after the
+// caller's buffer goes out of scope
 static Token error_token(Lexer *lexer, const char *message) {
+  snprintf(lexer->error_message, sizeof(lexer->error_message), "%s", message);
   Token token;
   token.kind = TOK_ERROR;
-  token.start = message;
-  token.length = strlen(message);
+  token.start = lexer->error_message;
+  token.length = strlen(lexer->error_message);
   token.line = lexer->line;
   token.column = lexer->column;
   lexer_error(lexer, message);
@@ -194,12 +234,20 @@ static int process_escape(char c) {
 
 // Scan string literal with escape sequence processing
 static Token scan_string(Lexer *lexer) {
-  // First pass: count length
+  // First pass: count length. Plain runs are skipped in bulk; only quotes
+  // and backslashes need a closer look.
   const char *scan = lexer->current;
+  const char *end = lexer->end;
   size_t processed_len = 0;
   
-  while (*scan != '"' && *scan != '\0') {
-    if (*scan == '\\' && scan[1] != '\0') {
+  while (true) {
+    const char *special = lexer_scan_for_either(scan, end, '"', '\\');
+    processed_len += (size_t)(special - scan);
+    scan = special;
+    if (scan == end || *scan == '"') {
+      break;
+    }
+    if (scan + 1 < end) {
       char esc = scan[1];
       int escaped = process_escape(esc);
       if (escaped == -1) {
@@ -215,10 +263,8 @@ static Token scan_string(Lexer *lexer) {
     }
   }
   
-  if (*scan == '\0') {
-    while (!lexer_is_at_end(lexer) && peek(lexer) != '"') {
-      advance(lexer);
-    }
+  if (scan == end) {
+    lexer_skip_to(lexer, lexer_scan_for_byte(lexer->current, end, '"'));
     return error_token(lexer, "Unterminated string");
   }
   
@@ -230,22 +276,27 @@ static Token scan_string(Lexer *lexer) {
   
   // Second pass: copy and process escapes
   size_t out_pos = 0;
-  while (peek(lexer) != '"') {
-    char c = advance(lexer);
-    if (c == '\\') {
-      char esc = advance(lexer);
-      int escaped = process_escape(esc);
-      if (escaped == -1) {
-        processed[out_pos++] = c;
-        processed[out_pos++] = esc;
-      } else {
-        processed[out_pos++] = (char)escaped;
-      }
+  const char *p = lexer->current;
+  while (true) {
+    const char *special = lexer_scan_for_either(p, end, '"', '\\');
+    memcpy(processed + out_pos, p, (size_t)(special - p));
+    out_pos += (size_t)(special - p);
+    p = special;
+    if (*p == '"') {
+      break;
+    }
+    char esc = p[1];
+    int escaped = process_escape(esc);
+    if (escaped == -1) {
+      processed[out_pos++] = '\\';
+      processed[out_pos++] = esc;
     } else {
-      processed[out_pos++] = c;
+      processed[out_pos++] = (char)escaped;
     }
+    p += 2;
   }
   processed[out_pos] = '\0';
+  lexer_skip_to(lexer, p);
   
   // Closing quote
   advance(lexer);
@@ -325,133 +376,196 @@ static Token scan_number(Lexer *lexer) {
   return make_token(lexer, TOK_INTEGER);
 }
 
-// Check keyword
-static TokenKind check_keyword(const char *start, size_t length,
-                               const char *rest, TokenKind kind) {
-  if (strlen(rest) == length && memcmp(start, rest, length) == 0) {
-    return kind;
+// Keyword and type-name table. Adding a keyword is a one-line change here;
+// the perfect hash below is rebuilt from this table at startup.
+static const struct {
+  const char *text;
+  TokenKind kind;
+} KEYWORDS[] = {
+    // Statements and declarations
+    {"let", KW_LET},
+    {"const", KW_CONST},
+    {"fn", KW_FN},
+    {"if", KW_IF},
+    {"else", KW_ELSE},
+    {"loop", KW_LOOP},
+    {"while", KW_WHILE},
+    {"ret", KW_RET},
+    {"halt", KW_HALT},
+    {"break", KW_BREAK},
+    {"continue", KW_CONTINUE},
+
+    // Module system
+    {"mod", KW_MOD},
+    {"use", KW_USE},
+    {"pub", KW_PUB},
+    {"self", KW_SELF},
+    {"super", KW_SUPER},
+    {"crate", KW_CRATE},
+    {"as", KW_AS},
+
+    // Types
+    {"i8", KW_I8},
+    {"i16", KW_I16},
+    {"i32", KW_I32},
+    {"i64", KW_I64},
+    {"i128", KW_I128},
+    {"i256", KW_I256},
+    {"i512", KW_I512},
+    {"i1024", KW_I1024},
+    {"u8", KW_U8},
+    {"u16", KW_U16},
+    {"u32", KW_U32},
+    {"u64", KW_U64},
+    {"u128", KW_U128},
+    {"u256", KW_U256},
+    {"u512", KW_U512},
+    {"u1024", KW_U1024},
+    {"f32", KW_F32},
+    {"f64", KW_F64},
+    {"ptr", KW_PTR},
+};
+
+#define KEYWORD_COUNT (sizeof(KEYWORDS) / sizeof(KEYWORDS[0]))
+#define KEYWORD_MAX_LENGTH 16
+
+// Minimal perfect hash over KEYWORDS (hash-and-displace). A key's base hash
+// picks a bucket; the bucket's displacement remixes the hash into a slot in
+// [0, KEYWORD_COUNT). Every keyword gets its own slot, so a lookup is one
+// hash plus one length check and memcmp.
+typedef struct {
+  uint32_t seed;
+  uint16_t displacement[KEYWORD_COUNT];
+  uint8_t slot_keyword[KEYWORD_COUNT];  // KEYWORDS index stored in each slot
+  uint8_t slot_length[KEYWORD_COUNT];
+  size_t min_length;
+  size_t max_length;
+} KeywordHash;
+
+static KeywordHash keyword_hash;
+
+static inline uint32_t keyword_base_hash(const char *text, size_t length,
+                                         uint32_t seed) {
+  uint32_t h = 2166136261u ^ seed;
+  for (size_t i = 0; i < length; i++) {
+    h = (h ^ (unsigned char)text[i]) * 16777619u;
   }
-  return TOK_IDENTIFIER;
+  return h;
 }
 
-// Identify keyword or identifier
-static TokenKind identifier_type(Lexer *lexer) {
-  size_t length = (size_t)(lexer->current - lexer->start);
-  const char *start = lexer->start;
+static inline uint32_t keyword_slot(uint32_t hash, uint32_t displacement) {
+  uint32_t h = hash ^ (displacement * 0x9E3779B1u);
+  h ^= h >> 16;
+  h *= 0x85EBCA6Bu;
+  h ^= h >> 13;
+  return h % KEYWORD_COUNT;
+}
 
-  switch (start[0]) {
-  case 'a':
-    return check_keyword(start, length, "as", KW_AS);
-  case 'l':
-    if (length == 3 && memcmp(start, "let", 3) == 0) {
-      return KW_LET;
-    } else if (length == 4 && memcmp(start, "loop", 4) == 0) {
-      return KW_LOOP;
-    }
-    break;
-  case 'c':
-    if (length == 5 && memcmp(start, "const", 5) == 0) {
-      return KW_CONST;
-    } else if (length == 8 && memcmp(start, "continue", 8) == 0) {
-      return KW_CONTINUE;
-    } else if (length == 5 && memcmp(start, "crate", 5) == 0) {
-      return KW_CRATE;
-    }
-    break;
-  case 'f':
-    if (length == 2 && memcmp(start, "fn", 2) == 0) {
-      return KW_FN;
-    } else if (length == 3 && memcmp(start, "f32", 3) == 0) {
-      return KW_F32;
-    } else if (length == 3 && memcmp(start, "f64", 3) == 0) {
-      return KW_F64;
-    }
-    break;
-  case 'i':
-    if (length > 1) {
-      switch (start[1]) {
-      case 'f':
-        return check_keyword(start, length, "if", KW_IF);
-      case '8':
-        return check_keyword(start, length, "i8", KW_I8);
-      case '1':
-        if (length == 3) return check_keyword(start, length, "i16", KW_I16);
-        if (length == 4) return check_keyword(start, length, "i128", KW_I128);
-        if (length == 5) return check_keyword(start, length, "i1024", KW_I1024);
-        break;
-      case '2':
-        return check_keyword(start, length, "i256", KW_I256);
-      case '3':
-        return check_keyword(start, length, "i32", KW_I32);
-      case '5':
-        return check_keyword(start, length, "i512", KW_I512);
-      case '6':
-        return check_keyword(start, length, "i64", KW_I64);
+// Try to place every bucket with the given seed
+static bool build_keyword_hash_with_seed(uint32_t seed) {
+  uint32_t hashes[KEYWORD_COUNT];
+  size_t bucket_size[KEYWORD_COUNT] = {0};
+  bool slot_used[KEYWORD_COUNT] = {false};
+
+  keyword_hash.seed = seed;
+  for (size_t i = 0; i < KEYWORD_COUNT; i++) {
+    hashes[i] = keyword_base_hash(KEYWORDS[i].text, strlen(KEYWORDS[i].text),
+                                  seed);
+    bucket_size[hashes[i] % KEYWORD_COUNT]++;
+  }
+
+  // Place the largest buckets first while the table is emptiest
+  for (size_t size = KEYWORD_COUNT; size > 0; size--) {
+    for (size_t bucket = 0; bucket < KEYWORD_COUNT; bucket++) {
+      if (bucket_size[bucket] != size) {
+        continue;
       }
-    }
-    break;
-  case 'm':
-    return check_keyword(start, length, "mod", KW_MOD);
-  case 'u':
-    if (length == 3 && memcmp(start, "use", 3) == 0) {
-      return KW_USE;
-    } else if (length > 1) {
-      switch (start[1]) {
-      case '8':
-        return check_keyword(start, length, "u8", KW_U8);
-      case '1':
-        if (length == 3) return check_keyword(start, length, "u16", KW_U16);
-        if (length == 4) return check_keyword(start, length, "u128", KW_U128);
-        if (length == 5) return check_keyword(start, length, "u1024", KW_U1024);
-        break;
-      case '2':
-        return check_keyword(start, length, "u256", KW_U256);
-      case '3':
-        return check_keyword(start, length, "u32", KW_U32);
-      case '5':
-        return check_keyword(start, length, "u512", KW_U512);
-      case '6':
-        return check_keyword(start, length, "u64", KW_U64);
+
+      uint32_t displacement = 0;
+      for (; displacement <= UINT16_MAX; displacement++) {
+        uint32_t slots[KEYWORD_COUNT];
+        size_t placed = 0;
+        bool fits = true;
+        for (size_t i = 0; i < KEYWORD_COUNT && fits; i++) {
+          if (hashes[i] % KEYWORD_COUNT != bucket) {
+            continue;
+          }
+          uint32_t slot = keyword_slot(hashes[i], displacement);
+          fits = !slot_used[slot];
+          for (size_t j = 0; j < placed && fits; j++) {
+            fits = slots[j] != slot;
+          }
+          slots[placed++] = slot;
+        }
+        if (fits) {
+          break;
+        }
+      }
+      if (displacement > UINT16_MAX) {
+        return false;
+      }
+
+      keyword_hash.displacement[bucket] = (uint16_t)displacement;
+      for (size_t i = 0; i < KEYWORD_COUNT; i++) {
+        if (hashes[i] % KEYWORD_COUNT == bucket) {
+          uint32_t slot = keyword_slot(hashes[i], displacement);
+          slot_used[slot] = true;
+          keyword_hash.slot_keyword[slot] = (uint8_t)i;
+          keyword_hash.slot_length[slot] = (uint8_t)strlen(KEYWORDS[i].text);
+        }
       }
     }
-    break;
-  case 'r':
-    return check_keyword(start, length, "ret", KW_RET);
-  case 'h':
-    return check_keyword(start, length, "halt", KW_HALT);
-  case 'e':
-    return check_keyword(start, length, "else", KW_ELSE);
-  case 'w':
-    return check_keyword(start, length, "while", KW_WHILE);
-  case 'p':
-    if (length == 3 && memcmp(start, "ptr", 3) == 0) {
-      return KW_PTR;
-    } else if (length == 3 && memcmp(start, "pub", 3) == 0) {
-      return KW_PUB;
-    }
-    break;
-  case 'b':
-    return check_keyword(start, length, "break", KW_BREAK);
-  case 's':
-    if (length == 4 && memcmp(start, "self", 4) == 0) {
-      return KW_SELF;
-    } else if (length == 5 && memcmp(start, "super", 5) == 0) {
-      return KW_SUPER;
+  }
+  return true;
+}
+
+static void build_keyword_hash(void) {
+  keyword_hash.min_length = KEYWORD_MAX_LENGTH;
+  keyword_hash.max_length = 0;
+  for (size_t i = 0; i < KEYWORD_COUNT; i++) {
+    size_t length = strlen(KEYWORDS[i].text);
+    if (length < keyword_hash.min_length) keyword_hash.min_length = length;
+    if (length > keyword_hash.max_length) keyword_hash.max_length = length;
+  }
+
+  for (uint32_t seed = 0;; seed++) {
+    if (build_keyword_hash_with_seed(seed)) {
+      return;
     }
-    break;
+  }
+}
+
+// Identify keyword or identifier
+static TokenKind identifier_type(Lexer *lexer) {
+  size_t length = (size_t)(lexer->current - lexer->start);
+  const char *start = lexer->start;
+
+  if (length < keyword_hash.min_length || length > keyword_hash.max_length) {
+    return TOK_IDENTIFIER;
   }
 
+  uint32_t hash = keyword_base_hash(start, length, keyword_hash.seed);
+  uint32_t slot =
+      keyword_slot(hash, keyword_hash.displacement[hash % KEYWORD_COUNT]);
+  if (keyword_hash.slot_length[slot] == length &&
+      memcmp(start, KEYWORDS[keyword_hash.slot_keyword[slot]].text, length) ==
+          0) {
+    return KEYWORDS[keyword_hash.slot_keyword[slot]].kind;
+  }
   return TOK_IDENTIFIER;
 }
 
 // Scan identifier
 static Token scan_identifier(Lexer *lexer) {
-  while (is_alnum(peek(lexer))) {
-    advance(lexer);
-  }
+  lexer_skip_within_line(
+      lexer, lexer_scan_identifier_chars(lexer->current, lexer->end));
 
   TokenKind kind = identifier_type(lexer);
-  return make_token(lexer, kind);
+  Token token = make_token(lexer, kind);
+  if (kind == TOK_IDENTIFIER) {
+    token.value.identifier = fcx_intern(token.start, token.length);
+  }
+  return token;
 }
 
 // Scan operator using greedy maximal matching trie lookup
@@ -460,8 +574,9 @@ static Token scan_operator(Lexer *lexer) {
 
   // Calculate maximum possible operator length (up to end of source or 20
   // chars)
-  size_t remaining = strlen(lexer->current);
-  size_t max_length = remaining > 20 ? 20 : remaining;
+  size_t remaining = lexer_remaining(lexer);
+  size_t max_length =
+      remaining > MAX_OPERATOR_LOOKAHEAD ? MAX_OPERATOR_LOOKAHEAD : remaining;
 
   size_t matched_length = 0;
   const OperatorInfo *best_match =
@@ -471,9 +586,9 @@ static Token scan_operator(Lexer *lexer) {
   char c = peek(lexer);
 
 #ifdef TEST_MODE
-  if (c == '/' && strlen(lexer->current) >= 2) {
+  if (c == '/' && lexer_remaining(lexer) >= 2) {
     char debug_str[21] = {0};
-    size_t len = strlen(lexer->current);
+    size_t len = lexer_remaining(lexer);
     size_t copy_len = len < 20 ? len : 20;
     memcpy(debug_str, lexer->current, copy_len);
     debug_str[copy_len] = '\0';
@@ -491,9 +606,9 @@ static Token scan_operator(Lexer *lexer) {
     }
 
 #ifdef TEST_MODE
-    if (c == '/' && strlen(lexer->current) >= 2) {
+    if (c == '/' && lexer_remaining(lexer) >= 2) {
       char debug_str[21] = {0};
-      size_t len = strlen(lexer->current);
+      size_t len = lexer_remaining(lexer);
       size_t copy_len = len < 20 ? len : 20;
       memcpy(debug_str, lexer->current, copy_len);
       debug_str[copy_len] = '\0';
@@ -558,7 +673,10 @@ static Token scan_operator(Lexer *lexer) {
       size_t op_len = 0;
 
       // Read up to 20 characters or until non-operator character
-      for (size_t i = 0; i < 20 && lexer->current[i] != '\0'; i++) {
+      size_t scan_limit = lexer_remaining(lexer) < MAX_OPERATOR_LOOKAHEAD
+                              ? lexer_remaining(lexer)
+                              : MAX_OPERATOR_LOOKAHEAD;
+      for (size_t i = 0; i < scan_limit; i++) {
         char ch = lexer->current[i];
         if (strchr("<>/"
                    "|\\:;!?^@%$&*~`.,_"
@@ -675,17 +793,18 @@ Token lexer_next_token(Lexer *lexer) {
   // Always try operator lookup first for any character that could start an
   // operator This handles all operators including multi-character ones like
   // mem>, stack>, print>, etc.
-  size_t remaining = strlen(lexer->current);
-  size_t max_length = remaining > 20 ? 20 : remaining;
+  size_t remaining = lexer_remaining(lexer);
+  size_t max_length =
+      remaining > MAX_OPERATOR_LOOKAHEAD ? MAX_OPERATOR_LOOKAHEAD : remaining;
   size_t matched_length = 0;
   const OperatorInfo *op_match =
       trie_lookup_greedy(lexer->current, max_length, &matched_length);
 
 #ifdef TEST_MODE
   // Debug output only for problematic operators
-  if (c == '/' && strlen(lexer->current) >= 2) {
+  if (c == '/' && lexer_remaining(lexer) >= 2) {
     char debug_str[21] = {0};
-    size_t len = strlen(lexer->current);
+    size_t len = lexer_remaining(lexer);
     size_t copy_len = len < 20 ? len : 20;
     memcpy(debug_str, lexer->current, copy_len);
     debug_str[copy_len] = '\0';
@@ -750,6 +869,171 @@ Token lexer_next_token(Lexer *lexer) {
   return scan_operator(lexer);
 }
 
+// ============================================================================
+// Token-array mode
+// ============================================================================
+
+// Store a heap string in the buffer, taking ownership of it
+static bool token_buffer_store_string(TokenBuffer *buffer, char *owned,
+                                      uint32_t *index) {
+  if (buffer->string_count >= buffer->string_capacity) {
+    size_t new_capacity =
+        buffer->string_capacity ? buffer->string_capacity * 2 : 64;
+    char **strings = realloc(buffer->strings, new_capacity * sizeof(char *));
+    if (!strings) {
+      return false;
+    }
+    buffer->strings = strings;
+    buffer->string_capacity = new_capacity;
+  }
+
+  *index = (uint32_t)buffer->string_count;
+  buffer->strings[buffer->string_count++] = owned;
+  return true;
+}
+
+static bool token_buffer_push(TokenBuffer *buffer, const Token *token) {
+  if (buffer->count >= buffer->capacity) {
+    size_t new_capacity = buffer->capacity ? buffer->capacity * 2 : 1024;
+    CompactToken *tokens =
+        realloc(buffer->tokens, new_capacity * sizeof(CompactToken));
+    if (!tokens) {
+      return false;
+    }
+    buffer->tokens = tokens;
+    buffer->capacity = new_capacity;
+  }
+
+  CompactToken *entry = &buffer->tokens[buffer->count];
+  entry->kind = (uint16_t)token->kind;
+  entry->length = (uint32_t)token->length;
+  entry->line = (uint32_t)token->line;
+  entry->column = (uint32_t)token->column;
+  entry->value = 0;
+
+  if (token->kind == TOK_ERROR) {
+    // Error tokens point at their message, not into the source
+    entry->offset = 0;
+    char *message = malloc(token->length + 1);
+    if (!message) {
+      return false;
+    }
+    memcpy(message, token->start, token->length);
+    message[token->length] = '\0';
+    if (!token_buffer_store_string(buffer, message, &entry->value)) {
+      free(message);
+      return false;
+    }
+  } else {
+    entry->offset = (uint32_t)(token->start - buffer->source);
+    if (token->kind == TOK_IDENTIFIER) {
+      entry->value = fcx_intern_id(token->value.identifier);
+    }
+    if (token->kind == TOK_STRING &&
+        !token_buffer_store_string(buffer, token->value.string,
+                                   &entry->value)) {
+      free(token->value.string);
+      return false;
+    }
+  }
+
+  buffer->count++;
+  return true;
+}
+
+// The body of `asm% { ... }` is raw assembly, not FCx tokens. Skip it the same
+// way parse_inline_asm does so lexing resumes right after the closing brace.
+static void skip_raw_asm_block(Lexer *lexer) {
+  const char *ptr = lexer->current;
+  int brace_depth = 1;
+
+  while (ptr < lexer->end) {
+    if (*ptr == '{') {
+      brace_depth++;
+    } else if (*ptr == '}' && --brace_depth == 0) {
+      lexer_skip_to(lexer, ptr + 1);
+      return;
+    }
+    ptr++;
+  }
+}
+
+// Lex the whole source once into a compact token array
+bool token_buffer_fill(TokenBuffer *buffer, const char *source) {
+  return token_buffer_fill_at(buffer, source, 1, 1);
+}
+
+// Same, for a source fragment that starts at line:column of a larger file
+bool token_buffer_fill_at(TokenBuffer *buffer, const char *source, size_t line,
+                          size_t column) {
+  memset(buffer, 0, sizeof(*buffer));
+  buffer->source = source;
+
+  Lexer lexer;
+  lexer_init(&lexer, source);
+  lexer.line = line;
+  lexer.column = column;
+  if ((size_t)(lexer.end - source) > UINT32_MAX) {
+    fprintf(stderr, "Error: Source too large for token buffer\n");
+    return false;
+  }
+
+  TokenKind previous_kind = TOK_EOF;
+  while (true) {
+    Token token = lexer_next_token(&lexer);
+    if (!token_buffer_push(buffer, &token)) {
+      fprintf(stderr, "Error: Out of memory while buffering tokens\n");
+      token_buffer_destroy(buffer);
+      return false;
+    }
+    if (token.kind == TOK_EOF) {
+      break;
+    }
+    if (token.kind == TOK_LBRACE && previous_kind == OP_INLINE_ASM) {
+      skip_raw_asm_block(&lexer);
+    }
+    previous_kind = token.kind;
+  }
+
+  buffer->had_error = lexer.had_error;
+  return true;
+}
+
+// Expand a buffered token. Indices past the end return the final TOK_EOF.
+Token token_buffer_get(const TokenBuffer *buffer, size_t index) {
+  if (index >= buffer->count) {
+    index = buffer->count - 1;
+  }
+  const CompactToken *entry = &buffer->tokens[index];
+
+  Token token;
+  token.kind = (TokenKind)entry->kind;
+  token.length = entry->length;
+  token.line = entry->line;
+  token.column = entry->column;
+  token.value.integer = 0;
+  if (token.kind == TOK_ERROR) {
+    token.start = buffer->strings[entry->value];
+  } else {
+    token.start = buffer->source + entry->offset;
+    if (token.kind == TOK_STRING) {
+      token.value.string = buffer->strings[entry->value];
+    } else if (token.kind == TOK_IDENTIFIER) {
+      token.value.identifier = fcx_intern_name(entry->value);
+    }
+  }
+  return token;
+}
+
+void token_buffer_destroy(TokenBuffer *buffer) {
+  for (size_t i = 0; i < buffer->string_count; i++) {
+    free(buffer->strings[i]);
+  }
+  free(buffer->strings);
+  free(buffer->tokens);
+  memset(buffer, 0, sizeof(*buffer));
+}
+
 // Test lexer with sample FCx code
 void test_lexer_functionality(void) {
   printf("=== FCx Lexer Functionality Test ===\n");
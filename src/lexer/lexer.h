@@ -7,6 +7,8 @@
 #include <stdio.h>
 #include <stddef.h>
 
+#include "intern.h"
+
 // Token types for FCx language
 typedef enum {
     // Literals
@@ -303,6 +305,7 @@ typedef struct {
         double floating;
         char *string;
         char character;
+        const char *identifier; // TOK_IDENTIFIER: interned name (intern.h)
     } value;
 } Token;
 
@@ -311,23 +314,69 @@ typedef struct {
     const char *source;
     const char *current;
     const char *start;
+    const char *end;      // One past the last source byte (set by lexer_init)
     size_t line;
     size_t column;
     bool had_error;
+    char error_message[256]; // Backing store for the last TOK_ERROR text
 } Lexer;
 
+// Compact token record for token-array mode (24 bytes vs. 56 for Token)
+typedef struct {
+    uint32_t offset;      // Byte offset of the token start in the source
+    uint32_t length;
+    uint32_t line;
+    uint32_t column;
+    uint16_t kind;        // TokenKind
+    uint32_t value;       // TOK_STRING/TOK_ERROR: index into strings[],
+                          // TOK_IDENTIFIER: InternId of the name
+} CompactToken;
+
+// Token array produced by lexing a source once. The parser, token dump and
+// operator expansion all read from it instead of re-lexing.
+typedef struct {
+    const char *source;
+    CompactToken *tokens;
+    size_t count;          // Always ends with a TOK_EOF token when filled
+    size_t capacity;
+    char **strings;        // String literal values and error messages
+    size_t string_count;
+    size_t string_capacity;
+    bool had_error;        // Lexer reported at least one error
+} TokenBuffer;
+
 // Operator trie node for efficient recognition
-typedef struct TrieNode {
-    struct TrieNode *children[256]; // ASCII character set
-    const OperatorInfo *operator_info; // NULL if not terminal
-    bool is_terminal;
+// Slot of the packed double-array operator trie built once from the registry.
+// A transition costs one add and one compare instead of a pointer chase
+// through a 256-entry child table. Slots are 8 bytes so that indexing one is
+// a shift; the 6-byte layout made every step slower than the pointer trie.
+typedef struct {
+    uint16_t base;           // Child slots start here (offset by byte class)
+    uint16_t check;          // Slot of the parent that owns this slot
+    int32_t operator_index;  // Registry index if terminal, -1 otherwise
 } TrieNode;
 
+// Vectorized scanning mode for whitespace, comments, identifiers and strings
+typedef enum {
+    LEXER_SIMD_NONE,    // Byte-at-a-time scanning
+    LEXER_SIMD_SSE2,    // 16 bytes per step (x86_64 baseline, default)
+    LEXER_SIMD_AVX2     // 32 bytes per step
+} LexerSimdLevel;
+
 // Function declarations
 void lexer_init(Lexer *lexer, const char *source);
 Token lexer_next_token(Lexer *lexer);
 bool lexer_is_at_end(const Lexer *lexer);
 void lexer_error(Lexer *lexer, const char *message);
+void lexer_set_simd_level(LexerSimdLevel level);
+
+// Token-array mode
+bool token_buffer_fill(TokenBuffer *buffer, const char *source);
+bool token_buffer_fill_at(TokenBuffer *buffer, const char *source, size_t line,
+                          size_t column);
+Token token_buffer_get(const TokenBuffer *buffer, size_t index);
+void token_buffer_destroy(TokenBuffer *buffer);
+LexerSimdLevel lexer_get_simd_level(void);
 
 // Operator registry functions
 const OperatorInfo *lookup_operator(const char *symbol);
@@ -336,6 +385,7 @@ void init_operator_registry(void);
 void build_operator_trie(void);
 const OperatorInfo *trie_lookup(const char *symbol, size_t length);
 const OperatorInfo *trie_lookup_greedy(const char *symbol, size_t max_length, size_t *matched_length);
+size_t get_operator_trie_bytes(void);
 bool is_valid_operator(const char *symbol);
 uint8_t get_operator_precedence(const char *symbol);
 OperatorCategory get_operator_category(const char *symbol);
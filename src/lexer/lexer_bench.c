@@ -0,0 +1,294 @@
+// Lexer throughput benchmark
+// Lexes a synthetic, operator-dense FCx source of increasing size and
+// reports MB/s. Throughput should stay flat as the input grows; a drop
+// with size means something in lexer_next_token went super-linear again.
+// Each input is lexed once per vector scanning mode; the token streams must
+// hash identically. Also compares trie_lookup_greedy against the old 256-way
+// pointer trie.
+
+#include "lexer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// One "line" of operator-dense FCx source
+static const char *OPERATOR_LINES[] = {
+    "let x := (a << 2) + b >> 3;\n",
+    "ptr <=> (expected, desired) !! value;\n",
+    "buf := mem>1024,8; x >>> y <<< z;\n",
+    "fd $/ buf, len; a <=>? b ..= c <?> d;\n",
+    "?(n <= 0) -> ret 0; a //// b /|/ c |/| d;\n",
+    "x +| y -| z *| w +% v -% u *% t;\n",
+    "// comment line with some text in it\n",
+    "r := popcount>x + clz>y + ctz>z;\n",
+    NULL,
+};
+
+// Whitespace-, comment- and identifier-heavy source, closer to what
+// #include expansion produces
+static const char *PREPROCESSED_LINES[] = {
+    "/* ------------------------------------------------------------------\n"
+    " * Module documentation block expanded from a shared header file.\n"
+    " * ------------------------------------------------------------------ */\n",
+    "        // Indented explanatory comment describing the next statement\n",
+    "        let accumulated_checksum_value := previous_checksum_value;\n",
+    "        print>\"formatting the output buffer for the current record\\n\";\n",
+    "\n",
+    "fn compute_running_total_for_window(window_start_index, window_len) {\n",
+    "            ret accumulated_checksum_value + window_start_index;\n",
+    "}\n",
+    NULL,
+};
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static char *generate_source(const char **lines, size_t target_bytes,
+                             size_t *out_size) {
+  size_t line_count = 0;
+  while (lines[line_count] != NULL) {
+    line_count++;
+  }
+  char *source = malloc(target_bytes + 128);
+  if (!source) {
+    return NULL;
+  }
+
+  size_t size = 0;
+  for (size_t i = 0; size < target_bytes; i++) {
+    const char *line = lines[i % line_count];
+    size_t len = strlen(line);
+    memcpy(source + size, line, len);
+    size += len;
+  }
+  source[size] = '\0';
+  *out_size = size;
+  return source;
+}
+
+static const char *simd_level_name(LexerSimdLevel level) {
+  switch (level) {
+  case LEXER_SIMD_NONE:
+    return "scalar";
+  case LEXER_SIMD_SSE2:
+    return "sse2";
+  case LEXER_SIMD_AVX2:
+    return "avx2";
+  }
+  return "?";
+}
+
+// Lex the whole source, returning elapsed seconds and a hash of the token
+// stream (kind, length, line, column)
+static double lex_source(const char *source, size_t *token_count,
+                         uint64_t *stream_hash, bool *had_error) {
+  Lexer lexer;
+  lexer_init(&lexer, source);
+
+  uint64_t hash = 1469598103934665603ULL;
+  size_t count = 0;
+  double start = now_seconds();
+  Token token;
+  do {
+    token = lexer_next_token(&lexer);
+    hash = (hash ^ (uint64_t)token.kind) * 1099511628211ULL;
+    hash = (hash ^ token.length) * 1099511628211ULL;
+    hash = (hash ^ token.line) * 1099511628211ULL;
+    hash = (hash ^ token.column) * 1099511628211ULL;
+    if (token.kind == TOK_STRING) {
+      free(token.value.string);
+    }
+    count++;
+  } while (token.kind != TOK_EOF);
+  double elapsed = now_seconds() - start;
+
+  *token_count = count;
+  *stream_hash = hash;
+  *had_error = lexer.had_error;
+  return elapsed;
+}
+
+static void run_benchmark(const char **lines, size_t target_bytes) {
+  size_t size = 0;
+  char *source = generate_source(lines, target_bytes, &size);
+  if (!source) {
+    fprintf(stderr, "Error: Failed to allocate %zu byte benchmark source\n",
+            target_bytes);
+    return;
+  }
+
+  double mb = (double)size / (1024.0 * 1024.0);
+  uint64_t reference_hash = 0;
+  LexerSimdLevel levels[] = {LEXER_SIMD_NONE, LEXER_SIMD_SSE2,
+                             LEXER_SIMD_AVX2};
+  for (size_t i = 0; i < sizeof(levels) / sizeof(levels[0]); i++) {
+    if (levels[i] == LEXER_SIMD_AVX2 && !__builtin_cpu_supports("avx2")) {
+      continue;
+    }
+    lexer_set_simd_level(levels[i]);
+    if (lexer_get_simd_level() != levels[i]) {
+      continue; // Not available on this target
+    }
+
+    size_t token_count = 0;
+    uint64_t hash = 0;
+    bool had_error = false;
+    double elapsed = lex_source(source, &token_count, &hash, &had_error);
+    if (i == 0) {
+      reference_hash = hash;
+    }
+    printf("%8.2f MB  %-6s %10zu tokens  %8.3f s  %8.2f MB/s%s%s\n", mb,
+           simd_level_name(levels[i]), token_count, elapsed,
+           elapsed > 0 ? mb / elapsed : 0.0, had_error ? "  (errors)" : "",
+           hash != reference_hash ? "  TOKEN STREAM MISMATCH" : "");
+  }
+
+  free(source);
+}
+
+// Reference: the original pointer trie (2 KB of child pointers per node)
+typedef struct PointerTrieNode {
+  struct PointerTrieNode *children[256];
+  const OperatorInfo *operator_info;
+} PointerTrieNode;
+
+static PointerTrieNode *pointer_trie_build(size_t *node_count) {
+  PointerTrieNode *root = calloc(1, sizeof(PointerTrieNode));
+  *node_count = 1;
+  for (size_t i = 0; root && i < get_operator_count(); i++) {
+    const OperatorInfo *op = get_operator_by_index(i);
+    PointerTrieNode *current = root;
+    for (const char *c = op->symbol; *c != '\0'; c++) {
+      unsigned char index = (unsigned char)*c;
+      if (current->children[index] == NULL) {
+        current->children[index] = calloc(1, sizeof(PointerTrieNode));
+        (*node_count)++;
+      }
+      current = current->children[index];
+    }
+    current->operator_info = op;
+  }
+  return root;
+}
+
+static void pointer_trie_free(PointerTrieNode *node) {
+  if (node == NULL) {
+    return;
+  }
+  for (int i = 0; i < 256; i++) {
+    pointer_trie_free(node->children[i]);
+  }
+  free(node);
+}
+
+// Kept out of line so it pays the same call cost as trie_lookup_greedy
+__attribute__((noinline)) static const OperatorInfo *
+pointer_trie_lookup(const PointerTrieNode *root, const char *symbol,
+                    size_t max_length, size_t *matched_length) {
+  const PointerTrieNode *current = root;
+  const OperatorInfo *last_match = NULL;
+  *matched_length = 0;
+  for (size_t i = 0; i < max_length && symbol[i] != '\0'; i++) {
+    current = current->children[(unsigned char)symbol[i]];
+    if (current == NULL) {
+      break;
+    }
+    if (current->operator_info) {
+      last_match = current->operator_info;
+      *matched_length = i + 1;
+    }
+  }
+  return last_match;
+}
+
+static void run_trie_benchmark(size_t rounds) {
+  // Every operator followed by trailing source, plus some non-operators
+  size_t op_count = get_operator_count();
+  size_t input_count = op_count + 4;
+  char (*inputs)[32] = calloc(input_count, sizeof(*inputs));
+  if (!inputs) {
+    return;
+  }
+  for (size_t i = 0; i < op_count; i++) {
+    snprintf(inputs[i], sizeof(inputs[i]), "%s x;",
+             get_operator_by_index(i)->symbol);
+  }
+  snprintf(inputs[op_count], sizeof(inputs[0]), "identifier");
+  snprintf(inputs[op_count + 1], sizeof(inputs[0]), "12345");
+  snprintf(inputs[op_count + 2], sizeof(inputs[0]), "(a)");
+  snprintf(inputs[op_count + 3], sizeof(inputs[0]), "\"str\"");
+
+  size_t node_count = 0;
+  PointerTrieNode *pointer_root = pointer_trie_build(&node_count);
+
+  // Both tries must agree before timing them
+  size_t mismatches = 0;
+  for (size_t i = 0; i < input_count; i++) {
+    size_t flat_len = 0, ptr_len = 0;
+    const OperatorInfo *flat = trie_lookup_greedy(inputs[i], 20, &flat_len);
+    const OperatorInfo *ptr =
+        pointer_trie_lookup(pointer_root, inputs[i], 20, &ptr_len);
+    if (flat != ptr || flat_len != ptr_len) {
+      mismatches++;
+    }
+  }
+
+  size_t checksum = 0;
+  double start = now_seconds();
+  for (size_t r = 0; r < rounds; r++) {
+    for (size_t i = 0; i < input_count; i++) {
+      size_t len = 0;
+      trie_lookup_greedy(inputs[i], 20, &len);
+      checksum += len;
+    }
+  }
+  double flat_elapsed = now_seconds() - start;
+
+  start = now_seconds();
+  for (size_t r = 0; r < rounds; r++) {
+    for (size_t i = 0; i < input_count; i++) {
+      size_t len = 0;
+      pointer_trie_lookup(pointer_root, inputs[i], 20, &len);
+      checksum -= len;
+    }
+  }
+  double pointer_elapsed = now_seconds() - start;
+
+  double lookups = (double)rounds * (double)input_count;
+  printf("\n=== Operator Trie Lookup Benchmark ===\n");
+  printf("pointer trie: %6zu nodes %8zu KB  %8.2f M lookups/s\n", node_count,
+         node_count * sizeof(PointerTrieNode) / 1024,
+         pointer_elapsed > 0 ? lookups / pointer_elapsed / 1e6 : 0.0);
+  printf("packed trie:               %8zu KB  %8.2f M lookups/s\n",
+         (get_operator_trie_bytes() + 1023) / 1024,
+         flat_elapsed > 0 ? lookups / flat_elapsed / 1e6 : 0.0);
+  printf("mismatches: %zu%s\n", mismatches, checksum != 0 ? " (checksum!)" : "");
+
+  pointer_trie_free(pointer_root);
+  free(inputs);
+}
+
+int main(int argc, char **argv) {
+  size_t max_mb = 32;
+  if (argc > 1) {
+    max_mb = (size_t)strtoul(argv[1], NULL, 10);
+    if (max_mb == 0) {
+      max_mb = 1;
+    }
+  }
+
+  printf("=== FCx Lexer Throughput Benchmark (operator-dense) ===\n");
+  for (size_t mb = 1; mb <= max_mb; mb *= 2) {
+    run_benchmark(OPERATOR_LINES, mb * 1024 * 1024);
+  }
+  printf("\n=== FCx Lexer Throughput Benchmark (preprocessed-style) ===\n");
+  for (size_t mb = 1; mb <= max_mb; mb *= 2) {
+    run_benchmark(PREPROCESSED_LINES, mb * 1024 * 1024);
+  }
+  run_trie_benchmark(20000);
+  return 0;
+}
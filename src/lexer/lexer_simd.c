@@ -0,0 +1,311 @@
+#include "lexer_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LEXER_HAVE_X86_SIMD 1
+#endif
+
+// Vectorized scanning mode for the lexer
+// SSE2 is part of the x86_64 baseline, so it is the default there. AVX2 is
+// only turned on by the driver after CPU feature detection.
+#ifdef LEXER_HAVE_X86_SIMD
+static LexerSimdLevel simd_level = LEXER_SIMD_SSE2;
+#else
+static LexerSimdLevel simd_level = LEXER_SIMD_NONE;
+#endif
+
+void lexer_set_simd_level(LexerSimdLevel level) {
+#ifdef LEXER_HAVE_X86_SIMD
+  simd_level = level;
+#else
+  (void)level;
+  simd_level = LEXER_SIMD_NONE;
+#endif
+}
+
+LexerSimdLevel lexer_get_simd_level(void) { return simd_level; }
+
+// ============================================================================
+// Scalar scanners (fallback, and tail handling for the vector paths)
+// ============================================================================
+
+static inline bool is_blank_byte(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static const char *scalar_scan_blanks(const char *p, const char *end) {
+  while (p < end && is_blank_byte(*p)) {
+    p++;
+  }
+  return p;
+}
+
+static const char *scalar_scan_identifier_chars(const char *p,
+                                                const char *end) {
+  while (p < end && is_alnum(*p)) {
+    p++;
+  }
+  return p;
+}
+
+static const char *scalar_scan_for_either(const char *p, const char *end,
+                                          char a, char b) {
+  while (p < end && *p != a && *p != b) {
+    p++;
+  }
+  return p;
+}
+
+static size_t scalar_count_newlines(const char *p, const char *end,
+                                    const char **last_newline) {
+  size_t count = 0;
+  for (; p < end; p++) {
+    if (*p == '\n') {
+      count++;
+      *last_newline = p;
+    }
+  }
+  return count;
+}
+
+#ifdef LEXER_HAVE_X86_SIMD
+
+// ============================================================================
+// SSE2 scanners (16 bytes per step)
+// ============================================================================
+
+// Bit i is set when byte i is a blank
+static inline unsigned sse2_blank_mask(__m128i v) {
+  __m128i m = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                   _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+      _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')),
+                   _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+  return (unsigned)_mm_movemask_epi8(m);
+}
+
+// Bit i is set when byte i is [A-Za-z0-9_]. Signed compares are fine here:
+// bytes >= 0x80 are negative and fall outside every range.
+static inline unsigned sse2_identifier_mask(__m128i v) {
+  __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+  __m128i letter =
+      _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                    _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+  __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+  __m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+  return (unsigned)_mm_movemask_epi8(
+      _mm_or_si128(_mm_or_si128(letter, digit), underscore));
+}
+
+static const char *sse2_scan_blanks(const char *p, const char *end) {
+  while (end - p >= 16) {
+    unsigned stop =
+        ~sse2_blank_mask(_mm_loadu_si128((const __m128i *)p)) & 0xFFFFu;
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+    p += 16;
+  }
+  return scalar_scan_blanks(p, end);
+}
+
+static const char *sse2_scan_identifier_chars(const char *p,
+                                              const char *end) {
+  while (end - p >= 16) {
+    unsigned stop =
+        ~sse2_identifier_mask(_mm_loadu_si128((const __m128i *)p)) & 0xFFFFu;
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+    p += 16;
+  }
+  return scalar_scan_identifier_chars(p, end);
+}
+
+static const char *sse2_scan_for_either(const char *p, const char *end,
+                                        char a, char b) {
+  __m128i va = _mm_set1_epi8(a);
+  __m128i vb = _mm_set1_epi8(b);
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)p);
+    unsigned hit = (unsigned)_mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)));
+    if (hit) {
+      return p + __builtin_ctz(hit);
+    }
+    p += 16;
+  }
+  return scalar_scan_for_either(p, end, a, b);
+}
+
+static size_t sse2_count_newlines(const char *p, const char *end,
+                                  const char **last_newline) {
+  __m128i nl = _mm_set1_epi8('\n');
+  size_t count = 0;
+  while (end - p >= 16) {
+    unsigned hit = (unsigned)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), nl));
+    if (hit) {
+      count += (size_t)__builtin_popcount(hit);
+      *last_newline = p + (31 - __builtin_clz(hit));
+    }
+    p += 16;
+  }
+  return count + scalar_count_newlines(p, end, last_newline);
+}
+
+// ============================================================================
+// AVX2 scanners (32 bytes per step)
+// ============================================================================
+
+#define LEXER_AVX2 __attribute__((target("avx2")))
+
+LEXER_AVX2 static inline uint32_t avx2_blank_mask(__m256i v) {
+  __m256i m = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                      _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+      _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')),
+                      _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+  return (uint32_t)_mm256_movemask_epi8(m);
+}
+
+LEXER_AVX2 static inline uint32_t avx2_identifier_mask(__m256i v) {
+  __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+  __m256i letter = _mm256_and_si256(
+      _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+      _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+  __m256i digit =
+      _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                       _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+  __m256i underscore = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+  return (uint32_t)_mm256_movemask_epi8(
+      _mm256_or_si256(_mm256_or_si256(letter, digit), underscore));
+}
+
+LEXER_AVX2 static const char *avx2_scan_blanks(const char *p,
+                                               const char *end) {
+  while (end - p >= 32) {
+    uint32_t stop =
+        ~avx2_blank_mask(_mm256_loadu_si256((const __m256i *)p));
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+    p += 32;
+  }
+  return sse2_scan_blanks(p, end);
+}
+
+LEXER_AVX2 static const char *avx2_scan_identifier_chars(const char *p,
+                                                         const char *end) {
+  while (end - p >= 32) {
+    uint32_t stop =
+        ~avx2_identifier_mask(_mm256_loadu_si256((const __m256i *)p));
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+    p += 32;
+  }
+  return sse2_scan_identifier_chars(p, end);
+}
+
+LEXER_AVX2 static const char *avx2_scan_for_either(const char *p,
+                                                   const char *end, char a,
+                                                   char b) {
+  __m256i va = _mm256_set1_epi8(a);
+  __m256i vb = _mm256_set1_epi8(b);
+  while (end - p >= 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)p);
+    uint32_t hit = (uint32_t)_mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, va), _mm256_cmpeq_epi8(v, vb)));
+    if (hit) {
+      return p + __builtin_ctz(hit);
+    }
+    p += 32;
+  }
+  return sse2_scan_for_either(p, end, a, b);
+}
+
+LEXER_AVX2 static size_t avx2_count_newlines(const char *p, const char *end,
+                                             const char **last_newline) {
+  __m256i nl = _mm256_set1_epi8('\n');
+  size_t count = 0;
+  while (end - p >= 32) {
+    uint32_t hit = (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)p), nl));
+    if (hit) {
+      count += (size_t)__builtin_popcount(hit);
+      *last_newline = p + (31 - __builtin_clz(hit));
+    }
+    p += 32;
+  }
+  return count + sse2_count_newlines(p, end, last_newline);
+}
+
+#endif // LEXER_HAVE_X86_SIMD
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+
+const char *lexer_scan_blanks(const char *p, const char *end) {
+#ifdef LEXER_HAVE_X86_SIMD
+  switch (simd_level) {
+  case LEXER_SIMD_AVX2:
+    return avx2_scan_blanks(p, end);
+  case LEXER_SIMD_SSE2:
+    return sse2_scan_blanks(p, end);
+  case LEXER_SIMD_NONE:
+    break;
+  }
+#endif
+  return scalar_scan_blanks(p, end);
+}
+
+const char *lexer_scan_identifier_chars(const char *p, const char *end) {
+#ifdef LEXER_HAVE_X86_SIMD
+  switch (simd_level) {
+  case LEXER_SIMD_AVX2:
+    return avx2_scan_identifier_chars(p, end);
+  case LEXER_SIMD_SSE2:
+    return sse2_scan_identifier_chars(p, end);
+  case LEXER_SIMD_NONE:
+    break;
+  }
+#endif
+  return scalar_scan_identifier_chars(p, end);
+}
+
+const char *lexer_scan_for_byte(const char *p, const char *end, char c) {
+  return lexer_scan_for_either(p, end, c, c);
+}
+
+const char *lexer_scan_for_either(const char *p, const char *end, char a,
+                                  char b) {
+#ifdef LEXER_HAVE_X86_SIMD
+  switch (simd_level) {
+  case LEXER_SIMD_AVX2:
+    return avx2_scan_for_either(p, end, a, b);
+  case LEXER_SIMD_SSE2:
+    return sse2_scan_for_either(p, end, a, b);
+  case LEXER_SIMD_NONE:
+    break;
+  }
+#endif
+  return scalar_scan_for_either(p, end, a, b);
+}
+
+size_t lexer_count_newlines(const char *p, const char *end,
+                            const char **last_newline) {
+#ifdef LEXER_HAVE_X86_SIMD
+  switch (simd_level) {
+  case LEXER_SIMD_AVX2:
+    return avx2_count_newlines(p, end, last_newline);
+  case LEXER_SIMD_SSE2:
+    return sse2_count_newlines(p, end, last_newline);
+  case LEXER_SIMD_NONE:
+    break;
+  }
+#endif
+  return scalar_count_newlines(p, end, last_newline);
+}
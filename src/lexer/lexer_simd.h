@@ -0,0 +1,29 @@
+#ifndef FCX_LEXER_SIMD_H
+#define FCX_LEXER_SIMD_H
+
+#include "lexer.h"
+
+// Vectorized byte scanners used by the lexer hot loops.
+// Every scanner works on the half-open range [p, end) and never reads past
+// end, so it is safe on unpadded source buffers. Each returns a pointer to
+// the first byte that stops the scan, or end if none does.
+
+// First byte that is not ' ', '\t', '\r' or '\n'
+const char *lexer_scan_blanks(const char *p, const char *end);
+
+// First byte that is not [A-Za-z0-9_]
+const char *lexer_scan_identifier_chars(const char *p, const char *end);
+
+// First occurrence of c
+const char *lexer_scan_for_byte(const char *p, const char *end, char c);
+
+// First occurrence of a or b
+const char *lexer_scan_for_either(const char *p, const char *end, char a,
+                                  char b);
+
+// Number of '\n' bytes in [p, end); *last_newline is set to the last one
+// found, or left untouched when there are none
+size_t lexer_count_newlines(const char *p, const char *end,
+                            const char **last_newline);
+
+#endif // FCX_LEXER_SIMD_H
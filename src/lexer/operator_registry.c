@@ -675,125 +675,235 @@ static const size_t OPERATOR_COUNT =
     sizeof(OPERATOR_REGISTRY) / sizeof(OperatorInfo);
 
 // Operator trie for efficient lookup
-static TrieNode *operator_trie_root = NULL;
+// Packed double-array trie: a transition from slot s on byte c goes to slot
+// t = slots[s].base + byte_class[c], and is valid iff slots[t].check == s.
+// Bytes are first mapped to a small class alphabet (only bytes that occur in
+// some operator symbol get a class), which keeps the array a few KB.
+#define TRIE_ROOT_SLOT 0
+#define TRIE_FREE_SLOT UINT16_MAX
+#define TRIE_ROOT_CHECK (UINT16_MAX - 1)
 
-// Forward declaration
-static void free_operator_trie(TrieNode *node);
+typedef struct {
+  TrieNode *slots;
+  size_t capacity;
+  size_t size; // One past the highest slot in use
+  uint8_t byte_class[256]; // 0 means the byte never appears in an operator
+  size_t class_count;
+} OperatorTrie;
+
+static OperatorTrie operator_trie = {0};
+static bool operator_trie_built = false;
 
 // Initialize the operator registry and build the trie
 void init_operator_registry(void) { build_operator_trie(); }
 
+// Registry indices sorted by symbol; equal symbols keep registry order so the
+// last duplicate wins, as it did with the pointer trie
+static int compare_operator_indices(const void *a, const void *b) {
+  size_t ia = *(const size_t *)a;
+  size_t ib = *(const size_t *)b;
+  int cmp = strcmp(OPERATOR_REGISTRY[ia].symbol, OPERATOR_REGISTRY[ib].symbol);
+  if (cmp != 0) {
+    return cmp;
+  }
+  return ia < ib ? -1 : (ia > ib ? 1 : 0);
+}
+
+// Grow the slot array so that slots [0, needed) exist
+static bool trie_reserve(size_t needed) {
+  if (needed <= operator_trie.capacity) {
+    return true;
+  }
+  if (needed > TRIE_ROOT_CHECK) {
+    return false; // Slot indices must fit in the 16-bit check field
+  }
+
+  size_t new_capacity = operator_trie.capacity ? operator_trie.capacity : 256;
+  while (new_capacity < needed) {
+    new_capacity *= 2;
+  }
+  TrieNode *slots =
+      realloc(operator_trie.slots, new_capacity * sizeof(TrieNode));
+  if (slots == NULL) {
+    return false;
+  }
+  for (size_t i = operator_trie.capacity; i < new_capacity; i++) {
+    slots[i].base = 0;
+    slots[i].check = TRIE_FREE_SLOT;
+    slots[i].operator_index = -1;
+  }
+  operator_trie.slots = slots;
+  operator_trie.capacity = new_capacity;
+  return true;
+}
+
+// Place the node at `slot` for the sorted symbols [lo, hi), which all share
+// their first `depth` bytes: pick a base where every child class lands on a
+// free slot, claim those slots, then recurse into each child.
+static bool pack_trie_node(const size_t *sorted, size_t lo, size_t hi,
+                           size_t depth, uint16_t slot) {
+  // Symbols that end here sort first within the range
+  while (lo < hi && OPERATOR_REGISTRY[sorted[lo]].symbol[depth] == '\0') {
+    if (operator_trie.slots[slot].operator_index >= 0) {
+      fprintf(stderr, "Warning: Duplicate operator symbol '%s' detected\n",
+              OPERATOR_REGISTRY[sorted[lo]].symbol);
+    }
+    operator_trie.slots[slot].operator_index = (int32_t)sorted[lo];
+    lo++;
+  }
+  if (lo == hi) {
+    return true; // Leaf: base 0 never reaches a slot owned by this node
+  }
+
+  // Classes of the distinct next bytes (already in ascending byte order)
+  uint8_t classes[256];
+  size_t child_count = 0;
+  for (size_t i = lo; i < hi; i++) {
+    unsigned char byte = (unsigned char)OPERATOR_REGISTRY[sorted[i]].symbol[depth];
+    uint8_t cls = operator_trie.byte_class[byte];
+    if (child_count == 0 || classes[child_count - 1] != cls) {
+      classes[child_count++] = cls;
+    }
+  }
+
+  // First-fit search for a base
+  size_t base = 0;
+  for (;; base++) {
+    if (!trie_reserve(base + operator_trie.class_count + 1)) {
+      return false;
+    }
+    size_t c = 0;
+    while (c < child_count &&
+           operator_trie.slots[base + classes[c]].check == TRIE_FREE_SLOT) {
+      c++;
+    }
+    if (c == child_count) {
+      break;
+    }
+  }
+
+  operator_trie.slots[slot].base = (uint16_t)base;
+  for (size_t c = 0; c < child_count; c++) {
+    size_t child = base + classes[c];
+    operator_trie.slots[child].check = slot;
+    if (child + 1 > operator_trie.size) {
+      operator_trie.size = child + 1;
+    }
+  }
+
+  // One child per group of symbols sharing the next byte
+  size_t i = lo;
+  size_t c = 0;
+  while (i < hi) {
+    char byte = OPERATOR_REGISTRY[sorted[i]].symbol[depth];
+    size_t group_end = i + 1;
+    while (group_end < hi &&
+           OPERATOR_REGISTRY[sorted[group_end]].symbol[depth] == byte) {
+      group_end++;
+    }
+    if (!pack_trie_node(sorted, i, group_end, depth + 1,
+                        (uint16_t)(base + classes[c++]))) {
+      return false;
+    }
+    i = group_end;
+  }
+  return true;
+}
+
+static void free_operator_trie(void) {
+  free(operator_trie.slots);
+  memset(&operator_trie, 0, sizeof(operator_trie));
+  operator_trie_built = false;
+}
+
 // Build the operator trie for O(k) lookup time
 void build_operator_trie(void) {
   // Clean up existing trie if it exists
-  if (operator_trie_root != NULL) {
-    free_operator_trie(operator_trie_root);
+  if (operator_trie_built) {
+    free_operator_trie();
   }
 
-  operator_trie_root = calloc(1, sizeof(TrieNode));
-  if (operator_trie_root == NULL) {
-    fprintf(stderr,
-            "Error: Failed to allocate memory for operator trie root\n");
+  size_t *sorted = malloc(OPERATOR_COUNT * sizeof(size_t));
+  size_t valid_count = 0;
+  if (sorted == NULL) {
+    fprintf(stderr, "Error: Failed to allocate memory for operator trie\n");
     return;
   }
-
   for (size_t i = 0; i < OPERATOR_COUNT; i++) {
     const OperatorInfo *op = &OPERATOR_REGISTRY[i];
-    TrieNode *current = operator_trie_root;
 
     // Validate operator symbol
     if (op->symbol == NULL || strlen(op->symbol) == 0) {
       fprintf(stderr, "Warning: Operator at index %zu has invalid symbol\n", i);
       continue;
     }
-
-    // Insert operator symbol into trie
-    for (const char *c = op->symbol; *c != '\0'; c++) {
-      unsigned char index = (unsigned char)*c;
-      if (current->children[index] == NULL) {
-        current->children[index] = calloc(1, sizeof(TrieNode));
-        if (current->children[index] == NULL) {
-          fprintf(stderr, "Error: Failed to allocate memory for trie node\n");
-          return;
-        }
-      }
-      current = current->children[index];
+    sorted[valid_count++] = i;
+  }
+  qsort(sorted, valid_count, sizeof(size_t), compare_operator_indices);
+
+  // Byte classes in ascending byte order, so sorted children have sorted
+  // classes
+  bool used[256] = {false};
+  for (size_t i = 0; i < valid_count; i++) {
+    for (const char *c = OPERATOR_REGISTRY[sorted[i]].symbol; *c; c++) {
+      used[(unsigned char)*c] = true;
     }
-
-    // Mark as terminal and store operator info
-    if (current->is_terminal) {
-      fprintf(stderr, "Warning: Duplicate operator symbol '%s' detected\n",
-              op->symbol);
+  }
+  for (size_t b = 1; b < 256; b++) {
+    if (used[b]) {
+      operator_trie.byte_class[b] = (uint8_t)++operator_trie.class_count;
     }
-    current->is_terminal = true;
-    current->operator_info = op;
   }
+
+  bool ok = trie_reserve(operator_trie.class_count + 1);
+  if (ok) {
+    operator_trie.slots[TRIE_ROOT_SLOT].check = TRIE_ROOT_CHECK;
+    operator_trie.size = 1;
+    ok = pack_trie_node(sorted, 0, valid_count, 0, TRIE_ROOT_SLOT);
+  }
+  free(sorted);
+
+  if (!ok) {
+    fprintf(stderr, "Error: Failed to allocate memory for operator trie\n");
+    free_operator_trie();
+    return;
+  }
+  operator_trie_built = true;
 }
 
 // Lookup operator using trie (greedy maximal matching)
 // Returns the longest matching operator and sets matched_length
 const OperatorInfo *trie_lookup_greedy(const char *symbol, size_t max_length,
                                        size_t *matched_length) {
-  if (operator_trie_root == NULL || symbol == NULL || matched_length == NULL) {
+  if (!operator_trie_built || symbol == NULL || matched_length == NULL) {
     if (matched_length)
       *matched_length = 0;
     return NULL;
   }
 
-  TrieNode *current = operator_trie_root;
+  const TrieNode *slots = operator_trie.slots;
+  const uint8_t *byte_class = operator_trie.byte_class;
   const OperatorInfo *last_match = NULL;
   size_t last_match_length = 0;
-
-#ifdef TEST_MODE
-  // Debug output only for problematic operators
-  if ((strcmp(symbol, "//") == 0 || strcmp(symbol, "///") == 0 ||
-       strcmp(symbol, "////") == 0 || strcmp(symbol, "/////") == 0 ||
-       strcmp(symbol, "////////") == 0)) {
-    printf("DEBUG: trie_lookup_greedy('%s', max_length=%zu)\n", symbol,
-           max_length);
-  }
-#endif
-
-  // Traverse trie for greedy maximal matching
-  for (size_t i = 0; i < max_length && symbol[i] != '\0'; i++) {
-    unsigned char index = (unsigned char)symbol[i];
-
-#ifdef TEST_MODE
-    if ((strcmp(symbol, "//") == 0 || strcmp(symbol, "///") == 0 ||
-         strcmp(symbol, "////") == 0 || strcmp(symbol, "/////") == 0 ||
-         strcmp(symbol, "////////") == 0)) {
-      printf("DEBUG: trie step %zu, char='%c' (index=%u), children[%u]=%p\n", i,
-             symbol[i], index, index, (void *)current->children[index]);
+  uint16_t current = TRIE_ROOT_SLOT;
+
+  // Traverse trie for greedy maximal matching. The NUL terminator has no
+  // class, so it also ends the walk.
+  for (size_t i = 0; i < max_length; i++) {
+    uint8_t cls = byte_class[(unsigned char)symbol[i]];
+    if (cls == 0) {
+      break;
     }
-#endif
-
-    if (current->children[index] == NULL) {
-#ifdef TEST_MODE
-      if ((strcmp(symbol, "//") == 0 || strcmp(symbol, "///") == 0 ||
-           strcmp(symbol, "////") == 0 || strcmp(symbol, "/////") == 0 ||
-           strcmp(symbol, "////////") == 0)) {
-        printf("DEBUG: trie traversal stopped at step %zu, no child for '%c'\n",
-               i, symbol[i]);
-      }
-#endif
+    uint16_t next = (uint16_t)(slots[current].base + cls);
+    if (slots[next].check != current) {
       break; // No more matches possible
     }
+    current = next;
 
-    current = current->children[index];
-    if (current->is_terminal) {
+    if (slots[current].operator_index >= 0) {
       // Found a valid operator, but continue to find longer matches
-      last_match = current->operator_info;
+      last_match = &OPERATOR_REGISTRY[slots[current].operator_index];
       last_match_length = i + 1;
-
-#ifdef TEST_MODE
-      if ((strcmp(symbol, "//") == 0 || strcmp(symbol, "///") == 0 ||
-           strcmp(symbol, "////") == 0 || strcmp(symbol, "/////") == 0 ||
-           strcmp(symbol, "////////") == 0)) {
-        printf(
-            "DEBUG: trie found terminal at step %zu, operator='%s', token=%d\n",
-            i, last_match->symbol, last_match->token);
-      }
-#endif
     }
   }
 
@@ -801,6 +911,12 @@ const OperatorInfo *trie_lookup_greedy(const char *symbol, size_t max_length,
   return last_match;
 }
 
+// Bytes used by the packed trie (slots in use plus the byte class map)
+size_t get_operator_trie_bytes(void) {
+  return operator_trie.size * sizeof(TrieNode) +
+         sizeof(operator_trie.byte_class);
+}
+
 // Legacy function for backward compatibility
 const OperatorInfo *trie_lookup(const char *symbol, size_t length) {
   size_t matched_length;
@@ -830,25 +946,7 @@ const OperatorInfo *get_operator_by_index(size_t index) {
   return &OPERATOR_REGISTRY[index];
 }
 
-// Free the operator trie
-static void free_operator_trie(TrieNode *node) {
-  if (node == NULL) {
-    return;
-  }
-
-  for (int i = 0; i < 256; i++) {
-    if (node->children[i] != NULL) {
-      free_operator_trie(node->children[i]);
-    }
-  }
-
-  free(node);
-}
-
-void cleanup_operator_registry(void) {
-  free_operator_trie(operator_trie_root);
-  operator_trie_root = NULL;
-}
+void cleanup_operator_registry(void) { free_operator_trie(); }
 
 // Find operator by exact string match (alternative to trie lookup)
 const OperatorInfo *find_operator_by_symbol(const char *symbol) {
@@ -1058,7 +1156,7 @@ bool validate_assembly_templates(void) {
 
 // Validate trie structure and operator recognition
 bool validate_trie_structure(void) {
-  if (operator_trie_root == NULL) {
+  if (!operator_trie_built) {
     printf("✗ Operator trie not initialized\n");
     return false;
   }
@@ -13,6 +13,7 @@
 #include "ir/fcx_ir.h"
 #include "ir/ir_gen.h"
 #include "ir/ir_optimize.h"
+#include "ir/ir_ssa.h"
 #include "lexer/lexer.h"
 #include "module/preprocessor.h"
 #include "module/c_import_zig.h"
@@ -59,14 +60,21 @@ typedef struct {
   bool stop_after_parse;
   bool stop_after_fcx_ir;
   bool stop_after_fc_ir;
+  bool time_passes;           // Report FCx IR optimization pass timings
   bool expand_operators;      // Verbose mode: expand dense operators
   bool enable_bounds_check;   // Enable runtime bounds checking
   bool enable_leak_detection; // Enable memory leak detection
   bool shared_library;        // Generate shared library (.so)
   bool object_only;           // Generate object file only (.o)
   bool position_independent;  // Generate position-independent code
+  bool emit_assembly;         // Also write <output>.s
+  bool emit_bitcode;          // Also write <output>.bc
+  bool emit_ir;               // Also write <output>.ll
   CompilationProfile profile; // Compilation profile
   OptimizationLevel opt_level; // Optimization level
+  size_t jobs;                // Threads used to parse top-level items,
+                              // optimize functions and generate code; 0 if
+                              // -j was not given
 } CompilerOptions;
 
 // Print usage information
@@ -84,6 +92,10 @@ void print_usage(const char *program_name) {
   printf("  -O2                    Standard optimizations (default)\n");
   printf("  -O3                    Aggressive optimizations\n");
   printf("  -Os                    Size optimizations\n");
+  printf("  -j <n>                 Parse, optimize and generate code for "
+         "top-level functions on n\n"
+         "                         threads (default: optimize on all cores, "
+         "the rest on one)\n");
   printf("  --disallow-ambiguous   Disallow ambiguous operators (team coding "
          "standards)\n");
   printf("  --show-asm             Show generated assembly code\n");
@@ -103,6 +115,9 @@ void print_usage(const char *program_name) {
   printf("  -c                     Compile to object file only (.o)\n");
   printf("  -shared                Generate shared library (.so)\n");
   printf("  -fPIC                  Generate position-independent code\n");
+  printf("  --emit=<kinds>         Also write <output>.s, .bc and/or .ll "
+         "(asm,bc,ll)\n"
+         "                         from the same optimized module\n");
   printf("\n");
   printf("IR Dumping Options:\n");
   printf("  --dump-tokens          Dump lexer tokens\n");
@@ -113,6 +128,7 @@ void print_usage(const char *program_name) {
   printf("  --stop-after-parse     Stop compilation after parsing\n");
   printf("  --stop-after-fcx-ir    Stop compilation after FCx IR generation\n");
   printf("  --stop-after-fc-ir     Stop compilation after FC IR lowering\n");
+  printf("  --time-passes          Report time spent in each FCx IR optimization pass\n");
   printf("\n");
   printf("General Options:\n");
   printf("  -h, --help             Show this help message\n");
@@ -421,14 +437,19 @@ bool parse_arguments(int argc, char *argv[], CompilerOptions *options) {
   options->stop_after_parse = false;
   options->stop_after_fcx_ir = false;
   options->stop_after_fc_ir = false;
+  options->time_passes = false;
   options->expand_operators = false;
   options->enable_bounds_check = false;
   options->enable_leak_detection = false;
   options->shared_library = false;
   options->object_only = false;
   options->position_independent = false;
+  options->emit_assembly = false;
+  options->emit_bitcode = false;
+  options->emit_ir = false;
   options->profile = PROFILE_RELEASE; // Default to release
   options->opt_level = OPT_LEVEL_O2;  // Default to O2
+  options->jobs = 0;
 
   for (int i = 1; i < argc; i++) {
     if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
@@ -483,6 +504,8 @@ bool parse_arguments(int argc, char *argv[], CompilerOptions *options) {
       options->stop_after_fcx_ir = true;
     } else if (strcmp(argv[i], "--stop-after-fc-ir") == 0) {
       options->stop_after_fc_ir = true;
+    } else if (strcmp(argv[i], "--time-passes") == 0) {
+      options->time_passes = true;
     } else if (strcmp(argv[i], "--expand-ops") == 0) {
       options->expand_operators = true;
     } else if (strcmp(argv[i], "--bounds-check") == 0) {
@@ -496,6 +519,22 @@ bool parse_arguments(int argc, char *argv[], CompilerOptions *options) {
       options->position_independent = true;  // Shared libs need PIC
     } else if (strcmp(argv[i], "-fPIC") == 0 || strcmp(argv[i], "-fpic") == 0) {
       options->position_independent = true;
+    } else if (strncmp(argv[i], "--emit=", 7) == 0) {
+      char kinds[64];
+      snprintf(kinds, sizeof(kinds), "%s", argv[i] + 7);
+      for (char *kind = strtok(kinds, ","); kind; kind = strtok(NULL, ",")) {
+        if (strcmp(kind, "asm") == 0) {
+          options->emit_assembly = true;
+        } else if (strcmp(kind, "bc") == 0) {
+          options->emit_bitcode = true;
+        } else if (strcmp(kind, "ll") == 0) {
+          options->emit_ir = true;
+        } else {
+          fprintf(stderr, "Error: Unknown output kind '%s'\n", kind);
+          fprintf(stderr, "Valid kinds: asm, bc, ll\n");
+          return false;
+        }
+      }
     } else if (strncmp(argv[i], "--profile=", 10) == 0) {
       const char *profile = argv[i] + 10;
       if (strcmp(profile, "debug") == 0) {
@@ -515,6 +554,22 @@ bool parse_arguments(int argc, char *argv[], CompilerOptions *options) {
         fprintf(stderr, "Valid profiles: debug, release, size\n");
         return false;
       }
+    } else if (strncmp(argv[i], "-j", 2) == 0) {
+      const char *count = argv[i][2] != '\0' ? argv[i] + 2 : NULL;
+      if (!count) {
+        if (i + 1 >= argc) {
+          fprintf(stderr, "Error: -j requires a thread count\n");
+          return false;
+        }
+        count = argv[++i];
+      }
+      char *end = NULL;
+      unsigned long jobs = strtoul(count, &end, 10);
+      if (*count == '\0' || *end != '\0' || jobs == 0) {
+        fprintf(stderr, "Error: Invalid thread count '%s'\n", count);
+        return false;
+      }
+      options->jobs = (size_t)jobs;
     } else if (strcmp(argv[i], "-o") == 0) {
       if (i + 1 >= argc) {
         fprintf(stderr, "Error: -o requires an output filename\n");
@@ -609,6 +664,12 @@ bool compile_fcx(const CompilerOptions *options) {
   // Initialize operator registry
   init_operator_registry();
 
+  // Use 32-byte lexer scanning when the host has AVX2 (SSE2 otherwise)
+  CpuFeatures host_features = fc_ir_detect_cpu_features();
+  if (fc_ir_has_feature(&host_features, CPU_FEATURE_AVX2)) {
+    lexer_set_simd_level(LEXER_SIMD_AVX2);
+  }
+
   // Preprocess first (handles #include, #define, etc.)
   if (options->verbose) {
     printf("Preprocessing...\n");
@@ -640,30 +701,39 @@ bool compile_fcx(const CompilerOptions *options) {
     printf("\n=== End Preprocessed Source ===\n\n");
   }
 
-  // Initialize lexer on preprocessed source
-  Lexer lexer;
-  lexer_init(&lexer, source);
-
+  // Lex the preprocessed source once; the dumps and the parser all read the
+  // same token array
   if (options->verbose) {
     printf("Lexical analysis...\n");
   }
 
+  TokenBuffer tokens;
+  if (!token_buffer_fill(&tokens, source)) {
+    free(source);
+    preprocessor_destroy(pp);
+    cleanup_operator_registry();
+    return false;
+  }
+
+  if (options->verbose) {
+    printf("Lexed %zu tokens\n", tokens.count);
+  }
+
   // Dump tokens if requested
   if (options->dump_tokens) {
     printf("\n=== Lexer Tokens ===\n");
-    Token token;
-    do {
-      token = lexer_next_token(&lexer);
+    for (size_t i = 0; i < tokens.count; i++) {
+      Token token = token_buffer_get(&tokens, i);
       printf("Token: Line %zu, Col %zu - Kind: %d, Length: %zu\n", token.line,
              token.column, token.kind, token.length);
       if (token.start && token.length > 0) {
         printf("  Text: '%.*s'\n", (int)token.length, token.start);
       }
-    } while (token.kind != TOK_EOF && token.kind != TOK_ERROR);
+      if (token.kind == TOK_ERROR) {
+        break;
+      }
+    }
     printf("=== End Tokens ===\n\n");
-
-    // Reset lexer for parsing
-    lexer_init(&lexer, source);
   }
 
   // Expand operators if requested
@@ -671,9 +741,8 @@ bool compile_fcx(const CompilerOptions *options) {
     printf("\n=== Operator Expansion Mode ===\n");
     printf("Expanding dense operators into readable sequences...\n\n");
     
-    Token token;
-    do {
-      token = lexer_next_token(&lexer);
+    for (size_t i = 0; i < tokens.count; i++) {
+      Token token = token_buffer_get(&tokens, i);
       if (token.start && token.length > 0) {
         char op_text[32];
         size_t copy_len = token.length < sizeof(op_text) - 1 ? token.length : sizeof(op_text) - 1;
@@ -687,17 +756,17 @@ bool compile_fcx(const CompilerOptions *options) {
           printf("Line %zu: '%s' => %s\n", token.line, op_text, expansion);
         }
       }
-    } while (token.kind != TOK_EOF && token.kind != TOK_ERROR);
+      if (token.kind == TOK_ERROR) {
+        break;
+      }
+    }
     
     printf("\n=== End Operator Expansion ===\n\n");
-
-    // Reset lexer for parsing
-    lexer_init(&lexer, source);
   }
 
   // Initialize parser
   Parser parser;
-  parser_init(&parser, &lexer);
+  parser_init_tokens(&parser, &tokens);
 
   if (options->verbose) {
     printf("Parsing...\n");
@@ -714,6 +783,8 @@ bool compile_fcx(const CompilerOptions *options) {
     if (options->verbose) {
       printf("Stopping after parse phase (--stop-after-parse)\n");
     }
+    parser_destroy(&parser);
+    token_buffer_destroy(&tokens);
     free(source);
     preprocessor_destroy(pp);
     cleanup_operator_registry();
@@ -728,52 +799,51 @@ bool compile_fcx(const CompilerOptions *options) {
   IRGenerator *ir_gen = ir_gen_create("main_module");
   if (!ir_gen) {
     fprintf(stderr, "Error: Failed to create IR generator\n");
+    parser_destroy(&parser);
+    token_buffer_destroy(&tokens);
     free(source);
     preprocessor_destroy(pp);
     cleanup_operator_registry();
     return false;
   }
 
-  // Parse preprocessed source into statements
+  // Parse preprocessed source into statements; with -j N top-level fn
+  // items are parsed on N threads
   Stmt **statements = NULL;
   size_t stmt_count = 0;
-  size_t stmt_capacity = 64;
-  
-  statements = malloc(stmt_capacity * sizeof(Stmt*));
-  if (!statements) {
-    fprintf(stderr, "Error: Out of memory\n");
+  if (options->verbose && options->jobs > 1) {
+    printf("Parsing top-level items on %zu threads\n", options->jobs);
+  }
+  if (!parse_program(&parser, options->jobs, &statements, &stmt_count)) {
+    fprintf(stderr, "Error: Parse error\n");
     ir_gen_destroy(ir_gen);
+    parser_destroy(&parser);
+    token_buffer_destroy(&tokens);
     free(source);
     preprocessor_destroy(pp);
     cleanup_operator_registry();
     return false;
   }
 
-  // Parse all statements
-  while (!parser_check(&parser, TOK_EOF)) {
-    Stmt *stmt = parse_statement(&parser);
-    if (!stmt) {
-      if (parser.had_error) {
-        fprintf(stderr, "Error: Parse error\n");
-        free(statements);
-        ir_gen_destroy(ir_gen);
-        free(source);
-        preprocessor_destroy(pp);
-        cleanup_operator_registry();
-        return false;
-      }
-      break;
-    }
-    
-    if (stmt_count >= stmt_capacity) {
-      stmt_capacity *= 2;
-      statements = realloc(statements, stmt_capacity * sizeof(Stmt*));
-    }
-    statements[stmt_count++] = stmt;
-  }
+  // The AST copies everything it keeps out of the token array
+  token_buffer_destroy(&tokens);
 
   if (options->verbose) {
     printf("Parsed %zu statements\n", stmt_count);
+    if (parser.arena) {
+      size_t line_count = 1;
+      for (const char *p = source; *p; p++) {
+        line_count += *p == '\n';
+      }
+      printf("AST: %zu bytes in %zu allocations, %zu KB reserved (%.1f bytes/line)\n",
+             parser.arena->bytes_used, parser.arena->allocations,
+             parser.arena->bytes_reserved / 1024,
+             (double)parser.arena->bytes_used / (double)line_count);
+    }
+    InternStats names;
+    fcx_intern_stats(&names);
+    printf("Names: %zu interned from %zu lookups, %zu bytes\n",
+           names.strings, names.lookups, names.bytes_used);
   }
 
   // Generate IR from parsed AST
@@ -782,6 +852,7 @@ bool compile_fcx(const CompilerOptions *options) {
       fprintf(stderr, "Error: IR generation failed: %s\n",
               ir_gen_get_error(ir_gen));
       free(statements);
+      parser_destroy(&parser);
       preprocessor_destroy(pp);
       ir_gen_destroy(ir_gen);
       free(source);
@@ -790,14 +861,24 @@ bool compile_fcx(const CompilerOptions *options) {
     }
   }
 
-  // Free statements array (statements themselves are managed elsewhere)
+  // The IR no longer references the AST
   free(statements);
+  parser_destroy(&parser);
 
   if (options->verbose && ir_gen->module) {
     printf("FCx IR module created: %s\n", ir_gen->module->name);
     printf("Functions: %u\n", ir_gen->module->function_count);
   }
 
+  // Rewrite reassigned variables into SSA form so that the optimizer sees
+  // single definitions and the backend can emit phis instead of stack slots
+  if (ir_gen->module) {
+    bool all_ssa = ir_ssa_construct_module(ir_gen->module);
+    if (options->verbose && !all_ssa) {
+      printf("Some functions were left out of SSA form\n");
+    }
+  }
+
   // Run FCx IR optimizations (constant folding, dead code elimination, etc.)
   if (ir_gen->module && options->opt_level > OPT_LEVEL_O0) {
     if (options->verbose) {
@@ -806,10 +887,16 @@ bool compile_fcx(const CompilerOptions *options) {
              options->opt_level == OPT_LEVEL_O2 ? "O2" :
              options->opt_level == OPT_LEVEL_O3 ? "O3" : "Os");
     }
-    bool opt_changed = ir_optimize_module_with_level(ir_gen->module, options->opt_level);
+    IROptStats opt_stats = {0};
+    bool opt_changed = ir_optimize_module_with_jobs(
+        ir_gen->module, options->opt_level, options->jobs,
+        options->time_passes ? &opt_stats : NULL);
     if (options->verbose && opt_changed) {
       printf("FCx IR optimizations applied\n");
     }
+    if (options->time_passes) {
+      ir_optimize_print_stats(&opt_stats, stderr);
+    }
   }
 
   // Dump FCx IR if requested (after optimization)
@@ -902,6 +989,9 @@ bool compile_fcx(const CompilerOptions *options) {
     }
 
     LLVMBackendConfig llvm_config = llvm_config_for_level(options->opt_level);
+    // Splitting the module stops LLVM inlining across partitions, so it
+    // only happens when -j asks for it
+    llvm_config.codegen_threads = (uint32_t)options->jobs;
     
     if (options->verbose) {
       const char *opt_desc = 
@@ -983,16 +1073,7 @@ bool compile_fcx(const CompilerOptions *options) {
       printf("=== End LLVM IR ===\n\n");
 
       printf("\n=== Generated Assembly ===\n");
-      if (llvm_generate_assembly(llvm_backend, "/tmp/fcx_output.s")) {
-        FILE *asm_file = fopen("/tmp/fcx_output.s", "r");
-        if (asm_file) {
-          char line[256];
-          while (fgets(line, sizeof(line), asm_file)) {
-            printf("%s", line);
-          }
-          fclose(asm_file);
-        }
-      }
+      llvm_print_assembly(llvm_backend, stdout);
       printf("=== End Assembly ===\n\n");
     }
 
@@ -1006,9 +1087,24 @@ bool compile_fcx(const CompilerOptions *options) {
       }
     }
 
+    // Extra outputs come from the same optimized module the object or
+    // executable is generated from; it is optimized only once
+    char assembly_path[4096], bitcode_path[4096], ir_path[4096];
+    snprintf(assembly_path, sizeof(assembly_path), "%s.s", options->output_file);
+    snprintf(bitcode_path, sizeof(bitcode_path), "%s.bc", options->output_file);
+    snprintf(ir_path, sizeof(ir_path), "%s.ll", options->output_file);
+    LLVMOutputPaths outputs = {
+        .object_path = options->object_only ? options->output_file : NULL,
+        .assembly_path = options->emit_assembly ? assembly_path : NULL,
+        .bitcode_path = options->emit_bitcode ? bitcode_path : NULL,
+        .ir_path = options->emit_ir ? ir_path : NULL,
+    };
+
     bool link_success;
     if (options->object_only) {
-      link_success = llvm_generate_object_file(llvm_backend, options->output_file);
+      link_success = llvm_emit_outputs(llvm_backend, &outputs);
+    } else if (!llvm_emit_outputs(llvm_backend, &outputs)) {
+      link_success = false;
     } else if (options->shared_library) {
       link_success = llvm_compile_shared_library(llvm_backend, options->output_file);
     } else {
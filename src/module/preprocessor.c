@@ -1895,7 +1895,10 @@ char *preprocessor_process_file_to_string(Preprocessor *pp, const char *filename
 // ============================================================================
 
 bool preprocessor_process_file(Preprocessor *pp, const char *filename,
-                               Stmt ***statements, size_t *stmt_count) {
+                               Stmt ***statements, size_t *stmt_count,
+                               AstArena **arena) {
+    *arena = NULL;
+    
     // Preprocess the file
     char *preprocessed = preprocessor_process_file_to_string(pp, filename);
     if (!preprocessed) {
@@ -1906,6 +1909,8 @@ bool preprocessor_process_file(Preprocessor *pp, const char *filename,
     Lexer lexer;
     lexer_init(&lexer, preprocessed);
     
+    // The statements live in the parser's AST arena, which goes to the
+    // caller on success
     Parser parser;
     parser_init(&parser, &lexer);
     
@@ -1920,6 +1925,10 @@ bool preprocessor_process_file(Preprocessor *pp, const char *filename,
         if (!stmt) {
             if (parser.had_error) {
                 pp_error(pp, "Parse error in preprocessed output");
+                free(*statements);
+                *statements = NULL;
+                *stmt_count = 0;
+                parser_destroy(&parser);
                 free(preprocessed);
                 return false;
             }
@@ -1935,6 +1944,9 @@ bool preprocessor_process_file(Preprocessor *pp, const char *filename,
         (*statements)[(*stmt_count)++] = stmt;
     }
     
+    *arena = parser.arena;
+    parser.owns_arena = false;
+    parser_destroy(&parser);
     free(preprocessed);
     return true;
 }
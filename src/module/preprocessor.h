@@ -21,6 +21,7 @@
 #ifndef FCX_PREPROCESSOR_H
 #define FCX_PREPROCESSOR_H
 
+#include "../parser/ast_arena.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -232,10 +233,13 @@ char *preprocessor_process_file_to_string(Preprocessor *pp, const char *filename
  * @param filename File to process
  * @param statements Output array of statements
  * @param stmt_count Output statement count
+ * @param arena Output AST arena holding the statements; the caller releases
+ *              it with ast_arena_destroy
  * @return true on success
  */
 bool preprocessor_process_file(Preprocessor *pp, const char *filename,
-                               struct Stmt ***statements, size_t *stmt_count);
+                               struct Stmt ***statements, size_t *stmt_count,
+                               AstArena **arena);
 
 // ============================================================================
 // Error handling
@@ -6,6 +6,7 @@
 #include "hmso.h"
 #include "../ir/fcx_ir.h"
 #include "../ir/ir_optimize.h"
+#include "../ir/ir_cfg.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -447,7 +448,8 @@ static FunctionSummary *generate_function_summary(FcxIRFunction *func) {
     
     summary->basic_block_count = func->block_count;
     summary->cyclomatic_complexity = calculate_complexity(func);
-    summary->loop_depth_max = 0;  // TODO: implement loop detection
+    const IRCFG *cfg = ir_cfg_get(func);
+    summary->loop_depth_max = cfg ? cfg->max_loop_depth : 0;
     
     summary->flags = analyze_function_flags(func);
     summary->memory_access = analyze_memory_access(func);
@@ -275,7 +275,7 @@ static bool optimize_function_standard(FcxIRFunction *func, const HMSOConfig *co
     }
     
     // Dead code elimination
-    if (opt_dead_code_elimination(func)) {
+    if (opt_dead_code_elimination(func, NULL)) {
         changed = true;
     }
     
@@ -0,0 +1,188 @@
+#include "ast_arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Large enough that a typical source file needs only a handful of chunks
+#define AST_ARENA_CHUNK_SIZE (64 * 1024)
+// Every AST and IR type needs at most 8-byte alignment (pointers, int64,
+// double, uint64 limbs)
+#define AST_ARENA_ALIGN ((size_t)8)
+
+struct AstArenaChunk {
+  AstArenaChunk *next;
+  size_t used;
+  size_t capacity;
+  _Alignas(max_align_t) unsigned char data[];
+};
+
+static size_t align_size(size_t size) {
+  return (size + AST_ARENA_ALIGN - 1) & ~(AST_ARENA_ALIGN - 1);
+}
+
+static AstArenaChunk *new_chunk(AstArena *arena, size_t capacity) {
+  AstArenaChunk *chunk = malloc(sizeof(AstArenaChunk) + capacity);
+  if (!chunk) {
+    return NULL;
+  }
+  chunk->next = NULL;
+  chunk->used = 0;
+  chunk->capacity = capacity;
+  arena->bytes_reserved += capacity;
+  return chunk;
+}
+
+AstArena *ast_arena_create(void) {
+  return ast_arena_create_sized(AST_ARENA_CHUNK_SIZE, AST_ARENA_CHUNK_SIZE);
+}
+
+AstArena *ast_arena_create_sized(size_t first_chunk_size,
+                                 size_t max_chunk_size) {
+  AstArena *arena = calloc(1, sizeof(AstArena));
+  if (!arena) {
+    return NULL;
+  }
+  arena->max_chunk_size = max_chunk_size;
+  arena->head = new_chunk(arena, first_chunk_size);
+  if (!arena->head) {
+    free(arena);
+    return NULL;
+  }
+  return arena;
+}
+
+void ast_arena_destroy(AstArena *arena) {
+  if (!arena) {
+    return;
+  }
+  AstArenaChunk *chunk = arena->head;
+  while (chunk) {
+    AstArenaChunk *next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  free(arena);
+}
+
+void ast_arena_reset(AstArena *arena) {
+  if (!arena) {
+    return;
+  }
+  // The head is the chunk most recently started, and so the largest one
+  // except for oversized requests behind it
+  AstArenaChunk *chunk = arena->head->next;
+  while (chunk) {
+    AstArenaChunk *next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  arena->head->next = NULL;
+  arena->head->used = 0;
+  arena->bytes_used = 0;
+  arena->bytes_reserved = arena->head->capacity;
+  arena->allocations = 0;
+}
+
+void ast_arena_adopt(AstArena *dst, AstArena *src) {
+  if (!src) {
+    return;
+  }
+  // Splice src's chunks in behind dst's head so dst keeps filling its own
+  // current chunk
+  AstArenaChunk *tail = src->head;
+  while (tail->next) {
+    tail = tail->next;
+  }
+  tail->next = dst->head->next;
+  dst->head->next = src->head;
+
+  dst->bytes_used += src->bytes_used;
+  dst->bytes_reserved += src->bytes_reserved;
+  dst->allocations += src->allocations;
+  free(src);
+}
+
+void *ast_arena_alloc(AstArena *arena, size_t size) {
+  if (!arena) {
+    return NULL;
+  }
+  size = align_size(size);
+
+  AstArenaChunk *chunk = arena->head;
+  if (chunk->capacity - chunk->used < size) {
+    // Each new chunk matches everything reserved so far, so the arena as a
+    // whole doubles until chunks reach max_chunk_size
+    size_t capacity = arena->bytes_reserved;
+    if (capacity > arena->max_chunk_size) {
+      capacity = arena->max_chunk_size;
+    }
+    if (size > capacity / 4) {
+      // Oversized request: give it its own chunk behind the current one so
+      // the remaining space in head keeps being used
+      AstArenaChunk *big = new_chunk(arena, size);
+      if (!big) {
+        return NULL;
+      }
+      big->used = size;
+      big->next = chunk->next;
+      chunk->next = big;
+      arena->bytes_used += size;
+      arena->allocations++;
+      return big->data;
+    }
+    chunk = new_chunk(arena, capacity);
+    if (!chunk) {
+      return NULL;
+    }
+    chunk->next = arena->head;
+    arena->head = chunk;
+  }
+
+  void *result = chunk->data + chunk->used;
+  chunk->used += size;
+  arena->bytes_used += size;
+  arena->allocations++;
+  return result;
+}
+
+void *ast_arena_dup(AstArena *arena, const void *src, size_t size) {
+  void *copy = ast_arena_alloc(arena, size);
+  if (copy && size > 0) {
+    memcpy(copy, src, size);
+  }
+  return copy;
+}
+
+uint64_t *ast_arena_limbs(AstArena *arena, const uint64_t *limbs,
+                          size_t count) {
+  return ast_arena_dup(arena, limbs, count * sizeof(uint64_t));
+}
+
+void *ast_arena_grow(AstArena *arena, void *ptr, size_t old_size,
+                     size_t new_size) {
+  if (!arena) {
+    return NULL;
+  }
+  if (!ptr || old_size == 0) {
+    return ast_arena_alloc(arena, new_size);
+  }
+  if (new_size <= old_size) {
+    return ptr;
+  }
+
+  // Extend in place if ptr is the most recent allocation of the head chunk
+  AstArenaChunk *chunk = arena->head;
+  size_t old_aligned = align_size(old_size);
+  size_t new_aligned = align_size(new_size);
+  if ((unsigned char *)ptr + old_aligned == chunk->data + chunk->used &&
+      chunk->capacity - chunk->used >= new_aligned - old_aligned) {
+    chunk->used += new_aligned - old_aligned;
+    arena->bytes_used += new_aligned - old_aligned;
+    return ptr;
+  }
+
+  void *result = ast_arena_alloc(arena, new_size);
+  if (result) {
+    memcpy(result, ptr, old_size);
+  }
+  return result;
+}
@@ -0,0 +1,57 @@
+#ifndef FCX_AST_ARENA_H
+#define FCX_AST_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bump allocator backing the AST
+// Expr/Stmt nodes and bigint limbs are carved out of large chunks and
+// released together by ast_arena_destroy. Nothing allocated from the arena is
+// freed individually. Names are not stored here but interned (intern.h).
+// The FCx IR allocates its per-function storage from the same allocator
+// (ir_arena.h), with chunks that start small and double.
+
+typedef struct AstArenaChunk AstArenaChunk;
+
+typedef struct {
+  AstArenaChunk *head;   // Chunk currently being filled
+  size_t bytes_used;     // Bytes handed out, including alignment padding
+  size_t bytes_reserved; // Bytes obtained from malloc for chunks
+  size_t allocations;    // Number of ast_arena_alloc calls that succeeded
+  size_t max_chunk_size; // New chunks grow up to this size
+} AstArena;
+
+// Arena with 64 KiB chunks
+AstArena *ast_arena_create(void);
+
+// Arena whose first chunk holds first_chunk_size bytes; each new chunk then
+// matches everything reserved so far, up to max_chunk_size
+AstArena *ast_arena_create_sized(size_t first_chunk_size,
+                                 size_t max_chunk_size);
+void ast_arena_destroy(AstArena *arena);
+
+// Release everything allocated from the arena but keep its current chunk,
+// so that a following run of similar size allocates nothing new
+void ast_arena_reset(AstArena *arena);
+
+// Move every chunk of src into dst and free src. Memory handed out by src
+// stays valid and is now released with dst.
+void ast_arena_adopt(AstArena *dst, AstArena *src);
+
+// Uninitialized storage aligned for any AST type; NULL on OOM
+void *ast_arena_alloc(AstArena *arena, size_t size);
+
+// Copy of size bytes of src
+void *ast_arena_dup(AstArena *arena, const void *src, size_t size);
+
+// Copy of count limbs of a big integer literal
+uint64_t *ast_arena_limbs(AstArena *arena, const uint64_t *limbs, size_t count);
+
+// Resize an array allocated from the arena, keeping its first old_size
+// bytes. The array is extended in place when it is the last allocation of
+// the current chunk; otherwise it is copied and the old storage stays unused
+// until the arena is destroyed. NULL on OOM, leaving ptr intact.
+void *ast_arena_grow(AstArena *arena, void *ptr, size_t old_size,
+                     size_t new_size);
+
+#endif // FCX_AST_ARENA_H
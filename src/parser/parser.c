@@ -6,6 +6,7 @@
 
 // Forward declarations for parsing functions
 Expr *parse_postfix(Parser *parser, Expr *operand);
+static void init_parse_rules(void);
 
 // Portable string duplication function for C99 compatibility
 static char *fcx_strdup(const char *str) {
@@ -19,6 +20,15 @@ static char *fcx_strdup(const char *str) {
   return copy;
 }
 
+// Interned name of an identifier-like token. Identifier tokens carry the
+// name the lexer interned; keywords used as names are interned here.
+static const char *token_name(const Token *token) {
+  if (token->kind == TOK_IDENTIFIER && token->value.identifier) {
+    return token->value.identifier;
+  }
+  return fcx_intern(token->start, token->length);
+}
+
 // Helper functions to categorize operators
 static bool is_memory_operator(TokenKind op) {
   return (op == OP_ALLOCATE || op == OP_DEALLOCATE || op == OP_STACK_ALLOC ||
@@ -49,10 +59,13 @@ static bool is_syscall_operator(TokenKind op) {
 // Resolves parsing conflicts for operators like <=> (function vs CAS) and <<<
 // (rotate vs format)
 
-void parser_init(Parser *parser, Lexer *lexer) {
-  parser->lexer = lexer;
-  parser->had_error = false;
+static void parser_init_common(Parser *parser) {
+  parser->had_error = parser->arena == NULL;
   parser->panic_mode = false;
+  parser->quiet = false;
+
+  // Build the rule table up front so parsers on other threads only read it
+  init_parse_rules();
 
   // Initialize disambiguation context stack
   parser->context_stack.depth = 0;
@@ -66,9 +79,73 @@ void parser_init(Parser *parser, Lexer *lexer) {
   parser_advance(parser);
 }
 
+void parser_init(Parser *parser, Lexer *lexer) {
+  parser->lexer = lexer;
+  parser->tokens = NULL;
+  parser->token_index = 0;
+  parser->token_end = 0;
+  parser->source = lexer->source;
+  parser->arena = ast_arena_create();
+  parser->owns_arena = true;
+  parser_init_common(parser);
+}
+
+// Parse from an already-lexed token array
+void parser_init_tokens(Parser *parser, const TokenBuffer *tokens) {
+  parser->lexer = NULL;
+  parser->tokens = tokens;
+  parser->token_index = 0;
+  parser->token_end = tokens->count;
+  parser->source = tokens->source;
+  parser->arena = ast_arena_create();
+  parser->owns_arena = true;
+  parser_init_common(parser);
+}
+
+// Parse tokens[begin, end) only, allocating nodes from a caller-owned arena.
+// The token at `end` reads as EOF.
+void parser_init_token_range(Parser *parser, const TokenBuffer *tokens,
+                             size_t begin, size_t end, AstArena *arena) {
+  parser->lexer = NULL;
+  parser->tokens = tokens;
+  parser->token_index = begin;
+  parser->token_end = end < tokens->count ? end : tokens->count;
+  parser->source = tokens->source;
+  parser->arena = arena;
+  parser->owns_arena = false;
+  parser_init_common(parser);
+}
+
+// Release the AST arena; every node this parser returned becomes invalid
+void parser_destroy(Parser *parser) {
+  if (parser->owns_arena) {
+    ast_arena_destroy(parser->arena);
+  }
+  parser->arena = NULL;
+}
+
+// Token at `index` in token-array mode, clamped to the parser's range
+static Token parser_token_at(const Parser *parser, size_t index) {
+  if (index < parser->token_end) {
+    return token_buffer_get(parser->tokens, index);
+  }
+  // Past the range: EOF located at the first token after it
+  Token token = token_buffer_get(parser->tokens, parser->token_end);
+  token.kind = TOK_EOF;
+  token.length = 0;
+  return token;
+}
+
 void parser_advance(Parser *parser) {
   parser->previous = parser->current;
-  parser->current = lexer_next_token(parser->lexer);
+  if (parser->tokens) {
+    parser->current = parser_token_at(parser, parser->token_index);
+    if (parser->token_index < parser->token_end) {
+      parser->token_index++;
+    }
+  } else {
+    parser->current = lexer_next_token(parser->lexer);
+  }
 }
 
 bool parser_check(Parser *parser, TokenKind type) {
@@ -95,14 +172,16 @@ Token consume(Parser *parser, TokenKind type, const char *message) {
 }
 
 void error_at_current(Parser *parser, const char *message) {
-  fprintf(stderr, "[Line %zu] Error at '%.*s': %s\n", parser->current.line,
-          (int)parser->current.length, parser->current.start, message);
+  if (!parser->quiet)
+    fprintf(stderr, "[Line %zu] Error at '%.*s': %s\n", parser->current.line,
+            (int)parser->current.length, parser->current.start, message);
   parser->had_error = true;
 }
 
 void error_at_previous(Parser *parser, const char *message) {
-  fprintf(stderr, "[Line %zu] Error at '%.*s': %s\n", parser->previous.line,
-          (int)parser->previous.length, parser->previous.start, message);
+  if (!parser->quiet)
+    fprintf(stderr, "[Line %zu] Error at '%.*s': %s\n", parser->previous.line,
+            (int)parser->previous.length, parser->previous.start, message);
   parser->had_error = true;
 }
 
@@ -181,7 +260,7 @@ bool is_function_context(Parser *parser) {
 
   // Pattern: @name <=> (named function)
   if (prev.kind == TOK_IDENTIFIER &&
-      parser->previous.start > parser->lexer->source &&
+      parser->previous.start > parser->source &&
       *(parser->previous.start - 1) == '@') {
     return true;
   }
@@ -623,7 +702,7 @@ Expr *parse_expression(Parser *parser) {
 
 // Parse literal values
 Expr *parse_literal(Parser *parser) {
-  Expr *expr = allocate_expr(EXPR_LITERAL);
+  Expr *expr = allocate_expr(parser, EXPR_LITERAL);
   if (!expr)
     return NULL;
 
@@ -721,10 +800,12 @@ Expr *parse_literal(Parser *parser) {
           return NULL;
         }
         
-        // Store as bigint with limb-based storage
+        // Store as bigint; only the used limbs are kept, in the AST arena
         expr->data.literal.type = LIT_BIGINT;
-        for (uint8_t j = 0; j < 16; j++) {
-          expr->data.literal.value.bigint.limbs[j] = (j < num_limbs) ? limbs[j] : 0;
+        expr->data.literal.value.bigint.limbs =
+            ast_arena_limbs(parser->arena, limbs, num_limbs);
+        if (!expr->data.literal.value.bigint.limbs) {
+          return NULL;
         }
         expr->data.literal.value.bigint.num_limbs = num_limbs;
         expr->data.literal.value.bigint.is_negative = false;
@@ -773,22 +854,18 @@ Expr *parse_literal(Parser *parser) {
 
 // Parse identifier (including keywords used as identifiers)
 Expr *parse_identifier(Parser *parser) {
-  Expr *expr = allocate_expr(EXPR_IDENTIFIER);
+  Expr *expr = allocate_expr(parser, EXPR_IDENTIFIER);
   if (!expr)
     return NULL;
 
   expr->line = parser->previous.line;
   expr->column = parser->previous.column;
 
-  size_t name_len = parser->previous.length;
-  expr->data.identifier = malloc(name_len + 1);
+  expr->data.identifier = token_name(&parser->previous);
   if (!expr->data.identifier) {
-    free_expr(expr);
     return NULL;
   }
 
-  strncpy(expr->data.identifier, parser->previous.start, name_len);
-  expr->data.identifier[name_len] = '\0';
 
   return expr;
 }
@@ -831,7 +908,7 @@ Expr *parse_binary(Parser *parser, Expr *left) {
       // with a placeholder right side, or use a different approach.
       //
       // Better solution: create a binary node with NULL right side as a marker
-      Expr *expr = allocate_expr(EXPR_BINARY);
+      Expr *expr = allocate_expr(parser, EXPR_BINARY);
       if (!expr) {
         free_expr(left);
         return NULL;
@@ -858,7 +935,7 @@ Expr *parse_binary(Parser *parser, Expr *left) {
   // Check if this is a special operator that needs a specific AST node type
   if (is_memory_operator(operator_type)) {
     // Create memory operation node
-    Expr *expr = allocate_expr(EXPR_MEMORY_OP);
+    Expr *expr = allocate_expr(parser, EXPR_MEMORY_OP);
     if (!expr) {
       free_expr(left);
       free_expr(right);
@@ -880,7 +957,6 @@ Expr *parse_binary(Parser *parser, Expr *left) {
     if (!expr->data.memory_op.operands) {
       free_expr(left);
       free_expr(right);
-      free(expr);
       return NULL;
     }
     expr->data.memory_op.operands[0] = left;
@@ -890,7 +966,7 @@ Expr *parse_binary(Parser *parser, Expr *left) {
     return expr;
   } else if (is_atomic_operator(operator_type)) {
     // Create atomic operation node
-    Expr *expr = allocate_expr(EXPR_ATOMIC_OP);
+    Expr *expr = allocate_expr(parser, EXPR_ATOMIC_OP);
     if (!expr) {
       free_expr(left);
       free_expr(right);
@@ -915,7 +991,6 @@ Expr *parse_binary(Parser *parser, Expr *left) {
     if (!expr->data.atomic_op.operands) {
       free_expr(left);
       free_expr(right);
-      free(expr);
       return NULL;
     }
     expr->data.atomic_op.operands[0] = left;
@@ -926,7 +1001,7 @@ Expr *parse_binary(Parser *parser, Expr *left) {
   } else if (is_syscall_operator(operator_type)) {
     // Create syscall operation node for: fd $/ buffer, length
     // left = fd, right = buffer, need to parse length after comma
-    Expr *expr = allocate_expr(EXPR_SYSCALL_OP);
+    Expr *expr = allocate_expr(parser, EXPR_SYSCALL_OP);
     if (!expr) {
       free_expr(left);
       free_expr(right);
@@ -952,7 +1027,6 @@ Expr *parse_binary(Parser *parser, Expr *left) {
       if (!length) {
         free_expr(left);
         free_expr(right);
-        free(expr);
         return NULL;
       }
     }
@@ -964,7 +1038,6 @@ Expr *parse_binary(Parser *parser, Expr *left) {
       free_expr(left);
       free_expr(right);
       if (length) free_expr(length);
-      free(expr);
       return NULL;
     }
     expr->data.syscall_op.args[0] = left;   // fd
@@ -985,7 +1058,7 @@ Expr *parse_binary(Parser *parser, Expr *left) {
        operator_type == OP_MUL_ASSIGN) &&
       operator_length == 2) {
     // This is an assignment expression
-    Expr *expr = allocate_expr(EXPR_ASSIGNMENT);
+    Expr *expr = allocate_expr(parser, EXPR_ASSIGNMENT);
     if (!expr) {
       free_expr(left);
       free_expr(right);
@@ -1002,7 +1075,7 @@ Expr *parse_binary(Parser *parser, Expr *left) {
   }
 
   // Regular binary expression
-  Expr *expr = allocate_expr(EXPR_BINARY);
+  Expr *expr = allocate_expr(parser, EXPR_BINARY);
   if (!expr) {
     free_expr(left);
     free_expr(right);
@@ -1032,7 +1105,7 @@ Expr *parse_unary(Parser *parser) {
       return NULL;
     }
 
-    Expr *expr = allocate_expr(EXPR_UNARY);
+    Expr *expr = allocate_expr(parser, EXPR_UNARY);
     if (!expr) {
       free_expr(operand);
       return NULL;
@@ -1064,7 +1137,7 @@ Expr *parse_unary(Parser *parser) {
     return NULL;
   }
 
-  Expr *expr = allocate_expr(EXPR_UNARY);
+  Expr *expr = allocate_expr(parser, EXPR_UNARY);
   if (!expr) {
     free_expr(operand);
     return NULL;
@@ -1127,7 +1200,7 @@ Expr *parse_ternary(Parser *parser, Expr *first) {
         // Binary CAS form: a <=> b
         pop_context(parser);
 
-        Expr *expr = allocate_expr(EXPR_ATOMIC_OP);
+        Expr *expr = allocate_expr(parser, EXPR_ATOMIC_OP);
         if (!expr) {
           free_expr(first);
           free_expr(second);
@@ -1141,7 +1214,6 @@ Expr *parse_ternary(Parser *parser, Expr *first) {
         if (!expr->data.atomic_op.operands) {
           free_expr(first);
           free_expr(second);
-          free(expr);
           return NULL;
         }
         expr->data.atomic_op.operands[0] = first;
@@ -1164,7 +1236,7 @@ Expr *parse_ternary(Parser *parser, Expr *first) {
     pop_context(parser);
   }
 
-  Expr *expr = allocate_expr(EXPR_TERNARY);
+  Expr *expr = allocate_expr(parser, EXPR_TERNARY);
   if (!expr) {
     free_expr(first);
     free_expr(second);
@@ -1184,7 +1256,7 @@ Expr *parse_ternary(Parser *parser, Expr *first) {
 
 // Parse function calls
 Expr *parse_call(Parser *parser, Expr *callee) {
-  Expr *expr = allocate_expr(EXPR_CALL);
+  Expr *expr = allocate_expr(parser, EXPR_CALL);
   if (!expr) {
     free_expr(callee);
     return NULL;
@@ -1235,7 +1307,7 @@ Expr *parse_call(Parser *parser, Expr *callee) {
 
 // Parse array/pointer indexing: ptr[index]
 Expr *parse_index(Parser *parser, Expr *base) {
-  Expr *expr = allocate_expr(EXPR_INDEX);
+  Expr *expr = allocate_expr(parser, EXPR_INDEX);
   if (!expr) {
     free_expr(base);
     return NULL;
@@ -1261,7 +1333,7 @@ Expr *parse_index(Parser *parser, Expr *base) {
 // Parse pointer dereference: @ptr (load) or ptr@ (store)
 // Using @ as the dereference operator
 Expr *parse_deref(Parser *parser) {
-  Expr *expr = allocate_expr(EXPR_DEREF);
+  Expr *expr = allocate_expr(parser, EXPR_DEREF);
   if (!expr) {
     return NULL;
   }
@@ -1288,7 +1360,7 @@ Expr *parse_postfix(Parser *parser, Expr *operand) {
 
   // Check if this is an atomic operation (like ptr!!)
   if (is_atomic_operator(operator_type)) {
-    Expr *expr = allocate_expr(EXPR_ATOMIC_OP);
+    Expr *expr = allocate_expr(parser, EXPR_ATOMIC_OP);
     if (!expr) {
       free_expr(operand);
       return NULL;
@@ -1300,7 +1372,6 @@ Expr *parse_postfix(Parser *parser, Expr *operand) {
     expr->data.atomic_op.operands = malloc(sizeof(Expr *));
     if (!expr->data.atomic_op.operands) {
       free_expr(operand);
-      free(expr);
       return NULL;
     }
     expr->data.atomic_op.operands[0] = operand;
@@ -1310,7 +1381,7 @@ Expr *parse_postfix(Parser *parser, Expr *operand) {
   }
 
   // Regular postfix unary expression
-  Expr *expr = allocate_expr(EXPR_UNARY);
+  Expr *expr = allocate_expr(parser, EXPR_UNARY);
   if (!expr) {
     free_expr(operand);
     return NULL;
@@ -1334,7 +1405,7 @@ Expr *parse_assignment(Parser *parser, Expr *target) {
     return NULL;
   }
 
-  Expr *expr = allocate_expr(EXPR_ASSIGNMENT);
+  Expr *expr = allocate_expr(parser, EXPR_ASSIGNMENT);
   if (!expr) {
     free_expr(target);
     free_expr(value);
@@ -1357,6 +1428,48 @@ Expr *parse_grouping(Parser *parser) {
   return expr;
 }
 
+// Parse a builtin type keyword (i8 ... u1024, f32, f64, ptr, rawptr) into a
+// heap-allocated Type; returns NULL without consuming anything otherwise
+static Type *parse_type_keyword(Parser *parser) {
+  TypeKind kind;
+  switch (parser->current.kind) {
+    case KW_I8: kind = TYPE_I8; break;
+    case KW_I16: kind = TYPE_I16; break;
+    case KW_I32: kind = TYPE_I32; break;
+    case KW_I64: kind = TYPE_I64; break;
+    case KW_I128: kind = TYPE_I128; break;
+    case KW_I256: kind = TYPE_I256; break;
+    case KW_I512: kind = TYPE_I512; break;
+    case KW_I1024: kind = TYPE_I1024; break;
+    case KW_U8: kind = TYPE_U8; break;
+    case KW_U16: kind = TYPE_U16; break;
+    case KW_U32: kind = TYPE_U32; break;
+    case KW_U64: kind = TYPE_U64; break;
+    case KW_U128: kind = TYPE_U128; break;
+    case KW_U256: kind = TYPE_U256; break;
+    case KW_U512: kind = TYPE_U512; break;
+    case KW_U1024: kind = TYPE_U1024; break;
+    case KW_F32: kind = TYPE_F32; break;
+    case KW_F64: kind = TYPE_F64; break;
+    case KW_PTR: kind = TYPE_PTR; break;
+    case KW_RAWPTR: kind = TYPE_RAWPTR; break;
+    default: return NULL;
+  }
+  Type *type = calloc(1, sizeof(Type));
+  if (!type) return NULL;
+  type->kind = kind;
+  parser_advance(parser); // consume the type keyword
+  return type;
+}
+
+// Free the parameter list of a function, including parameter types
+static void free_params(Parameter *params, size_t param_count) {
+  for (size_t i = 0; params && i < param_count; i++) {
+    free(params[i].type);
+  }
+  free(params);
+}
+
 // Parse function definition (when <=> is disambiguated as function)
 Expr *parse_function_definition(Parser *parser, Expr *name_expr) {
   if (name_expr->type != EXPR_IDENTIFIER) {
@@ -1407,17 +1520,13 @@ Expr *parse_function_definition(Parser *parser, Expr *name_expr) {
 
       consume(parser, TOK_IDENTIFIER, "Expected parameter name");
 
-      size_t name_len = parser->previous.length;
-      params[param_count].name = malloc(name_len + 1);
+      params[param_count].name = token_name(&parser->previous);
       if (!params[param_count].name) {
         free(params);
         free_expr(name_expr);
         pop_context(parser);
         return NULL;
       }
-
-      strncpy(params[param_count].name, parser->previous.start, name_len);
-      params[param_count].name[name_len] = '\0';
       params[param_count].type = NULL; // Type inference for now
 
       param_count++;
@@ -1432,7 +1541,7 @@ Expr *parse_function_definition(Parser *parser, Expr *name_expr) {
 
   pop_context(parser);
 
-  Expr *expr = allocate_expr(EXPR_FUNCTION_DEF);
+  Expr *expr = allocate_expr(parser, EXPR_FUNCTION_DEF);
   if (!expr) {
     free_expr(name_expr);
     free(params);
@@ -1441,11 +1550,11 @@ Expr *parse_function_definition(Parser *parser, Expr *name_expr) {
 
   expr->line = name_expr->line;
   expr->column = name_expr->column;
-  expr->data.function_def.name = fcx_strdup(name_expr->data.identifier);
-  expr->data.function_def.params = params;
-  expr->data.function_def.param_count = param_count;
-  expr->data.function_def.body = body;
-  expr->data.function_def.is_compact = true; // <=> syntax
+  expr->data.function_def->name = name_expr->data.identifier;
+  expr->data.function_def->params = params;
+  expr->data.function_def->param_count = param_count;
+  expr->data.function_def->body = body;
+  expr->data.function_def->is_compact = true; // <=> syntax
 
   free_expr(name_expr);
   return expr;
@@ -1495,14 +1604,10 @@ Stmt *parse_function_statement(Parser *parser) {
   // Traditional function syntax: fn name(params) { body }
   consume(parser, TOK_IDENTIFIER, "Expected function name");
 
-  size_t name_len = parser->previous.length;
-  char *name = malloc(name_len + 1);
+  const char *name = token_name(&parser->previous);
   if (!name)
     return NULL;
 
-  strncpy(name, parser->previous.start, name_len);
-  name[name_len] = '\0';
-
   consume(parser, TOK_LPAREN, "Expected '(' after function name");
 
   // Parse parameters
@@ -1514,7 +1619,6 @@ Stmt *parse_function_statement(Parser *parser) {
     param_capacity = 4;
     params = malloc(param_capacity * sizeof(Parameter));
     if (!params) {
-      free(name);
       return NULL;
     }
 
@@ -1524,11 +1628,7 @@ Stmt *parse_function_statement(Parser *parser) {
         Parameter *new_params =
             realloc(params, param_capacity * sizeof(Parameter));
         if (!new_params) {
-          for (size_t i = 0; i < param_count; i++) {
-            free(params[i].name);
-          }
-          free(params);
-          free(name);
+          free_params(params, param_count);
           return NULL;
         }
         params = new_params;
@@ -1536,20 +1636,20 @@ Stmt *parse_function_statement(Parser *parser) {
 
       consume(parser, TOK_IDENTIFIER, "Expected parameter name");
 
-      size_t param_name_len = parser->previous.length;
-      params[param_count].name = malloc(param_name_len + 1);
+      params[param_count].name = token_name(&parser->previous);
       if (!params[param_count].name) {
-        for (size_t i = 0; i < param_count; i++) {
-          free(params[i].name);
-        }
-        free(params);
-        free(name);
+        free_params(params, param_count);
         return NULL;
       }
 
-      strncpy(params[param_count].name, parser->previous.start, param_name_len);
-      params[param_count].name[param_name_len] = '\0';
-      params[param_count].type = NULL; // Type inference for now
+      // Optional parameter type: name: i32; untyped parameters are i64
+      params[param_count].type = NULL;
+      if (parser_match(parser, TOK_COLON)) {
+        params[param_count].type = parse_type_keyword(parser);
+        if (!params[param_count].type) {
+          error_at_current(parser, "Expected parameter type");
+        }
+      }
 
       param_count++;
     } while (parser_match(parser, TOK_COMMA));
@@ -1557,23 +1657,16 @@ Stmt *parse_function_statement(Parser *parser) {
 
   consume(parser, TOK_RPAREN, "Expected ')' after parameters");
 
-  // Parse optional return type: -> type
+  // Parse optional return type: -> type; without one the function returns i64
+  Type *return_type = NULL;
   // Check for -> operator (it's tokenized as an operator with kind 62)
   if (parser->current.start && parser->current.length >= 2 &&
       parser->current.start[0] == '-' && parser->current.start[1] == '>') {
     parser_advance(parser); // Skip ->
     // Parse the return type (can be identifier or keyword like i32, i64, etc.)
     // Including bigint types: i128, i256, i512, i1024, u128, u256, u512, u1024
-    if (parser_check(parser, TOK_IDENTIFIER) || 
-        parser_check(parser, KW_I8) || parser_check(parser, KW_I16) ||
-        parser_check(parser, KW_I32) || parser_check(parser, KW_I64) ||
-        parser_check(parser, KW_I128) || parser_check(parser, KW_I256) ||
-        parser_check(parser, KW_I512) || parser_check(parser, KW_I1024) ||
-        parser_check(parser, KW_U8) || parser_check(parser, KW_U16) ||
-        parser_check(parser, KW_U32) || parser_check(parser, KW_U64) ||
-        parser_check(parser, KW_U128) || parser_check(parser, KW_U256) ||
-        parser_check(parser, KW_U512) || parser_check(parser, KW_U1024) ||
-        parser_check(parser, KW_F32) || parser_check(parser, KW_F64)) {
+    return_type = parse_type_keyword(parser);
+    if (!return_type && parser_check(parser, TOK_IDENTIFIER)) {
       parser_advance(parser);
     }
   }
@@ -1581,26 +1674,25 @@ Stmt *parse_function_statement(Parser *parser) {
   // Expect opening brace for function body
   if (!parser_check(parser, TOK_LBRACE)) {
     error_at_current(parser, "Expected '{' before function body");
+    free_params(params, param_count);
+    free(return_type);
     return NULL;
   }
   parser_advance(parser); // consume {
 
   Block body = parse_block(parser);
 
-  Stmt *stmt = allocate_stmt(STMT_FUNCTION);
+  Stmt *stmt = allocate_stmt(parser, STMT_FUNCTION);
   if (!stmt) {
-    for (size_t i = 0; i < param_count; i++) {
-      free(params[i].name);
-    }
-    free(params);
-    free(name);
+    free_params(params, param_count);
+    free(return_type);
     return NULL;
   }
 
   stmt->data.function.name = name;
   stmt->data.function.params = params;
   stmt->data.function.param_count = param_count;
-  stmt->data.function.return_type = NULL;
+  stmt->data.function.return_type = return_type;
   stmt->data.function.body = body;
   stmt->data.function.verbosity = SYNTAX_VERBOSE;
 
@@ -1638,7 +1730,7 @@ Stmt *parse_compact_conditional_statement(Parser *parser) {
   then_branch.statements[0] = then_stmt;
   then_branch.count = 1;
 
-  Stmt *stmt = allocate_stmt(STMT_IF);
+  Stmt *stmt = allocate_stmt(parser, STMT_IF);
   if (!stmt) {
     free_expr(condition);
     free_block(&then_branch);
@@ -1659,11 +1751,8 @@ Stmt *parse_let_statement(Parser *parser) {
   // Parse variable name
   consume(parser, TOK_IDENTIFIER, "Expected variable name");
   
-  size_t name_len = parser->previous.length;
-  char *name = malloc(name_len + 1);
+  const char *name = token_name(&parser->previous);
   if (!name) return NULL;
-  strncpy(name, parser->previous.start, name_len);
-  name[name_len] = '\0';
 
   Type *type_annotation = NULL;
   Expr *initializer = NULL;
@@ -1672,49 +1761,11 @@ Stmt *parse_let_statement(Parser *parser) {
   // Or multi-variable: let a:b := ...
   if (parser_match(parser, TOK_COLON)) {
     // Check if next token is a type keyword
-    if (parser_check(parser, KW_I8) || parser_check(parser, KW_I16) ||
-        parser_check(parser, KW_I32) || parser_check(parser, KW_I64) ||
-        parser_check(parser, KW_I128) || parser_check(parser, KW_I256) ||
-        parser_check(parser, KW_I512) || parser_check(parser, KW_I1024) ||
-        parser_check(parser, KW_U8) || parser_check(parser, KW_U16) ||
-        parser_check(parser, KW_U32) || parser_check(parser, KW_U64) ||
-        parser_check(parser, KW_U128) || parser_check(parser, KW_U256) ||
-        parser_check(parser, KW_U512) || parser_check(parser, KW_U1024) ||
-        parser_check(parser, KW_F32) || parser_check(parser, KW_F64) ||
-        parser_check(parser, KW_PTR) || parser_check(parser, KW_RAWPTR)) {
-      // This is a type annotation
-      type_annotation = malloc(sizeof(Type));
-      if (type_annotation) {
-        // Map token to TypeKind
-        switch (parser->current.kind) {
-          case KW_I8: type_annotation->kind = TYPE_I8; break;
-          case KW_I16: type_annotation->kind = TYPE_I16; break;
-          case KW_I32: type_annotation->kind = TYPE_I32; break;
-          case KW_I64: type_annotation->kind = TYPE_I64; break;
-          case KW_I128: type_annotation->kind = TYPE_I128; break;
-          case KW_I256: type_annotation->kind = TYPE_I256; break;
-          case KW_I512: type_annotation->kind = TYPE_I512; break;
-          case KW_I1024: type_annotation->kind = TYPE_I1024; break;
-          case KW_U8: type_annotation->kind = TYPE_U8; break;
-          case KW_U16: type_annotation->kind = TYPE_U16; break;
-          case KW_U32: type_annotation->kind = TYPE_U32; break;
-          case KW_U64: type_annotation->kind = TYPE_U64; break;
-          case KW_U128: type_annotation->kind = TYPE_U128; break;
-          case KW_U256: type_annotation->kind = TYPE_U256; break;
-          case KW_U512: type_annotation->kind = TYPE_U512; break;
-          case KW_U1024: type_annotation->kind = TYPE_U1024; break;
-          case KW_F32: type_annotation->kind = TYPE_F32; break;
-          case KW_F64: type_annotation->kind = TYPE_F64; break;
-          case KW_PTR: type_annotation->kind = TYPE_PTR; break;
-          case KW_RAWPTR: type_annotation->kind = TYPE_RAWPTR; break;
-          default: type_annotation->kind = TYPE_I64; break;
-        }
-      }
-      parser_advance(parser); // consume the type keyword
-    } else {
+    type_annotation = parse_type_keyword(parser);
+    if (!type_annotation) {
       // This is multi-variable declaration: let a:b := ...
       // Parse remaining variable names
-      char **names = malloc(8 * sizeof(char *));
+      const char **names = malloc(8 * sizeof(const char *));
       size_t name_count = 1;
       size_t name_capacity = 8;
       names[0] = name;
@@ -1724,24 +1775,20 @@ Stmt *parse_let_statement(Parser *parser) {
         
         if (name_count >= name_capacity) {
           name_capacity *= 2;
-          char **new_names = realloc(names, name_capacity * sizeof(char *));
+          const char **new_names =
+              realloc(names, name_capacity * sizeof(const char *));
           if (!new_names) {
-            for (size_t i = 0; i < name_count; i++) free(names[i]);
             free(names);
             return NULL;
           }
           names = new_names;
         }
         
-        size_t len = parser->previous.length;
-        names[name_count] = malloc(len + 1);
+        names[name_count] = token_name(&parser->previous);
         if (!names[name_count]) {
-          for (size_t i = 0; i < name_count; i++) free(names[i]);
           free(names);
           return NULL;
         }
-        strncpy(names[name_count], parser->previous.start, len);
-        names[name_count][len] = '\0';
         name_count++;
       } while (parser_match(parser, TOK_COLON));
       
@@ -1754,9 +1801,8 @@ Stmt *parse_let_statement(Parser *parser) {
       if (parser_check(parser, TOK_SEMICOLON)) parser_advance(parser);
       
       // Create multi-assignment statement
-      Expr *multi_assign = allocate_expr(EXPR_MULTI_ASSIGN);
+      Expr *multi_assign = allocate_expr(parser, EXPR_MULTI_ASSIGN);
       if (!multi_assign) {
-        for (size_t i = 0; i < name_count; i++) free(names[i]);
         free(names);
         free_expr(initializer);
         return NULL;
@@ -1764,7 +1810,7 @@ Stmt *parse_let_statement(Parser *parser) {
       
       multi_assign->data.multi_assign.targets = malloc(name_count * sizeof(Expr *));
       for (size_t i = 0; i < name_count; i++) {
-        Expr *id_expr = allocate_expr(EXPR_IDENTIFIER);
+        Expr *id_expr = allocate_expr(parser, EXPR_IDENTIFIER);
         id_expr->data.identifier = names[i];
         multi_assign->data.multi_assign.targets[i] = id_expr;
       }
@@ -1774,8 +1820,8 @@ Stmt *parse_let_statement(Parser *parser) {
       
       free(names);
       
-      Stmt *stmt = allocate_stmt(STMT_LET);
-      stmt->data.let.name = fcx_strdup(multi_assign->data.multi_assign.targets[0]->data.identifier);
+      Stmt *stmt = allocate_stmt(parser, STMT_LET);
+      stmt->data.let.name = multi_assign->data.multi_assign.targets[0]->data.identifier;
       stmt->data.let.type_annotation = NULL;
       stmt->data.let.initializer = multi_assign;
       stmt->data.let.is_const = is_const;
@@ -1787,7 +1833,6 @@ Stmt *parse_let_statement(Parser *parser) {
   if (parser_match(parser, OP_ASSIGN_INFER) || parser_match(parser, OP_ASSIGN)) {
     initializer = parse_expression(parser);
     if (!initializer) {
-      free(name);
       if (type_annotation) free(type_annotation);
       return NULL;
     }
@@ -1798,9 +1843,8 @@ Stmt *parse_let_statement(Parser *parser) {
     parser_advance(parser);
   }
 
-  Stmt *stmt = allocate_stmt(STMT_LET);
+  Stmt *stmt = allocate_stmt(parser, STMT_LET);
   if (!stmt) {
-    free(name);
     if (type_annotation) free(type_annotation);
     free_expr(initializer);
     return NULL;
@@ -1846,9 +1890,6 @@ Stmt *parse_if_statement(Parser *parser) {
       // Extract the value from the arrow expression
       Expr *value = right->data.binary.left;
 
-      // Free the arrow wrapper
-      free(right);
-
       // Update the comparison's right side
       condition->data.binary.right = value;
 
@@ -1873,7 +1914,7 @@ Stmt *parse_if_statement(Parser *parser) {
       then_branch.statements[0] = then_stmt;
       then_branch.count = 1;
 
-      Stmt *stmt = allocate_stmt(STMT_IF);
+      Stmt *stmt = allocate_stmt(parser, STMT_IF);
       if (!stmt) {
         free_expr(condition);
         free_block(&then_branch);
@@ -1898,8 +1939,7 @@ Stmt *parse_if_statement(Parser *parser) {
     // Extract the left side as the actual condition
     Expr *actual_condition = condition->data.binary.left;
 
-    // Free the binary wrapper but keep the left child
-    free(condition);
+    // Keep only the left child; the wrapper stays in the AST arena
     condition = actual_condition;
 
     is_compact = true;
@@ -1923,7 +1963,7 @@ Stmt *parse_if_statement(Parser *parser) {
     then_branch.statements[0] = then_stmt;
     then_branch.count = 1;
 
-    Stmt *stmt = allocate_stmt(STMT_IF);
+    Stmt *stmt = allocate_stmt(parser, STMT_IF);
     if (!stmt) {
       free_expr(condition);
       free_block(&then_branch);
@@ -1961,7 +2001,7 @@ Stmt *parse_if_statement(Parser *parser) {
     then_branch.statements[0] = then_stmt;
     then_branch.count = 1;
 
-    Stmt *stmt = allocate_stmt(STMT_IF);
+    Stmt *stmt = allocate_stmt(parser, STMT_IF);
     if (!stmt) {
       free_expr(condition);
       free_block(&then_branch);
@@ -1986,7 +2026,7 @@ Stmt *parse_if_statement(Parser *parser) {
     else_branch = parse_block(parser);
   }
 
-  Stmt *stmt = allocate_stmt(STMT_IF);
+  Stmt *stmt = allocate_stmt(parser, STMT_IF);
   if (!stmt) {
     free_expr(condition);
     return NULL;
@@ -2030,18 +2070,14 @@ Stmt *parse_loop_statement(Parser *parser) {
 
       if (parser_match(parser, OP_SLICE_START)) { // </ operator
         // Create identifier expression for loop variable
-        Expr *var_expr = allocate_expr(EXPR_IDENTIFIER);
+        Expr *var_expr = allocate_expr(parser, EXPR_IDENTIFIER);
         if (!var_expr)
           return NULL;
 
-        size_t name_len = var_token.length;
-        var_expr->data.identifier = malloc(name_len + 1);
+        var_expr->data.identifier = token_name(&var_token);
         if (!var_expr->data.identifier) {
-          free_expr(var_expr);
           return NULL;
         }
-        strncpy(var_expr->data.identifier, var_token.start, name_len);
-        var_expr->data.identifier[name_len] = '\0';
 
         condition = var_expr; // Store loop variable in condition field
         iteration = parse_expression(parser); // Parse bound expression
@@ -2062,7 +2098,7 @@ Stmt *parse_loop_statement(Parser *parser) {
   consume(parser, TOK_LBRACE, "Expected '{' before loop body");
   Block body = parse_block(parser);
 
-  Stmt *stmt = allocate_stmt(STMT_LOOP);
+  Stmt *stmt = allocate_stmt(parser, STMT_LOOP);
   if (!stmt) {
     free_expr(condition);
     free_expr(iteration);
@@ -2093,7 +2129,7 @@ Stmt *parse_return_statement(Parser *parser) {
     parser_advance(parser);
   }
 
-  Stmt *stmt = allocate_stmt(is_halt ? STMT_HALT : STMT_RETURN);
+  Stmt *stmt = allocate_stmt(parser, is_halt ? STMT_HALT : STMT_RETURN);
   if (!stmt) {
     free_expr(value);
     return NULL;
@@ -2112,7 +2148,7 @@ Stmt *parse_break_continue_statement(Parser *parser) {
   }
 
   // Create proper break/continue statement
-  Stmt *stmt = allocate_stmt(is_break ? STMT_BREAK : STMT_CONTINUE);
+  Stmt *stmt = allocate_stmt(parser, is_break ? STMT_BREAK : STMT_CONTINUE);
   if (!stmt)
     return NULL;
 
@@ -2132,7 +2168,7 @@ Stmt *parse_expression_statement(Parser *parser) {
     parser_advance(parser);
   }
 
-  Stmt *stmt = allocate_stmt(STMT_EXPRESSION);
+  Stmt *stmt = allocate_stmt(parser, STMT_EXPRESSION);
   if (!stmt) {
     free_expr(expr);
     return NULL;
@@ -2181,7 +2217,7 @@ Block parse_block(Parser *parser) {
 
 // Parse memory operations (mem>, >mem, stack>, @>, etc.)
 Expr *parse_memory_operation(Parser *parser, TokenKind op) {
-  Expr *expr = allocate_expr(EXPR_MEMORY_OP);
+  Expr *expr = allocate_expr(parser, EXPR_MEMORY_OP);
   if (!expr)
     return NULL;
 
@@ -2236,7 +2272,6 @@ Expr *parse_memory_operation(Parser *parser, TokenKind op) {
   Expr *first_operand = parse_precedence(parser, PREC_ASSIGNMENT);
   if (!first_operand) {
     free(expr->data.memory_op.operands);
-    free(expr);
     return NULL;
   }
   expr->data.memory_op.operands[expr->data.memory_op.operand_count++] = first_operand;
@@ -2251,7 +2286,6 @@ Expr *parse_memory_operation(Parser *parser, TokenKind op) {
           free_expr(expr->data.memory_op.operands[i]);
         }
         free(expr->data.memory_op.operands);
-        free(expr);
         return NULL;
       }
       expr->data.memory_op.operands = new_operands;
@@ -2263,7 +2297,6 @@ Expr *parse_memory_operation(Parser *parser, TokenKind op) {
         free_expr(expr->data.memory_op.operands[i]);
       }
       free(expr->data.memory_op.operands);
-      free(expr);
       return NULL;
     }
     expr->data.memory_op.operands[expr->data.memory_op.operand_count++] = operand;
@@ -2274,7 +2307,7 @@ Expr *parse_memory_operation(Parser *parser, TokenKind op) {
 
 // Parse atomic operations (!, !!, <=>, etc.)
 Expr *parse_atomic_operation(Parser *parser, TokenKind op) {
-  Expr *expr = allocate_expr(EXPR_ATOMIC_OP);
+  Expr *expr = allocate_expr(parser, EXPR_ATOMIC_OP);
   if (!expr)
     return NULL;
 
@@ -2318,7 +2351,6 @@ Expr *parse_atomic_operation(Parser *parser, TokenKind op) {
       }
       free(expr->data.atomic_op.operands);
       expr->data.atomic_op.operands = NULL; // Prevent double free
-      free(expr); // Use free() directly instead of free_expr()
       return NULL;
     }
   }
@@ -2329,7 +2361,7 @@ Expr *parse_atomic_operation(Parser *parser, TokenKind op) {
 
 // Parse syscall operations ($/, /$, sys%, etc.)
 Expr *parse_syscall_operation(Parser *parser, TokenKind op) {
-  Expr *expr = allocate_expr(EXPR_SYSCALL_OP);
+  Expr *expr = allocate_expr(parser, EXPR_SYSCALL_OP);
   if (!expr)
     return NULL;
 
@@ -2395,7 +2427,6 @@ Expr *parse_syscall_operation(Parser *parser, TokenKind op) {
         expr->data.syscall_op.args = NULL;
         free_expr(expr->data.syscall_op.syscall_num);
         expr->data.syscall_op.syscall_num = NULL;
-        free(expr);
         return NULL;
       }
 
@@ -2446,7 +2477,6 @@ Expr *parse_syscall_operation(Parser *parser, TokenKind op) {
       free_expr(expr->data.syscall_op.args[0]);
       free(expr->data.syscall_op.args);
       expr->data.syscall_op.args = NULL;
-      free(expr);
       return NULL;
     }
 
@@ -2661,23 +2691,23 @@ static char* extract_asm_variables_ex(const char* template, char*** var_names,
 }
 
 Expr *parse_inline_asm(Parser *parser) {
-  Expr *expr = allocate_expr(EXPR_INLINE_ASM);
+  Expr *expr = allocate_expr(parser, EXPR_INLINE_ASM);
   if (!expr) return NULL;
 
   expr->line = parser->previous.line;
   expr->column = parser->previous.column;
 
   // Initialize inline_asm data
-  expr->data.inline_asm.asm_template = NULL;
-  expr->data.inline_asm.output_constraints = NULL;
-  expr->data.inline_asm.input_constraints = NULL;
-  expr->data.inline_asm.output_exprs = NULL;
-  expr->data.inline_asm.input_exprs = NULL;
-  expr->data.inline_asm.clobbers = NULL;
-  expr->data.inline_asm.output_count = 0;
-  expr->data.inline_asm.input_count = 0;
-  expr->data.inline_asm.clobber_count = 0;
-  expr->data.inline_asm.is_volatile = true; // Default to volatile for safety
+  expr->data.inline_asm->asm_template = NULL;
+  expr->data.inline_asm->output_constraints = NULL;
+  expr->data.inline_asm->input_constraints = NULL;
+  expr->data.inline_asm->output_exprs = NULL;
+  expr->data.inline_asm->input_exprs = NULL;
+  expr->data.inline_asm->clobbers = NULL;
+  expr->data.inline_asm->output_count = 0;
+  expr->data.inline_asm->input_count = 0;
+  expr->data.inline_asm->clobber_count = 0;
+  expr->data.inline_asm->is_volatile = true; // Default to volatile for safety
 
   char *raw_template = NULL;
   
@@ -2751,9 +2781,12 @@ Expr *parse_inline_asm(Parser *parser) {
     while (dst > raw_template && (dst[-1] == ' ' || dst[-1] == '\n')) *--dst = '\0';
     free(raw);
     
-    // Move lexer past the closing '}' and get next token
-    parser->lexer->current = ptr + 1; // Skip past '}'
-    parser->lexer->line += lines_skipped;
+    // Move lexer past the closing '}' and get next token. A token buffer
+    // already resumed lexing there when it saw this block.
+    if (!parser->tokens) {
+      parser->lexer->current = ptr + 1; // Skip past '}'
+      parser->lexer->line += lines_skipped;
+    }
     parser_advance(parser); // get next token
     
   } else {
@@ -2774,7 +2807,7 @@ Expr *parse_inline_asm(Parser *parser) {
     return NULL;
   }
   
-  expr->data.inline_asm.asm_template = processed_template;
+  expr->data.inline_asm->asm_template = processed_template;
   
   // Separate variables into outputs and inputs based on detection
   if (var_count > 0) {
@@ -2788,9 +2821,9 @@ Expr *parse_inline_asm(Parser *parser) {
     
     // Allocate arrays for outputs
     if (output_count > 0) {
-      expr->data.inline_asm.output_constraints = malloc(output_count * sizeof(char*));
-      expr->data.inline_asm.output_exprs = malloc(output_count * sizeof(Expr*));
-      if (!expr->data.inline_asm.output_constraints || !expr->data.inline_asm.output_exprs) {
+      expr->data.inline_asm->output_constraints = malloc(output_count * sizeof(char*));
+      expr->data.inline_asm->output_exprs = malloc(output_count * sizeof(Expr*));
+      if (!expr->data.inline_asm->output_constraints || !expr->data.inline_asm->output_exprs) {
         for (size_t i = 0; i < var_count; i++) free(var_names[i]);
         free(var_names);
         free(is_output);
@@ -2801,9 +2834,9 @@ Expr *parse_inline_asm(Parser *parser) {
     
     // Allocate arrays for inputs
     if (input_count > 0) {
-      expr->data.inline_asm.input_constraints = malloc(input_count * sizeof(char*));
-      expr->data.inline_asm.input_exprs = malloc(input_count * sizeof(Expr*));
-      if (!expr->data.inline_asm.input_constraints || !expr->data.inline_asm.input_exprs) {
+      expr->data.inline_asm->input_constraints = malloc(input_count * sizeof(char*));
+      expr->data.inline_asm->input_exprs = malloc(input_count * sizeof(Expr*));
+      if (!expr->data.inline_asm->input_constraints || !expr->data.inline_asm->input_exprs) {
         for (size_t i = 0; i < var_count; i++) free(var_names[i]);
         free(var_names);
         free(is_output);
@@ -2816,11 +2849,12 @@ Expr *parse_inline_asm(Parser *parser) {
     size_t out_idx = 0;
     size_t in_idx = 0;
     for (size_t i = 0; i < var_count; i++) {
-      Expr* var_expr = allocate_expr(EXPR_IDENTIFIER);
+      Expr* var_expr = allocate_expr(parser, EXPR_IDENTIFIER);
       if (var_expr) {
         var_expr->line = expr->line;
         var_expr->column = expr->column;
-        var_expr->data.identifier = var_names[i]; // Transfer ownership
+        var_expr->data.identifier = fcx_intern_cstr(var_names[i]);
+        free(var_names[i]);
       } else {
         free(var_names[i]);
         continue;
@@ -2828,19 +2862,19 @@ Expr *parse_inline_asm(Parser *parser) {
       
       if (is_output[i]) {
         // Output constraint: "=r" (any general register, output)
-        expr->data.inline_asm.output_constraints[out_idx] = fcx_strdup("=r");
-        expr->data.inline_asm.output_exprs[out_idx] = var_expr;
+        expr->data.inline_asm->output_constraints[out_idx] = fcx_strdup("=r");
+        expr->data.inline_asm->output_exprs[out_idx] = var_expr;
         out_idx++;
       } else {
         // Input constraint: "r" (any general register)
-        expr->data.inline_asm.input_constraints[in_idx] = fcx_strdup("r");
-        expr->data.inline_asm.input_exprs[in_idx] = var_expr;
+        expr->data.inline_asm->input_constraints[in_idx] = fcx_strdup("r");
+        expr->data.inline_asm->input_exprs[in_idx] = var_expr;
         in_idx++;
       }
     }
     
-    expr->data.inline_asm.output_count = out_idx;
-    expr->data.inline_asm.input_count = in_idx;
+    expr->data.inline_asm->output_count = out_idx;
+    expr->data.inline_asm->input_count = in_idx;
     free(var_names);
     free(is_output);
   }
@@ -2849,21 +2883,21 @@ Expr *parse_inline_asm(Parser *parser) {
   if (parser_check(parser, TOK_STRING)) {
     // Parse output constraints
     size_t output_capacity = 4;
-    expr->data.inline_asm.output_constraints = malloc(output_capacity * sizeof(char*));
-    expr->data.inline_asm.output_exprs = malloc(output_capacity * sizeof(Expr*));
-    if (!expr->data.inline_asm.output_constraints || !expr->data.inline_asm.output_exprs) {
+    expr->data.inline_asm->output_constraints = malloc(output_capacity * sizeof(char*));
+    expr->data.inline_asm->output_exprs = malloc(output_capacity * sizeof(Expr*));
+    if (!expr->data.inline_asm->output_constraints || !expr->data.inline_asm->output_exprs) {
       free_expr(expr);
       return NULL;
     }
 
     // Parse output list: "=r", "=a", etc.
     while (parser_check(parser, TOK_STRING)) {
-      if (expr->data.inline_asm.output_count >= output_capacity) {
+      if (expr->data.inline_asm->output_count >= output_capacity) {
         output_capacity *= 2;
-        expr->data.inline_asm.output_constraints = realloc(
-            expr->data.inline_asm.output_constraints, output_capacity * sizeof(char*));
-        expr->data.inline_asm.output_exprs = realloc(
-            expr->data.inline_asm.output_exprs, output_capacity * sizeof(Expr*));
+        expr->data.inline_asm->output_constraints = realloc(
+            expr->data.inline_asm->output_constraints, output_capacity * sizeof(char*));
+        expr->data.inline_asm->output_exprs = realloc(
+            expr->data.inline_asm->output_exprs, output_capacity * sizeof(Expr*));
       }
 
       parser_advance(parser);
@@ -2875,9 +2909,9 @@ Expr *parse_inline_asm(Parser *parser) {
       }
       memcpy(constraint, parser->previous.start + 1, clen);
       constraint[clen] = '\0';
-      expr->data.inline_asm.output_constraints[expr->data.inline_asm.output_count] = constraint;
-      expr->data.inline_asm.output_exprs[expr->data.inline_asm.output_count] = NULL;
-      expr->data.inline_asm.output_count++;
+      expr->data.inline_asm->output_constraints[expr->data.inline_asm->output_count] = constraint;
+      expr->data.inline_asm->output_exprs[expr->data.inline_asm->output_count] = NULL;
+      expr->data.inline_asm->output_count++;
 
       if (!parser_match(parser, TOK_COMMA)) break;
     }
@@ -2896,22 +2930,22 @@ Expr *parse_inline_asm(Parser *parser) {
   if (parser_check(parser, TOK_STRING)) {
     // Check if this looks like an input (has parentheses after)
     // Peek ahead - for now just parse as inputs if we already have outputs
-    if (expr->data.inline_asm.output_count > 0) {
+    if (expr->data.inline_asm->output_count > 0) {
       size_t input_capacity = 4;
-      expr->data.inline_asm.input_constraints = malloc(input_capacity * sizeof(char*));
-      expr->data.inline_asm.input_exprs = malloc(input_capacity * sizeof(Expr*));
-      if (!expr->data.inline_asm.input_constraints || !expr->data.inline_asm.input_exprs) {
+      expr->data.inline_asm->input_constraints = malloc(input_capacity * sizeof(char*));
+      expr->data.inline_asm->input_exprs = malloc(input_capacity * sizeof(Expr*));
+      if (!expr->data.inline_asm->input_constraints || !expr->data.inline_asm->input_exprs) {
         free_expr(expr);
         return NULL;
       }
 
       while (parser_check(parser, TOK_STRING)) {
-        if (expr->data.inline_asm.input_count >= input_capacity) {
+        if (expr->data.inline_asm->input_count >= input_capacity) {
           input_capacity *= 2;
-          expr->data.inline_asm.input_constraints = realloc(
-              expr->data.inline_asm.input_constraints, input_capacity * sizeof(char*));
-          expr->data.inline_asm.input_exprs = realloc(
-              expr->data.inline_asm.input_exprs, input_capacity * sizeof(Expr*));
+          expr->data.inline_asm->input_constraints = realloc(
+              expr->data.inline_asm->input_constraints, input_capacity * sizeof(char*));
+          expr->data.inline_asm->input_exprs = realloc(
+              expr->data.inline_asm->input_exprs, input_capacity * sizeof(Expr*));
         }
 
         parser_advance(parser);
@@ -2923,7 +2957,7 @@ Expr *parse_inline_asm(Parser *parser) {
         }
         memcpy(constraint, parser->previous.start + 1, clen);
         constraint[clen] = '\0';
-        expr->data.inline_asm.input_constraints[expr->data.inline_asm.input_count] = constraint;
+        expr->data.inline_asm->input_constraints[expr->data.inline_asm->input_count] = constraint;
 
         // Parse (expr) for input value
         if (parser_match(parser, TOK_LPAREN)) {
@@ -2932,13 +2966,13 @@ Expr *parse_inline_asm(Parser *parser) {
             free_expr(expr);
             return NULL;
           }
-          expr->data.inline_asm.input_exprs[expr->data.inline_asm.input_count] = in_expr;
+          expr->data.inline_asm->input_exprs[expr->data.inline_asm->input_count] = in_expr;
           consume(parser, TOK_RPAREN, "Expected ')' after input expression");
         } else {
-          expr->data.inline_asm.input_exprs[expr->data.inline_asm.input_count] = NULL;
+          expr->data.inline_asm->input_exprs[expr->data.inline_asm->input_count] = NULL;
         }
 
-        expr->data.inline_asm.input_count++;
+        expr->data.inline_asm->input_count++;
         if (!parser_match(parser, TOK_COMMA)) break;
       }
     }
@@ -2952,8 +2986,10 @@ Stmt *parse_function(Parser *parser) {
 }
 
 // Memory management
-Expr *allocate_expr(ExprType type) {
-  Expr *expr = malloc(sizeof(Expr));
+_Static_assert(sizeof(Expr) <= 48, "Expr should stay within 48 bytes");
+
+Expr *allocate_expr(Parser *parser, ExprType type) {
+  Expr *expr = ast_arena_alloc(parser->arena, sizeof(Expr));
   if (expr) {
     expr->type = type;
     expr->line = 0;
@@ -2961,12 +2997,29 @@ Expr *allocate_expr(ExprType type) {
 
     // Initialize all union members to NULL/0
     memset(&expr->data, 0, sizeof(expr->data));
+
+    // Large payloads live out of line so they don't bloat every node
+    if (type == EXPR_FUNCTION_DEF) {
+      expr->data.function_def =
+          ast_arena_alloc(parser->arena, sizeof(FunctionDefExpr));
+      if (!expr->data.function_def) {
+        return NULL;
+      }
+      memset(expr->data.function_def, 0, sizeof(FunctionDefExpr));
+    } else if (type == EXPR_INLINE_ASM) {
+      expr->data.inline_asm =
+          ast_arena_alloc(parser->arena, sizeof(InlineAsmExpr));
+      if (!expr->data.inline_asm) {
+        return NULL;
+      }
+      memset(expr->data.inline_asm, 0, sizeof(InlineAsmExpr));
+    }
   }
   return expr;
 }
 
-Stmt *allocate_stmt(StmtType type) {
-  Stmt *stmt = malloc(sizeof(Stmt));
+Stmt *allocate_stmt(Parser *parser, StmtType type) {
+  Stmt *stmt = ast_arena_alloc(parser->arena, sizeof(Stmt));
   if (stmt) {
     stmt->type = type;
     stmt->line = 0;
@@ -2991,10 +3044,7 @@ void free_expr(Expr *expr) {
     break;
 
   case EXPR_IDENTIFIER:
-    if (expr->data.identifier) {
-      free(expr->data.identifier);
-    }
-    break;
+    break; // The name is interned
 
   case EXPR_BINARY:
     free_expr(expr->data.binary.left);
@@ -3054,16 +3104,9 @@ void free_expr(Expr *expr) {
     break;
 
   case EXPR_FUNCTION_DEF:
-    if (expr->data.function_def.name) {
-      free(expr->data.function_def.name);
-    }
-    for (size_t i = 0; i < expr->data.function_def.param_count; i++) {
-      if (expr->data.function_def.params[i].name) {
-        free(expr->data.function_def.params[i].name);
-      }
-    }
-    free(expr->data.function_def.params);
-    free_block(&expr->data.function_def.body);
+    // Names are interned
+    free(expr->data.function_def->params);
+    free_block(&expr->data.function_def->body);
     break;
 
   case EXPR_MEMORY_OP:
@@ -3091,39 +3134,37 @@ void free_expr(Expr *expr) {
     break;
     
   case EXPR_INLINE_ASM:
-    if (expr->data.inline_asm.asm_template) {
-      free((void*)expr->data.inline_asm.asm_template);
+    if (expr->data.inline_asm->asm_template) {
+      free((void*)expr->data.inline_asm->asm_template);
     }
-    for (size_t i = 0; i < expr->data.inline_asm.output_count; i++) {
-      if (expr->data.inline_asm.output_constraints && expr->data.inline_asm.output_constraints[i]) {
-        free((void*)expr->data.inline_asm.output_constraints[i]);
+    for (size_t i = 0; i < expr->data.inline_asm->output_count; i++) {
+      if (expr->data.inline_asm->output_constraints && expr->data.inline_asm->output_constraints[i]) {
+        free((void*)expr->data.inline_asm->output_constraints[i]);
       }
-      if (expr->data.inline_asm.output_exprs && expr->data.inline_asm.output_exprs[i]) {
-        free_expr(expr->data.inline_asm.output_exprs[i]);
+      if (expr->data.inline_asm->output_exprs && expr->data.inline_asm->output_exprs[i]) {
+        free_expr(expr->data.inline_asm->output_exprs[i]);
       }
     }
-    free(expr->data.inline_asm.output_constraints);
-    free(expr->data.inline_asm.output_exprs);
-    for (size_t i = 0; i < expr->data.inline_asm.input_count; i++) {
-      if (expr->data.inline_asm.input_constraints && expr->data.inline_asm.input_constraints[i]) {
-        free((void*)expr->data.inline_asm.input_constraints[i]);
+    free(expr->data.inline_asm->output_constraints);
+    free(expr->data.inline_asm->output_exprs);
+    for (size_t i = 0; i < expr->data.inline_asm->input_count; i++) {
+      if (expr->data.inline_asm->input_constraints && expr->data.inline_asm->input_constraints[i]) {
+        free((void*)expr->data.inline_asm->input_constraints[i]);
       }
-      if (expr->data.inline_asm.input_exprs && expr->data.inline_asm.input_exprs[i]) {
-        free_expr(expr->data.inline_asm.input_exprs[i]);
+      if (expr->data.inline_asm->input_exprs && expr->data.inline_asm->input_exprs[i]) {
+        free_expr(expr->data.inline_asm->input_exprs[i]);
       }
     }
-    free(expr->data.inline_asm.input_constraints);
-    free(expr->data.inline_asm.input_exprs);
-    for (size_t i = 0; i < expr->data.inline_asm.clobber_count; i++) {
-      if (expr->data.inline_asm.clobbers && expr->data.inline_asm.clobbers[i]) {
-        free((void*)expr->data.inline_asm.clobbers[i]);
+    free(expr->data.inline_asm->input_constraints);
+    free(expr->data.inline_asm->input_exprs);
+    for (size_t i = 0; i < expr->data.inline_asm->clobber_count; i++) {
+      if (expr->data.inline_asm->clobbers && expr->data.inline_asm->clobbers[i]) {
+        free((void*)expr->data.inline_asm->clobbers[i]);
       }
     }
-    free(expr->data.inline_asm.clobbers);
+    free(expr->data.inline_asm->clobbers);
     break;
   }
-
-  free(expr);
 }
 
 void free_stmt(Stmt *stmt) {
@@ -3136,22 +3177,13 @@ void free_stmt(Stmt *stmt) {
     break;
 
   case STMT_LET:
-    if (stmt->data.let.name) {
-      free(stmt->data.let.name);
-    }
     free_expr(stmt->data.let.initializer);
     break;
 
   case STMT_FUNCTION:
-    if (stmt->data.function.name) {
-      free(stmt->data.function.name);
-    }
-    for (size_t i = 0; i < stmt->data.function.param_count; i++) {
-      if (stmt->data.function.params[i].name) {
-        free(stmt->data.function.params[i].name);
-      }
-    }
-    free(stmt->data.function.params);
+    // Names are interned
+    free_params(stmt->data.function.params, stmt->data.function.param_count);
+    free(stmt->data.function.return_type);
     free_block(&stmt->data.function.body);
     break;
 
@@ -3203,8 +3235,6 @@ void free_stmt(Stmt *stmt) {
     }
     break;
   }
-
-  free(stmt);
 }
 
 void free_block(Block *block) {
@@ -3269,7 +3299,7 @@ Stmt *parse_mod_statement(Parser *parser, bool is_public) {
     char *name = parser_strdup(parser->previous.start, name_len);
     if (!name) return NULL;
     
-    Stmt *stmt = allocate_stmt(STMT_MOD);
+    Stmt *stmt = allocate_stmt(parser, STMT_MOD);
     if (!stmt) {
         free(name);
         return NULL;
@@ -3363,7 +3393,7 @@ static char** parse_use_path(Parser *parser, size_t *out_len) {
 Stmt *parse_use_statement(Parser *parser, bool is_public) {
     // We've already consumed 'use'
     
-    Stmt *stmt = allocate_stmt(STMT_USE);
+    Stmt *stmt = allocate_stmt(parser, STMT_USE);
     if (!stmt) return NULL;
     
     stmt->line = parser->previous.line;
@@ -3378,7 +3408,6 @@ Stmt *parse_use_statement(Parser *parser, bool is_public) {
     size_t path_len = 0;
     char **path = parse_use_path(parser, &path_len);
     if (!path) {
-        free(stmt);
         return NULL;
     }
     
@@ -2,6 +2,7 @@
 #define FCX_PARSER_H
 
 #include "../lexer/lexer.h"
+#include "ast_arena.h"
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -90,8 +91,8 @@ typedef struct {
             size_t length;
         } raw_bytes;
         struct {
-            uint64_t limbs[16];  // Up to 1024 bits (16 x 64-bit limbs), little-endian
-            uint8_t num_limbs;   // Number of limbs used (1-16)
+            uint64_t *limbs;     // num_limbs limbs in the AST arena, little-endian
+            uint8_t num_limbs;   // Number of limbs used (1-16, up to 1024 bits)
             bool is_negative;
         } bigint;
     } value;
@@ -123,7 +124,7 @@ struct Type {
 
 // Function parameter
 typedef struct {
-    char *name;
+    const char *name; // Interned
     Type *type;
 } Parameter;
 
@@ -134,15 +135,41 @@ typedef struct {
     size_t capacity;
 } Block;
 
+// Function definition expression (out of line, see Expr)
+typedef struct {
+    const char *name; // Interned
+    Parameter *params;
+    size_t param_count;
+    Block body;
+    bool is_compact; // <=> syntax vs fn syntax
+} FunctionDefExpr;
+
+// Inline assembly expression (out of line, see Expr)
+typedef struct {
+    char *asm_template;      // Assembly template string
+    char **output_constraints; // Output constraints ("=r", "=a", etc.)
+    char **input_constraints;  // Input constraints ("r", "m", etc.)
+    Expr **output_exprs;     // Output expressions (variables to write to)
+    Expr **input_exprs;      // Input expressions (values to read)
+    char **clobbers;         // Clobbered registers ("memory", "cc", etc.)
+    size_t output_count;
+    size_t input_count;
+    size_t clobber_count;
+    bool is_volatile;        // volatile asm
+} InlineAsmExpr;
+
 // Expression structure
+// Nodes live in the parser's AST arena. Kept at 48 bytes: rare, large
+// payloads (function definitions, inline asm, bigint limbs) are stored out
+// of line in the same arena.
 struct Expr {
     ExprType type;
-    size_t line;
-    size_t column;
+    uint32_t line;
+    uint32_t column;
     
     union {
         LiteralValue literal;
-        char *identifier;
+        const char *identifier; // Interned
         
         struct {
             TokenKind op;
@@ -198,13 +225,7 @@ struct Expr {
             Expr *else_expr;
         } conditional;
         
-        struct {
-            char *name;
-            Parameter *params;
-            size_t param_count;
-            Block body;
-            bool is_compact; // <=> syntax vs fn syntax
-        } function_def;
+        FunctionDefExpr *function_def;
         
         struct {
             enum {
@@ -252,18 +273,7 @@ struct Expr {
             } syscall_type;
         } syscall_op;
         
-        struct {
-            char *asm_template;      // Assembly template string
-            char **output_constraints; // Output constraints ("=r", "=a", etc.)
-            char **input_constraints;  // Input constraints ("r", "m", etc.)
-            Expr **output_exprs;     // Output expressions (variables to write to)
-            Expr **input_exprs;      // Input expressions (values to read)
-            char **clobbers;         // Clobbered registers ("memory", "cc", etc.)
-            size_t output_count;
-            size_t input_count;
-            size_t clobber_count;
-            bool is_volatile;        // volatile asm
-        } inline_asm;
+        InlineAsmExpr *inline_asm;
     } data;
 };
 
@@ -292,14 +302,14 @@ struct Stmt {
         Expr *expression;
         
         struct {
-            char *name;
+            const char *name; // Interned
             Type *type_annotation;
             Expr *initializer;
             bool is_const;
         } let;
         
         struct {
-            char *name;
+            const char *name; // Interned
             Parameter *params;
             size_t param_count;
             Type *return_type;
@@ -365,7 +375,14 @@ typedef struct {
 
 // Parser state
 typedef struct {
-    Lexer *lexer;
+    Lexer *lexer;                 // Streaming mode (NULL in token-array mode)
+    const TokenBuffer *tokens;    // Token-array mode (NULL when streaming)
+    size_t token_index;           // Next token to read from `tokens`
+    size_t token_end;             // Tokens at or past this index read as EOF
+    const char *source;
+    AstArena *arena;              // Holds every Expr/Stmt this parser returns
+    bool owns_arena;              // parser_destroy releases `arena`
+    bool quiet;                   // Record errors without printing them
     Token current;
     Token previous;
     bool had_error;
@@ -405,6 +422,22 @@ typedef struct {
 
 // Function declarations
 void parser_init(Parser *parser, Lexer *lexer);
+void parser_init_tokens(Parser *parser, const TokenBuffer *tokens);
+void parser_init_token_range(Parser *parser, const TokenBuffer *tokens,
+                             size_t begin, size_t end, AstArena *arena);
+void parser_destroy(Parser *parser);
+
+// Parse every top-level statement into a malloc'd array (nodes stay in
+// parser->arena). With jobs > 1 the token array is split at top-level fn
+// items and the pieces are parsed on `jobs` threads; the result is the same
+// as a serial parse. Returns false on a parse error or OOM.
+bool parse_program(Parser *parser, size_t jobs, Stmt ***statements,
+                   size_t *stmt_count);
+
+// Token indices in [begin, end) where a new top-level fn item starts, begin
+// always first, in a malloc'd array. Returns the count (0 on OOM).
+size_t parser_split_top_level_items(const TokenBuffer *tokens, size_t begin,
+                                    size_t end, size_t **starts);
 Expr *parse_expression(Parser *parser);
 Stmt *parse_statement(Parser *parser);
 Stmt *parse_function(Parser *parser);
@@ -477,8 +510,10 @@ void error_at_current(Parser *parser, const char *message);
 void error_at_previous(Parser *parser, const char *message);
 
 // Memory management
-Expr *allocate_expr(ExprType type);
-Stmt *allocate_stmt(StmtType type);
+// Nodes come from parser->arena and are released by parser_destroy;
+// free_expr/free_stmt only release the heap-allocated members of a node.
+Expr *allocate_expr(Parser *parser, ExprType type);
+Stmt *allocate_stmt(Parser *parser, StmtType type);
 void free_expr(Expr *expr);
 void free_stmt(Stmt *stmt);
 void free_block(Block *block);
@@ -0,0 +1,204 @@
+// Parallel parsing benchmark
+// Generates a large FCx source made of many independent top-level functions,
+// lexes it once, then parses it with parse_program at increasing -j values.
+// Every run must produce the same statement array; an AST hash (node kinds
+// and positions) is compared against the serial parse.
+// Usage: parser_bench [functions] [max_jobs]  (max_jobs defaults to #CPUs)
+
+#include "parser.h"
+#include "../bench_source.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static uint64_t hash_mix(uint64_t hash, uint64_t value) {
+  return (hash ^ value) * 1099511628211ULL;
+}
+
+static uint64_t hash_stmt(uint64_t hash, const Stmt *stmt);
+
+static uint64_t hash_expr(uint64_t hash, const Expr *expr) {
+  if (!expr) {
+    return hash_mix(hash, 0xff);
+  }
+  hash = hash_mix(hash, expr->type);
+  hash = hash_mix(hash, expr->line);
+  hash = hash_mix(hash, expr->column);
+
+  switch (expr->type) {
+  case EXPR_BINARY:
+    hash = hash_mix(hash, expr->data.binary.op);
+    hash = hash_expr(hash, expr->data.binary.left);
+    return hash_expr(hash, expr->data.binary.right);
+  case EXPR_UNARY:
+    hash = hash_mix(hash, expr->data.unary.op);
+    return hash_expr(hash, expr->data.unary.operand);
+  case EXPR_TERNARY:
+    hash = hash_expr(hash, expr->data.ternary.first);
+    hash = hash_expr(hash, expr->data.ternary.second);
+    return hash_expr(hash, expr->data.ternary.third);
+  case EXPR_CALL:
+    hash = hash_expr(hash, expr->data.call.function);
+    for (size_t i = 0; i < expr->data.call.arg_count; i++) {
+      hash = hash_expr(hash, expr->data.call.args[i]);
+    }
+    return hash;
+  case EXPR_INDEX:
+    hash = hash_expr(hash, expr->data.index.base);
+    return hash_expr(hash, expr->data.index.index);
+  case EXPR_ASSIGNMENT:
+    hash = hash_mix(hash, expr->data.assignment.op);
+    hash = hash_expr(hash, expr->data.assignment.target);
+    return hash_expr(hash, expr->data.assignment.value);
+  case EXPR_FUNCTION_DEF:
+    for (size_t i = 0; i < expr->data.function_def->body.count; i++) {
+      hash = hash_stmt(hash, expr->data.function_def->body.statements[i]);
+    }
+    return hash;
+  default:
+    return hash;
+  }
+}
+
+static uint64_t hash_block(uint64_t hash, const Block *block) {
+  hash = hash_mix(hash, block->count);
+  for (size_t i = 0; i < block->count; i++) {
+    hash = hash_stmt(hash, block->statements[i]);
+  }
+  return hash;
+}
+
+static uint64_t hash_stmt(uint64_t hash, const Stmt *stmt) {
+  if (!stmt) {
+    return hash_mix(hash, 0xfe);
+  }
+  hash = hash_mix(hash, stmt->type);
+  hash = hash_mix(hash, stmt->line);
+  hash = hash_mix(hash, stmt->column);
+
+  switch (stmt->type) {
+  case STMT_EXPRESSION:
+    return hash_expr(hash, stmt->data.expression);
+  case STMT_LET:
+    return hash_expr(hash, stmt->data.let.initializer);
+  case STMT_FUNCTION:
+    hash = hash_mix(hash, stmt->data.function.param_count);
+    return hash_block(hash, &stmt->data.function.body);
+  case STMT_IF:
+    hash = hash_expr(hash, stmt->data.if_stmt.condition);
+    hash = hash_block(hash, &stmt->data.if_stmt.then_branch);
+    return hash_block(hash, &stmt->data.if_stmt.else_branch);
+  case STMT_LOOP:
+    hash = hash_expr(hash, stmt->data.loop.condition);
+    hash = hash_expr(hash, stmt->data.loop.iteration);
+    return hash_block(hash, &stmt->data.loop.body);
+  case STMT_RETURN:
+  case STMT_HALT:
+    return hash_expr(hash, stmt->data.return_value);
+  default:
+    return hash;
+  }
+}
+
+// Parse the whole buffer with `jobs` threads; returns elapsed seconds
+static double parse_once(const TokenBuffer *tokens, size_t jobs,
+                         size_t *stmt_count, uint64_t *ast_hash,
+                         size_t *arena_bytes, bool *ok) {
+  Parser parser;
+  parser_init_tokens(&parser, tokens);
+
+  Stmt **statements = NULL;
+  double start = now_seconds();
+  *ok = parse_program(&parser, jobs, &statements, stmt_count);
+  double elapsed = now_seconds() - start;
+
+  uint64_t hash = 1469598103934665603ULL;
+  for (size_t i = 0; *ok && i < *stmt_count; i++) {
+    hash = hash_stmt(hash, statements[i]);
+  }
+  *ast_hash = hash;
+  *arena_bytes = parser.arena ? parser.arena->bytes_used : 0;
+
+  free(statements);
+  parser_destroy(&parser);
+  return elapsed;
+}
+
+int main(int argc, char **argv) {
+  size_t function_count = 20000;
+  if (argc > 1) {
+    function_count = (size_t)strtoul(argv[1], NULL, 10);
+    if (function_count == 0) {
+      function_count = 1;
+    }
+  }
+  long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t max_jobs = cpu_count > 0 ? (size_t)cpu_count : 1;
+  if (argc > 2) {
+    max_jobs = (size_t)strtoul(argv[2], NULL, 10);
+    if (max_jobs == 0) {
+      max_jobs = 1;
+    }
+  }
+
+  size_t size = 0;
+  char *source = generate_bench_source(BENCH_HELPER, BENCH_FUNCTION_TEMPLATE,
+                                       function_count, &size);
+  if (!source) {
+    fprintf(stderr, "Error: Failed to allocate benchmark source\n");
+    return 1;
+  }
+
+  init_operator_registry();
+  TokenBuffer tokens;
+  if (!token_buffer_fill(&tokens, source)) {
+    fprintf(stderr, "Error: Failed to lex benchmark source\n");
+    free(source);
+    return 1;
+  }
+
+  printf("=== FCx Parallel Parse Benchmark ===\n");
+  printf("%zu functions, %.2f MB, %zu tokens, %ld CPUs\n\n", function_count + 1,
+         (double)size / (1024.0 * 1024.0), tokens.count, cpu_count);
+
+  double serial = 0.0;
+  uint64_t reference_hash = 0;
+  size_t reference_count = 0;
+  for (size_t jobs = 1; jobs <= max_jobs; jobs *= 2) {
+    // Best of three to keep thread start-up noise out of the numbers
+    double best = 0.0;
+    size_t stmt_count = 0;
+    uint64_t hash = 0;
+    size_t arena_bytes = 0;
+    bool ok = true;
+    for (int run = 0; run < 3; run++) {
+      double elapsed =
+          parse_once(&tokens, jobs, &stmt_count, &hash, &arena_bytes, &ok);
+      if (run == 0 || elapsed < best) {
+        best = elapsed;
+      }
+    }
+    if (jobs == 1) {
+      serial = best;
+      reference_hash = hash;
+      reference_count = stmt_count;
+    }
+
+    printf("-j %-3zu %8zu stmts  %8.3f s  %6.2fx  %8zu KB AST%s%s\n", jobs,
+           stmt_count, best, best > 0 ? serial / best : 0.0,
+           arena_bytes / 1024, ok ? "" : "  (parse error)",
+           hash != reference_hash || stmt_count != reference_count
+               ? "  AST MISMATCH"
+               : "");
+    if (jobs < max_jobs && jobs * 2 > max_jobs) {
+      jobs = max_jobs / 2; // Always finish with every CPU
+    }
+  }
+
+  token_buffer_destroy(&tokens);
+  free(source);
+  cleanup_operator_registry();
+  return 0;
+}
@@ -0,0 +1,268 @@
+#include "parser.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// Parallel parsing of top-level items
+// Top-level fn items are independent, so the token array is cut at their
+// boundaries with a brace-matching pre-scan and each piece is parsed by its
+// own Parser. Worker threads allocate into per-thread arenas that are
+// adopted by the caller's arena afterwards; statements are concatenated in
+// source order. Any parse error discards the parallel result and reparses
+// serially, so diagnostics are exactly those of a serial parse.
+
+typedef struct {
+  size_t begin;      // First token of the piece
+  size_t end;        // One past the last token
+  Stmt **statements;
+  size_t count;
+  bool stopped;      // parse_statement returned NULL without an error
+} ParseSegment;
+
+typedef struct {
+  const TokenBuffer *tokens;
+  const Parser *settings;   // Flags copied into every worker parser
+  ParseSegment *segments;
+  size_t segment_count;
+  atomic_size_t next_segment;
+  atomic_bool failed;
+} ParallelParse;
+
+typedef struct {
+  ParallelParse *work;
+  AstArena *arena;
+  pthread_t thread;
+  bool started;
+} ParseWorker;
+
+// The serial top-level loop: parse until EOF or until parse_statement gives
+// up. *stopped is set when it gave up without reporting an error.
+static bool parse_statements(Parser *parser, Stmt ***statements,
+                             size_t *stmt_count, bool *stopped) {
+  size_t capacity = 0;
+  *statements = NULL;
+  *stmt_count = 0;
+  *stopped = false;
+
+  while (!parser_check(parser, TOK_EOF)) {
+    Stmt *stmt = parse_statement(parser);
+    if (!stmt) {
+      if (parser->had_error) {
+        return false;
+      }
+      *stopped = true;
+      break;
+    }
+
+    if (*stmt_count >= capacity) {
+      capacity = capacity ? capacity * 2 : 64;
+      Stmt **grown = realloc(*statements, capacity * sizeof(Stmt *));
+      if (!grown) {
+        parser->had_error = true;
+        return false;
+      }
+      *statements = grown;
+    }
+    (*statements)[(*stmt_count)++] = stmt;
+  }
+  return true;
+}
+
+// A boundary is `fn` or `pub fn` at brace depth 0 right after a `;` or `}`,
+// so `name <=> fn(...)` style definitions never split.
+size_t parser_split_top_level_items(const TokenBuffer *tokens, size_t begin,
+                                    size_t end, size_t **starts) {
+  size_t capacity = 64;
+  size_t count = 0;
+  *starts = malloc(capacity * sizeof(size_t));
+  if (!*starts) {
+    return 0;
+  }
+  (*starts)[count++] = begin;
+
+  size_t depth = 0;
+  for (size_t i = begin; i < end; i++) {
+    TokenKind kind = (TokenKind)tokens->tokens[i].kind;
+    if (kind == TOK_LBRACE) {
+      depth++;
+      continue;
+    }
+    if (kind == TOK_RBRACE) {
+      if (depth > 0) {
+        depth--;
+      }
+      continue;
+    }
+    if (depth != 0 || i == begin) {
+      continue;
+    }
+
+    bool starts_fn =
+        kind == KW_FN ||
+        (kind == KW_PUB && i + 1 < end && tokens->tokens[i + 1].kind == KW_FN);
+    TokenKind prev = (TokenKind)tokens->tokens[i - 1].kind;
+    if (!starts_fn || (prev != TOK_SEMICOLON && prev != TOK_RBRACE)) {
+      continue;
+    }
+
+    if (count >= capacity) {
+      capacity *= 2;
+      size_t *grown = realloc(*starts, capacity * sizeof(size_t));
+      if (!grown) {
+        free(*starts);
+        *starts = NULL;
+        return 0;
+      }
+      *starts = grown;
+    }
+    (*starts)[count++] = i;
+  }
+  return count;
+}
+
+static void *parse_worker(void *arg) {
+  ParseWorker *worker = arg;
+  ParallelParse *work = worker->work;
+
+  for (;;) {
+    size_t index = atomic_fetch_add(&work->next_segment, 1);
+    if (index >= work->segment_count || atomic_load(&work->failed)) {
+      break;
+    }
+
+    ParseSegment *segment = &work->segments[index];
+    Parser parser;
+    parser_init_token_range(&parser, work->tokens, segment->begin,
+                            segment->end, worker->arena);
+    parser.quiet = true;
+    parser.disallow_ambiguous_ops = work->settings->disallow_ambiguous_ops;
+    parser.strict_parsing = work->settings->strict_parsing;
+
+    // Errors the parser recovered from count too: the serial reparse has to
+    // report them
+    if (!parse_statements(&parser, &segment->statements, &segment->count,
+                          &segment->stopped) ||
+        parser.had_error) {
+      atomic_store(&work->failed, true);
+    }
+  }
+  return NULL;
+}
+
+// Returns false when the parallel attempt has to be abandoned; parser is
+// untouched in that case
+static bool parse_program_parallel(Parser *parser, size_t jobs,
+                                   Stmt ***statements, size_t *stmt_count) {
+  size_t begin = parser->token_index - 1; // parser->current
+  size_t *starts = NULL;
+  size_t segment_count =
+      parser_split_top_level_items(parser->tokens, begin, parser->token_end,
+                                   &starts);
+  if (segment_count < 2) {
+    free(starts);
+    return false;
+  }
+
+  ParallelParse work = {
+      .tokens = parser->tokens,
+      .settings = parser,
+      .segments = calloc(segment_count, sizeof(ParseSegment)),
+      .segment_count = segment_count,
+  };
+  atomic_init(&work.next_segment, 0);
+  atomic_init(&work.failed, false);
+
+  size_t worker_count = jobs < segment_count ? jobs : segment_count;
+  ParseWorker *workers = calloc(worker_count, sizeof(ParseWorker));
+  bool ok = work.segments != NULL && workers != NULL;
+
+  for (size_t i = 0; ok && i < segment_count; i++) {
+    work.segments[i].begin = starts[i];
+    work.segments[i].end =
+        i + 1 < segment_count ? starts[i + 1] : parser->token_end;
+  }
+  free(starts);
+
+  for (size_t i = 0; ok && i < worker_count; i++) {
+    workers[i].work = &work;
+    workers[i].arena = ast_arena_create();
+    ok = workers[i].arena != NULL;
+  }
+
+  if (ok) {
+    // The calling thread is worker 0
+    for (size_t i = 1; i < worker_count; i++) {
+      workers[i].started = pthread_create(&workers[i].thread, NULL,
+                                          parse_worker, &workers[i]) == 0;
+    }
+    parse_worker(&workers[0]);
+    for (size_t i = 1; i < worker_count; i++) {
+      if (workers[i].started) {
+        pthread_join(workers[i].thread, NULL);
+      }
+    }
+    ok = !atomic_load(&work.failed);
+  }
+
+  // Concatenate in source order, ending where a serial parse would stop
+  size_t total = 0;
+  size_t used_segments = 0;
+  for (size_t i = 0; ok && i < segment_count; i++) {
+    total += work.segments[i].count;
+    used_segments = i + 1;
+    if (work.segments[i].stopped) {
+      break;
+    }
+  }
+  Stmt **merged = ok ? malloc((total ? total : 1) * sizeof(Stmt *)) : NULL;
+  ok = merged != NULL;
+  if (ok) {
+    size_t n = 0;
+    for (size_t i = 0; i < used_segments; i++) {
+      for (size_t j = 0; j < work.segments[i].count; j++) {
+        merged[n++] = work.segments[i].statements[j];
+      }
+    }
+  }
+
+  for (size_t i = 0; work.segments && i < segment_count; i++) {
+    free(work.segments[i].statements);
+  }
+  free(work.segments);
+  for (size_t i = 0; workers && i < worker_count; i++) {
+    if (ok) {
+      ast_arena_adopt(parser->arena, workers[i].arena);
+    } else {
+      ast_arena_destroy(workers[i].arena);
+    }
+  }
+  free(workers);
+
+  if (!ok) {
+    return false;
+  }
+
+  // Leave the caller's parser at EOF, as after a serial parse
+  parser->token_index = parser->token_end;
+  parser_advance(parser);
+  *statements = merged;
+  *stmt_count = total;
+  return true;
+}
+
+bool parse_program(Parser *parser, size_t jobs, Stmt ***statements,
+                   size_t *stmt_count) {
+  if (jobs > 1 && parser->tokens && parser->arena && !parser->had_error &&
+      parse_program_parallel(parser, jobs, statements, stmt_count)) {
+    return true;
+  }
+
+  bool stopped;
+  if (!parse_statements(parser, statements, stmt_count, &stopped)) {
+    free(*statements);
+    *statements = NULL;
+    *stmt_count = 0;
+    return false;
+  }
+  return true;
+}